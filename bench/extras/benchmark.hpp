@@ -0,0 +1,110 @@
+//
+// Copyright (c) Mark A. Gibbs, 2015.
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+// 
+
+// A minimal benchmark runner.
+// 
+// Each benchmark is a callable that performs one iteration of the work being
+// measured. The runner does a few untimed warm-up iterations, then times a
+// fixed number of iterations both by wall clock and (where available) with
+// hardware performance counters, and reports the results per element.
+// Counter values marked with * were multiplexed by the kernel, and have been
+// scaled up from the fraction of the time the counter was running.
+// 
+// Requires at least C++11.
+
+#ifndef BOOST_RANGEIO_BenchInc_extras_X_benchmark_2015_01_01_
+#define BOOST_RANGEIO_BenchInc_extras_X_benchmark_2015_01_01_
+
+#include <boost/config.hpp>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+
+#include "perf_counters.hpp"
+
+namespace boost {
+namespace rangeio {
+namespace bench_extras {
+
+// 
+// Prevents the compiler from optimizing away a computed value.
+// 
+template <typename T>
+inline void do_not_optimize(T const& value)
+{
+#if defined(__GNUC__)
+  asm volatile("" : : "r,m"(value) : "memory");
+#else
+  static volatile T const* sink;
+  sink = &value;
+#endif
+}
+
+class benchmark_runner
+{
+public:
+  explicit benchmark_runner(::std::size_t iterations = 100, ::std::size_t warmups = 5) :
+    iterations_(iterations),
+    warmups_(warmups)
+  {
+    if (!counters_.any_available())
+      ::std::printf("# hardware performance counters unavailable; reporting wall-clock time only\n");
+    
+    ::std::printf("%-48s %12s", "benchmark", "ns/elem");
+    for (int i = 0; i != perf_counter_count; ++i)
+      ::std::printf(" %14s", perf_counter_name(perf_counter_id(i)));
+    ::std::printf("\n");
+  }
+  
+  // Runs a benchmark, where each call to f() processes elements elements.
+  template <typename F>
+  void run(char const* name, ::std::size_t elements, F f)
+  {
+    for (::std::size_t i = 0; i != warmups_; ++i)
+      f();
+    
+    typedef ::std::chrono::steady_clock clock;
+    
+    counters_.start();
+    clock::time_point const start = clock::now();
+    
+    for (::std::size_t i = 0; i != iterations_; ++i)
+      f();
+    
+    clock::time_point const stop = clock::now();
+    counters_.stop();
+    
+    perf_counter_values const values = counters_.read();
+    
+    double const total = double(iterations_) * double(elements ? elements : 1);
+    double const ns = double(::std::chrono::duration_cast< ::std::chrono::nanoseconds>(stop - start).count());
+    
+    ::std::printf("%-48s %12.2f", name, ns / total);
+    for (int i = 0; i != perf_counter_count; ++i)
+    {
+      if (values.available[i] && values.scaled[i])
+        ::std::printf(" %13.2f*", double(values.value[i]) / total);
+      else if (values.available[i])
+        ::std::printf(" %14.2f", double(values.value[i]) / total);
+      else
+        ::std::printf(" %14s", "n/a");
+    }
+    ::std::printf("\n");
+  }
+  
+private:
+  ::std::size_t iterations_;
+  ::std::size_t warmups_;
+  perf_counters counters_;
+};
+
+} // namespace bench_extras
+} // namespace rangeio
+} // namespace boost
+
+#endif  // include guard
@@ -0,0 +1,235 @@
+//
+// Copyright (c) Mark A. Gibbs, 2015.
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+// 
+
+// Hardware performance counter collection for the benchmarks, via Linux's
+// perf_event_open().
+// 
+// Each counter is opened individually rather than as a group, so that if some
+// counters are not available (no PMU in a virtual machine, restrictive
+// perf_event_paranoid settings, unsupported cache events, and so on) the
+// others can still be collected. On non-Linux platforms, or when a counter
+// cannot be opened, the counter is simply reported as unavailable.
+// 
+// Because the counters are not grouped, the kernel may multiplex them onto
+// the available hardware counters, so that each only counts for part of the
+// time it is enabled. Each counter therefore also reads the time it was
+// enabled and the time it was actually running, and its value is scaled up by
+// their ratio (and flagged as an estimate). A counter that never ran is
+// reported as unavailable.
+// 
+// Requires at least C++11.
+
+#ifndef BOOST_RANGEIO_BenchInc_extras_X_perf_counters_2015_01_01_
+#define BOOST_RANGEIO_BenchInc_extras_X_perf_counters_2015_01_01_
+
+#include <boost/config.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__linux__)
+#   include <linux/perf_event.h>
+#   include <sys/ioctl.h>
+#   include <sys/syscall.h>
+#   include <unistd.h>
+#   define BOOST_RANGEIO_BENCH_HAS_PERF_EVENTS
+#endif
+
+namespace boost {
+namespace rangeio {
+namespace bench_extras {
+
+// The counters that are collected, in the order they are reported.
+enum perf_counter_id
+{
+  perf_cycles,
+  perf_instructions,
+  perf_branch_misses,
+  perf_l1d_misses,
+  perf_llc_misses,
+  
+  perf_counter_count
+};
+
+inline char const* perf_counter_name(perf_counter_id id)
+{
+  static char const* const names[perf_counter_count] =
+  {
+    "cycles",
+    "instructions",
+    "branch-misses",
+    "L1d-misses",
+    "LLC-misses"
+  };
+  
+  return names[id];
+}
+
+// 
+// The values read from a set of counters.
+// 
+// Counters that could not be opened (or read), or that were never scheduled
+// onto the hardware, have available[id] == false, and their value is
+// meaningless. Counters that were multiplexed have scaled[id] == true, and
+// their value is an estimate extrapolated from the time they were running.
+// 
+struct perf_counter_values
+{
+  ::std::uint64_t value[perf_counter_count];
+  bool            available[perf_counter_count];
+  bool            scaled[perf_counter_count];
+};
+
+// 
+// A set of hardware performance counters for the calling thread.
+// 
+// Usage: construct once, then bracket the code to be measured with start()
+// and stop(), then call read(). Counters are not inherited by child threads.
+// 
+class perf_counters
+{
+public:
+  perf_counters()
+  {
+    for (int i = 0; i != perf_counter_count; ++i)
+      fd_[i] = -1;
+
+#ifdef BOOST_RANGEIO_BENCH_HAS_PERF_EVENTS
+    fd_[perf_cycles] = open_(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+    fd_[perf_instructions] = open_(PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+    fd_[perf_branch_misses] = open_(PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES);
+    fd_[perf_l1d_misses] = open_(PERF_TYPE_HW_CACHE,
+      PERF_COUNT_HW_CACHE_L1D |
+      (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+      (PERF_COUNT_HW_CACHE_RESULT_MISS << 16));
+    fd_[perf_llc_misses] = open_(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
+#endif // BOOST_RANGEIO_BENCH_HAS_PERF_EVENTS
+  }
+  
+  ~perf_counters()
+  {
+#ifdef BOOST_RANGEIO_BENCH_HAS_PERF_EVENTS
+    for (int i = 0; i != perf_counter_count; ++i)
+    {
+      if (fd_[i] != -1)
+        ::close(fd_[i]);
+    }
+#endif // BOOST_RANGEIO_BENCH_HAS_PERF_EVENTS
+  }
+  
+  perf_counters(perf_counters const&) = delete;
+  perf_counters& operator=(perf_counters const&) = delete;
+  
+  // True if at least one counter could be opened.
+  bool any_available() const
+  {
+    for (int i = 0; i != perf_counter_count; ++i)
+    {
+      if (fd_[i] != -1)
+        return true;
+    }
+    
+    return false;
+  }
+  
+  void start()
+  {
+#ifdef BOOST_RANGEIO_BENCH_HAS_PERF_EVENTS
+    for (int i = 0; i != perf_counter_count; ++i)
+    {
+      if (fd_[i] != -1)
+      {
+        ::ioctl(fd_[i], PERF_EVENT_IOC_RESET, 0);
+        ::ioctl(fd_[i], PERF_EVENT_IOC_ENABLE, 0);
+      }
+    }
+#endif // BOOST_RANGEIO_BENCH_HAS_PERF_EVENTS
+  }
+  
+  void stop()
+  {
+#ifdef BOOST_RANGEIO_BENCH_HAS_PERF_EVENTS
+    for (int i = 0; i != perf_counter_count; ++i)
+    {
+      if (fd_[i] != -1)
+        ::ioctl(fd_[i], PERF_EVENT_IOC_DISABLE, 0);
+    }
+#endif // BOOST_RANGEIO_BENCH_HAS_PERF_EVENTS
+  }
+  
+  perf_counter_values read() const
+  {
+    perf_counter_values values;
+    
+    for (int i = 0; i != perf_counter_count; ++i)
+    {
+      values.value[i] = 0;
+      values.available[i] = false;
+      values.scaled[i] = false;
+
+#ifdef BOOST_RANGEIO_BENCH_HAS_PERF_EVENTS
+      if (fd_[i] != -1)
+      {
+        // The layout given by the read_format set in open_().
+        struct
+        {
+          ::std::uint64_t value;
+          ::std::uint64_t time_enabled;
+          ::std::uint64_t time_running;
+        } r = {};
+        
+        if (::read(fd_[i], &r, sizeof(r)) == ssize_t(sizeof(r)) && r.time_running != 0)
+        {
+          values.available[i] = true;
+          
+          if (r.time_running < r.time_enabled)
+          {
+            values.value[i] = ::std::uint64_t(double(r.value) * (double(r.time_enabled) / double(r.time_running)));
+            values.scaled[i] = true;
+          }
+          else
+          {
+            values.value[i] = r.value;
+          }
+        }
+      }
+#endif // BOOST_RANGEIO_BENCH_HAS_PERF_EVENTS
+    }
+    
+    return values;
+  }
+  
+private:
+#ifdef BOOST_RANGEIO_BENCH_HAS_PERF_EVENTS
+  static int open_(::std::uint32_t type, ::std::uint64_t config)
+  {
+    perf_event_attr attr;
+    ::std::memset(&attr, 0, sizeof(attr));
+    
+    attr.type = type;
+    attr.size = sizeof(attr);
+    attr.config = config;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    
+    long const fd = ::syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+    
+    return (fd < 0) ? -1 : int(fd);
+  }
+#endif // BOOST_RANGEIO_BENCH_HAS_PERF_EVENTS
+
+  int fd_[perf_counter_count];
+};
+
+} // namespace bench_extras
+} // namespace rangeio
+} // namespace boost
+
+#endif  // include guard
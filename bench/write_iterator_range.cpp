@@ -0,0 +1,159 @@
+//
+// Copyright (c) Mark A. Gibbs, 2015.
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+// 
+
+// Benchmarks for write_iterator_range() and the underlying detail::write_impl()
+// functions.
+// 
+// Each benchmark writes a range of 10000 elements into an in-memory sink that
+// is rewound (not reallocated) before each iteration, so that the results
+// reflect the cost of formatting and not of the sink.
+// 
+// This benchmark requires C++11.
+
+#include <boost/config.hpp>
+
+#ifdef BOOST_NO_CXX11_RVALUE_REFERENCES
+#   include <iostream>
+int main() { ::std::cout << "Not supported in C++98.\n"; }
+#else
+
+#include <cstddef>
+#include <deque>
+#include <list>
+#include <locale>
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+#include <boost/rangeio/detail/formatting_saver.hpp>
+#include <boost/rangeio/detail/write.hpp>
+#include <boost/rangeio/write_iterator_range.hpp>
+
+#include "extras/benchmark.hpp"
+
+namespace {
+
+// An output stream buffer over a large fixed buffer, that can be rewound.
+class rewindable_streambuf :
+  public ::std::streambuf
+{
+public:
+  explicit rewindable_streambuf(::std::size_t n) :
+    buffer_(n)
+  {
+    rewind();
+  }
+  
+  void rewind() { setp(buffer_.data(), buffer_.data() + buffer_.size()); }
+  
+private:
+  ::std::vector<char> buffer_;
+};
+
+::std::size_t const elements = 10000;
+
+} // anonymous namespace
+
+int main()
+{
+  using ::boost::rangeio::bench_extras::do_not_optimize;
+  
+  ::std::vector<int> ints;
+  ::std::vector<double> doubles;
+  ::std::vector< ::std::string> strings;
+  for (::std::size_t i = 0; i != elements; ++i)
+  {
+    ints.push_back(int(i * 7919));
+    doubles.push_back(double(i) * 0.125);
+    strings.push_back("element");
+  }
+  
+  ::std::list<int> const int_list(ints.begin(), ints.end());
+  ::std::deque<int> const int_deque(ints.begin(), ints.end());
+  
+  rewindable_streambuf buf(elements * 32);
+  ::std::ostream out(&buf);
+  out.imbue(::std::locale::classic());
+  
+  ::boost::rangeio::bench_extras::benchmark_runner runner;
+  
+  runner.run("write_impl/vector<int>", elements, [&]
+  {
+    buf.rewind();
+    ::std::vector<int>::const_iterator i = ints.begin();
+    ::std::size_t n = 0;
+    ::boost::rangeio::detail::write_impl(out, i, ints.cend(), n);
+    do_not_optimize(n);
+  });
+  
+  runner.run("write_impl/vector<int>/char delim", elements, [&]
+  {
+    buf.rewind();
+    ::std::vector<int>::const_iterator i = ints.begin();
+    ::std::size_t n = 0;
+    char const delim = ',';
+    ::boost::rangeio::detail::write_impl(out, i, ints.cend(), delim, n);
+    do_not_optimize(n);
+  });
+  
+  runner.run("write_iterator_range/vector<int>", elements, [&]
+  {
+    buf.rewind();
+    do_not_optimize(::boost::rangeio::write_iterator_range(out, ints.begin(), ints.end()).count);
+  });
+  
+  runner.run("write_iterator_range/vector<int>/str delim", elements, [&]
+  {
+    buf.rewind();
+    do_not_optimize(::boost::rangeio::write_iterator_range(out, ints.begin(), ints.end(), ", ").count);
+  });
+  
+  runner.run("write_iterator_range/list<int>/str delim", elements, [&]
+  {
+    buf.rewind();
+    do_not_optimize(::boost::rangeio::write_iterator_range(out, int_list.begin(), int_list.end(), ", ").count);
+  });
+  
+  runner.run("write_iterator_range/deque<int>/str delim", elements, [&]
+  {
+    buf.rewind();
+    do_not_optimize(::boost::rangeio::write_iterator_range(out, int_deque.begin(), int_deque.end(), ", ").count);
+  });
+  
+  runner.run("write_iterator_range/vector<double>/str delim", elements, [&]
+  {
+    buf.rewind();
+    do_not_optimize(::boost::rangeio::write_iterator_range(out, doubles.begin(), doubles.end(), ", ").count);
+  });
+  
+  runner.run("write_iterator_range/vector<string>/str delim", elements, [&]
+  {
+    buf.rewind();
+    do_not_optimize(::boost::rangeio::write_iterator_range(out, strings.begin(), strings.end(), ", ").count);
+  });
+  
+  runner.run("write_iterator_range (deferred)/vector<int>", elements, [&]
+  {
+    buf.rewind();
+    out << ::boost::rangeio::write_iterator_range(ints.begin(), ints.end(), ' ');
+  });
+  
+  // The per-element cost of restoring the formatting state when no element
+  // has changed it (the locale is not checked - see formatting_saver).
+  runner.run("formatting_saver::restore", elements, [&]
+  {
+    ::boost::rangeio::detail::formatting_saver<char, ::std::char_traits<char>> const saver(out);
+    for (::std::size_t i = 0; i != elements; ++i)
+      saver.restore();
+    do_not_optimize(out.width());
+  });
+  
+  return out ? 0 : 1;
+}
+
+#endif  // BOOST_NO_CXX11_RVALUE_REFERENCES
@@ -0,0 +1,311 @@
+//
+// Copyright (c) Mark A. Gibbs, 2015.
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+// 
+
+// Defines the write_base64() functions, which write contiguous ranges of
+// bytes in base64 or base64url, the read_base64() function, which reads them
+// back, and base64_format, which selects the variant.
+// 
+// Requires at least C++11.
+
+#ifndef BOOST_RANGEIO_Inc_base64_2015_01_01_
+#define BOOST_RANGEIO_Inc_base64_2015_01_01_
+
+#include <boost/config.hpp>
+
+#ifdef BOOST_NO_CXX11_RVALUE_REFERENCES
+#   error "C++98 is not supported"
+#else
+
+#include <cstddef>
+#include <ios>
+#include <istream>
+#include <locale>
+#include <ostream>
+#include <type_traits>
+#include <utility>
+
+#include <boost/core/enable_if.hpp>
+
+#include <boost/rangeio/detail/base64.hpp>
+#include <boost/rangeio/detail/batch_output.hpp>
+#include <boost/rangeio/detail/module_export.hpp>
+#include <boost/rangeio/write_iterator_range.hpp>
+
+namespace boost {
+namespace rangeio {
+
+// Variant of base64 written by write_base64() and read by read_base64().
+// 
+// Members:
+//   url:     if true, the base64url alphabet (RFC 4648 section 5, with '-'
+//            and '_' rather than '+' and '/') is used.
+//   padding: if true, the output is padded with '=' to a multiple of 4
+//            characters. (read_base64() accepts input with or without
+//            padding either way.)
+// 
+// The default is standard, padded base64. base64url() gives the usual
+// variant for URLs and tokens: base64url, without padding.
+// 
+BOOST_RANGEIO_MODULE_EXPORT struct base64_format
+{
+  base64_format() :
+    url(false),
+    padding(true)
+  {}
+  
+  static base64_format base64url()
+  {
+    base64_format f;
+    f.url = true;
+    f.padding = false;
+    return f;
+  }
+  
+  bool  url;
+  bool  padding;
+};
+
+// Result type from read_base64().
+// 
+// Has two public data members:
+//   next:  the output iterator, after the last byte decoded.
+//   count: the number of bytes decoded
+// 
+BOOST_RANGEIO_MODULE_EXPORT template <typename OutputIterator>
+struct read_base64_result_t
+{
+  typedef OutputIterator iterator;
+  
+  iterator       next;
+  ::std::size_t  count;
+
+//protected:
+  explicit read_base64_result_t(iterator p) :
+    next(::std::move(p)),
+    count(0)
+  {}
+};
+
+namespace detail {
+
+// Tests whether T can be written by write_base64(): the integer types the
+// size of a byte, except bool.
+template <typename T>
+struct is_base64_element :
+  ::std::integral_constant<bool,
+    ::std::is_integral<T>::value &&
+    (sizeof(T) == 1) &&
+    !::std::is_same<typename ::std::remove_cv<T>::type, bool>::value>
+{};
+
+// Underlying implementation function for write_base64().
+// 
+// Encodes the bytes [i, e) according to f, into a batch_output that writes
+// to out's stream buffer, a block of complete groups at a time (see
+// base64_encode_groups(), which is vectorized where possible), then the
+// final partial group. On return, n is the number of bytes whose encoding
+// was completely handed to the stream buffer, and i refers to the first byte
+// that was not. If the stream buffer fails, out's badbit is set. As with
+// write_impl(), the stream's width is reset to zero.
+template <typename T, typename CharT, typename Traits>
+void base64_write_impl(
+  ::std::basic_ostream<CharT, Traits>& out,
+  T const*& i,
+  T const* const e,
+  ::std::size_t& n,
+  base64_format const& f)
+{
+  ::std::ios_base::iostate state = ::std::ios_base::goodbit;
+  
+  if ((i != e) && bool(out))
+  {
+    typename ::std::basic_ostream<CharT, Traits>::sentry const sentry(out);
+    
+    if (sentry)
+    {
+      ::std::ctype<CharT> const& ct = ::std::use_facet< ::std::ctype<CharT>>(out.getloc());
+      
+      CharT alphabet[64];
+      char const* const narrow_alphabet = detail::base64_alphabet(f.url);
+      ct.widen(narrow_alphabet, narrow_alphabet + 64, alphabet);
+      
+      CharT const pad = f.padding ? ct.widen('=') : CharT();
+      
+      detail::batch_output<CharT, Traits> batch(out);
+      
+      unsigned char const* p = reinterpret_cast<unsigned char const*>(i);
+      ::std::size_t groups = ::std::size_t(e - i) / 3;
+      
+      while ((groups != 0) && batch.reserve(4))
+      {
+        ::std::size_t const available = batch.space() / 4;
+        ::std::size_t const k = (groups < available) ? groups : available;
+        
+        detail::base64_encode_groups(p, k, batch.position(), alphabet);
+        batch.commit(4 * k);
+        batch.end_groups(k, 4, 3);
+        
+        p += 3 * k;
+        groups -= k;
+      }
+      
+      ::std::size_t const rest = ::std::size_t(e - i) % 3;
+      
+      if ((groups == 0) && (rest != 0) && batch.reserve(4))
+      {
+        batch.commit(detail::base64_encode_tail(p, rest, batch.position(), alphabet, pad));
+        batch.end_element(rest);
+      }
+      
+      if (!batch.flush())
+        state |= ::std::ios_base::badbit;
+      
+      n += batch.elements();
+      i += batch.elements();
+    }
+  }
+  
+  // Regardless of anything else, reset the stream's width to zero.
+  out.width(0);
+  
+  // This may throw, if out has exceptions enabled.
+  if (state != ::std::ios_base::goodbit)
+    out.setstate(state);
+}
+
+} // namespace detail
+
+// Base64 write_base64().
+// 
+// These versions of write_base64 take an ostream& as their first argument,
+// and a contiguous range of bytes - either as a pair of pointers, or a
+// pointer and a count - and write them in base64 (or base64url, as f
+// selects), returning a struct with info about how it went: next refers to
+// the first byte whose encoding was not written, and count is the number of
+// bytes whose encoding was.
+// 
+// The output is encoded in large blocks directly into a local buffer, which
+// is handed to the stream buffer with a single sputn() each time it fills.
+// Where AVX2 is enabled at compile time (see detail/simd.hpp), narrow output
+// is encoded 24 bytes at a time with vector instructions.
+// 
+// The stream's formatting flags and fill character are ignored.
+// 
+BOOST_RANGEIO_MODULE_EXPORT template <typename T, typename CharT, typename Traits>
+typename ::boost::enable_if_c<
+  detail::is_base64_element<T>::value,
+  write_iterator_range_result_t<T const*>>::type
+write_base64(::std::basic_ostream<CharT, Traits>& o, T const* first, T const* last, base64_format const& f = base64_format())
+{
+  write_iterator_range_result_t<T const*> w(first);
+  detail::base64_write_impl(o, w.next, last, w.count, f);
+  return w;
+}
+
+BOOST_RANGEIO_MODULE_EXPORT template <typename T, typename CharT, typename Traits>
+typename ::boost::enable_if_c<
+  detail::is_base64_element<T>::value,
+  write_iterator_range_result_t<T const*>>::type
+write_base64(::std::basic_ostream<CharT, Traits>& o, T const* first, ::std::size_t n, base64_format const& f = base64_format())
+{
+  write_iterator_range_result_t<T const*> w(first);
+  detail::base64_write_impl(o, w.next, first + n, w.count, f);
+  return w;
+}
+
+// Base64 read_base64().
+// 
+// Reads base64 (or base64url, as f selects) from in, after skipping leading
+// whitespace (unless skipws is not set), and writes the decoded bytes (as
+// unsigned char) to out. Reading stops at the first character that is not
+// in the alphabet, which is left in the stream, or after the padding, if
+// there is any. Padding is optional.
+// 
+// failbit is set if no characters could be read, or the input ends part way
+// through a byte (after a single character of a group), or the padding is
+// wrong; eofbit is set if the end of the input is reached. Either way, the
+// bytes decoded up to that point have been written to out.
+// 
+BOOST_RANGEIO_MODULE_EXPORT template <typename OutputIterator, typename CharT, typename Traits>
+read_base64_result_t<OutputIterator>
+read_base64(::std::basic_istream<CharT, Traits>& in, OutputIterator out, base64_format const& f = base64_format())
+{
+  read_base64_result_t<OutputIterator> r(::std::move(out));
+  
+  ::std::ios_base::iostate state = ::std::ios_base::goodbit;
+  
+  typename ::std::basic_istream<CharT, Traits>::sentry const sentry(in);
+  
+  if (sentry)
+  {
+    ::std::basic_streambuf<CharT, Traits>* const sb = in.rdbuf();
+    ::std::ctype<CharT> const& ct = ::std::use_facet< ::std::ctype<CharT>>(in.getloc());
+    
+    unsigned long bits = 0;
+    unsigned int bit_count = 0;
+    ::std::size_t characters = 0;
+    
+    typename Traits::int_type c = sb->sgetc();
+    
+    for (; !Traits::eq_int_type(c, Traits::eof()); c = sb->snextc())
+    {
+      int const v = detail::base64_value(ct.narrow(Traits::to_char_type(c), '\0'), f.url);
+      if (v < 0)
+        break;
+      
+      bits = (bits << 6) | (unsigned long)(v);
+      bit_count += 6;
+      ++characters;
+      
+      if (bit_count >= 8)
+      {
+        bit_count -= 8;
+        *r.next = static_cast<unsigned char>(bits >> bit_count);
+        ++r.next;
+        ++r.count;
+        
+        bits &= (1ul << bit_count) - 1;
+      }
+    }
+    
+    // Padding (only valid after 2 or 3 characters of a group)
+    if (!Traits::eq_int_type(c, Traits::eof()) && (ct.narrow(Traits::to_char_type(c), '\0') == '='))
+    {
+      ::std::size_t const needed = ((characters % 4) >= 2) ? (4 - (characters % 4)) : 0;
+      
+      for (::std::size_t k = 0; k != needed; ++k)
+      {
+        if (Traits::eq_int_type(c, Traits::eof()) || (ct.narrow(Traits::to_char_type(c), '\0') != '='))
+          break;
+        
+        ++characters;
+        c = sb->snextc();
+      }
+      
+      if ((characters % 4) != 0)
+        state |= ::std::ios_base::failbit;
+    }
+    
+    if (Traits::eq_int_type(c, Traits::eof()))
+      state |= ::std::ios_base::eofbit;
+    
+    if ((characters == 0) || ((characters % 4) == 1))
+      state |= ::std::ios_base::failbit;
+  }
+  
+  // This may throw, if in has exceptions enabled.
+  if (state != ::std::ios_base::goodbit)
+    in.setstate(state);
+  
+  return r;
+}
+
+} // namespace rangeio
+} // namespace boost
+
+#endif  // BOOST_NO_CXX11_RVALUE_REFERENCES
+#endif  // include guard
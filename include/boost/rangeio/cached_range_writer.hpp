@@ -0,0 +1,158 @@
+//
+// Copyright (c) Mark A. Gibbs, 2015.
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+// 
+
+// Defines basic_cached_range_writer, which formats a range once and then
+// writes the same characters again for as long as the range (as identified
+// by a version stamp) and the stream's formatting state are unchanged.
+// 
+// Requires at least C++11.
+
+#ifndef BOOST_RANGEIO_Inc_cached_range_writer_2015_01_01_
+#define BOOST_RANGEIO_Inc_cached_range_writer_2015_01_01_
+
+#include <boost/config.hpp>
+
+#ifdef BOOST_NO_CXX11_RVALUE_REFERENCES
+#   error "C++98 is not supported"
+#else
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <string>
+
+#include <boost/rangeio/detail/cached_output.hpp>
+#include <boost/rangeio/detail/module_export.hpp>
+#include <boost/rangeio/detail/write.hpp>
+
+namespace boost {
+namespace rangeio {
+
+// Cached range writer.
+// 
+// Writes a range exactly as the immediate write_iterator_range() would, but
+// keeps a copy of the formatted characters. The next write with the same
+// version stamp, to a stream with the same formatting state, does not touch
+// the range at all - it simply writes the cached characters to the stream's
+// buffer (with a single sputn()).
+// 
+// The version stamp is supplied by the caller, and must change whenever the
+// range's contents change (a generation counter bumped on every update is
+// the usual choice). The range is not looked at when the stamp matches, so
+// a stale stamp means stale output.
+// 
+// The formatting state compared is the stream's flags, precision, width,
+// fill character and locale. Any difference causes the range to be formatted
+// again (and the new result to be cached). Formatting state stored in the
+// stream's iword()/pword() slots (by custom manipulators) is *not* compared -
+// call invalidate() if that changes.
+// 
+// The result of a write that fails part way is never cached.
+// 
+// Unlike the other write functions, write() returns the stream, because a
+// cached write does not traverse the range, so it has no iterator to return.
+// The number of elements in the cached output is available from count().
+// 
+// A cached writer is not thread-safe; each thread (or each stream, if the
+// stream is shared under a lock) should have its own.
+// 
+BOOST_RANGEIO_MODULE_EXPORT template <typename CharT, typename Traits = ::std::char_traits<CharT>, typename Allocator = ::std::allocator<CharT>>
+class basic_cached_range_writer
+{
+public:
+  typedef CharT                                               char_type;
+  typedef Traits                                              traits_type;
+  typedef Allocator                                           allocator_type;
+  typedef ::std::uint64_t                                     version_type;
+  typedef ::std::basic_ostream<CharT, Traits>                 ostream_type;
+  
+  typedef typename detail::cached_output<CharT, Traits, Allocator>::size_type
+                                                              size_type;
+  
+  basic_cached_range_writer() :
+    basic_cached_range_writer(Allocator())
+  {}
+  
+  explicit basic_cached_range_writer(Allocator const& a) :
+    output_(a),
+    version_(0),
+    count_(0)
+  {}
+  
+  basic_cached_range_writer(basic_cached_range_writer const&) = delete;
+  basic_cached_range_writer& operator=(basic_cached_range_writer const&) = delete;
+  
+  // Writes the range [i, e), with delim between the elements.
+  template <typename InputIterator, typename Sentinel, typename Delimiter>
+  ostream_type& write(ostream_type& o, version_type version, InputIterator i, Sentinel const e, Delimiter&& d)
+  {
+    if (bool(o) && !hit_(o, version))
+    {
+      prepare_(o, version);
+      detail::write_impl(output_.stream(), i, e, d, count_);
+      output_.store(o);
+    }
+    
+    return output_.commit(o);
+  }
+  
+  // Writes the range [i, e), with no delimiter.
+  template <typename InputIterator, typename Sentinel>
+  ostream_type& write(ostream_type& o, version_type version, InputIterator i, Sentinel const e)
+  {
+    if (bool(o) && !hit_(o, version))
+    {
+      prepare_(o, version);
+      detail::write_impl(output_.stream(), i, e, count_);
+      output_.store(o);
+    }
+    
+    return output_.commit(o);
+  }
+  
+  // Discards the cached output (keeping the buffer's capacity), so that the
+  // next write formats the range again.
+  void invalidate() { output_.invalidate(); }
+  
+  // True if there is cached output.
+  bool cached() const { return output_.valid(); }
+  
+  // The cached output's version stamp, character count and element count
+  // (only meaningful if cached() is true).
+  version_type version() const { return version_; }
+  size_type size() const { return output_.size(); }
+  ::std::size_t count() const { return count_; }
+  
+  allocator_type get_allocator() const { return output_.get_allocator(); }
+  
+private:
+  bool hit_(ostream_type const& o, version_type version) const
+  {
+    return (version == version_) && output_.matches(o);
+  }
+  
+  void prepare_(ostream_type& o, version_type version)
+  {
+    output_.reset(o);
+    version_ = version;
+    count_ = 0;
+  }
+  
+  detail::cached_output<CharT, Traits, Allocator>   output_;
+  version_type                                      version_;
+  ::std::size_t                                     count_;
+};
+
+BOOST_RANGEIO_MODULE_EXPORT typedef basic_cached_range_writer<char>     cached_range_writer;
+BOOST_RANGEIO_MODULE_EXPORT typedef basic_cached_range_writer<wchar_t>  wcached_range_writer;
+
+} // namespace rangeio
+} // namespace boost
+
+#endif  // BOOST_NO_CXX11_RVALUE_REFERENCES
+#endif  // include guard
@@ -0,0 +1,176 @@
+//
+// Copyright (c) Mark A. Gibbs, 2015.
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+// 
+
+// Contains the base64 encoding and decoding functions used by write_base64()
+// and read_base64().
+// 
+// This file is written to be C++98-safe.
+
+#ifndef BOOST_RANGEIO_Inc_detail_X_base64_2015_01_01_
+#define BOOST_RANGEIO_Inc_detail_X_base64_2015_01_01_
+
+#include <boost/config.hpp>
+
+#include <cstddef>
+
+#include <boost/rangeio/detail/simd.hpp>
+
+namespace boost {
+namespace rangeio {
+namespace detail {
+
+// The 64 characters of the base64 alphabet (RFC 4648 section 4), or of the
+// base64url alphabet (section 5).
+inline char const* base64_alphabet(bool url)
+{
+  return url ?
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_" :
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+}
+
+// The value of the base64 (or base64url) character c, or -1 if c is not in
+// the alphabet.
+inline int base64_value(char c, bool url)
+{
+  if ((c >= 'A') && (c <= 'Z'))
+    return c - 'A';
+  if ((c >= 'a') && (c <= 'z'))
+    return (c - 'a') + 26;
+  if ((c >= '0') && (c <= '9'))
+    return (c - '0') + 52;
+  
+  if (c == (url ? '-' : '+'))
+    return 62;
+  if (c == (url ? '_' : '/'))
+    return 63;
+  
+  return -1;
+}
+
+// Encodes the n complete 3-byte groups at p as 4n characters at out, using
+// the characters in alphabet.
+template <typename CharT>
+void base64_encode_groups_scalar(unsigned char const* p, ::std::size_t n, CharT* out, CharT const* alphabet)
+{
+  for (; n != 0; --n, p += 3, out += 4)
+  {
+    unsigned long const v = (unsigned long)(p[0]) << 16 | (unsigned long)(p[1]) << 8 | p[2];
+    
+    out[0] = alphabet[(v >> 18) & 0x3F];
+    out[1] = alphabet[(v >> 12) & 0x3F];
+    out[2] = alphabet[(v >> 6) & 0x3F];
+    out[3] = alphabet[v & 0x3F];
+  }
+}
+
+template <typename CharT>
+void base64_encode_groups(unsigned char const* p, ::std::size_t n, CharT* out, CharT const* alphabet)
+{
+  detail::base64_encode_groups_scalar(p, n, out, alphabet);
+}
+
+#ifdef BOOST_RANGEIO_HAS_AVX2
+// AVX2 version for narrow characters (where alphabet must be the base64 or
+// base64url alphabet, as base64_alphabet() gives - the characters are
+// computed rather than looked up).
+// 
+// Encodes 8 groups (24 bytes) at a time: the bytes are loaded 4 bytes before
+// the groups (so each 128-bit lane holds the 12 bytes it encodes), shuffled
+// so that each 32-bit element holds one group, split into 6-bit values with
+// multiplies, and translated to characters by adding per-range offsets looked
+// up with a byte shuffle. Because the loads are 32 bytes wide, the first is
+// done at p and shifted into place, and the vector loop stops while at least
+// 4 bytes past the last group it encodes are still in the input; the
+// remaining groups are encoded by the scalar loop.
+inline void base64_encode_groups(unsigned char const* p, ::std::size_t n, char* out, char const* alphabet)
+{
+  if (n >= 11)
+  {
+    bool const url = (alphabet[62] == '-');
+    
+    // Offsets from the 6-bit values to their characters, indexed by range:
+    // [0, 25] -> 'A', [26, 51] -> 'a', [52, 61] -> '0', 62, 63.
+    __m256i const offsets = _mm256_setr_epi8(
+      65, 71, -4, -4, -4, -4, -4, -4, -4, -4, -4, -4, (url ? -17 : -19), (url ? 32 : -16), 0, 0,
+      65, 71, -4, -4, -4, -4, -4, -4, -4, -4, -4, -4, (url ? -17 : -19), (url ? 32 : -16), 0, 0);
+    
+    __m256i const shuffle = _mm256_setr_epi8(
+       5,  4,  6,  5,  8,  7,  9,  8, 11, 10, 12, 11, 14, 13, 15, 14,
+       1,  0,  2,  1,  4,  3,  5,  4,  7,  6,  8,  7, 10,  9, 11, 10);
+    
+    __m256i v = _mm256_permutevar8x32_epi32(
+      _mm256_loadu_si256(reinterpret_cast<__m256i const*>(p)),
+      _mm256_setr_epi32(0, 0, 1, 2, 3, 4, 5, 6));
+    
+    for (;;)
+    {
+      // Each 32-bit element holds the bytes b, a, c, b of a group.
+      __m256i const in = _mm256_shuffle_epi8(v, shuffle);
+      
+      // Split into the four 6-bit values, one per byte.
+      __m256i const t0 = _mm256_mulhi_epu16(
+        _mm256_and_si256(in, _mm256_set1_epi32(0x0FC0FC00)),
+        _mm256_set1_epi32(0x04000040));
+      __m256i const t1 = _mm256_mullo_epi16(
+        _mm256_and_si256(in, _mm256_set1_epi32(0x003F03F0)),
+        _mm256_set1_epi32(0x01000010));
+      __m256i const values = _mm256_or_si256(t0, t1);
+      
+      // Find the range of each value (0 for [0, 25], 1 for [26, 51], 2 to
+      // 11 for [52, 61], 12 for 62 and 13 for 63), and add its offset.
+      __m256i const ranges = _mm256_sub_epi8(
+        _mm256_subs_epu8(values, _mm256_set1_epi8(51)),
+        _mm256_cmpgt_epi8(values, _mm256_set1_epi8(25)));
+      
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(out),
+        _mm256_add_epi8(values, _mm256_shuffle_epi8(offsets, ranges)));
+      
+      p += 24;
+      out += 32;
+      n -= 8;
+      
+      if (n < 10)
+        break;
+      
+      v = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(p - 4));
+    }
+  }
+  
+  detail::base64_encode_groups_scalar(p, n, out, alphabet);
+}
+#endif // BOOST_RANGEIO_HAS_AVX2
+
+// Encodes the final partial group of n (1 or 2) bytes at p at out, using the
+// characters in alphabet, followed by padding characters if pad is not zero.
+// Returns the number of characters written (at most 4).
+template <typename CharT>
+::std::size_t base64_encode_tail(unsigned char const* p, ::std::size_t n, CharT* out, CharT const* alphabet, CharT pad)
+{
+  unsigned long const v = (unsigned long)(p[0]) << 16 | ((n == 2) ? (unsigned long)(p[1]) << 8 : 0);
+  
+  out[0] = alphabet[(v >> 18) & 0x3F];
+  out[1] = alphabet[(v >> 12) & 0x3F];
+  
+  if (n == 2)
+    out[2] = alphabet[(v >> 6) & 0x3F];
+  
+  ::std::size_t size = n + 1;
+  
+  if (pad != CharT())
+  {
+    for (; size != 4; ++size)
+      out[size] = pad;
+  }
+  
+  return size;
+}
+
+} // namespace detail
+} // namespace rangeio
+} // namespace boost
+
+#endif  // include guard
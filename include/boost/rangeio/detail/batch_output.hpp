@@ -0,0 +1,280 @@
+//
+// Copyright (c) Mark A. Gibbs, 2015.
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+// 
+
+// This file is written to be C++98-safe.
+
+#ifndef BOOST_RANGEIO_Inc_detail_X_batch_output_2015_01_01_
+#define BOOST_RANGEIO_Inc_detail_X_batch_output_2015_01_01_
+
+#include <boost/config.hpp>
+
+#include <cstddef>
+#include <ios>
+#include <streambuf>
+
+#include <boost/static_assert.hpp>
+
+namespace boost {
+namespace rangeio {
+namespace detail {
+
+// 
+// Fixed-size output buffer for the batch formatting engines.
+// 
+// The engines format elements directly into the buffer (see space() and
+// commit()), and the buffer is handed to the stream buffer with a single
+// sputn() whenever it fills up, rather than one call per character or per
+// element. The engines call end_element() after each element, so that the
+// number of elements whose output has been completely handed to the stream
+// buffer is known (see elements()) even if a sputn() fails - including the
+// elements whose output was accepted by a sputn() that only wrote part of the
+// buffer.
+// 
+// Once a sputn() has failed, nothing more is written. If a sputn() throws,
+// the exception is handled the way the formatted output functions handle it:
+// the stream's badbit is set (without throwing ios_base::failure), and the
+// exception is rethrown only if the stream's exceptions include badbit.
+// Otherwise it is treated as any other failure.
+// 
+template <typename CharT, typename Traits, ::std::size_t N = 512>
+class batch_output
+{
+  // The element ends are kept as offsets into the buffer.
+  BOOST_STATIC_ASSERT(N <= 0xFFFFu);
+  
+public:
+  explicit batch_output(::std::basic_ios<CharT, Traits>& out) :
+    out_(&out),
+    sb_(out.rdbuf()),
+    size_(0),
+    marks_(0),
+    pending_(0),
+    elements_(0),
+    failed_(false)
+  {}
+  
+  // The free space, and the position to format into.
+  ::std::size_t space() const { return N - size_; }
+  CharT* position() { return buffer_ + size_; }
+  
+  // Adds the next n characters formatted at position() to the output.
+  void commit(::std::size_t n) { size_ += n; }
+  
+  // Flushes if there are fewer than n characters of free space (n must not be
+  // more than N), and returns true if there is (or now is) enough space.
+  bool reserve(::std::size_t n)
+  {
+    return (space() >= n) || flush();
+  }
+  
+  // Appends n characters, flushing as often as necessary.
+  bool append(CharT const* p, ::std::size_t n)
+  {
+    while (n != 0)
+    {
+      if ((space() == 0) && !flush())
+        return false;
+      
+      ::std::size_t const k = (n < space()) ? n : space();
+      Traits::copy(position(), p, k);
+      commit(k);
+      
+      p += k;
+      n -= k;
+    }
+    
+    return !failed_;
+  }
+  
+  // Appends n copies of c, flushing as often as necessary.
+  bool append(::std::size_t n, CharT c)
+  {
+    while (n != 0)
+    {
+      if ((space() == 0) && !flush())
+        return false;
+      
+      ::std::size_t const k = (n < space()) ? n : space();
+      Traits::assign(position(), k, c);
+      commit(k);
+      
+      n -= k;
+    }
+    
+    return !failed_;
+  }
+  
+  // Appends the n characters at p, padded to width with fill the way num_put
+  // pads: with the fill characters after them if adjust is left, after the
+  // first prefix characters (the sign) if adjust is internal, and before them
+  // otherwise. The fill run is written with a single assign().
+  bool append_padded(
+    CharT const* p,
+    ::std::size_t n,
+    ::std::size_t prefix,
+    ::std::size_t width,
+    CharT fill,
+    ::std::ios_base::fmtflags adjust)
+  {
+    if (width <= n)
+      return append(p, n);
+    
+    ::std::size_t const pad = width - n;
+    
+    if (adjust == ::std::ios_base::left)
+      return append(p, n) && append(pad, fill);
+    
+    if (adjust == ::std::ios_base::internal)
+      return append(p, prefix) && append(pad, fill) && append(p + prefix, n - prefix);
+    
+    return append(pad, fill) && append(p, n);
+  }
+  
+  // Marks the end of the output of the next n elements.
+  void end_element(::std::size_t n = 1)
+  {
+    mark_(n, 0, 0);
+  }
+  
+  // Marks the end of the output of the next groups groups of elements, which
+  // were written back to back, each group_size characters long and holding
+  // group_elements elements (for example, one byte in two hex digits, or
+  // three bytes in four base64 characters). A partial sputn() then counts
+  // the elements of every complete group it accepted, without a mark for
+  // each group. group_size and group_elements must be from 1 to 255.
+  void end_groups(::std::size_t groups, ::std::size_t group_size, ::std::size_t group_elements)
+  {
+    mark_(groups * group_elements, group_size, group_elements);
+  }
+  
+  // Hands the buffered output to the stream buffer. Returns false if that
+  // fails (or a previous flush failed).
+  bool flush()
+  {
+    if (failed_)
+      return false;
+    
+    ::std::streamsize written = 0;
+    
+    if (size_ != 0)
+    {
+      try
+      {
+        written = sb_->sputn(buffer_, ::std::streamsize(size_));
+      }
+      catch (...)
+      {
+        // None of the buffered elements are counted.
+        failed_ = true;
+        
+        try
+        {
+          out_->setstate(::std::ios_base::badbit);
+        }
+        catch (::std::ios_base::failure const&)
+        {}
+        
+        if ((out_->exceptions() & ::std::ios_base::badbit) != 0)
+          throw;
+        
+        return false;
+      }
+    }
+    
+    if (written != ::std::streamsize(size_))
+    {
+      // Count the elements that were accepted before the failure.
+      for (::std::size_t m = marks_; m != 0; --m)
+      {
+        if (::std::streamsize(ends_[m - 1]) <= written)
+        {
+          elements_ += counts_[m - 1];
+          break;
+        }
+        
+        // If the failure was part way through a run of groups, count the
+        // complete groups (and everything before the run).
+        if (group_sizes_[m - 1] != 0)
+        {
+          ::std::size_t const before = (m > 1) ? counts_[m - 2] : 0;
+          ::std::size_t const groups = (counts_[m - 1] - before) / group_elements_[m - 1];
+          ::std::streamsize const start = ::std::streamsize(ends_[m - 1]) - ::std::streamsize(groups * group_sizes_[m - 1]);
+          
+          if (start < written)
+          {
+            elements_ += before + (::std::size_t(written - start) / group_sizes_[m - 1]) * group_elements_[m - 1];
+            break;
+          }
+        }
+      }
+      
+      failed_ = true;
+      return false;
+    }
+    
+    size_ = 0;
+    marks_ = 0;
+    elements_ += pending_;
+    pending_ = 0;
+    
+    return true;
+  }
+  
+  bool failed() const { return failed_; }
+  
+  // The number of elements completely handed to the stream buffer.
+  ::std::size_t elements() const { return elements_; }
+  
+private:
+  void mark_(::std::size_t n, ::std::size_t group_size, ::std::size_t group_elements)
+  {
+    pending_ += n;
+    
+    // If there are more ends than there is room to keep, the last one is
+    // moved (so a partial sputn() may count too few elements, never too
+    // many). The moved mark also covers the elements of the one it replaced,
+    // so it can no longer be counted by groups.
+    if (marks_ == N)
+    {
+      --marks_;
+      group_size = 0;
+    }
+    
+    ends_[marks_] = static_cast<unsigned short>(size_);
+    counts_[marks_] = pending_;
+    group_sizes_[marks_] = static_cast<unsigned char>(group_size);
+    group_elements_[marks_] = static_cast<unsigned char>(group_elements);
+    ++marks_;
+  }
+  
+  ::std::basic_ios<CharT, Traits>*        out_;
+  ::std::basic_streambuf<CharT, Traits>*  sb_;
+  
+  CharT                                   buffer_[N];
+  ::std::size_t                           size_;
+  
+  // The offset of the end of each element marked since the last flush, and
+  // the number of elements pending at that point. For a run of groups (see
+  // end_groups()), the size of each group and the elements in it; otherwise
+  // the group size is zero.
+  unsigned short                          ends_[N];
+  ::std::size_t                           counts_[N];
+  unsigned char                           group_sizes_[N];
+  unsigned char                           group_elements_[N];
+  ::std::size_t                           marks_;
+  
+  ::std::size_t                           pending_;
+  ::std::size_t                           elements_;
+  
+  bool                                    failed_;
+};
+
+} // namespace detail
+} // namespace rangeio
+} // namespace boost
+
+#endif  // include guard
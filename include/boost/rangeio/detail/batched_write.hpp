@@ -0,0 +1,464 @@
+//
+// Copyright (c) Mark A. Gibbs, 2015.
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+// 
+
+// Contains the batched write loop for ranges of integers, which write_impl()
+// uses when it can produce exactly the same output as "out << *i" would.
+// 
+// This file is written to be C++98-safe.
+
+#ifndef BOOST_RANGEIO_Inc_detail_X_batched_write_2015_01_01_
+#define BOOST_RANGEIO_Inc_detail_X_batched_write_2015_01_01_
+
+#include <boost/config.hpp>
+
+#include <cstddef>
+#include <ios>
+#include <iterator>
+#include <locale>
+#include <ostream>
+#include <string>
+
+#include <boost/rangeio/detail/batch_output.hpp>
+#include <boost/rangeio/detail/projection.hpp>
+#include <boost/rangeio/detail/write_probe.hpp>
+
+#include <boost/type_traits/integral_constant.hpp>
+#include <boost/type_traits/is_base_of.hpp>
+#include <boost/type_traits/is_convertible.hpp>
+#include <boost/type_traits/is_signed.hpp>
+#include <boost/type_traits/make_unsigned.hpp>
+#include <boost/type_traits/remove_const.hpp>
+
+namespace boost {
+namespace rangeio {
+namespace detail {
+
+// Tests whether T is one of the integer types that streams write with
+// num_put (so not bool, and not the character types, which are written as
+// characters).
+template <typename T>
+struct is_batched_integer : ::boost::false_type {};
+
+template <> struct is_batched_integer<short> : ::boost::true_type {};
+template <> struct is_batched_integer<unsigned short> : ::boost::true_type {};
+template <> struct is_batched_integer<int> : ::boost::true_type {};
+template <> struct is_batched_integer<unsigned int> : ::boost::true_type {};
+template <> struct is_batched_integer<long> : ::boost::true_type {};
+template <> struct is_batched_integer<unsigned long> : ::boost::true_type {};
+#ifdef BOOST_HAS_LONG_LONG
+template <> struct is_batched_integer< ::boost::long_long_type> : ::boost::true_type {};
+template <> struct is_batched_integer< ::boost::ulong_long_type> : ::boost::true_type {};
+#endif // BOOST_HAS_LONG_LONG
+
+// Describes how a delimiter of type Delimiter is written to a stream of
+// CharT, if "out << delim" just writes a sequence of characters (for a
+// character, a string, or a character array or pointer, of CharT).
+// 
+// supported is true_type for those delimiters, in which case data() and
+// size() give the characters, unless usable() is false (for a null pointer,
+// which the stream would fail to write).
+template <typename Delimiter, typename CharT, typename Traits>
+struct batch_delimiter
+{
+  typedef ::boost::false_type supported;
+};
+
+template <typename CharT, typename Traits>
+struct batch_delimiter<CharT, CharT, Traits>
+{
+  typedef ::boost::true_type supported;
+  
+  static bool usable(CharT const&) { return true; }
+  static CharT const* data(CharT const& d) { return &d; }
+  static ::std::size_t size(CharT const&) { return 1; }
+};
+
+template <typename CharT, typename Traits>
+struct batch_delimiter<CharT const*, CharT, Traits>
+{
+  typedef ::boost::true_type supported;
+  
+  static bool usable(CharT const* d) { return d != 0; }
+  static CharT const* data(CharT const* d) { return d; }
+  static ::std::size_t size(CharT const* d) { return Traits::length(d); }
+};
+
+template <typename CharT, typename Traits>
+struct batch_delimiter<CharT*, CharT, Traits> :
+  batch_delimiter<CharT const*, CharT, Traits>
+{};
+
+template <typename CharT, typename Traits, ::std::size_t N>
+struct batch_delimiter<CharT[N], CharT, Traits> :
+  batch_delimiter<CharT const*, CharT, Traits>
+{};
+
+template <typename CharT, typename Traits, typename Allocator>
+struct batch_delimiter< ::std::basic_string<CharT, Traits, Allocator>, CharT, Traits>
+{
+  typedef ::boost::true_type supported;
+  
+  static bool usable(::std::basic_string<CharT, Traits, Allocator> const&) { return true; }
+  static CharT const* data(::std::basic_string<CharT, Traits, Allocator> const& d) { return d.data(); }
+  static ::std::size_t size(::std::basic_string<CharT, Traits, Allocator> const& d) { return d.size(); }
+};
+
+// Tests whether a range can be written with batched_write_impl(): the range
+// must begin with a random access iterator (so the iterator can be moved back
+// to the first element not written), and end with the same type or a type
+// convertible to or from it (such as a container's const_iterator and
+// iterator, in either order), its elements (projected with Projection - see
+// projected_value) must be integers (see is_batched_integer), and the
+// delimiter (Delimiter is void for writes without delimiters) must be one
+// batch_delimiter supports.
+template <typename InputIterator, typename Sentinel, typename Delimiter, typename CharT, typename Traits, typename Projection = identity_projection>
+struct use_batched_write :
+  ::boost::integral_constant<bool,
+    (::boost::is_convertible<Sentinel, InputIterator>::value ||
+      ::boost::is_convertible<InputIterator, Sentinel>::value) &&
+    ::boost::is_base_of< ::std::random_access_iterator_tag,
+      typename ::std::iterator_traits<InputIterator>::iterator_category>::value &&
+    is_batched_integer<typename projected_value<Projection, InputIterator>::type>::value &&
+    batch_delimiter<typename ::boost::remove_const<Delimiter>::type, CharT, Traits>::supported::value>
+{};
+
+template <typename InputIterator, typename Sentinel, typename CharT, typename Traits, typename Projection>
+struct use_batched_write<InputIterator, Sentinel, void, CharT, Traits, Projection> :
+  ::boost::integral_constant<bool,
+    (::boost::is_convertible<Sentinel, InputIterator>::value ||
+      ::boost::is_convertible<InputIterator, Sentinel>::value) &&
+    ::boost::is_base_of< ::std::random_access_iterator_tag,
+      typename ::std::iterator_traits<InputIterator>::iterator_category>::value &&
+    is_batched_integer<typename projected_value<Projection, InputIterator>::type>::value>
+{};
+
+// Tests whether facet F of loc is the same facet object as the classic
+// locale's (so it has not been replaced).
+template <typename Facet>
+bool is_classic_facet(::std::locale const& loc)
+{
+  ::std::locale const& classic = ::std::locale::classic();
+  
+  return ::std::has_facet<Facet>(loc) && ::std::has_facet<Facet>(classic) &&
+    (&::std::use_facet<Facet>(loc) == &::std::use_facet<Facet>(classic));
+}
+
+// Tests whether the batched write loop produces exactly the same output as
+// num_put would with out's current state: the base must be decimal, octal or
+// hex, without showbase; unitbuf must not be set (because the batched loop
+// does not flush after each element); and the locale's num_put and numpunct
+// facets must be the classic ones (so there is no digit grouping, and no
+// customized formatting).
+template <typename CharT, typename Traits>
+bool batched_write_usable(::std::basic_ostream<CharT, Traits>& out)
+{
+  typedef ::std::num_put<CharT, ::std::ostreambuf_iterator<CharT, Traits> > num_put_type;
+  
+  ::std::ios_base::fmtflags const flags = out.flags();
+  
+  if ((flags & (::std::ios_base::showbase | ::std::ios_base::unitbuf)) != 0)
+    return false;
+  
+  ::std::locale const loc = out.getloc();
+  
+  return detail::is_classic_facet<num_put_type>(loc) &&
+    detail::is_classic_facet< ::std::numpunct<CharT> >(loc);
+}
+
+// How integers are formatted by batched_write_impl(), taken from the
+// stream's state.
+template <typename CharT>
+struct batched_integer_format
+{
+  unsigned int               base;
+  bool                       showpos;
+  CharT                      digits[16];
+  CharT                      plus;
+  CharT                      minus;
+  
+  ::std::size_t              width;
+  CharT                      fill;
+  ::std::ios_base::fmtflags  adjust;
+};
+
+// Tests whether v is negative (without comparing unsigned values to zero).
+template <typename T>
+bool is_negative(T v, ::boost::true_type) { return v < T(0); }
+
+template <typename T>
+bool is_negative(T, ::boost::false_type) { return false; }
+
+// Formats v as num_put would (without padding), ending at end, and returns
+// the first character. sign is set to the number of sign characters (0 or
+// 1).
+template <typename T, typename CharT>
+CharT* format_batched_integer(T v, CharT* end, batched_integer_format<CharT> const& f, ::std::size_t& sign)
+{
+  typedef typename ::boost::make_unsigned<T>::type unsigned_type;
+  
+  CharT* p = end;
+  sign = 0;
+  
+  if (f.base == 10)
+  {
+    typedef typename ::boost::is_signed<T>::type is_signed;
+    
+    bool const negative = detail::is_negative(v, is_signed());
+    unsigned_type u = negative ? unsigned_type(unsigned_type(0) - unsigned_type(v)) : unsigned_type(v);
+    
+    do
+    {
+      *--p = f.digits[u % 10];
+      u /= 10;
+    } while (u != 0);
+    
+    if (negative)
+    {
+      *--p = f.minus;
+      sign = 1;
+    }
+    else if (f.showpos && is_signed::value)
+    {
+      *--p = f.plus;
+      sign = 1;
+    }
+  }
+  else
+  {
+    // Signed values are written as their unsigned representation.
+    unsigned_type u = unsigned_type(v);
+    unsigned int const shift = (f.base == 16) ? 4 : 3;
+    unsigned int const mask = f.base - 1;
+    
+    do
+    {
+      *--p = f.digits[u & mask];
+      u >>= shift;
+    } while (u != 0);
+  }
+  
+  return p;
+}
+
+// Gets the value of the element i refers to, projected with proj, as a T.
+template <typename T, typename InputIterator>
+T batched_value(InputIterator const& i, identity_projection&)
+{
+  return T(*i);
+}
+
+template <typename T, typename InputIterator, typename Projection>
+T batched_value(InputIterator const& i, Projection& proj)
+{
+  return T(detail::project(proj, *i));
+}
+
+// Formats the element i refers to (projected with proj) into out, padded as
+// num_put would pad it.
+template <typename InputIterator, typename Projection, typename CharT, typename Traits, ::std::size_t N>
+bool write_batched_element(
+  batch_output<CharT, Traits, N>& out,
+  InputIterator const& i,
+  Projection& proj,
+  batched_integer_format<CharT> const& f)
+{
+  typedef typename projected_value<Projection, InputIterator>::type value_type;
+  
+  // Enough for the digits of any integer in octal, and a sign.
+  CharT buffer[(sizeof(value_type) * 8 + 2) / 3 + 1];
+  CharT* const end = buffer + (sizeof(buffer) / sizeof(buffer[0]));
+  
+  ::std::size_t sign;
+  CharT const* const p = detail::format_batched_integer(detail::batched_value<value_type>(i, proj), end, f, sign);
+  
+  return out.append_padded(p, ::std::size_t(end - p), sign, f.width, f.fill, f.adjust);
+}
+
+// Sets up f with the formatting state of out.
+template <typename CharT, typename Traits>
+void init_batched_integer_format(batched_integer_format<CharT>& f, ::std::basic_ostream<CharT, Traits>& out)
+{
+  ::std::ios_base::fmtflags const flags = out.flags();
+  ::std::ios_base::fmtflags const basefield = flags & ::std::ios_base::basefield;
+  
+  f.base = (basefield == ::std::ios_base::oct) ? 8 : ((basefield == ::std::ios_base::hex) ? 16 : 10);
+  f.showpos = ((flags & ::std::ios_base::showpos) != 0);
+  
+  ::std::ctype<CharT> const& ct = ::std::use_facet< ::std::ctype<CharT> >(out.getloc());
+  
+  char const* const digits = ((flags & ::std::ios_base::uppercase) != 0) ?
+    "0123456789ABCDEF" : "0123456789abcdef";
+  ct.widen(digits, digits + 16, f.digits);
+  f.plus = ct.widen('+');
+  f.minus = ct.widen('-');
+  
+  f.width = (out.width() > 0) ? ::std::size_t(out.width()) : 0;
+  f.fill = out.fill();
+  f.adjust = flags & ::std::ios_base::adjustfield;
+}
+
+// Batched write loop for ranges of integers without delimiters.
+// 
+// Produces exactly the same output as write_impl()'s loop, when
+// use_batched_write is true for the range and batched_write_usable() is
+// true for out, but formats the elements (and pads them to the stream's
+// width, once the run of fill characters is known) directly into a
+// batch_output, which is handed to the stream buffer with one sputn() each
+// time it fills. On return, n is the number of elements completely handed to
+// the stream buffer, and i refers to the first element that was not. Each
+// element is projected with proj (see use_batched_write).
+// 
+// This is only the loop: it does not reset the stream's width or fire the
+// probes (see batched_write_impl()), and it returns the error state to set
+// on the stream rather than setting it, so it can be used for each segment
+// of a segmented range.
+template <typename RandomAccessIterator, typename Sentinel, typename CharT, typename Traits, typename Projection>
+::std::ios_base::iostate batched_write_elements(
+  ::std::basic_ostream<CharT, Traits>& out,
+  RandomAccessIterator& i,
+  Sentinel const& e,
+  ::std::size_t& n,
+  Projection& proj)
+{
+  typename ::std::basic_ostream<CharT, Traits>::sentry const sentry(out);
+  
+  if (!sentry)
+    return ::std::ios_base::goodbit;
+  
+  batched_integer_format<CharT> f;
+  detail::init_batched_integer_format(f, out);
+  
+  batch_output<CharT, Traits> batch(out);
+  
+  for (RandomAccessIterator p = i; !(p == e); ++p)
+  {
+    if (!detail::write_batched_element(batch, p, proj, f))
+      break;
+    
+    batch.end_element();
+  }
+  
+  bool const flushed = batch.flush();
+  
+  n += batch.elements();
+  i += typename ::std::iterator_traits<RandomAccessIterator>::difference_type(batch.elements());
+  
+  return flushed ? ::std::ios_base::goodbit : ::std::ios_base::badbit;
+}
+
+// Batched write loop for ranges of integers with delimiters.
+// 
+// This is exactly the same as batched_write_elements() without delimiters,
+// except that the delimiter's characters (see batch_delimiter) are written
+// between the elements, unpadded - and before the first element too, if
+// delimit_first is true (for the segments after the first of a segmented
+// range).
+template <typename RandomAccessIterator, typename Sentinel, typename Delimiter, typename CharT, typename Traits, typename Projection>
+::std::ios_base::iostate batched_write_elements(
+  ::std::basic_ostream<CharT, Traits>& out,
+  RandomAccessIterator& i,
+  Sentinel const& e,
+  Delimiter& delim,
+  ::std::size_t& n,
+  bool delimit_first,
+  Projection& proj)
+{
+  typedef batch_delimiter<typename ::boost::remove_const<Delimiter>::type, CharT, Traits> delimiter_traits;
+  
+  typename ::std::basic_ostream<CharT, Traits>::sentry const sentry(out);
+  
+  if (!sentry)
+    return ::std::ios_base::goodbit;
+  
+  batched_integer_format<CharT> f;
+  detail::init_batched_integer_format(f, out);
+  
+  CharT const* const delim_data = delimiter_traits::data(delim);
+  ::std::size_t const delim_size = delimiter_traits::size(delim);
+  
+  batch_output<CharT, Traits> batch(out);
+  
+  for (RandomAccessIterator p = i; !(p == e); ++p)
+  {
+    if ((delimit_first || !(p == i)) && !batch.append(delim_data, delim_size))
+      break;
+    
+    if (!detail::write_batched_element(batch, p, proj, f))
+      break;
+    
+    batch.end_element();
+  }
+  
+  bool const flushed = batch.flush();
+  
+  n += batch.elements();
+  i += typename ::std::iterator_traits<RandomAccessIterator>::difference_type(batch.elements());
+  
+  return flushed ? ::std::ios_base::goodbit : ::std::ios_base::badbit;
+}
+
+// Underlying implementation functions for the batched writes of ranges of
+// integers: batched_write_elements(), with the probes fired, the stream's
+// width reset to zero, and any error set on the stream.
+// 
+// There are two versions - one with a delimiter, and one without.
+template <typename RandomAccessIterator, typename Sentinel, typename CharT, typename Traits, typename Projection>
+void batched_write_impl(
+  ::std::basic_ostream<CharT, Traits>& out,
+  RandomAccessIterator& i,
+  Sentinel const& e,
+  ::std::size_t& n,
+  Projection& proj)
+{
+  detail::write_probe<CharT, Traits> const probe(out, n);
+  
+  ::std::ios_base::iostate state = ::std::ios_base::goodbit;
+  
+  if (!(i == e) && bool(out))
+    state = detail::batched_write_elements(out, i, e, n, proj);
+  
+  // Regardless of anything else, reset the stream's width to zero.
+  out.width(0);
+  
+  // This may throw, if out has exceptions enabled.
+  if (state != ::std::ios_base::goodbit)
+    out.setstate(state);
+  
+  probe.finish(out, n, !(i == e));
+}
+
+template <typename RandomAccessIterator, typename Sentinel, typename Delimiter, typename CharT, typename Traits, typename Projection>
+void batched_write_impl(
+  ::std::basic_ostream<CharT, Traits>& out,
+  RandomAccessIterator& i,
+  Sentinel const& e,
+  Delimiter& delim,
+  ::std::size_t& n,
+  Projection& proj)
+{
+  detail::write_probe<CharT, Traits> const probe(out, n);
+  
+  ::std::ios_base::iostate state = ::std::ios_base::goodbit;
+  
+  if (!(i == e) && bool(out))
+    state = detail::batched_write_elements(out, i, e, delim, n, false, proj);
+  
+  // Regardless of anything else, reset the stream's width to zero.
+  out.width(0);
+  
+  // This may throw, if out has exceptions enabled.
+  if (state != ::std::ios_base::goodbit)
+    out.setstate(state);
+  
+  probe.finish(out, n, !(i == e));
+}
+
+} // namespace detail
+} // namespace rangeio
+} // namespace boost
+
+#endif  // include guard
@@ -0,0 +1,172 @@
+//
+// Copyright (c) Mark A. Gibbs, 2015.
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+// 
+
+// Requires at least C++11.
+
+#ifndef BOOST_RANGEIO_Inc_detail_X_cached_output_2015_01_01_
+#define BOOST_RANGEIO_Inc_detail_X_cached_output_2015_01_01_
+
+#include <boost/config.hpp>
+
+#include <cstddef>
+#include <ios>
+#include <locale>
+#include <ostream>
+
+#include <boost/rangeio/range_stringbuf.hpp>
+
+namespace boost {
+namespace rangeio {
+namespace detail {
+
+// 
+// Formatted output kept for reuse, along with the formatting state it was
+// formatted with.
+// 
+// The output is formatted by a private stream (stream()) that is given the
+// formatting state of the target stream by reset(). The output is only valid
+// after a call to store() when that stream did not fail, and only reusable
+// for streams with the same flags, precision, width, fill character and
+// locale (see matches()). Formatting state stored in iword()/pword() slots
+// cannot be compared, so it is not part of the key.
+// 
+template <typename CharT, typename Traits, typename Allocator>
+class cached_output
+{
+public:
+  typedef ::std::basic_ostream<CharT, Traits>                         ostream_type;
+  typedef typename basic_range_stringbuf<CharT, Traits, Allocator>::size_type
+                                                                      size_type;
+  
+  explicit cached_output(Allocator const& a) :
+    buffer_(a),
+    stream_(&buffer_),
+    valid_(false),
+    flags_(),
+    precision_(0),
+    width_(0),
+    fill_()
+  {}
+  
+  cached_output(cached_output const&) = delete;
+  cached_output& operator=(cached_output const&) = delete;
+  
+  ostream_type& stream() { return stream_; }
+  
+  CharT const* data() const { return buffer_.data(); }
+  size_type size() const { return buffer_.size(); }
+  
+  Allocator get_allocator() const { return buffer_.get_allocator(); }
+  
+  bool valid() const { return valid_; }
+  void invalidate() { valid_ = false; }
+  
+  // True if the output is valid, and was formatted with o's formatting
+  // state.
+  bool matches(ostream_type const& o) const
+  {
+    return valid_ &&
+      (o.flags() == flags_) &&
+      (o.precision() == precision_) &&
+      (o.width() == width_) &&
+      Traits::eq(o.fill(), fill_) &&
+      (o.getloc() == locale_);
+  }
+  
+  // Discards the output, and gives the formatting stream the same formatting
+  // state as o.
+  void reset(ostream_type& o)
+  {
+    valid_ = false;
+    buffer_.clear();
+    
+    stream_.clear();
+    stream_.copyfmt(o);
+    stream_.tie(0);
+    stream_.exceptions(::std::ios_base::goodbit);
+  }
+  
+  // Prepares the formatting stream to append more output to output that
+  // matches(), by giving it the stored formatting state again. (The write
+  // functions reset the width after each write, and the last element written
+  // may have changed any of the rest.)
+  void resume()
+  {
+    stream_.flags(flags_);
+    stream_.precision(precision_);
+    stream_.width(width_);
+    stream_.fill(fill_);
+    
+    if (stream_.getloc() != locale_)
+      stream_.imbue(locale_);
+  }
+  
+  // Marks the output as valid, for o's formatting state, if the formatting
+  // stream has not failed (and as not valid if it has).
+  void store(ostream_type const& o)
+  {
+    valid_ = bool(stream_);
+    if (!valid_)
+      return;
+    
+    flags_ = o.flags();
+    precision_ = o.precision();
+    width_ = o.width();
+    fill_ = o.fill();
+    locale_ = o.getloc();
+  }
+  
+  // Writes the output to o (if o is good) with a single sputn(), copies the
+  // formatting stream's error state to o if the output is not valid (because
+  // the formatting failed), and resets o's width.
+  ostream_type& commit(ostream_type& o)
+  {
+    ::std::ios_base::iostate state = ::std::ios_base::goodbit;
+    
+    if (bool(o))
+    {
+      size_type const n = buffer_.size();
+      
+      if (n != 0)
+      {
+        typename ostream_type::sentry const sentry(o);
+        
+        if (!sentry || (o.rdbuf()->sputn(buffer_.data(), ::std::streamsize(n)) != ::std::streamsize(n)))
+          state |= ::std::ios_base::badbit;
+      }
+      
+      if (!valid_)
+        state |= stream_.rdstate();
+    }
+    
+    o.width(0);
+    
+    // This may throw, if o has exceptions enabled.
+    if (state != ::std::ios_base::goodbit)
+      o.setstate(state);
+    
+    return o;
+  }
+  
+private:
+  basic_range_stringbuf<CharT, Traits, Allocator>   buffer_;
+  ostream_type                                      stream_;
+  
+  bool                                              valid_;
+  
+  ::std::ios_base::fmtflags                         flags_;
+  ::std::streamsize                                 precision_;
+  ::std::streamsize                                 width_;
+  CharT                                             fill_;
+  ::std::locale                                     locale_;
+};
+
+} // namespace detail
+} // namespace rangeio
+} // namespace boost
+
+#endif  // include guard
@@ -0,0 +1,150 @@
+//
+// Copyright (c) Mark A. Gibbs, 2015.
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+// 
+
+// This file is written to be C++98-safe.
+
+#ifndef BOOST_RANGEIO_Inc_detail_X_counting_streambuf_2015_01_01_
+#define BOOST_RANGEIO_Inc_detail_X_counting_streambuf_2015_01_01_
+
+#include <boost/config.hpp>
+
+#include <ios>
+#include <locale>
+#include <ostream>
+#include <streambuf>
+
+namespace boost {
+namespace rangeio {
+namespace detail {
+
+// 
+// Stream buffer that passes output straight through to another stream
+// buffer, counting the characters the other buffer accepts.
+// 
+// It has no buffer of its own, so nothing is ever held back, and it only ever
+// calls sputc(), sputn() and pubsync() on the other buffer. (Measuring the
+// output by the buffer's position instead would not work for pipes or
+// sockets, and would flush some file buffers.)
+// 
+template <typename CharT, typename Traits>
+class counting_streambuf :
+  public ::std::basic_streambuf<CharT, Traits>
+{
+public:
+  typedef CharT                       char_type;
+  typedef Traits                      traits_type;
+  typedef typename Traits::int_type   int_type;
+  
+  explicit counting_streambuf(::std::basic_streambuf<CharT, Traits>* buf) :
+    buf_(buf),
+    count_(0)
+  {}
+  
+  ::std::streamoff count() const { return count_; }
+  
+protected:
+  virtual int_type overflow(int_type c)
+  {
+    if (traits_type::eq_int_type(c, traits_type::eof()))
+      return traits_type::not_eof(c);
+    
+    int_type const r = buf_->sputc(traits_type::to_char_type(c));
+    if (!traits_type::eq_int_type(r, traits_type::eof()))
+      ++count_;
+    
+    return r;
+  }
+  
+  virtual ::std::streamsize xsputn(char_type const* s, ::std::streamsize n)
+  {
+    ::std::streamsize const r = buf_->sputn(s, n);
+    count_ += r;
+    return r;
+  }
+  
+  virtual int sync()
+  {
+    return buf_->pubsync();
+  }
+  
+  virtual void imbue(::std::locale const& loc)
+  {
+    buf_->pubimbue(loc);
+  }
+  
+private:
+  ::std::basic_streambuf<CharT, Traits>* buf_;
+  ::std::streamoff count_;
+};
+
+// 
+// Counts the characters written to a stream while it exists.
+// 
+// If the stream is good when this is constructed, the stream's buffer is
+// replaced with a counting_streambuf wrapped around it, and the original
+// buffer is put back (without disturbing the stream's state) when this is
+// destroyed. Otherwise, nothing can be written, and the count is zero.
+// 
+// If active is false, the stream is left alone, and the count is -1.
+// 
+template <typename CharT, typename Traits>
+class output_counter
+{
+public:
+  explicit output_counter(::std::basic_ostream<CharT, Traits>& out, bool active = true) :
+    out_(out),
+    buf_(out.rdbuf()),
+    counter_(buf_),
+    attached_(false),
+    active_(active)
+  {
+    if (active_ && out_.good())
+    {
+      // The stream is good, so clearing its state (as rdbuf() does) changes
+      // nothing.
+      out_.rdbuf(&counter_);
+      attached_ = true;
+    }
+  }
+  
+  ~output_counter()
+  {
+    if (attached_)
+    {
+      ::std::ios_base::iostate const state = out_.rdstate();
+      out_.rdbuf(buf_);
+      
+      // If the write failed with exceptions enabled, this is being destroyed
+      // during the unwinding, and clear() throws again - after it has set
+      // the state.
+      try
+      {
+        out_.clear(state);
+      }
+      catch (::std::ios_base::failure const&)
+      {}
+    }
+  }
+  
+  ::std::streamoff count() const { return active_ ? counter_.count() : ::std::streamoff(-1); }
+  
+private:
+  output_counter(output_counter const&);
+  output_counter& operator=(output_counter const&);
+  
+  ::std::basic_ostream<CharT, Traits>&    out_;
+  ::std::basic_streambuf<CharT, Traits>*  buf_;
+  counting_streambuf<CharT, Traits>       counter_;
+  bool                                    attached_;
+  bool                                    active_;
+};
+
+} // namespace detail
+} // namespace rangeio
+} // namespace boost
+
+#endif  // include guard
@@ -0,0 +1,236 @@
+//
+// Copyright (c) Mark A. Gibbs, 2015.
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+// 
+
+// Contains the type-erased write loop used when BOOST_RANGEIO_ERASED_WRITE is
+// defined (see prefer_inline_write.hpp).
+// 
+// The loop itself depends only on the stream type, so only one copy of it is
+// generated per stream type, no matter how many different kinds of ranges are
+// written. Everything that depends on the range or the delimiter is done
+// through a few small functions called via pointers - one set per kind of
+// range, and one per kind of delimiter.
+// 
+// This file is written to be C++98-safe.
+
+#ifndef BOOST_RANGEIO_Inc_detail_X_erased_write_2015_01_01_
+#define BOOST_RANGEIO_Inc_detail_X_erased_write_2015_01_01_
+
+#include <boost/config.hpp>
+
+#include <cstddef>
+#include <iosfwd>
+
+#include <boost/rangeio/detail/formatting_saver.hpp>
+#include <boost/rangeio/detail/write_probe.hpp>
+
+namespace boost {
+namespace rangeio {
+namespace detail {
+
+// A type-erased range, as used by the type-erased write loop.
+// 
+// state points to the range's iterator and sentinel, and the functions are:
+//   at_end(state):
+//     Returns true if the iterator is equal to the sentinel.
+//   write_element(state, out, n):
+//     Performs "out << *i". If bool(out) is then true, performs "++n" and
+//     "++i", and returns true. Otherwise returns false.
+template <typename CharT, typename Traits>
+struct erased_write_range
+{
+  void*  state;
+  bool   (*at_end)(void const*);
+  bool   (*write_element)(void*, ::std::basic_ostream<CharT, Traits>&, ::std::size_t&);
+};
+
+// A type-erased delimiter, as used by the type-erased write loop.
+// 
+// delim points to the delimiter, and write(delim, out) performs
+// "out << delim" and returns bool(out). write is null for writes without
+// delimiters.
+template <typename CharT, typename Traits>
+struct erased_write_delimiter
+{
+  void*  delim;
+  bool   (*write)(void*, ::std::basic_ostream<CharT, Traits>&);
+};
+
+// The state of a range being written by the type-erased write loop, and the
+// implementations of the operations on it.
+// 
+// The operations depend only on the iterator and sentinel types (and the
+// stream type), so they are shared by all writes of the same kind of range,
+// regardless of the delimiter.
+template <typename InputIterator, typename Sentinel>
+struct erased_write_range_state
+{
+  erased_write_range_state(InputIterator& i, Sentinel const& e) :
+    i(i),
+    e(e)
+  {}
+  
+  template <typename CharT, typename Traits>
+  erased_write_range<CharT, Traits> erase()
+  {
+    erased_write_range<CharT, Traits> const r =
+    {
+      this,
+      &erased_write_range_state::at_end,
+      &erased_write_range_state::template write_element<CharT, Traits>
+    };
+    
+    return r;
+  }
+  
+  static bool at_end(void const* state)
+  {
+    erased_write_range_state const* const p = static_cast<erased_write_range_state const*>(state);
+    return p->i == p->e;
+  }
+  
+  template <typename CharT, typename Traits>
+  static bool write_element(void* state, ::std::basic_ostream<CharT, Traits>& out, ::std::size_t& n)
+  {
+    erased_write_range_state* const p = static_cast<erased_write_range_state*>(state);
+    
+    if ((out << *p->i))
+    {
+      // If the write succeeds, increment:
+      ++n;    // ... the write count (do first because it will never throw)
+      ++p->i; // ... the iterator
+      
+      return true;
+    }
+    
+    return false;
+  }
+  
+  InputIterator&   i;
+  Sentinel const&  e;
+};
+
+// The implementation of the delimiter operation for the type-erased write
+// loop.
+// 
+// This depends only on the delimiter type (and the stream type), so it is
+// shared by all writes with the same kind of delimiter, regardless of the
+// range.
+template <typename Delimiter>
+struct erased_write_delimiter_ops
+{
+  template <typename CharT, typename Traits>
+  static erased_write_delimiter<CharT, Traits> erase(Delimiter& delim)
+  {
+    erased_write_delimiter<CharT, Traits> const d =
+    {
+      const_cast<void*>(static_cast<void const*>(&delim)),
+      &erased_write_delimiter_ops::template write<CharT, Traits>
+    };
+    
+    return d;
+  }
+  
+  template <typename CharT, typename Traits>
+  static bool write(void* delim, ::std::basic_ostream<CharT, Traits>& out)
+  {
+    return bool(out << *static_cast<Delimiter*>(delim));
+  }
+};
+
+// The type-erased write loop.
+// 
+// Behaves exactly like write_impl() (with or without delimiters, depending on
+// whether delim.write is null), with all of the range and delimiter
+// operations done via r and delim.
+// 
+// This is never inlined, because inlining it (and then propagating the
+// constant function pointers) would just recreate a specialized copy of the
+// loop for each range type, which is exactly what is being avoided.
+template <typename CharT, typename Traits>
+BOOST_NOINLINE void
+erased_write_engine(
+  ::std::basic_ostream<CharT, Traits>& out,
+  erased_write_range<CharT, Traits> const& r,
+  erased_write_delimiter<CharT, Traits> const& delim,
+  ::std::size_t& n)
+{
+  detail::write_probe<CharT, Traits> const probe(out, n);
+  
+  // Only bother to attempt writing if the range is empty or the output stream
+  // is good (bool(out) is true).
+  if (!r.at_end(r.state) && bool(out))
+  {
+    // Save the formatting state prior to writing the first element.
+    detail::formatting_saver<CharT, Traits> formatting(out);
+    
+    if (r.write_element(r.state, out, n))
+    {
+      while (!r.at_end(r.state) && bool(out) &&
+        ((delim.write == 0) || delim.write(delim.delim, out)))
+      {
+        // If there are still more elements to write (and the output stream is
+        // still good), restore the formatting state to what it was before the
+        // first write.
+        formatting.restore();
+        
+        r.write_element(r.state, out, n);
+      }
+    }
+  }
+  
+  // Regardless of anything else, reset the stream's width to zero.
+  out.width(0);
+  
+  probe.finish(out, n, !r.at_end(r.state));
+}
+
+// Type-erased versions of write_impl().
+// 
+// There are two versions - one with a delimiter, and one without.
+template <
+  typename InputIterator,
+  typename Sentinel,
+  typename CharT,
+  typename Traits>
+void
+erased_write_impl(
+  ::std::basic_ostream<CharT, Traits>& out,
+  InputIterator& i,
+  Sentinel const& e,
+  ::std::size_t& n)
+{
+  erased_write_range_state<InputIterator, Sentinel> state(i, e);
+  erased_write_delimiter<CharT, Traits> const no_delim = { 0, 0 };
+  
+  detail::erased_write_engine(out, state.template erase<CharT, Traits>(), no_delim, n);
+}
+
+template <
+  typename InputIterator,
+  typename Sentinel,
+  typename Delimiter,
+  typename CharT,
+  typename Traits>
+void
+erased_write_impl(
+  ::std::basic_ostream<CharT, Traits>& out,
+  InputIterator& i,
+  Sentinel const& e,
+  Delimiter& delim,
+  ::std::size_t& n)
+{
+  erased_write_range_state<InputIterator, Sentinel> state(i, e);
+  
+  detail::erased_write_engine(out, state.template erase<CharT, Traits>(),
+    erased_write_delimiter_ops<Delimiter>::template erase<CharT, Traits>(delim), n);
+}
+
+} // namespace detail
+} // namespace rangeio
+} // namespace boost
+
+#endif  // include guard
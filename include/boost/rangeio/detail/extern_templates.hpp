@@ -0,0 +1,211 @@
+//
+// Copyright (c) Mark A. Gibbs, 2015.
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+// 
+
+// Explicit instantiations of the write implementation functions for the most
+// common element, iterator, delimiter and character types.
+// 
+// By default, RangeIO is header-only, and this file does nothing. If
+// BOOST_RANGEIO_SEPARATE_COMPILATION is defined, the instantiations listed
+// here are declared extern, so translation units that use them do not
+// instantiate them again - instead, they must be linked against the compiled
+// library (libboost_rangeio, built by build/Makefile), which defines them.
+// (The library source defines BOOST_RANGEIO_SOURCE to get the definitions.)
+// 
+// The instantiations cover:
+//   character types:  char, wchar_t
+//   element types:    all the standard arithmetic types except the character
+//                     types and bool, and std::basic_string<CharT>
+//   iterator types:   T*, T const*, std::vector<T>::iterator and
+//                     std::vector<T>::const_iterator (with the same type used
+//                     as the sentinel)
+//   delimiter types:  none, CharT, CharT const, CharT const* and
+//                     std::basic_string<CharT> const
+// 
+// The type-erased write loops (used when BOOST_RANGEIO_ERASED_WRITE is
+// defined) are also instantiated for char and wchar_t.
+// 
+// Any other combination is instantiated implicitly, as usual. (In
+// particular, string literal delimiters are arrays, not pointers, so are not
+// covered unless they are passed as pointers.)
+// 
+// The instantiations depend on the configuration macros that change the
+// write loops - BOOST_RANGEIO_ERASED_WRITE and BOOST_RANGEIO_ENABLE_USDT - so
+// code using the library must be compiled with the same settings of those
+// macros as the library was. That is checked at link time: the library
+// defines a function whose name encodes its settings (for example,
+// separate_compilation_config_inline_nousdt()), and every translation unit
+// using it calls the one for its own settings during static initialization,
+// so a mismatch is an undefined reference to that function rather than a
+// silent mix of instantiations. (BOOST_RANGEIO_NO_SIMD, and the SIMD target
+// flags, only affect the hex and base64 writes, which are not instantiated
+// here, so they do not need to match.)
+// 
+// Requires at least C++11 when used.
+
+#ifndef BOOST_RANGEIO_Inc_detail_X_extern_templates_2015_01_01_
+#define BOOST_RANGEIO_Inc_detail_X_extern_templates_2015_01_01_
+
+#include <boost/config.hpp>
+
+#if defined(BOOST_RANGEIO_SOURCE) || defined(BOOST_RANGEIO_SEPARATE_COMPILATION)
+
+#if defined(BOOST_NO_CXX11_EXTERN_TEMPLATE)
+#   error "Separate compilation requires extern templates"
+#endif
+
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include <boost/preprocessor/seq/cat.hpp>
+#include <boost/preprocessor/seq/elem.hpp>
+#include <boost/preprocessor/seq/for_each_product.hpp>
+
+#include <boost/rangeio/detail/write.hpp>
+
+#if defined(BOOST_RANGEIO_SOURCE)
+#   define BOOST_RANGEIO_DETAIL_EXTERN
+#else
+#   define BOOST_RANGEIO_DETAIL_EXTERN extern
+#endif
+
+#if defined(BOOST_RANGEIO_ERASED_WRITE)
+#   define BOOST_RANGEIO_DETAIL_CONFIG_WRITE erased
+#else
+#   define BOOST_RANGEIO_DETAIL_CONFIG_WRITE inline
+#endif
+
+#if defined(BOOST_RANGEIO_ENABLE_USDT)
+#   define BOOST_RANGEIO_DETAIL_CONFIG_USDT usdt
+#else
+#   define BOOST_RANGEIO_DETAIL_CONFIG_USDT nousdt
+#endif
+
+#define BOOST_RANGEIO_DETAIL_CONFIG_CHECK \
+  BOOST_PP_SEQ_CAT((separate_compilation_config_)(BOOST_RANGEIO_DETAIL_CONFIG_WRITE)(_)(BOOST_RANGEIO_DETAIL_CONFIG_USDT))
+
+#define BOOST_RANGEIO_DETAIL_POINTER(T) T*
+#define BOOST_RANGEIO_DETAIL_CONST_POINTER(T) T const*
+#define BOOST_RANGEIO_DETAIL_VECTOR_ITERATOR(T) ::std::vector< T >::iterator
+#define BOOST_RANGEIO_DETAIL_VECTOR_CONST_ITERATOR(T) ::std::vector< T >::const_iterator
+
+#define BOOST_RANGEIO_DETAIL_ITERATOR_FORMS \
+  (BOOST_RANGEIO_DETAIL_POINTER) \
+  (BOOST_RANGEIO_DETAIL_CONST_POINTER) \
+  (BOOST_RANGEIO_DETAIL_VECTOR_ITERATOR) \
+  (BOOST_RANGEIO_DETAIL_VECTOR_CONST_ITERATOR)
+
+#define BOOST_RANGEIO_DETAIL_ARITHMETIC_TYPES \
+  (short)(unsigned short) \
+  (int)(unsigned int) \
+  (long)(unsigned long) \
+  (long long)(unsigned long long) \
+  (float)(double)(long double)
+
+#define BOOST_RANGEIO_DETAIL_INSTANTIATE_WRITE(C, I) \
+  BOOST_RANGEIO_DETAIL_EXTERN template void write_impl< I, I, C, ::std::char_traits< C > >( \
+    ::std::basic_ostream< C >&, I&, I const&, ::std::size_t&); \
+  BOOST_RANGEIO_DETAIL_EXTERN template void instrumented_write_impl< I, I, C, ::std::char_traits< C >, null_write_instrument>( \
+    ::std::basic_ostream< C >&, I&, I const&, ::std::size_t&, null_write_instrument&);
+
+#define BOOST_RANGEIO_DETAIL_INSTANTIATE_WRITE_DELIM(C, I, D) \
+  BOOST_RANGEIO_DETAIL_EXTERN template void write_impl< I, I, D, C, ::std::char_traits< C > >( \
+    ::std::basic_ostream< C >&, I&, I const&, D&, ::std::size_t&); \
+  BOOST_RANGEIO_DETAIL_EXTERN template void instrumented_write_impl< I, I, D, C, ::std::char_traits< C >, null_write_instrument>( \
+    ::std::basic_ostream< C >&, I&, I const&, D&, ::std::size_t&, null_write_instrument&);
+
+// product is (CharT)(element type)(iterator form)
+#define BOOST_RANGEIO_DETAIL_INSTANTIATE_WRITE_PRODUCT(r, product) \
+  BOOST_RANGEIO_DETAIL_INSTANTIATE_WRITE( \
+    BOOST_PP_SEQ_ELEM(0, product), \
+    BOOST_PP_SEQ_ELEM(2, product)(BOOST_PP_SEQ_ELEM(1, product)))
+
+// product is (CharT)(element type)(iterator form)(delimiter type)
+#define BOOST_RANGEIO_DETAIL_INSTANTIATE_WRITE_DELIM_PRODUCT(r, product) \
+  BOOST_RANGEIO_DETAIL_INSTANTIATE_WRITE_DELIM( \
+    BOOST_PP_SEQ_ELEM(0, product), \
+    BOOST_PP_SEQ_ELEM(2, product)(BOOST_PP_SEQ_ELEM(1, product)), \
+    BOOST_PP_SEQ_ELEM(3, product))
+
+namespace boost {
+namespace rangeio {
+namespace detail {
+
+// The configuration check (see above).
+#if defined(BOOST_RANGEIO_SOURCE)
+int BOOST_RANGEIO_DETAIL_CONFIG_CHECK() { return 0; }
+#else
+int BOOST_RANGEIO_DETAIL_CONFIG_CHECK();
+
+namespace {
+
+BOOST_ATTRIBUTE_UNUSED int const separate_compilation_config_check = detail::BOOST_RANGEIO_DETAIL_CONFIG_CHECK();
+
+} // anonymous namespace
+#endif // BOOST_RANGEIO_SOURCE
+
+BOOST_PP_SEQ_FOR_EACH_PRODUCT(
+  BOOST_RANGEIO_DETAIL_INSTANTIATE_WRITE_PRODUCT,
+  ((char))
+  (BOOST_RANGEIO_DETAIL_ARITHMETIC_TYPES(::std::string))
+  (BOOST_RANGEIO_DETAIL_ITERATOR_FORMS))
+
+BOOST_PP_SEQ_FOR_EACH_PRODUCT(
+  BOOST_RANGEIO_DETAIL_INSTANTIATE_WRITE_DELIM_PRODUCT,
+  ((char))
+  (BOOST_RANGEIO_DETAIL_ARITHMETIC_TYPES(::std::string))
+  (BOOST_RANGEIO_DETAIL_ITERATOR_FORMS)
+  ((char)(char const)(char const*)(::std::string const)))
+
+BOOST_PP_SEQ_FOR_EACH_PRODUCT(
+  BOOST_RANGEIO_DETAIL_INSTANTIATE_WRITE_PRODUCT,
+  ((wchar_t))
+  (BOOST_RANGEIO_DETAIL_ARITHMETIC_TYPES(::std::wstring))
+  (BOOST_RANGEIO_DETAIL_ITERATOR_FORMS))
+
+BOOST_PP_SEQ_FOR_EACH_PRODUCT(
+  BOOST_RANGEIO_DETAIL_INSTANTIATE_WRITE_DELIM_PRODUCT,
+  ((wchar_t))
+  (BOOST_RANGEIO_DETAIL_ARITHMETIC_TYPES(::std::wstring))
+  (BOOST_RANGEIO_DETAIL_ITERATOR_FORMS)
+  ((wchar_t)(wchar_t const)(wchar_t const*)(::std::wstring const)))
+
+// The type-erased write loops (see erased_write.hpp).
+BOOST_RANGEIO_DETAIL_EXTERN template void erased_write_engine<char, ::std::char_traits<char> >(
+  ::std::basic_ostream<char>&,
+  erased_write_range<char, ::std::char_traits<char> > const&,
+  erased_write_delimiter<char, ::std::char_traits<char> > const&,
+  ::std::size_t&);
+BOOST_RANGEIO_DETAIL_EXTERN template void erased_write_engine<wchar_t, ::std::char_traits<wchar_t> >(
+  ::std::basic_ostream<wchar_t>&,
+  erased_write_range<wchar_t, ::std::char_traits<wchar_t> > const&,
+  erased_write_delimiter<wchar_t, ::std::char_traits<wchar_t> > const&,
+  ::std::size_t&);
+
+} // namespace detail
+} // namespace rangeio
+} // namespace boost
+
+#undef BOOST_RANGEIO_DETAIL_INSTANTIATE_WRITE_DELIM_PRODUCT
+#undef BOOST_RANGEIO_DETAIL_INSTANTIATE_WRITE_PRODUCT
+#undef BOOST_RANGEIO_DETAIL_INSTANTIATE_WRITE_DELIM
+#undef BOOST_RANGEIO_DETAIL_INSTANTIATE_WRITE
+#undef BOOST_RANGEIO_DETAIL_ARITHMETIC_TYPES
+#undef BOOST_RANGEIO_DETAIL_ITERATOR_FORMS
+#undef BOOST_RANGEIO_DETAIL_VECTOR_CONST_ITERATOR
+#undef BOOST_RANGEIO_DETAIL_VECTOR_ITERATOR
+#undef BOOST_RANGEIO_DETAIL_CONST_POINTER
+#undef BOOST_RANGEIO_DETAIL_POINTER
+#undef BOOST_RANGEIO_DETAIL_EXTERN
+#undef BOOST_RANGEIO_DETAIL_CONFIG_CHECK
+#undef BOOST_RANGEIO_DETAIL_CONFIG_USDT
+#undef BOOST_RANGEIO_DETAIL_CONFIG_WRITE
+
+#endif // BOOST_RANGEIO_SOURCE || BOOST_RANGEIO_SEPARATE_COMPILATION
+
+#endif  // include guard
@@ -0,0 +1,170 @@
+//
+// Copyright (c) Mark A. Gibbs, 2015.
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+// 
+
+// This file is written to be C++98-safe.
+
+#ifndef BOOST_RANGEIO_Inc_detail_X_growable_streambuf_2015_01_01_
+#define BOOST_RANGEIO_Inc_detail_X_growable_streambuf_2015_01_01_
+
+#include <boost/config.hpp>
+
+#include <climits>
+#include <cstddef>
+#include <ios>
+#include <streambuf>
+#include <string>
+
+#include <boost/rangeio/detail/scratch_block.hpp>
+
+namespace boost {
+namespace rangeio {
+namespace detail {
+
+// 
+// Output-only stream buffer that writes into a growable array, used as
+// scratch space for formatting.
+// 
+// Unlike std::basic_stringbuf, clearing the buffer keeps its capacity, so a
+// buffer that is reused never allocates once it has grown large enough.
+// 
+// By default the buffer owns its storage, but it can also be attached to a
+// borrowed scratch block (for example, one from the thread's scratch arena -
+// see detail/scratch_arena.hpp), which it then uses until it is detached.
+// 
+template <typename CharT, typename Traits = ::std::char_traits<CharT> >
+class growable_streambuf :
+  public ::std::basic_streambuf<CharT, Traits>
+{
+public:
+  typedef typename ::std::basic_streambuf<CharT, Traits>::int_type  int_type;
+  typedef typename ::std::basic_streambuf<CharT, Traits>::pos_type  pos_type;
+  typedef typename ::std::basic_streambuf<CharT, Traits>::off_type  off_type;
+  
+  growable_streambuf() :
+    block_(&own_)
+  {}
+  
+  CharT const* data() const { return this->pbase(); }
+  
+  ::std::size_t size() const { return ::std::size_t(this->pptr() - this->pbase()); }
+  
+  ::std::size_t capacity() const { return block_->capacity() / sizeof(CharT); }
+  
+  // Discards the contents, keeping the capacity.
+  void clear() { this->setp(this->pbase(), this->epptr()); }
+  
+  // Discards the contents and the capacity.
+  void release()
+  {
+    block_->release();
+    this->setp(0, 0);
+  }
+  
+  // Discards the contents, and uses block as the storage until detach() is
+  // called. The block's existing capacity is reused.
+  void attach(scratch_block& block)
+  {
+    block_ = &block;
+    reset_();
+  }
+  
+  // Discards the contents, and goes back to using the buffer's own storage.
+  void detach()
+  {
+    block_ = &own_;
+    reset_();
+  }
+  
+  void reserve(::std::size_t n)
+  {
+    if (n > capacity())
+      grow_(n);
+  }
+  
+protected:
+  int_type overflow(int_type c)
+  {
+    if (Traits::eq_int_type(c, Traits::eof()))
+      return Traits::not_eof(c);
+    
+    grow_(size() + 1);
+    
+    *this->pptr() = Traits::to_char_type(c);
+    this->pbump(1);
+    
+    return c;
+  }
+  
+  ::std::streamsize xsputn(CharT const* s, ::std::streamsize n)
+  {
+    if (n <= 0)
+      return 0;
+    
+    ::std::size_t const count = ::std::size_t(n);
+    
+    if (count > ::std::size_t(this->epptr() - this->pptr()))
+      grow_(size() + count);
+    
+    Traits::copy(this->pptr(), s, count);
+    advance_(count);
+    
+    return n;
+  }
+  
+  // Only supports querying the current output position, so that the number
+  // of characters written can be measured.
+  pos_type seekoff(off_type off, ::std::ios_base::seekdir dir, ::std::ios_base::openmode which)
+  {
+    if ((off == 0) && (dir == ::std::ios_base::cur) && (which & ::std::ios_base::out))
+      return pos_type(off_type(size()));
+    
+    return pos_type(off_type(-1));
+  }
+  
+private:
+  void grow_(::std::size_t min_capacity)
+  {
+    ::std::size_t const old_size = size();
+    
+    ::std::size_t new_capacity = (capacity() < 128) ? 256 : (2 * capacity());
+    if (new_capacity < min_capacity)
+      new_capacity = min_capacity;
+    
+    block_->grow(new_capacity * sizeof(CharT), old_size * sizeof(CharT));
+    
+    CharT* const p = static_cast<CharT*>(block_->data());
+    this->setp(p, p + new_capacity);
+    advance_(old_size);
+  }
+  
+  void reset_()
+  {
+    CharT* const p = static_cast<CharT*>(block_->data());
+    this->setp(p, p + capacity());
+  }
+  
+  // pbump() takes an int, so advance in int-sized steps.
+  void advance_(::std::size_t n)
+  {
+    while (n > ::std::size_t(INT_MAX))
+    {
+      this->pbump(INT_MAX);
+      n -= ::std::size_t(INT_MAX);
+    }
+    
+    this->pbump(int(n));
+  }
+  
+  scratch_block   own_;
+  scratch_block*  block_;
+};
+
+} // namespace detail
+} // namespace rangeio
+} // namespace boost
+
+#endif  // include guard
@@ -0,0 +1,117 @@
+//
+// Copyright (c) Mark A. Gibbs, 2015.
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+// 
+
+// Contains the hex (and binary) encoding functions used by write_hex().
+// 
+// This file is written to be C++98-safe.
+
+#ifndef BOOST_RANGEIO_Inc_detail_X_hex_2015_01_01_
+#define BOOST_RANGEIO_Inc_detail_X_hex_2015_01_01_
+
+#include <boost/config.hpp>
+
+#include <cstddef>
+
+#include <boost/rangeio/detail/simd.hpp>
+
+namespace boost {
+namespace rangeio {
+namespace detail {
+
+// The 16 hex digits (as a 16-byte table, usable with a vector shuffle).
+inline char const* hex_digits(bool uppercase)
+{
+  return uppercase ? "0123456789ABCDEF" : "0123456789abcdef";
+}
+
+// The number of significant hex digits in v (at least 1).
+template <typename Unsigned>
+::std::size_t hex_length(Unsigned v)
+{
+  ::std::size_t n = 1;
+  while ((v >>= 4) != 0)
+    ++n;
+  
+  return n;
+}
+
+// Writes the lowest n hex digits of v (an unsigned integer) to out, most
+// significant first, using the digit characters in digits.
+template <typename Unsigned, typename CharT>
+void hex_encode_integer(Unsigned v, ::std::size_t n, CharT* out, CharT const* digits)
+{
+  for (out += n; n != 0; --n, v >>= 4)
+    *--out = digits[v & 0xF];
+}
+
+// The number of significant binary digits in v (at least 1).
+template <typename Unsigned>
+::std::size_t binary_length(Unsigned v)
+{
+  ::std::size_t n = 1;
+  while ((v >>= 1) != 0)
+    ++n;
+  
+  return n;
+}
+
+// Writes the lowest n binary digits of v (an unsigned integer) to out, most
+// significant first, using the first two digit characters in digits.
+template <typename Unsigned, typename CharT>
+void binary_encode_integer(Unsigned v, ::std::size_t n, CharT* out, CharT const* digits)
+{
+  for (out += n; n != 0; --n, v >>= 1)
+    *--out = digits[v & 0x1];
+}
+
+// Writes the two hex digits of each of the n bytes at p to out, using the
+// digit characters in digits.
+template <typename CharT>
+void hex_encode_bytes_scalar(unsigned char const* p, ::std::size_t n, CharT* out, CharT const* digits)
+{
+  for (; n != 0; --n, ++p)
+  {
+    *out++ = digits[*p >> 4];
+    *out++ = digits[*p & 0xF];
+  }
+}
+
+template <typename CharT>
+void hex_encode_bytes(unsigned char const* p, ::std::size_t n, CharT* out, CharT const* digits)
+{
+  detail::hex_encode_bytes_scalar(p, n, out, digits);
+}
+
+#ifdef BOOST_RANGEIO_HAS_SSSE3
+// SSSE3 version for narrow characters: looks up the high and low nibbles of
+// 16 bytes at a time with a byte shuffle of the digit table, then interleaves
+// them.
+inline void hex_encode_bytes(unsigned char const* p, ::std::size_t n, char* out, char const* digits)
+{
+  __m128i const table = _mm_loadu_si128(reinterpret_cast<__m128i const*>(digits));
+  __m128i const mask = _mm_set1_epi8(0x0F);
+  
+  for (; n >= 16; n -= 16, p += 16, out += 32)
+  {
+    __m128i const v = _mm_loadu_si128(reinterpret_cast<__m128i const*>(p));
+    
+    __m128i const hi = _mm_shuffle_epi8(table, _mm_and_si128(_mm_srli_epi16(v, 4), mask));
+    __m128i const lo = _mm_shuffle_epi8(table, _mm_and_si128(v, mask));
+    
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm_unpacklo_epi8(hi, lo));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 16), _mm_unpackhi_epi8(hi, lo));
+  }
+  
+  detail::hex_encode_bytes_scalar(p, n, out, digits);
+}
+#endif // BOOST_RANGEIO_HAS_SSSE3
+
+} // namespace detail
+} // namespace rangeio
+} // namespace boost
+
+#endif  // include guard
@@ -0,0 +1,28 @@
+//
+// Copyright (c) Mark A. Gibbs, 2015.
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+// 
+
+// Defines BOOST_RANGEIO_MODULE_EXPORT, which marks the declarations that are
+// exported by the boost.rangeio module (see module/boost.rangeio.cppm).
+// 
+// When the headers are included normally, it expands to nothing. The module
+// interface unit defines it as "export" before including the headers in its
+// purview.
+// 
+// Only primary templates, non-template classes and functions, and variables
+// are marked. (Specializations are not declared with export; they are
+// available wherever their primary template is.)
+// 
+// This file is written to be C++98-safe.
+
+#ifndef BOOST_RANGEIO_Inc_detail_X_module_export_2015_01_01_
+#define BOOST_RANGEIO_Inc_detail_X_module_export_2015_01_01_
+
+#ifndef BOOST_RANGEIO_MODULE_EXPORT
+#   define BOOST_RANGEIO_MODULE_EXPORT
+#endif
+
+#endif  // include guard
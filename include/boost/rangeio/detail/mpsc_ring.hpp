@@ -0,0 +1,197 @@
+//
+// Copyright (c) Mark A. Gibbs, 2015.
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+// 
+
+// Requires at least C++11.
+
+#ifndef BOOST_RANGEIO_Inc_detail_X_mpsc_ring_2015_01_01_
+#define BOOST_RANGEIO_Inc_detail_X_mpsc_ring_2015_01_01_
+
+#include <boost/config.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+namespace boost {
+namespace rangeio {
+namespace detail {
+
+// 
+// Bounded lock-free multi-producer single-consumer ring of fixed-size byte
+// slots.
+// 
+// This is Dmitry Vyukov's bounded queue: each slot has a sequence number that
+// says whose turn it is to use it, so producers only contend on the enqueue
+// position (with a single compare-and-swap), and never on each other's slots.
+// 
+// A producer calls try_claim() to get a slot, fills in its data (at most
+// slot_size() bytes), then calls publish() with the number of bytes used.
+// The consumer calls peek() to get the next published slot (if any), reads
+// it, then calls release(). Slots are consumed in claim order, so a slot that
+// has been claimed but not yet published holds up the consumer.
+// 
+// The slot count is rounded up to a power of two.
+// 
+class mpsc_ring
+{
+public:
+  // A claimed or published slot.
+  struct slot
+  {
+    char*          data;
+    ::std::size_t  size;
+    ::std::size_t  position;
+  };
+  
+  mpsc_ring(::std::size_t slot_count, ::std::size_t slot_size) :
+    mask_(round_up_(slot_count) - 1),
+    slot_size_(slot_size),
+    cells_(new cell[mask_ + 1]),
+    storage_(new char[(mask_ + 1) * slot_size]),
+    enqueue_position_(0),
+    dequeue_position_(0)
+  {
+    for (::std::size_t i = 0; i <= mask_; ++i)
+      cells_[i].sequence.store(i, ::std::memory_order_relaxed);
+  }
+  
+  mpsc_ring(mpsc_ring const&) = delete;
+  mpsc_ring& operator=(mpsc_ring const&) = delete;
+  
+  ::std::size_t slot_count() const { return mask_ + 1; }
+  ::std::size_t slot_size() const { return slot_size_; }
+  
+  // Producer side.
+  
+  // Claims the next slot, if there is one free. Returns false if the ring is
+  // full.
+  bool try_claim(slot& s)
+  {
+    ::std::size_t position = enqueue_position_.load(::std::memory_order_relaxed);
+    
+    for (;;)
+    {
+      cell& c = cells_[position & mask_];
+      ::std::size_t const sequence = c.sequence.load(::std::memory_order_acquire);
+      
+      ::std::ptrdiff_t const diff = ::std::ptrdiff_t(sequence) - ::std::ptrdiff_t(position);
+      
+      if (diff == 0)
+      {
+        if (enqueue_position_.compare_exchange_weak(position, position + 1, ::std::memory_order_relaxed))
+          break;
+      }
+      else if (diff < 0)
+      {
+        return false;
+      }
+      else
+      {
+        position = enqueue_position_.load(::std::memory_order_relaxed);
+      }
+    }
+    
+    s.data = storage_.get() + ((position & mask_) * slot_size_);
+    s.size = 0;
+    s.position = position;
+    
+    return true;
+  }
+  
+  // Publishes a claimed slot, with size bytes of data.
+  void publish(slot const& s, ::std::size_t size)
+  {
+    cell& c = cells_[s.position & mask_];
+    c.size = size;
+    c.sequence.store(s.position + 1, ::std::memory_order_release);
+  }
+  
+  // Gets the position the next claimed slot will have.
+  ::std::size_t enqueue_position() const
+  {
+    return enqueue_position_.load(::std::memory_order_acquire);
+  }
+  
+  // Consumer side.
+  
+  // Gets the next published slot, if there is one. Returns false if the next
+  // slot has not been published yet (or the ring is empty).
+  bool peek(slot& s, ::std::size_t offset = 0) const
+  {
+    ::std::size_t const position = dequeue_position_.load(::std::memory_order_relaxed) + offset;
+    cell const& c = cells_[position & mask_];
+    
+    if (c.sequence.load(::std::memory_order_acquire) != (position + 1))
+      return false;
+    
+    s.data = storage_.get() + ((position & mask_) * slot_size_);
+    s.size = c.size;
+    s.position = position;
+    
+    return true;
+  }
+  
+  // Releases the next count slots (which must all have been peeked), so that
+  // producers can reuse them.
+  void release(::std::size_t count = 1)
+  {
+    ::std::size_t position = dequeue_position_.load(::std::memory_order_relaxed);
+    
+    for (::std::size_t i = 0; i != count; ++i, ++position)
+      cells_[position & mask_].sequence.store(position + mask_ + 1, ::std::memory_order_release);
+    
+    dequeue_position_.store(position, ::std::memory_order_release);
+  }
+  
+  // Gets the position of the next slot the consumer will read (so all slots
+  // before it have been consumed).
+  ::std::size_t dequeue_position() const
+  {
+    return dequeue_position_.load(::std::memory_order_acquire);
+  }
+  
+private:
+  static ::std::size_t round_up_(::std::size_t n)
+  {
+    ::std::size_t r = 2;
+    while (r < n)
+      r *= 2;
+    
+    return r;
+  }
+  
+  // The cells and positions are padded out to a cache line, rather than
+  // aligned, because over-aligned types cannot be allocated dynamically
+  // before C++17.
+  static ::std::size_t const cache_line_size = 64;
+  
+  struct cell
+  {
+    ::std::atomic< ::std::size_t>  sequence;
+    ::std::size_t                  size;
+    
+    char padding[cache_line_size - sizeof(::std::atomic< ::std::size_t>) - sizeof(::std::size_t)];
+  };
+  
+  ::std::size_t const             mask_;
+  ::std::size_t const             slot_size_;
+  ::std::unique_ptr<cell[]> const cells_;
+  ::std::unique_ptr<char[]> const storage_;
+  
+  // The positions are on separate cache lines, because they are written by
+  // different threads.
+  char                            padding0_[cache_line_size];
+  ::std::atomic< ::std::size_t>   enqueue_position_;
+  char                            padding1_[cache_line_size];
+  ::std::atomic< ::std::size_t>   dequeue_position_;
+};
+
+} // namespace detail
+} // namespace rangeio
+} // namespace boost
+
+#endif  // include guard
@@ -0,0 +1,29 @@
+//
+// Copyright (c) Mark A. Gibbs, 2015.
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+// 
+
+// Detects support for polymorphic allocators (<memory_resource>), and defines
+// BOOST_RANGEIO_HAS_PMR if they are available. Defining BOOST_RANGEIO_NO_PMR
+// before including any RangeIO header disables the std::pmr support.
+// 
+// This file is written to be C++98-safe.
+
+#ifndef BOOST_RANGEIO_Inc_detail_X_pmr_2015_01_01_
+#define BOOST_RANGEIO_Inc_detail_X_pmr_2015_01_01_
+
+#include <boost/config.hpp>
+
+#if !defined(BOOST_RANGEIO_NO_PMR) && !defined(BOOST_NO_CXX17_HDR_MEMORY_RESOURCE) && defined(__has_include)
+#   if __has_include(<memory_resource>) && ((__cplusplus >= 201703L) || (defined(_MSVC_LANG) && (_MSVC_LANG >= 201703L)))
+#       define BOOST_RANGEIO_HAS_PMR
+#   endif
+#endif
+
+#ifdef BOOST_RANGEIO_HAS_PMR
+#   include <memory_resource>
+#endif
+
+#endif  // include guard
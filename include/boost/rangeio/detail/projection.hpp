@@ -0,0 +1,173 @@
+//
+// Copyright (c) Mark A. Gibbs, 2015.
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+// 
+
+// Contains the projection support for the range write operations: the
+// identity projection used by the plain writes, and project(), which applies
+// a projection to an element.
+// 
+// This file is written to be C++98-safe (projections that are general
+// function objects require C++11).
+
+#ifndef BOOST_RANGEIO_Inc_detail_X_projection_2015_01_01_
+#define BOOST_RANGEIO_Inc_detail_X_projection_2015_01_01_
+
+#include <boost/config.hpp>
+
+#include <iosfwd>
+#include <iterator>
+
+#include <boost/type_traits/integral_constant.hpp>
+#include <boost/type_traits/remove_cv.hpp>
+#include <boost/type_traits/remove_reference.hpp>
+
+#ifndef BOOST_NO_CXX11_DECLTYPE
+#   include <type_traits>
+#   include <utility>
+#endif
+
+namespace boost {
+namespace rangeio {
+namespace detail {
+
+// The projection used by writes that do not project their elements.
+// 
+// It is never actually applied: write_element() has an overload for it that
+// writes the element directly, so the plain writes are exactly "out << *i".
+struct identity_projection
+{};
+
+// Applies a projection to an element.
+// 
+// Projections can be:
+//   * pointers to data members, giving a reference to the member of the
+//     element (or of the object it points to, if it is a pointer);
+//   * pointers to const member functions taking no arguments, giving the
+//     result of calling the function on the element (or the object it points
+//     to);
+//   * (C++11 only) any other function object, giving the result of calling
+//     it with the element.
+// In the first case, the member is written in place - no copy is made.
+template <typename M, typename C, typename T>
+M const& project(M C::* pm, T const& x)
+{
+  return x.*pm;
+}
+
+template <typename M, typename C, typename T>
+M const& project(M C::* pm, T* const& p)
+{
+  return (*p).*pm;
+}
+
+template <typename R, typename C, typename T>
+R project(R (C::*pmf)() const, T const& x)
+{
+  return (x.*pmf)();
+}
+
+template <typename R, typename C, typename T>
+R project(R (C::*pmf)() const, T* const& p)
+{
+  return ((*p).*pmf)();
+}
+
+#ifndef BOOST_NO_CXX11_DECLTYPE
+template <typename Projection, typename T>
+auto project(Projection& proj, T&& x) -> decltype(proj(::std::forward<T>(x)))
+{
+  return proj(::std::forward<T>(x));
+}
+
+// Tests whether Projection can be applied (with project()) to the elements
+// of a range with iterator type InputIterator.
+template <typename Projection, typename InputIterator, typename = void>
+struct is_projection :
+  ::boost::false_type
+{};
+
+template <typename Projection, typename InputIterator>
+struct is_projection<Projection, InputIterator,
+  decltype(void(detail::project(::std::declval<Projection&>(), *::std::declval<InputIterator&>())))> :
+  ::boost::true_type
+{};
+#endif // BOOST_NO_CXX11_DECLTYPE
+
+// The type of the value an element of a range with iterator type
+// InputIterator is projected to by Projection, without references or
+// cv-qualifiers (void if it cannot be determined - for function objects in
+// C++98, where only the member pointer projections are recognized).
+// 
+// This is only used to decide how the projected values can be written (see
+// use_batched_write), so it does not need to be exact for function objects
+// that are not applicable.
+template <typename Projection, typename InputIterator, typename = void>
+struct projected_value
+{
+  typedef void type;
+};
+
+#ifndef BOOST_NO_CXX11_DECLTYPE
+template <typename Projection, typename InputIterator>
+struct projected_value<Projection, InputIterator,
+  decltype(void(detail::project(::std::declval<Projection&>(), *::std::declval<InputIterator&>())))>
+{
+  typedef typename ::std::decay<decltype(detail::project(::std::declval<Projection&>(), *::std::declval<InputIterator&>()))>::type type;
+};
+#else
+template <typename M, typename C, typename InputIterator>
+struct projected_value<M C::*, InputIterator>
+{
+  typedef typename ::boost::remove_cv<M>::type type;
+};
+
+template <typename R, typename C, typename InputIterator>
+struct projected_value<R (C::*)() const, InputIterator>
+{
+  typedef typename ::boost::remove_cv<typename ::boost::remove_reference<R>::type>::type type;
+};
+#endif // BOOST_NO_CXX11_DECLTYPE
+
+template <typename InputIterator>
+struct projected_value<identity_projection, InputIterator>
+{
+  typedef typename ::std::iterator_traits<InputIterator>::value_type type;
+};
+
+// Writes the element i refers to, projected with proj, and returns
+// bool(out).
+template <
+  typename InputIterator,
+  typename CharT,
+  typename Traits>
+bool
+write_element(
+  ::std::basic_ostream<CharT, Traits>& out,
+  InputIterator& i,
+  identity_projection&)
+{
+  return bool(out << *i);
+}
+
+template <
+  typename InputIterator,
+  typename CharT,
+  typename Traits,
+  typename Projection>
+bool
+write_element(
+  ::std::basic_ostream<CharT, Traits>& out,
+  InputIterator& i,
+  Projection& proj)
+{
+  return bool(out << detail::project(proj, *i));
+}
+
+} // namespace detail
+} // namespace rangeio
+} // namespace boost
+
+#endif  // include guard
@@ -0,0 +1,292 @@
+//
+// Copyright (c) Mark A. Gibbs, 2015.
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+// 
+
+// Requires at least C++11.
+
+#ifndef BOOST_RANGEIO_Inc_detail_X_scratch_arena_2015_01_01_
+#define BOOST_RANGEIO_Inc_detail_X_scratch_arena_2015_01_01_
+
+#include <boost/config.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+
+#include <boost/rangeio/detail/scratch_block.hpp>
+
+namespace boost {
+namespace rangeio {
+namespace detail {
+
+// The largest scratch block (in bytes) that is kept for reuse when it is
+// given back to its arena. Larger blocks are freed, so that a single huge
+// write does not pin its memory for the life of the thread.
+inline ::std::atomic< ::std::size_t>& scratch_retain_limit()
+{
+  static ::std::atomic< ::std::size_t> limit(::std::size_t(1) << 20);
+  return limit;
+}
+
+class scratch_arena;
+
+// The set of all live scratch arenas (as an intrusive list), so that the
+// memory of idle threads can be released from another thread.
+struct scratch_arena_registry
+{
+  static scratch_arena_registry& instance()
+  {
+    static scratch_arena_registry registry;
+    return registry;
+  }
+  
+  ::std::mutex    mutex;
+  scratch_arena*  first = nullptr;
+};
+
+// 
+// A thread's reusable scratch memory.
+// 
+// Each thread has one arena, holding a stack of scratch blocks. A block is
+// acquired for the duration of a formatting operation, then given back (in
+// reverse order of acquisition, so nested operations - such as an element
+// inserter that itself formats a range - each get their own block). Blocks
+// keep their capacity when given back, so once a thread has warmed up,
+// formatting never allocates.
+// 
+// Operations nested more than max_depth deep do not get a block from the
+// arena (see scratch_lease).
+// 
+// Memory can be released by the owning thread at any time (for the blocks
+// not in use), or by any thread for arenas that are not in use and have not
+// been used since the previous sweep (see release_idle()).
+// 
+// The owning thread only touches an atomic state flag and a use counter when
+// acquiring and giving back its outermost block - the registry mutex is only
+// taken when the arena is created or destroyed, and by sweeps.
+// 
+class scratch_arena
+{
+public:
+  static ::std::size_t const max_depth = 8;
+  
+  scratch_arena() :
+    depth_(0),
+    state_(idle),
+    uses_(0),
+    swept_uses_(0),
+    previous_(nullptr)
+  {
+    scratch_arena_registry& registry = scratch_arena_registry::instance();
+    
+    ::std::lock_guard< ::std::mutex> const lock(registry.mutex);
+    
+    next_ = registry.first;
+    if (next_)
+      next_->previous_ = this;
+    
+    registry.first = this;
+  }
+  
+  ~scratch_arena()
+  {
+    scratch_arena_registry& registry = scratch_arena_registry::instance();
+    
+    ::std::lock_guard< ::std::mutex> const lock(registry.mutex);
+    
+    if (previous_)
+      previous_->next_ = next_;
+    else
+      registry.first = next_;
+    
+    if (next_)
+      next_->previous_ = previous_;
+  }
+  
+  scratch_arena(scratch_arena const&) = delete;
+  scratch_arena& operator=(scratch_arena const&) = delete;
+  
+  static scratch_arena& this_thread()
+  {
+    static thread_local scratch_arena arena;
+    return arena;
+  }
+  
+  // Acquires the next free block, or returns null if max_depth blocks are
+  // already in use. Every call must be matched by a call to give_back().
+  scratch_block* acquire()
+  {
+    if (depth_ == 0)
+      enter_();
+    
+    ::std::size_t const n = depth_++;
+    return (n < max_depth) ? &blocks_[n] : nullptr;
+  }
+  
+  // Gives back the most recently acquired block.
+  void give_back() BOOST_NOEXCEPT
+  {
+    ::std::size_t const n = --depth_;
+    if ((n < max_depth) && (blocks_[n].capacity() > scratch_retain_limit().load(::std::memory_order_relaxed)))
+      blocks_[n].release();
+    
+    if (depth_ == 0)
+    {
+      uses_.store(uses_.load(::std::memory_order_relaxed) + 1, ::std::memory_order_relaxed);
+      state_.store(idle, ::std::memory_order_release);
+    }
+  }
+  
+  // The number of bytes held by the arena. Must only be called by the owning
+  // thread.
+  ::std::size_t capacity()
+  {
+    bool const outermost = (depth_ == 0);
+    if (outermost)
+      enter_();
+    
+    ::std::size_t n = 0;
+    for (::std::size_t i = 0; i != max_depth; ++i)
+      n += blocks_[i].capacity();
+    
+    if (outermost)
+      state_.store(idle, ::std::memory_order_release);
+    
+    return n;
+  }
+  
+  // Frees the blocks that are not in use, and returns the number of bytes
+  // freed. Must only be called by the owning thread.
+  // 
+  // Like acquire(), this marks the arena busy while it works (unless it is
+  // already in use), so it never frees blocks at the same time as a sweep.
+  ::std::size_t release()
+  {
+    bool const outermost = (depth_ == 0);
+    if (outermost)
+      enter_();
+    
+    ::std::size_t const n = release_blocks_();
+    
+    if (outermost)
+      state_.store(idle, ::std::memory_order_release);
+    
+    return n;
+  }
+  
+  // Frees the memory of every arena that is not in use, and has not been
+  // used since the previous call. Returns the number of bytes freed.
+  // 
+  // May be called from any thread.
+  static ::std::size_t release_idle()
+  {
+    scratch_arena_registry& registry = scratch_arena_registry::instance();
+    
+    ::std::lock_guard< ::std::mutex> const lock(registry.mutex);
+    
+    ::std::size_t n = 0;
+    for (scratch_arena* arena = registry.first; arena; arena = arena->next_)
+      n += arena->release_if_idle_();
+    
+    return n;
+  }
+  
+private:
+  enum { idle, busy, sweeping };
+  
+  // Marks the arena busy. If a sweep is releasing the arena's memory, spins
+  // until it is done (which only takes as long as freeing the blocks).
+  void enter_()
+  {
+    int expected = idle;
+    while (!state_.compare_exchange_weak(expected, busy, ::std::memory_order_acquire, ::std::memory_order_relaxed))
+      expected = idle;
+  }
+  
+  ::std::size_t release_blocks_()
+  {
+    ::std::size_t n = 0;
+    for (::std::size_t i = depth_; i < max_depth; ++i)
+    {
+      n += blocks_[i].capacity();
+      blocks_[i].release();
+    }
+    
+    return n;
+  }
+  
+  // Must be called with the registry mutex held.
+  ::std::size_t release_if_idle_()
+  {
+    ::std::size_t const uses = uses_.load(::std::memory_order_relaxed);
+    if (uses != swept_uses_)
+    {
+      swept_uses_ = uses;
+      return 0;
+    }
+    
+    int expected = idle;
+    if (!state_.compare_exchange_strong(expected, sweeping, ::std::memory_order_acquire, ::std::memory_order_relaxed))
+      return 0;
+    
+    ::std::size_t const n = release_blocks_();
+    
+    state_.store(idle, ::std::memory_order_release);
+    
+    return n;
+  }
+  
+  // Only accessed by the owning thread, or by a sweep that has set the state
+  // to sweeping.
+  scratch_block                  blocks_[max_depth];
+  ::std::size_t                  depth_;
+  
+  ::std::atomic<int>             state_;
+  
+  // Incremented (only by the owning thread) each time the outermost block is
+  // given back.
+  ::std::atomic< ::std::size_t>  uses_;
+  
+  // The value of uses_ at the previous sweep, and the links in the registry's
+  // list (only accessed with the registry mutex held).
+  ::std::size_t                  swept_uses_;
+  scratch_arena*                 previous_;
+  scratch_arena*                 next_;
+};
+
+// Holds a block from the calling thread's scratch arena for its lifetime.
+// 
+// If the arena has no free block (because the lease is nested too deeply),
+// the lease uses a block of its own instead.
+class scratch_lease
+{
+public:
+  scratch_lease() :
+    arena_(scratch_arena::this_thread()),
+    block_(arena_.acquire())
+  {
+    if (!block_)
+      block_ = &own_;
+  }
+  
+  ~scratch_lease() { arena_.give_back(); }
+  
+  scratch_lease(scratch_lease const&) = delete;
+  scratch_lease& operator=(scratch_lease const&) = delete;
+  
+  scratch_block& block() { return *block_; }
+  
+private:
+  scratch_arena&  arena_;
+  scratch_block*  block_;
+  scratch_block   own_;
+};
+
+} // namespace detail
+} // namespace rangeio
+} // namespace boost
+
+#endif  // include guard
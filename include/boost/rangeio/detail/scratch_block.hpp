@@ -0,0 +1,86 @@
+//
+// Copyright (c) Mark A. Gibbs, 2015.
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+// 
+
+// This file is written to be C++98-safe.
+
+#ifndef BOOST_RANGEIO_Inc_detail_X_scratch_block_2015_01_01_
+#define BOOST_RANGEIO_Inc_detail_X_scratch_block_2015_01_01_
+
+#include <boost/config.hpp>
+
+#include <cstddef>
+#include <cstring>
+#include <new>
+
+namespace boost {
+namespace rangeio {
+namespace detail {
+
+// 
+// A growable block of raw scratch memory, used as the storage for formatting
+// buffers.
+// 
+// The memory is aligned for any fundamental type, so it can hold any
+// character type. Only trivially-copyable contents may be stored, because
+// growing the block copies the bytes.
+// 
+class scratch_block
+{
+public:
+  scratch_block() :
+    data_(0),
+    capacity_(0)
+  {}
+  
+  ~scratch_block() { release(); }
+  
+  void* data() const { return data_; }
+  
+  // The capacity in bytes.
+  ::std::size_t capacity() const { return capacity_; }
+  
+  // Grows the block to at least n bytes, keeping the first keep bytes of the
+  // contents.
+  void grow(::std::size_t n, ::std::size_t keep)
+  {
+    if (n <= capacity_)
+      return;
+    
+    void* const p = ::operator new(n);
+    
+    if (keep != 0)
+      ::std::memcpy(p, data_, (keep < capacity_) ? keep : capacity_);
+    
+    ::operator delete(data_);
+    
+    data_ = p;
+    capacity_ = n;
+  }
+  
+  // Frees the memory.
+  void release()
+  {
+    ::operator delete(data_);
+    
+    data_ = 0;
+    capacity_ = 0;
+  }
+  
+private:
+  // Not copyable.
+  scratch_block(scratch_block const&);
+  scratch_block& operator=(scratch_block const&);
+  
+  void*          data_;
+  ::std::size_t  capacity_;
+};
+
+} // namespace detail
+} // namespace rangeio
+} // namespace boost
+
+#endif  // include guard
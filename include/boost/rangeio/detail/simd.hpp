@@ -0,0 +1,44 @@
+//
+// Copyright (c) Mark A. Gibbs, 2015.
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+// 
+
+// Detects the SIMD instruction sets the formatting engines can use, and
+// defines:
+//   BOOST_RANGEIO_HAS_SSSE3:  if SSSE3 is enabled for the target.
+//   BOOST_RANGEIO_HAS_AVX2:   if AVX2 is enabled for the target.
+// 
+// The instruction sets are detected at compile time, from the compiler's own
+// target macros (so, for example, building with -mssse3 or -march=native
+// enables them); there is no run-time dispatch. Code without them uses
+// scalar fallbacks that produce exactly the same output. Defining
+// BOOST_RANGEIO_NO_SIMD before including any RangeIO header disables all of
+// them.
+// 
+// This file is written to be C++98-safe.
+
+#ifndef BOOST_RANGEIO_Inc_detail_X_simd_2015_01_01_
+#define BOOST_RANGEIO_Inc_detail_X_simd_2015_01_01_
+
+#include <boost/config.hpp>
+
+#if !defined(BOOST_RANGEIO_NO_SIMD)
+#   if defined(__SSSE3__)
+#       define BOOST_RANGEIO_HAS_SSSE3
+#   endif
+#   if defined(__AVX2__)
+#       define BOOST_RANGEIO_HAS_AVX2
+#   endif
+#endif
+
+#ifdef BOOST_RANGEIO_HAS_SSSE3
+#   include <tmmintrin.h>
+#endif
+
+#ifdef BOOST_RANGEIO_HAS_AVX2
+#   include <immintrin.h>
+#endif
+
+#endif  // include guard
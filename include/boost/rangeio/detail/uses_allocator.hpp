@@ -0,0 +1,67 @@
+//
+// Copyright (c) Mark A. Gibbs, 2015.
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+// 
+
+// Requires at least C++11.
+
+#ifndef BOOST_RANGEIO_Inc_detail_X_uses_allocator_2015_01_01_
+#define BOOST_RANGEIO_Inc_detail_X_uses_allocator_2015_01_01_
+
+#include <boost/config.hpp>
+
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+#include <boost/type_traits/integral_constant.hpp>
+
+namespace boost {
+namespace rangeio {
+namespace detail {
+
+// How a T is constructed with an allocator (uses-allocator construction):
+//   0: T does not use the allocator, so it is constructed without it.
+//   1: T(allocator_arg, a, args...)
+//   2: T(args..., a)
+template <typename T, typename Allocator, typename... Args>
+struct uses_allocator_construction :
+  ::boost::integral_constant<int,
+    !::std::uses_allocator<T, Allocator>::value ? 0 :
+    ::std::is_constructible<T, ::std::allocator_arg_t, Allocator const&, Args...>::value ? 1 :
+    2>
+{};
+
+template <typename T, typename Allocator, typename... Args>
+T make_using_allocator_(::boost::integral_constant<int, 0>, Allocator const&, Args&&... args)
+{
+  return T(::std::forward<Args>(args)...);
+}
+
+template <typename T, typename Allocator, typename... Args>
+T make_using_allocator_(::boost::integral_constant<int, 1>, Allocator const& a, Args&&... args)
+{
+  return T(::std::allocator_arg, a, ::std::forward<Args>(args)...);
+}
+
+template <typename T, typename Allocator, typename... Args>
+T make_using_allocator_(::boost::integral_constant<int, 2>, Allocator const& a, Args&&... args)
+{
+  return T(::std::forward<Args>(args)..., a);
+}
+
+// Creates a T from args, using the allocator a if T is allocator-aware (like
+// std::make_obj_using_allocator() in C++20).
+template <typename T, typename Allocator, typename... Args>
+T make_using_allocator(Allocator const& a, Args&&... args)
+{
+  return detail::make_using_allocator_<T>(uses_allocator_construction<T, Allocator, Args...>(), a, ::std::forward<Args>(args)...);
+}
+
+} // namespace detail
+} // namespace rangeio
+} // namespace boost
+
+#endif  // include guard
@@ -16,13 +16,1478 @@
 #include <boost/config.hpp>
 
 #include <cstddef>
+#include <iosfwd>
+#include <iterator>
+#include <string>
 
+#include <boost/rangeio/detail/batched_write.hpp>
+#include <boost/rangeio/detail/erased_write.hpp>
 #include <boost/rangeio/detail/formatting_saver.hpp>
+#include <boost/rangeio/detail/projection.hpp>
+#include <boost/rangeio/detail/write_probe.hpp>
+#include <boost/rangeio/prefer_inline_write.hpp>
+#include <boost/rangeio/segmented_iterator_traits.hpp>
+#include <boost/rangeio/sentinels.hpp>
+
+#include <boost/type_traits/integral_constant.hpp>
+#include <boost/type_traits/is_same.hpp>
+#include <boost/type_traits/remove_const.hpp>
 
 namespace boost {
 namespace rangeio {
 namespace detail {
 
+// Instrumentation policy that does nothing.
+// 
+// An instrumentation policy is notified of the progress of a write:
+//   start(out):         before anything else is done.
+//   element():          after each element is successfully written.
+//   delimiter():        after each delimiter is successfully written.
+//   finish(out, stop):  after everything else is done (including resetting the
+//                       stream width), where stop is true if the write
+//                       stopped before reaching the end of the range.
+// 
+// All of the functions in this policy are empty and inline, so when it is
+// used the instrumentation compiles away completely.
+// 
+// (The USDT probes in write_probe.hpp are independent of the instrumentation
+// policy, and are fired by every write when they are enabled.)
+struct null_write_instrument
+{
+  template <typename CharT, typename Traits>
+  void start(::std::basic_ostream<CharT, Traits>&) {}
+  
+  void element() {}
+  void delimiter() {}
+  
+  template <typename CharT, typename Traits>
+  void finish(::std::basic_ostream<CharT, Traits>&, bool) {}
+};
+
+// Writes the first element of a range.
+// 
+// If "out << *i" (with the element projected by proj) succeeds, performs
+// "++n" and "++i", notifies instrument, and returns true. Otherwise, returns
+// false.
+template <
+  typename InputIterator,
+  typename CharT,
+  typename Traits,
+  typename Instrument,
+  typename Projection>
+bool
+write_first_element(
+  ::std::basic_ostream<CharT, Traits>& out,
+  InputIterator& i,
+  ::std::size_t& n,
+  Instrument& instrument,
+  Projection& proj)
+{
+  if (detail::write_element(out, i, proj))
+  {
+    // If the first write succeeds, increment:
+    ++n; // ... the write count (do first because it will never throw)
+    ++i; // ... the iterator
+    
+    instrument.element();
+    
+    return true;
+  }
+  
+  return false;
+}
+
+// Writes the remaining elements of a range without delimiters, after the
+// first element has been written.
+// 
+// While i is not equal to e and bool(out) is true, restores the formatting
+// state and performs "out << *i" (with the element projected by proj). If
+// bool(out) is still true, performs "++i" and "++n".
+template <
+  typename InputIterator,
+  typename Sentinel,
+  typename CharT,
+  typename Traits,
+  typename Instrument,
+  typename Projection>
+void
+write_remaining_elements(
+  ::std::basic_ostream<CharT, Traits>& out,
+  InputIterator& i,
+  Sentinel const& e,
+  ::std::size_t& n,
+  detail::formatting_saver<CharT, Traits> const& formatting,
+  Instrument& instrument,
+  Projection& proj)
+{
+  while ((i != e) && bool(out))
+  {
+    // If there are still more elements to write (and the output stream is
+    // still good), restore the formatting state to what it was before the
+    // first write.
+    formatting.restore();
+    
+    if (detail::write_element(out, i, proj))
+    {
+      // If the next write succeeds, increment:
+      ++n; // ... the write count (do first because it will never throw)
+      ++i; // ... the iterator
+      
+      instrument.element();
+    }
+  }
+}
+
+// Writes the remaining elements of a range with delimiters, after the first
+// element has been written.
+// 
+// While i is not equal to e and bool(out) is true, performs "out << delim".
+// If bool(out) is still true, restores the formatting state and performs
+// "out << *i" (with the element projected by proj). If bool(out) is still
+// true, performs "++i" and "++n".
+template <
+  typename InputIterator,
+  typename Sentinel,
+  typename Delimiter,
+  typename CharT,
+  typename Traits,
+  typename Instrument,
+  typename Projection>
+void
+write_remaining_elements(
+  ::std::basic_ostream<CharT, Traits>& out,
+  InputIterator& i,
+  Sentinel const& e,
+  Delimiter& delim,
+  ::std::size_t& n,
+  detail::formatting_saver<CharT, Traits> const& formatting,
+  Instrument& instrument,
+  Projection& proj)
+{
+  while ((i != e) && bool(out) && (out << delim))
+  {
+    instrument.delimiter();
+    
+    // If there are still more elements to write (and the output stream is
+    // still good), restore the formatting state to what it was before the
+    // first write.
+    formatting.restore();
+    
+    if (detail::write_element(out, i, proj))
+    {
+      // If the next write succeeds, increment:
+      ++n; // ... the write count (do first because it will never throw)
+      ++i; // ... the iterator
+      
+      instrument.element();
+    }
+  }
+}
+
+// Tests whether a range described by an iterator and a sentinel can be
+// written segment-by-segment (which requires that the sentinel is an iterator
+// of the same type, and that that type is a segmented iterator).
+template <typename InputIterator, typename Sentinel>
+struct is_segmented_range :
+  ::boost::false_type
+{};
+
+template <typename InputIterator>
+struct is_segmented_range<InputIterator, InputIterator> :
+  segmented_iterator_traits<InputIterator>::is_segmented_iterator
+{};
+
+// Tests whether the segments of a segmented range with local iterators of
+// type LocalIterator can be written with the batched write loop (see
+// batched_write_elements()): the local ranges must be ranges the loop
+// supports (with the projection applied), and the elements must be written
+// without instrumentation.
+template <
+  typename LocalIterator,
+  typename Delimiter,
+  typename CharT,
+  typename Traits,
+  typename Instrument,
+  typename Projection>
+struct use_batched_segment_write :
+  ::boost::integral_constant<bool,
+    ::boost::is_same<Instrument, null_write_instrument>::value &&
+    use_batched_write<LocalIterator, LocalIterator, Delimiter, CharT, Traits, Projection>::value>
+{};
+
+// Tests whether the batched write loop can actually be used for the segments
+// of a segmented range with out's current state (see batched_write_usable()).
+// 
+// There are two versions - one with a delimiter, and one without.
+template <typename CharT, typename Traits>
+bool
+batched_segment_write_usable(::std::basic_ostream<CharT, Traits>&, ::boost::false_type)
+{
+  return false;
+}
+
+template <typename CharT, typename Traits>
+bool
+batched_segment_write_usable(::std::basic_ostream<CharT, Traits>& out, ::boost::true_type)
+{
+  return detail::batched_write_usable(out);
+}
+
+template <typename Delimiter, typename CharT, typename Traits>
+bool
+batched_segment_write_usable(::std::basic_ostream<CharT, Traits>&, Delimiter&, ::boost::false_type)
+{
+  return false;
+}
+
+template <typename Delimiter, typename CharT, typename Traits>
+bool
+batched_segment_write_usable(::std::basic_ostream<CharT, Traits>& out, Delimiter& delim, ::boost::true_type)
+{
+  typedef batch_delimiter<typename ::boost::remove_const<Delimiter>::type, CharT, Traits> delimiter_traits;
+  
+  return detail::batched_write_usable(out) && delimiter_traits::usable(delim);
+}
+
+// Writes the elements of one segment of a segmented range, [li, le), without
+// delimiters.
+// 
+// started is true if an element of the range has already been written, and
+// is set to true once one has been. If batched is true, the segment is
+// written with the batched write loop (see batched_write_elements());
+// otherwise, the elements are written one at a time.
+// 
+// There are two versions: one for segments that can never be written with
+// the batched write loop (see use_batched_segment_write), and one for
+// segments that can.
+template <
+  typename LocalIterator,
+  typename CharT,
+  typename Traits,
+  typename Instrument,
+  typename Projection>
+void
+write_segment(
+  ::std::basic_ostream<CharT, Traits>& out,
+  LocalIterator& li,
+  LocalIterator const& le,
+  ::std::size_t& n,
+  bool& started,
+  bool,
+  detail::formatting_saver<CharT, Traits> const& formatting,
+  Instrument& instrument,
+  Projection& proj,
+  ::boost::false_type)
+{
+  if (!started && (li != le))
+  {
+    if (!detail::write_first_element(out, li, n, instrument, proj))
+      return;
+    
+    started = true;
+  }
+  
+  detail::write_remaining_elements(out, li, le, n, formatting, instrument, proj);
+}
+
+template <
+  typename LocalIterator,
+  typename CharT,
+  typename Traits,
+  typename Instrument,
+  typename Projection>
+void
+write_segment(
+  ::std::basic_ostream<CharT, Traits>& out,
+  LocalIterator& li,
+  LocalIterator const& le,
+  ::std::size_t& n,
+  bool& started,
+  bool batched,
+  detail::formatting_saver<CharT, Traits> const& formatting,
+  Instrument& instrument,
+  Projection& proj,
+  ::boost::true_type)
+{
+  if (!batched)
+  {
+    detail::write_segment(out, li, le, n, started, batched, formatting, instrument, proj, ::boost::false_type());
+    return;
+  }
+  
+  if (li == le)
+    return;
+  
+  // The batched write loop never changes the stream's formatting state, so
+  // it does not need to be restored between segments.
+  ::std::size_t const start_count = n;
+  ::std::ios_base::iostate const state = detail::batched_write_elements(out, li, le, n, proj);
+  
+  if (n != start_count)
+    started = true;
+  
+  // This may throw, if out has exceptions enabled.
+  if (state != ::std::ios_base::goodbit)
+    out.setstate(state);
+}
+
+// Writes the elements of one segment of a segmented range, [li, le), with
+// delimiters.
+// 
+// This is exactly the same as write_segment() without delimiters, except
+// that the delimiter is written between the elements - including before the
+// first element of the segment, if started is true.
+template <
+  typename LocalIterator,
+  typename Delimiter,
+  typename CharT,
+  typename Traits,
+  typename Instrument,
+  typename Projection>
+void
+write_segment(
+  ::std::basic_ostream<CharT, Traits>& out,
+  LocalIterator& li,
+  LocalIterator const& le,
+  Delimiter& delim,
+  ::std::size_t& n,
+  bool& started,
+  bool,
+  detail::formatting_saver<CharT, Traits> const& formatting,
+  Instrument& instrument,
+  Projection& proj,
+  ::boost::false_type)
+{
+  if (!started && (li != le))
+  {
+    if (!detail::write_first_element(out, li, n, instrument, proj))
+      return;
+    
+    started = true;
+  }
+  
+  detail::write_remaining_elements(out, li, le, delim, n, formatting, instrument, proj);
+}
+
+template <
+  typename LocalIterator,
+  typename Delimiter,
+  typename CharT,
+  typename Traits,
+  typename Instrument,
+  typename Projection>
+void
+write_segment(
+  ::std::basic_ostream<CharT, Traits>& out,
+  LocalIterator& li,
+  LocalIterator const& le,
+  Delimiter& delim,
+  ::std::size_t& n,
+  bool& started,
+  bool batched,
+  detail::formatting_saver<CharT, Traits> const& formatting,
+  Instrument& instrument,
+  Projection& proj,
+  ::boost::true_type)
+{
+  if (!batched)
+  {
+    detail::write_segment(out, li, le, delim, n, started, batched, formatting, instrument, proj, ::boost::false_type());
+    return;
+  }
+  
+  if (li == le)
+    return;
+  
+  ::std::size_t const start_count = n;
+  ::std::ios_base::iostate const state = detail::batched_write_elements(out, li, le, delim, n, started, proj);
+  
+  if (n != start_count)
+    started = true;
+  
+  // This may throw, if out has exceptions enabled.
+  if (state != ::std::ios_base::goodbit)
+    out.setstate(state);
+}
+
+// Writes all the elements of a non-empty range without delimiters.
+// 
+// There are two versions: one for general ranges, and one for segmented
+// ranges, which writes the range segment by segment using the local
+// iterators (with the batched write loop, where possible - see
+// write_segment()).
+template <
+  typename InputIterator,
+  typename Sentinel,
+  typename CharT,
+  typename Traits,
+  typename Instrument,
+  typename Projection>
+void
+write_elements(
+  ::std::basic_ostream<CharT, Traits>& out,
+  InputIterator& i,
+  Sentinel const& e,
+  ::std::size_t& n,
+  detail::formatting_saver<CharT, Traits> const& formatting,
+  Instrument& instrument,
+  Projection& proj,
+  ::boost::false_type)
+{
+  if (detail::write_first_element(out, i, n, instrument, proj))
+    detail::write_remaining_elements(out, i, e, n, formatting, instrument, proj);
+}
+
+template <
+  typename SegmentedIterator,
+  typename CharT,
+  typename Traits,
+  typename Instrument,
+  typename Projection>
+void
+write_elements(
+  ::std::basic_ostream<CharT, Traits>& out,
+  SegmentedIterator& i,
+  SegmentedIterator const& e,
+  ::std::size_t& n,
+  detail::formatting_saver<CharT, Traits> const& formatting,
+  Instrument& instrument,
+  Projection& proj,
+  ::boost::true_type)
+{
+  typedef segmented_iterator_traits<SegmentedIterator> traits;
+  
+  typename traits::segment_iterator s = traits::segment(i);
+  typename traits::segment_iterator const last_segment = traits::segment(e);
+  
+  typename traits::local_iterator li = traits::local(i);
+  
+  typedef typename use_batched_segment_write<typename traits::local_iterator, void,
+    CharT, Traits, Instrument, Projection>::type batched_tag;
+  
+  bool const batched = detail::batched_segment_write_usable(out, batched_tag());
+  
+  bool started = false;
+  bool done = false;
+  
+  while (!done)
+  {
+    bool const is_last_segment = (s == last_segment);
+    typename traits::local_iterator const le = is_last_segment ? traits::local(e) : traits::end(s);
+    
+    detail::write_segment(out, li, le, n, started, batched, formatting, instrument, proj, batched_tag());
+    
+    if ((li != le) || is_last_segment)
+      done = true;
+    else
+      li = traits::begin(++s);
+  }
+  
+  i = traits::compose(s, li);
+}
+
+// Writes all the elements of a non-empty range with delimiters.
+// 
+// There are two versions: one for general ranges, and one for segmented
+// ranges, which writes the range segment by segment using the local
+// iterators (with the batched write loop, where possible - see
+// write_segment()).
+template <
+  typename InputIterator,
+  typename Sentinel,
+  typename Delimiter,
+  typename CharT,
+  typename Traits,
+  typename Instrument,
+  typename Projection>
+void
+write_elements(
+  ::std::basic_ostream<CharT, Traits>& out,
+  InputIterator& i,
+  Sentinel const& e,
+  Delimiter& delim,
+  ::std::size_t& n,
+  detail::formatting_saver<CharT, Traits> const& formatting,
+  Instrument& instrument,
+  Projection& proj,
+  ::boost::false_type)
+{
+  if (detail::write_first_element(out, i, n, instrument, proj))
+    detail::write_remaining_elements(out, i, e, delim, n, formatting, instrument, proj);
+}
+
+template <
+  typename SegmentedIterator,
+  typename Delimiter,
+  typename CharT,
+  typename Traits,
+  typename Instrument,
+  typename Projection>
+void
+write_elements(
+  ::std::basic_ostream<CharT, Traits>& out,
+  SegmentedIterator& i,
+  SegmentedIterator const& e,
+  Delimiter& delim,
+  ::std::size_t& n,
+  detail::formatting_saver<CharT, Traits> const& formatting,
+  Instrument& instrument,
+  Projection& proj,
+  ::boost::true_type)
+{
+  typedef segmented_iterator_traits<SegmentedIterator> traits;
+  
+  typename traits::segment_iterator s = traits::segment(i);
+  typename traits::segment_iterator const last_segment = traits::segment(e);
+  
+  typename traits::local_iterator li = traits::local(i);
+  
+  typedef typename use_batched_segment_write<typename traits::local_iterator, Delimiter,
+    CharT, Traits, Instrument, Projection>::type batched_tag;
+  
+  bool const batched = detail::batched_segment_write_usable(out, delim, batched_tag());
+  
+  bool started = false;
+  bool done = false;
+  
+  while (!done)
+  {
+    bool const is_last_segment = (s == last_segment);
+    typename traits::local_iterator const le = is_last_segment ? traits::local(e) : traits::end(s);
+    
+    detail::write_segment(out, li, le, delim, n, started, batched, formatting, instrument, proj, batched_tag());
+    
+    if ((li != le) || is_last_segment)
+      done = true;
+    else
+      li = traits::begin(++s);
+  }
+  
+  i = traits::compose(s, li);
+}
+
+// Underlying implementation function for all versions of write without
+// delimiters, with instrumentation and projection.
+// 
+// This is exactly the same as write_impl() (without delimiters), except that
+// instrument is notified of the progress of the write (see
+// null_write_instrument for the interface), and each element is projected
+// with proj before it is written (see project()).
+template <
+  typename InputIterator,
+  typename Sentinel,
+  typename CharT,
+  typename Traits,
+  typename Instrument,
+  typename Projection>
+void
+projected_write_impl(
+  ::std::basic_ostream<CharT, Traits>& out,
+  InputIterator& i,
+  Sentinel const& e,
+  ::std::size_t& n,
+  Instrument& instrument,
+  Projection& proj)
+{
+  detail::write_probe<CharT, Traits> const probe(out, n);
+  instrument.start(out);
+  
+  // Only bother to attempt writing if the range is empty (i == e) or the
+  // output stream is good (bool(out) is true).
+  if (!(i == e) && bool(out))
+  {
+    // Save the formatting state prior to writing the first element.
+    detail::formatting_saver<CharT, Traits> formatting(out);
+    
+    detail::write_elements(out, i, e, n, formatting, instrument, proj,
+      typename is_segmented_range<InputIterator, Sentinel>::type());
+  }
+  
+  // Regardless of anything else, reset the stream's width to zero.
+  out.width(0);
+  
+  bool const stopped = !(i == e);
+  
+  instrument.finish(out, stopped);
+  probe.finish(out, n, stopped);
+}
+
+// Underlying implementation function for all versions of write with
+// delimiters, with instrumentation and projection.
+// 
+// This is exactly the same as write_impl() (with delimiters), except that
+// instrument is notified of the progress of the write (see
+// null_write_instrument for the interface), and each element is projected
+// with proj before it is written (see project()).
+template <
+  typename InputIterator,
+  typename Sentinel,
+  typename Delimiter,
+  typename CharT,
+  typename Traits,
+  typename Instrument,
+  typename Projection>
+void
+projected_write_impl(
+  ::std::basic_ostream<CharT, Traits>& out,
+  InputIterator& i,
+  Sentinel const& e,
+  Delimiter& delim,
+  ::std::size_t& n,
+  Instrument& instrument,
+  Projection& proj)
+{
+  detail::write_probe<CharT, Traits> const probe(out, n);
+  instrument.start(out);
+  
+  // Only bother to attempt writing if the range is empty (i == e) or the
+  // output stream is good (bool(out) is true).
+  if (!(i == e) && bool(out))
+  {
+    // Save the formatting state prior to writing the first element.
+    detail::formatting_saver<CharT, Traits> formatting(out);
+    
+    detail::write_elements(out, i, e, delim, n, formatting, instrument, proj,
+      typename is_segmented_range<InputIterator, Sentinel>::type());
+  }
+  
+  // Regardless of anything else, reset the stream's width to zero.
+  out.width(0);
+  
+  bool const stopped = !(i == e);
+  
+  instrument.finish(out, stopped);
+  probe.finish(out, n, stopped);
+}
+
+// Underlying implementation function for all versions of write of counted
+// ranges without delimiters, with instrumentation and projection.
+// 
+// This is exactly the same as projected_write_impl() (without delimiters),
+// except that the end of the range is not found by comparing i to a sentinel:
+// instead, at most count elements are written. The loop runs on a plain
+// integer counter, which the compiler can reason about (and unroll) far more
+// easily than an arbitrary iterator comparison.
+template <
+  typename InputIterator,
+  typename CharT,
+  typename Traits,
+  typename Instrument,
+  typename Projection>
+void
+projected_write_n_impl(
+  ::std::basic_ostream<CharT, Traits>& out,
+  InputIterator& i,
+  ::std::size_t count,
+  ::std::size_t& n,
+  Instrument& instrument,
+  Projection& proj)
+{
+  detail::write_probe<CharT, Traits> const probe(out, n);
+  instrument.start(out);
+  
+  // Only bother to attempt writing if the range is empty (count == 0) or the
+  // output stream is good (bool(out) is true).
+  if ((count != 0) && bool(out))
+  {
+    // Save the formatting state prior to writing the first element.
+    detail::formatting_saver<CharT, Traits> formatting(out);
+    
+    if (detail::write_element(out, i, proj))
+    {
+      // If the first write succeeds, increment:
+      ++n; // ... the write count (do first because it will never throw)
+      ++i; // ... the iterator
+      --count;
+      
+      instrument.element();
+      
+      while ((count != 0) && bool(out))
+      {
+        // If there are still more elements to write (and the output stream is
+        // still good), restore the formatting state to what it was before the
+        // first write.
+        formatting.restore();
+        
+        if (detail::write_element(out, i, proj))
+        {
+          // If the next write succeeds, increment:
+          ++n; // ... the write count (do first because it will never throw)
+          ++i; // ... the iterator
+          --count;
+          
+          instrument.element();
+        }
+      }
+    }
+  }
+  
+  // Regardless of anything else, reset the stream's width to zero.
+  out.width(0);
+  
+  bool const stopped = (count != 0);
+  
+  instrument.finish(out, stopped);
+  probe.finish(out, n, stopped);
+}
+
+// Underlying implementation function for all versions of write of counted
+// ranges with delimiters, with instrumentation and projection.
+// 
+// This is exactly the same as projected_write_impl() (with delimiters),
+// except that the end of the range is not found by comparing i to a sentinel:
+// instead, at most count elements are written.
+template <
+  typename InputIterator,
+  typename Delimiter,
+  typename CharT,
+  typename Traits,
+  typename Instrument,
+  typename Projection>
+void
+projected_write_n_impl(
+  ::std::basic_ostream<CharT, Traits>& out,
+  InputIterator& i,
+  ::std::size_t count,
+  Delimiter& delim,
+  ::std::size_t& n,
+  Instrument& instrument,
+  Projection& proj)
+{
+  detail::write_probe<CharT, Traits> const probe(out, n);
+  instrument.start(out);
+  
+  // Only bother to attempt writing if the range is empty (count == 0) or the
+  // output stream is good (bool(out) is true).
+  if ((count != 0) && bool(out))
+  {
+    // Save the formatting state prior to writing the first element.
+    detail::formatting_saver<CharT, Traits> formatting(out);
+    
+    if (detail::write_element(out, i, proj))
+    {
+      // If the first write succeeds, increment:
+      ++n; // ... the write count (do first because it will never throw)
+      ++i; // ... the iterator
+      --count;
+      
+      instrument.element();
+      
+      while ((count != 0) && bool(out) && (out << delim))
+      {
+        instrument.delimiter();
+        
+        // If there are still more elements to write (and the output stream is
+        // still good), restore the formatting state to what it was before the
+        // first write.
+        formatting.restore();
+        
+        if (detail::write_element(out, i, proj))
+        {
+          // If the next write succeeds, increment:
+          ++n; // ... the write count (do first because it will never throw)
+          ++i; // ... the iterator
+          --count;
+          
+          instrument.element();
+        }
+      }
+    }
+  }
+  
+  // Regardless of anything else, reset the stream's width to zero.
+  out.width(0);
+  
+  bool const stopped = (count != 0);
+  
+  instrument.finish(out, stopped);
+  probe.finish(out, n, stopped);
+}
+
+// Writes an element of a filtered write, if pred accepts it.
+// 
+// x is the element, which the caller gets by dereferencing the iterator once
+// (Reference is the iterator's reference type, so it is bound exactly as
+// "*i" is), and both tests and writes. Returns false if the write failed.
+// 
+// There are two versions - one with a delimiter (written before every
+// element but the first, as first says), and one without.
+template <
+  typename Reference,
+  typename CharT,
+  typename Traits,
+  typename Predicate>
+bool
+filtered_write_element(
+  ::std::basic_ostream<CharT, Traits>& out,
+  Reference x,
+  ::std::size_t& n,
+  detail::formatting_saver<CharT, Traits> const& formatting,
+  Predicate& pred)
+{
+  if (!detail::project(pred, x))
+    return true;
+  
+  formatting.restore();
+  
+  if (!(out << x))
+    return false;
+  
+  ++n;
+  return true;
+}
+
+template <
+  typename Reference,
+  typename Delimiter,
+  typename CharT,
+  typename Traits,
+  typename Predicate>
+bool
+filtered_write_element(
+  ::std::basic_ostream<CharT, Traits>& out,
+  Reference x,
+  Delimiter& delim,
+  ::std::size_t& n,
+  bool& first,
+  detail::formatting_saver<CharT, Traits> const& formatting,
+  Predicate& pred)
+{
+  if (!detail::project(pred, x))
+    return true;
+  
+  if (!first)
+  {
+    if (!(out << delim))
+      return false;
+    
+    formatting.restore();
+  }
+  
+  if (!(out << x))
+    return false;
+  
+  ++n;
+  first = false;
+  return true;
+}
+
+// Underlying implementation function for all versions of filtered write
+// without delimiters.
+// 
+// While i is not equal to e and bool(out) is true: if pred (applied to the
+// element with project(), so it may be a pointer to a member) is true,
+// restores the formatting state and writes the element, and if bool(out) is
+// still true, performs "++n". Unless the write failed, performs "++i" and
+// "++visited". Each element is dereferenced only once, for both the test and
+// the write (see filtered_write_element()).
+// 
+// On return, i refers to the first element not visited - the element whose
+// write failed, if one did - and the stream's width is reset to zero, as
+// with write_impl().
+template <
+  typename InputIterator,
+  typename Sentinel,
+  typename CharT,
+  typename Traits,
+  typename Predicate>
+void
+filtered_write_impl(
+  ::std::basic_ostream<CharT, Traits>& out,
+  InputIterator& i,
+  Sentinel const& e,
+  ::std::size_t& n,
+  ::std::size_t& visited,
+  Predicate& pred)
+{
+  detail::write_probe<CharT, Traits> const probe(out, n);
+  
+  if (!(i == e) && bool(out))
+  {
+    // Save the formatting state prior to writing the first element.
+    detail::formatting_saver<CharT, Traits> formatting(out);
+    
+    typedef typename ::std::iterator_traits<InputIterator>::reference reference;
+    
+    for (; !(i == e) && bool(out); ++i, ++visited)
+    {
+      if (!detail::filtered_write_element<reference>(out, *i, n, formatting, pred))
+        break;
+    }
+  }
+  
+  // Regardless of anything else, reset the stream's width to zero.
+  out.width(0);
+  
+  probe.finish(out, n, !(i == e));
+}
+
+// Underlying implementation function for all versions of filtered write with
+// delimiters.
+// 
+// This is exactly the same as filtered_write_impl() without delimiters,
+// except that "out << delim" is performed before each element written after
+// the first (so delimiters only ever go between elements that are actually
+// written), and a failure writing the delimiter also stops the write.
+template <
+  typename InputIterator,
+  typename Sentinel,
+  typename Delimiter,
+  typename CharT,
+  typename Traits,
+  typename Predicate>
+void
+filtered_write_impl(
+  ::std::basic_ostream<CharT, Traits>& out,
+  InputIterator& i,
+  Sentinel const& e,
+  Delimiter& delim,
+  ::std::size_t& n,
+  ::std::size_t& visited,
+  Predicate& pred)
+{
+  detail::write_probe<CharT, Traits> const probe(out, n);
+  
+  if (!(i == e) && bool(out))
+  {
+    // Save the formatting state prior to writing the first element.
+    detail::formatting_saver<CharT, Traits> formatting(out);
+    
+    typedef typename ::std::iterator_traits<InputIterator>::reference reference;
+    
+    bool first = true;
+    
+    for (; !(i == e) && bool(out); ++i, ++visited)
+    {
+      if (!detail::filtered_write_element<reference>(out, *i, delim, n, first, formatting, pred))
+        break;
+    }
+  }
+  
+  // Regardless of anything else, reset the stream's width to zero.
+  out.width(0);
+  
+  probe.finish(out, n, !(i == e));
+}
+
+// Finds the length of a null-terminated sequence.
+// 
+// For the standard character types, this uses std::char_traits<>::length(),
+// which is normally a (vectorized) strlen() or wcslen().
+template <typename T>
+::std::size_t
+null_terminated_length(T const* p)
+{
+  T const* q = p;
+  while (!(*q == T()))
+    ++q;
+  
+  return ::std::size_t(q - p);
+}
+
+inline ::std::size_t
+null_terminated_length(char const* p)
+{
+  return ::std::char_traits<char>::length(p);
+}
+
+inline ::std::size_t
+null_terminated_length(wchar_t const* p)
+{
+  return ::std::char_traits<wchar_t>::length(p);
+}
+
+// Overloads of projected_write_impl() for null-terminated pointer ranges.
+// 
+// These find the end of the range first, and then write it as a counted
+// range.
+template <
+  typename T,
+  typename CharT,
+  typename Traits,
+  typename Instrument,
+  typename Projection>
+void
+projected_write_impl(
+  ::std::basic_ostream<CharT, Traits>& out,
+  T*& i,
+  null_terminated_t const&,
+  ::std::size_t& n,
+  Instrument& instrument,
+  Projection& proj)
+{
+  detail::projected_write_n_impl(out, i, detail::null_terminated_length(i), n, instrument, proj);
+}
+
+template <
+  typename T,
+  typename Delimiter,
+  typename CharT,
+  typename Traits,
+  typename Instrument,
+  typename Projection>
+void
+projected_write_impl(
+  ::std::basic_ostream<CharT, Traits>& out,
+  T*& i,
+  null_terminated_t const&,
+  Delimiter& delim,
+  ::std::size_t& n,
+  Instrument& instrument,
+  Projection& proj)
+{
+  detail::projected_write_n_impl(out, i, detail::null_terminated_length(i), delim, n, instrument, proj);
+}
+
+// Underlying implementation functions for all versions of write, with
+// instrumentation (but no projection).
+// 
+// These are exactly the same as the projected_write_impl() and
+// projected_write_n_impl() functions, with the identity projection (which
+// writes each element with "out << *i").
+template <
+  typename InputIterator,
+  typename Sentinel,
+  typename CharT,
+  typename Traits,
+  typename Instrument>
+void
+instrumented_write_impl(
+  ::std::basic_ostream<CharT, Traits>& out,
+  InputIterator& i,
+  Sentinel const& e,
+  ::std::size_t& n,
+  Instrument& instrument)
+{
+  identity_projection proj;
+  detail::projected_write_impl(out, i, e, n, instrument, proj);
+}
+
+template <
+  typename InputIterator,
+  typename Sentinel,
+  typename Delimiter,
+  typename CharT,
+  typename Traits,
+  typename Instrument>
+void
+instrumented_write_impl(
+  ::std::basic_ostream<CharT, Traits>& out,
+  InputIterator& i,
+  Sentinel const& e,
+  Delimiter& delim,
+  ::std::size_t& n,
+  Instrument& instrument)
+{
+  identity_projection proj;
+  detail::projected_write_impl(out, i, e, delim, n, instrument, proj);
+}
+
+template <
+  typename InputIterator,
+  typename CharT,
+  typename Traits,
+  typename Instrument>
+void
+instrumented_write_n_impl(
+  ::std::basic_ostream<CharT, Traits>& out,
+  InputIterator& i,
+  ::std::size_t count,
+  ::std::size_t& n,
+  Instrument& instrument)
+{
+  identity_projection proj;
+  detail::projected_write_n_impl(out, i, count, n, instrument, proj);
+}
+
+template <
+  typename InputIterator,
+  typename Delimiter,
+  typename CharT,
+  typename Traits,
+  typename Instrument>
+void
+instrumented_write_n_impl(
+  ::std::basic_ostream<CharT, Traits>& out,
+  InputIterator& i,
+  ::std::size_t count,
+  Delimiter& delim,
+  ::std::size_t& n,
+  Instrument& instrument)
+{
+  identity_projection proj;
+  detail::projected_write_n_impl(out, i, count, delim, n, instrument, proj);
+}
+
+// Tests whether a write should use the type-erased write loop (see
+// erased_write.hpp).
+// 
+// That is only the case when BOOST_RANGEIO_ERASED_WRITE is defined, and the
+// range is not one of the kinds with a specialized write algorithm (segmented
+// or null-terminated), and prefer_inline_write has not been specialized to
+// select the inlined loop.
+#ifdef BOOST_RANGEIO_ERASED_WRITE
+template <typename InputIterator, typename Sentinel, typename Delimiter>
+struct use_erased_write :
+  ::boost::integral_constant<bool,
+    !is_segmented_range<InputIterator, Sentinel>::value &&
+    !::boost::is_same<Sentinel, null_terminated_t>::value &&
+    !prefer_inline_write<InputIterator, Sentinel, Delimiter>::value>
+{};
+#else
+template <typename InputIterator, typename Sentinel, typename Delimiter>
+struct use_erased_write :
+  ::boost::false_type
+{};
+#endif // BOOST_RANGEIO_ERASED_WRITE
+
+// Selects between the inlined and type-erased write loops for write_impl().
+template <
+  typename InputIterator,
+  typename Sentinel,
+  typename CharT,
+  typename Traits>
+void
+select_write_impl(
+  ::std::basic_ostream<CharT, Traits>& out,
+  InputIterator& i,
+  Sentinel const& e,
+  ::std::size_t& n,
+  ::boost::false_type)
+{
+  null_write_instrument instrument;
+  detail::instrumented_write_impl(out, i, e, n, instrument);
+}
+
+template <
+  typename InputIterator,
+  typename Sentinel,
+  typename CharT,
+  typename Traits>
+void
+select_write_impl(
+  ::std::basic_ostream<CharT, Traits>& out,
+  InputIterator& i,
+  Sentinel const& e,
+  ::std::size_t& n,
+  ::boost::true_type)
+{
+  detail::erased_write_impl(out, i, e, n);
+}
+
+template <
+  typename InputIterator,
+  typename Sentinel,
+  typename Delimiter,
+  typename CharT,
+  typename Traits>
+void
+select_write_impl(
+  ::std::basic_ostream<CharT, Traits>& out,
+  InputIterator& i,
+  Sentinel const& e,
+  Delimiter& delim,
+  ::std::size_t& n,
+  ::boost::false_type)
+{
+  null_write_instrument instrument;
+  detail::instrumented_write_impl(out, i, e, delim, n, instrument);
+}
+
+template <
+  typename InputIterator,
+  typename Sentinel,
+  typename Delimiter,
+  typename CharT,
+  typename Traits>
+void
+select_write_impl(
+  ::std::basic_ostream<CharT, Traits>& out,
+  InputIterator& i,
+  Sentinel const& e,
+  Delimiter& delim,
+  ::std::size_t& n,
+  ::boost::true_type)
+{
+  detail::erased_write_impl(out, i, e, delim, n);
+}
+
+// Selects the batched write loop for write_impl() and write_n_impl(), if the
+// range is one it supports (see use_batched_write) and it produces exactly
+// the same output with the stream's current state (see
+// batched_write_usable()). Otherwise, selects between the inlined and
+// type-erased write loops.
+template <
+  typename InputIterator,
+  typename Sentinel,
+  typename CharT,
+  typename Traits>
+void
+select_batched_write_impl(
+  ::std::basic_ostream<CharT, Traits>& out,
+  InputIterator& i,
+  Sentinel const& e,
+  ::std::size_t& n,
+  ::boost::false_type)
+{
+  detail::select_write_impl(out, i, e, n,
+    typename use_erased_write<InputIterator, Sentinel, void>::type());
+}
+
+template <
+  typename InputIterator,
+  typename Sentinel,
+  typename CharT,
+  typename Traits>
+void
+select_batched_write_impl(
+  ::std::basic_ostream<CharT, Traits>& out,
+  InputIterator& i,
+  Sentinel const& e,
+  ::std::size_t& n,
+  ::boost::true_type)
+{
+  identity_projection proj;
+  
+  if (detail::batched_write_usable(out))
+    detail::batched_write_impl(out, i, e, n, proj);
+  else
+    detail::select_write_impl(out, i, e, n,
+      typename use_erased_write<InputIterator, Sentinel, void>::type());
+}
+
+template <
+  typename InputIterator,
+  typename Sentinel,
+  typename Delimiter,
+  typename CharT,
+  typename Traits>
+void
+select_batched_write_impl(
+  ::std::basic_ostream<CharT, Traits>& out,
+  InputIterator& i,
+  Sentinel const& e,
+  Delimiter& delim,
+  ::std::size_t& n,
+  ::boost::false_type)
+{
+  detail::select_write_impl(out, i, e, delim, n,
+    typename use_erased_write<InputIterator, Sentinel, Delimiter>::type());
+}
+
+template <
+  typename InputIterator,
+  typename Sentinel,
+  typename Delimiter,
+  typename CharT,
+  typename Traits>
+void
+select_batched_write_impl(
+  ::std::basic_ostream<CharT, Traits>& out,
+  InputIterator& i,
+  Sentinel const& e,
+  Delimiter& delim,
+  ::std::size_t& n,
+  ::boost::true_type)
+{
+  typedef batch_delimiter<typename ::boost::remove_const<Delimiter>::type, CharT, Traits> delimiter_traits;
+  
+  identity_projection proj;
+  
+  if (detail::batched_write_usable(out) && delimiter_traits::usable(delim))
+    detail::batched_write_impl(out, i, e, delim, n, proj);
+  else
+    detail::select_write_impl(out, i, e, delim, n,
+      typename use_erased_write<InputIterator, Sentinel, Delimiter>::type());
+}
+
+// Projected versions of select_batched_write_impl() (only with delimiters,
+// as the projected writes are): the batched write loop is selected if the
+// projected values are integers it supports. Otherwise, the elements are
+// written one at a time (the type-erased write loop is never used).
+template <
+  typename InputIterator,
+  typename Sentinel,
+  typename Delimiter,
+  typename CharT,
+  typename Traits,
+  typename Projection>
+void
+select_batched_write_impl(
+  ::std::basic_ostream<CharT, Traits>& out,
+  InputIterator& i,
+  Sentinel const& e,
+  Delimiter& delim,
+  ::std::size_t& n,
+  Projection& proj,
+  ::boost::false_type)
+{
+  null_write_instrument instrument;
+  detail::projected_write_impl(out, i, e, delim, n, instrument, proj);
+}
+
+template <
+  typename InputIterator,
+  typename Sentinel,
+  typename Delimiter,
+  typename CharT,
+  typename Traits,
+  typename Projection>
+void
+select_batched_write_impl(
+  ::std::basic_ostream<CharT, Traits>& out,
+  InputIterator& i,
+  Sentinel const& e,
+  Delimiter& delim,
+  ::std::size_t& n,
+  Projection& proj,
+  ::boost::true_type)
+{
+  typedef batch_delimiter<typename ::boost::remove_const<Delimiter>::type, CharT, Traits> delimiter_traits;
+  
+  if (detail::batched_write_usable(out) && delimiter_traits::usable(delim))
+    detail::batched_write_impl(out, i, e, delim, n, proj);
+  else
+    detail::select_batched_write_impl(out, i, e, delim, n, proj, ::boost::false_type());
+}
+
+template <
+  typename InputIterator,
+  typename CharT,
+  typename Traits>
+void
+select_batched_write_n_impl(
+  ::std::basic_ostream<CharT, Traits>& out,
+  InputIterator& i,
+  ::std::size_t count,
+  ::std::size_t& n,
+  ::boost::false_type)
+{
+  null_write_instrument instrument;
+  detail::instrumented_write_n_impl(out, i, count, n, instrument);
+}
+
+template <
+  typename InputIterator,
+  typename CharT,
+  typename Traits>
+void
+select_batched_write_n_impl(
+  ::std::basic_ostream<CharT, Traits>& out,
+  InputIterator& i,
+  ::std::size_t count,
+  ::std::size_t& n,
+  ::boost::true_type)
+{
+  if (detail::batched_write_usable(out))
+  {
+    InputIterator const e = i + typename ::std::iterator_traits<InputIterator>::difference_type(count);
+    identity_projection proj;
+    detail::batched_write_impl(out, i, e, n, proj);
+  }
+  else
+  {
+    detail::select_batched_write_n_impl(out, i, count, n, ::boost::false_type());
+  }
+}
+
+template <
+  typename InputIterator,
+  typename Delimiter,
+  typename CharT,
+  typename Traits>
+void
+select_batched_write_n_impl(
+  ::std::basic_ostream<CharT, Traits>& out,
+  InputIterator& i,
+  ::std::size_t count,
+  Delimiter& delim,
+  ::std::size_t& n,
+  ::boost::false_type)
+{
+  null_write_instrument instrument;
+  detail::instrumented_write_n_impl(out, i, count, delim, n, instrument);
+}
+
+template <
+  typename InputIterator,
+  typename Delimiter,
+  typename CharT,
+  typename Traits>
+void
+select_batched_write_n_impl(
+  ::std::basic_ostream<CharT, Traits>& out,
+  InputIterator& i,
+  ::std::size_t count,
+  Delimiter& delim,
+  ::std::size_t& n,
+  ::boost::true_type)
+{
+  typedef batch_delimiter<typename ::boost::remove_const<Delimiter>::type, CharT, Traits> delimiter_traits;
+  
+  if (detail::batched_write_usable(out) && delimiter_traits::usable(delim))
+  {
+    InputIterator const e = i + typename ::std::iterator_traits<InputIterator>::difference_type(count);
+    identity_projection proj;
+    detail::batched_write_impl(out, i, e, delim, n, proj);
+  }
+  else
+  {
+    detail::select_batched_write_n_impl(out, i, count, delim, n, ::boost::false_type());
+  }
+}
+
+// Projected versions of select_batched_write_n_impl() (only with
+// delimiters, as the projected writes are).
+template <
+  typename InputIterator,
+  typename Delimiter,
+  typename CharT,
+  typename Traits,
+  typename Projection>
+void
+select_batched_write_n_impl(
+  ::std::basic_ostream<CharT, Traits>& out,
+  InputIterator& i,
+  ::std::size_t count,
+  Delimiter& delim,
+  ::std::size_t& n,
+  Projection& proj,
+  ::boost::false_type)
+{
+  null_write_instrument instrument;
+  detail::projected_write_n_impl(out, i, count, delim, n, instrument, proj);
+}
+
+template <
+  typename InputIterator,
+  typename Delimiter,
+  typename CharT,
+  typename Traits,
+  typename Projection>
+void
+select_batched_write_n_impl(
+  ::std::basic_ostream<CharT, Traits>& out,
+  InputIterator& i,
+  ::std::size_t count,
+  Delimiter& delim,
+  ::std::size_t& n,
+  Projection& proj,
+  ::boost::true_type)
+{
+  typedef batch_delimiter<typename ::boost::remove_const<Delimiter>::type, CharT, Traits> delimiter_traits;
+  
+  if (detail::batched_write_usable(out) && delimiter_traits::usable(delim))
+  {
+    InputIterator const e = i + typename ::std::iterator_traits<InputIterator>::difference_type(count);
+    detail::batched_write_impl(out, i, e, delim, n, proj);
+  }
+  else
+  {
+    detail::select_batched_write_n_impl(out, i, count, delim, n, proj, ::boost::false_type());
+  }
+}
+
 // Underlying implementation function for all versions of write without
 // delimiters.
 // 
@@ -40,6 +1505,13 @@ namespace detail {
 // 
 // At the end of the function, whether there have been any writes or not, the
 // stream width is set to zero.
+// 
+// Ranges of integers are written with the batched write loop, when it
+// produces exactly the same output (see select_batched_write_impl()), and
+// segmented ranges are written segment by segment (with the batched write
+// loop for each segment, when possible). Otherwise, if
+// BOOST_RANGEIO_ERASED_WRITE is defined, this may use the type-erased write
+// loop (see use_erased_write).
 template <
   typename InputIterator,
   typename Sentinel,
@@ -52,38 +1524,11 @@ write_impl(
   Sentinel const& e,
   ::std::size_t& n)
 {
-  // Only bother to attempt writing if the range is empty (i == e) or the
-  // output stream is good (bool(out) is true).
-  if (!(i == e) && bool(out))
-  {
-    // Save the formatting state prior to writing the first element.
-    detail::formatting_saver<CharT, Traits> formatting(out);
-    
-    if ((out << *i))
-    {
-      // If the first write succeeds, increment:
-      ++n; // ... the write count (do first because it will never throw)
-      ++i; // ... the iterator
-      
-      while ((i != e) && bool(out))
-      {
-        // If there are still more elements to write (and the output stream is
-        // still good), restore the formatting state to what it was before the
-        // first write.
-        formatting.restore();
-        
-        if ((out << *i))
-        {
-          // If the next write succeeds, increment:
-          ++n; // ... the write count (do first because it will never throw)
-          ++i; // ... the iterator
-        }
-      }
-    }
-  }
+  typedef ::boost::integral_constant<bool,
+    use_batched_write<InputIterator, Sentinel, void, CharT, Traits>::value &&
+    !is_segmented_range<InputIterator, Sentinel>::value> use_batched;
   
-  // Regardless of anything else, reset the stream's width to zero.
-  out.width(0);
+  detail::select_batched_write_impl(out, i, e, n, typename use_batched::type());
 }
 
 // Underlying implementation function for all versions of write with delimiters.
@@ -103,6 +1548,13 @@ write_impl(
 // 
 // At the end of the function, whether there have been any writes or not, the
 // stream width is set to zero.
+// 
+// Ranges of integers are written with the batched write loop, when it
+// produces exactly the same output (see select_batched_write_impl()), and
+// segmented ranges are written segment by segment (with the batched write
+// loop for each segment, when possible). Otherwise, if
+// BOOST_RANGEIO_ERASED_WRITE is defined, this may use the type-erased write
+// loop (see use_erased_write).
 template <
   typename InputIterator,
   typename Sentinel,
@@ -117,42 +1569,118 @@ write_impl(
   Delimiter& delim,
   ::std::size_t& n)
 {
-  // Only bother to attempt writing if the range is empty (i == e) or the
-  // output stream is good (bool(out) is true).
-  if (!(i == e) && bool(out))
-  {
-    // Save the formatting state prior to writing the first element.
-    detail::formatting_saver<CharT, Traits> formatting(out);
-    
-    if ((out << *i))
-    {
-      // If the first write succeeds, increment:
-      ++n; // ... the write count (do first because it will never throw)
-      ++i; // ... the iterator
-      
-      while ((i != e) && bool(out) && (out << delim))
-      {
-        // If there are still more elements to write (and the output stream is
-        // still good), restore the formatting state to what it was before the
-        // first write.
-        formatting.restore();
-        
-        if ((out << *i))
-        {
-          // If the next write succeeds, increment:
-          ++n; // ... the write count (do first because it will never throw)
-          ++i; // ... the iterator
-        }
-      }
-    }
-  }
+  typedef ::boost::integral_constant<bool,
+    use_batched_write<InputIterator, Sentinel, Delimiter, CharT, Traits>::value &&
+    !is_segmented_range<InputIterator, Sentinel>::value> use_batched;
   
-  // Regardless of anything else, reset the stream's width to zero.
-  out.width(0);
+  detail::select_batched_write_impl(out, i, e, delim, n, typename use_batched::type());
+}
+
+// Underlying implementation function for all versions of write of counted
+// ranges without delimiters.
+// 
+// Exactly the same as write_impl() (without delimiters), except that at most
+// count elements are written, rather than writing until i == e. (The
+// type-erased write loop is never used.)
+template <
+  typename InputIterator,
+  typename CharT,
+  typename Traits>
+void
+write_n_impl(
+  ::std::basic_ostream<CharT, Traits>& out,
+  InputIterator& i,
+  ::std::size_t count,
+  ::std::size_t& n)
+{
+  detail::select_batched_write_n_impl(out, i, count, n,
+    typename use_batched_write<InputIterator, InputIterator, void, CharT, Traits>::type());
+}
+
+// Underlying implementation function for all versions of write of counted
+// ranges with delimiters.
+// 
+// Exactly the same as write_impl() (with delimiters), except that at most
+// count elements are written, rather than writing until i == e. (The
+// type-erased write loop is never used.)
+template <
+  typename InputIterator,
+  typename Delimiter,
+  typename CharT,
+  typename Traits>
+void
+write_n_impl(
+  ::std::basic_ostream<CharT, Traits>& out,
+  InputIterator& i,
+  ::std::size_t count,
+  Delimiter& delim,
+  ::std::size_t& n)
+{
+  detail::select_batched_write_n_impl(out, i, count, delim, n,
+    typename use_batched_write<InputIterator, InputIterator, Delimiter, CharT, Traits>::type());
+}
+
+// Underlying implementation function for the projected writes with
+// delimiters.
+// 
+// Exactly the same as write_impl() (with delimiters), except that each
+// element is projected with proj before it is written (see project()), and
+// the type-erased write loop is never used. Ranges whose projected values are
+// integers are written with the batched write loop, when it produces exactly
+// the same output.
+template <
+  typename InputIterator,
+  typename Sentinel,
+  typename Delimiter,
+  typename CharT,
+  typename Traits,
+  typename Projection>
+void
+write_impl(
+  ::std::basic_ostream<CharT, Traits>& out,
+  InputIterator& i,
+  Sentinel const& e,
+  Delimiter& delim,
+  ::std::size_t& n,
+  Projection& proj)
+{
+  typedef ::boost::integral_constant<bool,
+    use_batched_write<InputIterator, Sentinel, Delimiter, CharT, Traits, Projection>::value &&
+    !is_segmented_range<InputIterator, Sentinel>::value> use_batched;
+  
+  detail::select_batched_write_impl(out, i, e, delim, n, proj, typename use_batched::type());
+}
+
+// Underlying implementation function for the projected writes of counted
+// ranges with delimiters.
+// 
+// Exactly the same as the projected write_impl(), except that at most count
+// elements are written, rather than writing until i == e.
+template <
+  typename InputIterator,
+  typename Delimiter,
+  typename CharT,
+  typename Traits,
+  typename Projection>
+void
+write_n_impl(
+  ::std::basic_ostream<CharT, Traits>& out,
+  InputIterator& i,
+  ::std::size_t count,
+  Delimiter& delim,
+  ::std::size_t& n,
+  Projection& proj)
+{
+  detail::select_batched_write_n_impl(out, i, count, delim, n, proj,
+    typename use_batched_write<InputIterator, InputIterator, Delimiter, CharT, Traits, Projection>::type());
 }
 
 } // namespace detail
 } // namespace rangeio
 } // namespace boost
 
+// If separate compilation is enabled, declare the common instantiations
+// extern.
+#include <boost/rangeio/detail/extern_templates.hpp>
+
 #endif  // include guard
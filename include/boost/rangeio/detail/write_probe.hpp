@@ -0,0 +1,123 @@
+//
+// Copyright (c) Mark A. Gibbs, 2015.
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+// 
+
+// Optional USDT (user-level statically defined tracing) probes for the range
+// write operations.
+// 
+// The probes are only compiled in if BOOST_RANGEIO_ENABLE_USDT is defined
+// before any RangeIO header is included, in which case <sys/sdt.h> (from
+// SystemTap) must be available. Otherwise, everything in this file compiles
+// away to nothing.
+// 
+// When enabled, the following probes are defined under the "boost_rangeio"
+// provider:
+//   write__start(count):
+//     Fired at the start of every write, where count is the element count
+//     passed in.
+//   write__end(written, bytes):
+//     Fired at the end of every write, where written is the number of elements
+//     written and bytes is the number of characters written (or -1 if it cannot
+//     be determined).
+//   write__fail(written, bytes):
+//     Fired just before write__end when the write stopped before the end of
+//     the range because the stream failed.
+// 
+// Counting the characters written means wrapping the stream's buffer in a
+// counting_streambuf for the duration of the write (which costs a virtual
+// call per character or block of characters), so it is only done while a
+// tracer is attached to one of the probes, as reported by the probes'
+// SystemTap semaphores. Semaphores change how <sys/sdt.h> emits every probe in
+// the translation unit (each one then needs a semaphore variable), so this
+// file never turns them on itself: if _SDT_HAS_SEMAPHORES is defined when
+// <sys/sdt.h> is included, this file defines (weak) semaphores for its own
+// probes and tests them, and unattached probes cost a single nop each (and a
+// test of the semaphores). Otherwise, the probes still fire, but bytes is
+// always -1, so that unattached probes still cost only a nop each.
+// 
+// This file is written to be C++98-safe.
+
+#ifndef BOOST_RANGEIO_Inc_detail_X_write_probe_2015_01_01_
+#define BOOST_RANGEIO_Inc_detail_X_write_probe_2015_01_01_
+
+#include <boost/config.hpp>
+
+#include <cstddef>
+#include <ios>
+#include <iosfwd>
+
+#ifdef BOOST_RANGEIO_ENABLE_USDT
+#   include <sys/sdt.h>
+#   include <boost/rangeio/detail/counting_streambuf.hpp>
+#endif // BOOST_RANGEIO_ENABLE_USDT
+
+#if defined(BOOST_RANGEIO_ENABLE_USDT) && defined(_SDT_HAS_SEMAPHORES)
+// The probe semaphores, which a tracer increments while it is attached to a
+// probe. They are weak, so every translation unit can define them.
+extern "C" {
+__extension__ unsigned short boost_rangeio_write__start_semaphore __attribute__((weak, unused, section(".probes")));
+__extension__ unsigned short boost_rangeio_write__end_semaphore __attribute__((weak, unused, section(".probes")));
+__extension__ unsigned short boost_rangeio_write__fail_semaphore __attribute__((weak, unused, section(".probes")));
+}
+
+#   define BOOST_RANGEIO_WRITE_PROBES_ENABLED() \
+      __builtin_expect((boost_rangeio_write__start_semaphore | boost_rangeio_write__end_semaphore | boost_rangeio_write__fail_semaphore) != 0, 0)
+#elif defined(BOOST_RANGEIO_ENABLE_USDT)
+#   define BOOST_RANGEIO_WRITE_PROBES_ENABLED() false
+#endif
+
+namespace boost {
+namespace rangeio {
+namespace detail {
+
+// 
+// Fires the write probes.
+// 
+// Construct at the start of a write (which fires write__start), and call
+// finish() at the end (which fires write__end, and write__fail if
+// necessary).
+// 
+template <typename CharT, typename Traits>
+class write_probe
+{
+public:
+#ifdef BOOST_RANGEIO_ENABLE_USDT
+  write_probe(::std::basic_ostream<CharT, Traits>& out, ::std::size_t n) :
+    start_count_(n),
+    counter_(out, BOOST_RANGEIO_WRITE_PROBES_ENABLED())
+  {
+    DTRACE_PROBE1(boost_rangeio, write__start, start_count_);
+  }
+  
+  void finish(::std::basic_ostream<CharT, Traits>&, ::std::size_t n, bool stopped) const
+  {
+    ::std::size_t const written = n - start_count_;
+    
+    // If there are no semaphores, or a tracer was attached during the write,
+    // the characters were not counted (and the count is -1).
+    ::std::streamoff const bytes = counter_.count();
+    
+    if (stopped)
+      DTRACE_PROBE2(boost_rangeio, write__fail, written, bytes);
+    
+    DTRACE_PROBE2(boost_rangeio, write__end, written, bytes);
+  }
+  
+private:
+  ::std::size_t const             start_count_;
+  output_counter<CharT, Traits>   counter_;
+#else
+  write_probe(::std::basic_ostream<CharT, Traits>&, ::std::size_t) {}
+  
+  void finish(::std::basic_ostream<CharT, Traits>&, ::std::size_t, bool) const {}
+#endif // BOOST_RANGEIO_ENABLE_USDT
+};
+
+} // namespace detail
+} // namespace rangeio
+} // namespace boost
+
+#endif  // include guard
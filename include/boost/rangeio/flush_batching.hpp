@@ -0,0 +1,496 @@
+//
+// Copyright (c) Mark A. Gibbs, 2015.
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+// 
+
+// Defines flush_batching, and the versions of the immediate
+// write_iterator_range() functions that batch the output (and the flushes)
+// of a whole range write.
+// 
+// Requires at least C++11.
+
+#ifndef BOOST_RANGEIO_Inc_flush_batching_2015_01_01_
+#define BOOST_RANGEIO_Inc_flush_batching_2015_01_01_
+
+#include <boost/config.hpp>
+
+#ifdef BOOST_NO_CXX11_RVALUE_REFERENCES
+#   error "C++98 is not supported"
+#else
+
+#include <cstddef>
+#include <ios>
+#include <iterator>
+#include <ostream>
+#include <streambuf>
+
+#include <boost/type_traits/integral_constant.hpp>
+#include <boost/type_traits/is_base_of.hpp>
+
+#include <boost/rangeio/detail/module_export.hpp>
+#include <boost/rangeio/detail/projection.hpp>
+#include <boost/rangeio/detail/write.hpp>
+#include <boost/rangeio/write_iterator_range.hpp>
+
+namespace boost {
+namespace rangeio {
+
+// Requests that the output of a range write be batched (see the
+// flush_batching versions of write_iterator_range()).
+// 
+// Has one public data member:
+//   bytes: the stream is flushed each time at least this many characters
+//          have been handed to its buffer since the last flush (the output
+//          is handed on in blocks of at most 2048 characters), or 0 to never
+//          flush during the write.
+// 
+BOOST_RANGEIO_MODULE_EXPORT struct flush_batching
+{
+  explicit flush_batching(::std::size_t n = 0) :
+    bytes(n)
+  {}
+  
+  ::std::size_t  bytes;
+};
+
+namespace detail {
+
+// 
+// Stream buffer that collects output in a fixed-size buffer, and hands it to
+// another stream buffer with a single sputn() each time it fills (and
+// flushes that stream buffer each time a given number of characters have
+// been handed to it).
+// 
+// Flushes requested through this buffer (by std::flush or std::endl) do
+// nothing, so they are effectively deferred to the end of the write. Once
+// handing output on has failed, all further output fails.
+// 
+// As with batch_output, the writer calls end_element() after each element,
+// so that the number of elements whose output has been completely handed on
+// is known (see elements()) even if a sputn() only hands on part of the
+// buffer.
+// 
+template <typename CharT, typename Traits>
+class flush_batching_streambuf :
+  public ::std::basic_streambuf<CharT, Traits>
+{
+public:
+  typedef typename Traits::int_type int_type;
+  
+  flush_batching_streambuf(::std::basic_streambuf<CharT, Traits>* target, ::std::size_t flush_bytes) :
+    target_(target),
+    flush_bytes_(flush_bytes),
+    unflushed_(0),
+    marks_(0),
+    pending_(0),
+    elements_(0),
+    failed_(false)
+  {
+    // If the flushes are more frequent than the buffer would fill, use only
+    // as much of the buffer as is flushed each time.
+    ::std::size_t const n = ((flush_bytes != 0) && (flush_bytes < buffer_size)) ? flush_bytes : buffer_size;
+    this->setp(buffer_, buffer_ + n);
+  }
+  
+  flush_batching_streambuf(flush_batching_streambuf const&) = delete;
+  flush_batching_streambuf& operator=(flush_batching_streambuf const&) = delete;
+  
+  // Hands the rest of the buffered output on. Returns false if that (or any
+  // earlier output) failed.
+  bool commit() { return forward_(); }
+  
+  // Marks the end of the output of an element.
+  void end_element()
+  {
+    ++pending_;
+    
+    // If there are more ends than there is room to keep, the last one is
+    // moved (so a partial sputn() may count too few elements, never too
+    // many).
+    if (marks_ == max_marks)
+      --marks_;
+    
+    ends_[marks_] = static_cast<unsigned short>(this->pptr() - this->pbase());
+    counts_[marks_] = pending_;
+    ++marks_;
+  }
+  
+  // The number of elements completely handed on.
+  ::std::size_t elements() const { return elements_; }
+  
+protected:
+  int_type overflow(int_type c)
+  {
+    if (!forward_())
+      return Traits::eof();
+    
+    if (Traits::eq_int_type(c, Traits::eof()))
+      return Traits::not_eof(c);
+    
+    *this->pptr() = Traits::to_char_type(c);
+    this->pbump(1);
+    
+    return c;
+  }
+  
+  int sync()
+  {
+    return failed_ ? -1 : 0;
+  }
+  
+private:
+  static ::std::size_t const buffer_size = 2048;
+  static ::std::size_t const max_marks = 512;
+  
+  bool forward_()
+  {
+    if (failed_)
+      return false;
+    
+    ::std::streamsize const n = this->pptr() - this->pbase();
+    ::std::streamsize const written = (n != 0) ? target_->sputn(this->pbase(), n) : 0;
+    
+    if (written != n)
+    {
+      // Count the elements that were accepted before the failure.
+      for (::std::size_t m = marks_; m != 0; --m)
+      {
+        if (::std::streamsize(ends_[m - 1]) <= written)
+        {
+          elements_ += counts_[m - 1];
+          break;
+        }
+      }
+      
+      failed_ = true;
+      return false;
+    }
+    
+    marks_ = 0;
+    elements_ += pending_;
+    pending_ = 0;
+    
+    if (n == 0)
+      return true;
+    
+    this->setp(this->pbase(), this->epptr());
+    
+    unflushed_ += ::std::size_t(n);
+    if ((flush_bytes_ != 0) && (unflushed_ >= flush_bytes_))
+    {
+      unflushed_ = 0;
+      
+      if (target_->pubsync() == -1)
+      {
+        failed_ = true;
+        return false;
+      }
+    }
+    
+    return true;
+  }
+  
+  ::std::basic_streambuf<CharT, Traits>*  target_;
+  ::std::size_t const                     flush_bytes_;
+  ::std::size_t                           unflushed_;
+  
+  // The offset of the end of each element marked since the buffer was last
+  // handed on, and the number of elements pending at that point.
+  unsigned short                          ends_[max_marks];
+  ::std::size_t                           counts_[max_marks];
+  ::std::size_t                           marks_;
+  
+  ::std::size_t                           pending_;
+  ::std::size_t                           elements_;
+  
+  bool                                    failed_;
+  
+  CharT                                   buffer_[buffer_size];
+};
+
+// Instrumentation policy (see null_write_instrument) that marks the end of
+// each element in a flush_batching_streambuf.
+template <typename CharT, typename Traits>
+class flush_batching_instrument
+{
+public:
+  explicit flush_batching_instrument(flush_batching_streambuf<CharT, Traits>& buffer) :
+    buffer_(buffer)
+  {}
+  
+  void start(::std::basic_ostream<CharT, Traits>&) {}
+  
+  void element() { buffer_.end_element(); }
+  void delimiter() {}
+  
+  void finish(::std::basic_ostream<CharT, Traits>&, bool) {}
+  
+private:
+  flush_batching_streambuf<CharT, Traits>& buffer_;
+};
+
+// 
+// Private stream that formats a range write for a target stream, through a
+// flush_batching_streambuf attached to the target's stream buffer.
+// 
+// The private stream is given the target's formatting state (so elements and
+// delimiters are formatted exactly as they would be by the target), but has
+// no tied stream, no exceptions enabled, and unitbuf unset - so writing to it
+// never flushes anything. The target itself is never changed, so its flags
+// do not need to be restored.
+// 
+template <typename CharT, typename Traits>
+class flush_batching_stream
+{
+public:
+  typedef ::std::basic_ostream<CharT, Traits> ostream_type;
+  
+  flush_batching_stream(ostream_type& o, ::std::size_t flush_bytes) :
+    buffer_(o.rdbuf(), flush_bytes),
+    stream_(&buffer_)
+  {
+    stream_.copyfmt(o);
+    stream_.tie(0);
+    stream_.exceptions(::std::ios_base::goodbit);
+    stream_.unsetf(::std::ios_base::unitbuf);
+    stream_.clear();
+  }
+  
+  flush_batching_stream(flush_batching_stream const&) = delete;
+  flush_batching_stream& operator=(flush_batching_stream const&) = delete;
+  
+  ostream_type& stream() { return stream_; }
+  
+  flush_batching_instrument<CharT, Traits> instrument() { return flush_batching_instrument<CharT, Traits>(buffer_); }
+  
+  // Hands the rest of the output on to o's stream buffer. Returns false if
+  // handing on any of the output failed.
+  bool commit() { return buffer_.commit(); }
+  
+  // The number of elements completely handed on to o's stream buffer.
+  ::std::size_t elements() const { return buffer_.elements(); }
+  
+  // Copies the private stream's error state to o, with badbit set as well if
+  // handed_on is false.
+  void finish(ostream_type& o, bool handed_on)
+  {
+    ::std::ios_base::iostate state = stream_.rdstate() & (::std::ios_base::badbit | ::std::ios_base::failbit);
+    
+    if (!handed_on)
+      state |= ::std::ios_base::badbit;
+    
+    // This may throw, if o has exceptions enabled.
+    if (state != ::std::ios_base::goodbit)
+      o.setstate(state);
+  }
+  
+private:
+  flush_batching_streambuf<CharT, Traits>  buffer_;
+  ostream_type                             stream_;
+};
+
+// Makes i refer to the first element whose output was not handed on, and n
+// the number of elements whose output was (counting from start), after a
+// write that formatted the elements from first to i handed on only the first
+// k of them. Single-pass iterators cannot go back, so for them both i and n
+// are left as they are - referring to the first element not formatted, and
+// counting every element formatted - so that they still agree.
+template <typename InputIterator>
+void flush_batching_rewind(
+  InputIterator& i,
+  InputIterator const& first,
+  ::std::size_t& n,
+  ::std::size_t start,
+  ::std::size_t k,
+  ::boost::true_type)
+{
+  i = first;
+  ::std::advance(i, typename ::std::iterator_traits<InputIterator>::difference_type(k));
+  n = start + k;
+}
+
+template <typename InputIterator>
+void flush_batching_rewind(
+  InputIterator&,
+  InputIterator const&,
+  ::std::size_t&,
+  ::std::size_t,
+  ::std::size_t,
+  ::boost::false_type)
+{}
+
+template <typename InputIterator>
+void flush_batching_rewind(
+  InputIterator& i,
+  InputIterator const& first,
+  ::std::size_t& n,
+  ::std::size_t start,
+  ::std::size_t k)
+{
+  typedef typename ::std::iterator_traits<InputIterator>::iterator_category category;
+  
+  detail::flush_batching_rewind(i, first, n, start, k,
+    typename ::boost::is_base_of< ::std::forward_iterator_tag, category>::type());
+}
+
+// Hands the rest of batch's output on to o's stream buffer, and sets o's
+// error state. If handing the output on failed, n is set to the number of
+// elements whose output was completely handed on (counting from start), and
+// i is moved back to the first element that was not (see
+// flush_batching_rewind() for single-pass iterators).
+template <typename InputIterator, typename CharT, typename Traits>
+void flush_batching_commit(
+  ::std::basic_ostream<CharT, Traits>& o,
+  flush_batching_stream<CharT, Traits>& batch,
+  InputIterator& i,
+  InputIterator const& first,
+  ::std::size_t& n,
+  ::std::size_t start)
+{
+  bool const handed_on = batch.commit();
+  
+  if (!handed_on)
+    detail::flush_batching_rewind(i, first, n, start, batch.elements());
+  
+  batch.finish(o, handed_on);
+}
+
+// Underlying implementation functions for the flush_batching versions of
+// write_iterator_range(): the same as write_impl(), except that the range is
+// written to a flush_batching_stream for o, with the end of each element
+// marked (so the elements are always written one at a time, without the
+// batched fast paths, which would buffer the output a second time).
+// 
+// There are two versions - one with a delimiter, and one without.
+template <
+  typename InputIterator,
+  typename Sentinel,
+  typename Delimiter,
+  typename CharT,
+  typename Traits>
+void
+flush_batching_write_impl(
+  ::std::basic_ostream<CharT, Traits>& o,
+  flush_batching const& b,
+  InputIterator& i,
+  Sentinel const& e,
+  Delimiter& delim,
+  ::std::size_t& n)
+{
+  if (bool(o))
+  {
+    // The sentry flushes the tied stream once (rather than once for each
+    // element), and if o has unitbuf set, flushes o once at the end of the
+    // write.
+    typename ::std::basic_ostream<CharT, Traits>::sentry const sentry(o);
+    
+    if (sentry)
+    {
+      detail::flush_batching_stream<CharT, Traits> batch(o, b.bytes);
+      flush_batching_instrument<CharT, Traits> instrument = batch.instrument();
+      identity_projection proj;
+      
+      InputIterator const first = i;
+      ::std::size_t const start = n;
+      
+      detail::projected_write_impl(batch.stream(), i, e, delim, n, instrument, proj);
+      detail::flush_batching_commit(o, batch, i, first, n, start);
+    }
+  }
+  
+  // Regardless of anything else, reset the stream's width to zero.
+  o.width(0);
+}
+
+template <
+  typename InputIterator,
+  typename Sentinel,
+  typename CharT,
+  typename Traits>
+void
+flush_batching_write_impl(
+  ::std::basic_ostream<CharT, Traits>& o,
+  flush_batching const& b,
+  InputIterator& i,
+  Sentinel const& e,
+  ::std::size_t& n)
+{
+  if (bool(o))
+  {
+    typename ::std::basic_ostream<CharT, Traits>::sentry const sentry(o);
+    
+    if (sentry)
+    {
+      detail::flush_batching_stream<CharT, Traits> batch(o, b.bytes);
+      flush_batching_instrument<CharT, Traits> instrument = batch.instrument();
+      identity_projection proj;
+      
+      InputIterator const first = i;
+      ::std::size_t const start = n;
+      
+      detail::projected_write_impl(batch.stream(), i, e, n, instrument, proj);
+      detail::flush_batching_commit(o, batch, i, first, n, start);
+    }
+  }
+  
+  o.width(0);
+}
+
+} // namespace detail
+
+// Flush-batched immediate write_iterator_range().
+// 
+// These are exactly the same as the immediate versions of
+// write_iterator_range(), except that the output of the whole write is
+// batched: rather than each element being written to the stream (which, if
+// the stream has unitbuf set - as std::cerr does - or its stream buffer is
+// unbuffered, means one system call or more per element), the range is
+// formatted into a fixed-size buffer, which is handed to the stream's buffer
+// in large blocks. For example, to dump a large range to std::cerr with a
+// handful of writes rather than one per element:
+// 
+//   write_iterator_range(std::cerr, v.begin(), v.end(), '\n', flush_batching());
+// 
+// The tied stream is flushed once, at the start of the write. Flushes that
+// would happen during the write (because of unitbuf, or elements that write
+// std::flush or std::endl) do not happen; instead, if the stream has unitbuf
+// set, it is flushed once at the end of the write, and if b.bytes is not
+// zero, it is also flushed during the write (see flush_batching). The
+// stream's flags are never changed.
+// 
+// The elements are formatted with a private stream that is given a copy of
+// the stream's formatting state (with copyfmt()), so these are only worth
+// using for large ranges. If handing the output on to the stream's buffer
+// fails, the count is the number of elements whose output was completely
+// accepted, and next refers to the first element that was not. Single-pass
+// iterators cannot be moved back, so for them next refers to the first
+// element that was not formatted, and the count is the number of elements
+// that were (including any whose output was lost).
+// 
+// There are two versions - one with a delimiter, and one without.
+// 
+BOOST_RANGEIO_MODULE_EXPORT template <typename InputIterator, typename Sentinel, typename Delimiter, typename CharT, typename Traits>
+write_iterator_range_result_t<InputIterator>
+write_iterator_range(::std::basic_ostream<CharT, Traits>& o, InputIterator i, Sentinel const e, Delimiter&& d, flush_batching const b)
+{
+  write_iterator_range_result_t<InputIterator> w(i);
+  detail::flush_batching_write_impl(o, b, w.next, e, d, w.count);
+  return w;
+}
+
+BOOST_RANGEIO_MODULE_EXPORT template <typename InputIterator, typename Sentinel, typename CharT, typename Traits>
+write_iterator_range_result_t<InputIterator>
+write_iterator_range(::std::basic_ostream<CharT, Traits>& o, InputIterator i, Sentinel const e, flush_batching const b)
+{
+  write_iterator_range_result_t<InputIterator> w(i);
+  detail::flush_batching_write_impl(o, b, w.next, e, w.count);
+  return w;
+}
+
+} // namespace rangeio
+} // namespace boost
+
+#endif  // BOOST_NO_CXX11_RVALUE_REFERENCES
+#endif  // include guard
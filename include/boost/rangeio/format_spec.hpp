@@ -0,0 +1,365 @@
+//
+// Copyright (c) Mark A. Gibbs, 2015.
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+// 
+
+// Defines format_spec, which describes how each element of a range is
+// formatted with a std::format-style format spec, and the versions of the
+// immediate write_iterator_range() functions that use it.
+// 
+// Requires at least C++11.
+
+#ifndef BOOST_RANGEIO_Inc_format_spec_2015_01_01_
+#define BOOST_RANGEIO_Inc_format_spec_2015_01_01_
+
+#include <boost/config.hpp>
+
+#ifdef BOOST_NO_CXX11_RVALUE_REFERENCES
+#   error "C++98 is not supported"
+#else
+
+#include <cstddef>
+#include <ios>
+#include <ostream>
+
+#include <boost/rangeio/detail/module_export.hpp>
+#include <boost/rangeio/detail/write.hpp>
+#include <boost/rangeio/write_iterator_range.hpp>
+
+namespace boost {
+namespace rangeio {
+
+// A std::format-style format spec for the elements of a range.
+// 
+// Constructed from a replacement field, like "{:>8.3f}" (or "{}"), or just
+// the spec inside one, like ">8.3f". The spec is:
+// 
+//   [[fill]align][sign][#][0][width][.precision][L][type]
+// 
+// where:
+//   fill:      any single character other than '{' or '}' (default ' ').
+//   align:     '<' (left) or '>' (right). (Centring, '^', is not supported,
+//              because iostreams cannot centre.)
+//   sign:      '+' (show the sign of non-negative numbers) or '-' (the
+//              default). (' ' is not supported.)
+//   #:         show the base prefix of integers and the decimal point of
+//              floating point values.
+//   0:         pad numbers with zeros after the sign and base prefix (ignored
+//              if align is given).
+//   width:     the minimum width of each element.
+//   precision: the precision of floating point values. If it is not given,
+//              the stream's precision is kept.
+//   L:         accepted for compatibility - the stream's locale is always
+//              used.
+//   type:      'd' (decimal), 'o' (octal), 'x' or 'X' (hex), 'f' or 'F'
+//              (fixed), 'e' or 'E' (scientific), 'g' or 'G' (general), or
+//              'a' or 'A' (hex float). The uppercase types write their
+//              letters in uppercase.
+// 
+// The elements are still written with "out << *i", so the spec is
+// translated to the equivalent iostream formatting state, and integers and
+// signs come out as iostreams write them (for example, negative integers in
+// hex are written as their unsigned representation, and '+' only applies to
+// decimal values).
+// 
+// Parsing never fails loudly: if the spec cannot be parsed, or uses
+// something that is not supported, valid() is false, and writes with it fail
+// the stream. In C++14, the constructor is constexpr, so a spec can be
+// parsed (and checked) at compile time:
+// 
+//   constexpr format_spec spec("{:>8.3f}");
+//   static_assert(spec.valid(), "bad format spec");
+// 
+BOOST_RANGEIO_MODULE_EXPORT class format_spec
+{
+public:
+  BOOST_CXX14_CONSTEXPR format_spec(char const* spec) :
+    fill_(' '),
+    align_(0),
+    sign_('-'),
+    alternate_(false),
+    zero_pad_(false),
+    width_(0),
+    precision_(-1),
+    type_(0),
+    valid_(false)
+  {
+    valid_ = parse_(spec);
+  }
+  
+  BOOST_CONSTEXPR bool valid() const { return valid_; }
+  
+  BOOST_CONSTEXPR char fill() const { return fill_; }
+  BOOST_CONSTEXPR char align() const { return align_; }
+  BOOST_CONSTEXPR char sign() const { return sign_; }
+  BOOST_CONSTEXPR bool alternate() const { return alternate_; }
+  BOOST_CONSTEXPR bool zero_pad() const { return zero_pad_; }
+  BOOST_CONSTEXPR ::std::streamsize width() const { return width_; }
+  BOOST_CONSTEXPR ::std::streamsize precision() const { return precision_; }
+  BOOST_CONSTEXPR char type() const { return type_; }
+  
+  // Returns f with the parts the spec describes replaced.
+  ::std::ios_base::fmtflags flags(::std::ios_base::fmtflags f) const
+  {
+    typedef ::std::ios_base ios_base;
+    
+    f &= ~(ios_base::adjustfield | ios_base::basefield | ios_base::floatfield |
+      ios_base::showpos | ios_base::showbase | ios_base::showpoint | ios_base::uppercase);
+    
+    if (align_ == '<')
+      f |= ios_base::left;
+    else if (align_ == '>')
+      f |= ios_base::right;
+    else if (zero_pad_)
+      f |= ios_base::internal;
+    
+    if (sign_ == '+')
+      f |= ios_base::showpos;
+    if (alternate_)
+      f |= ios_base::showbase | ios_base::showpoint;
+    
+    switch (type_)
+    {
+    case 'o':           f |= ios_base::oct; break;
+    case 'x': case 'X': f |= ios_base::hex; break;
+    case 'f': case 'F': f |= ios_base::dec | ios_base::fixed; break;
+    case 'e': case 'E': f |= ios_base::dec | ios_base::scientific; break;
+    case 'a': case 'A': f |= ios_base::dec | ios_base::fixed | ios_base::scientific; break;
+    default:            f |= ios_base::dec; break;
+    }
+    
+    if ((type_ >= 'A') && (type_ <= 'Z'))
+      f |= ios_base::uppercase;
+    
+    return f;
+  }
+  
+private:
+  static BOOST_CONSTEXPR bool is_align_(char c) { return (c == '<') || (c == '>') || (c == '^'); }
+  static BOOST_CONSTEXPR bool is_digit_(char c) { return (c >= '0') && (c <= '9'); }
+  
+  // Reads a decimal number at p (which must be a digit), and returns false if
+  // it is too big.
+  static BOOST_CXX14_CONSTEXPR bool parse_number_(char const*& p, ::std::streamsize& n)
+  {
+    n = 0;
+    for (; is_digit_(*p); ++p)
+    {
+      n = (n * 10) + (*p - '0');
+      if (n > 0xFFFF)
+        return false;
+    }
+    
+    return true;
+  }
+  
+  BOOST_CXX14_CONSTEXPR bool parse_(char const* p)
+  {
+    if (p == 0)
+      return false;
+    
+    bool const field = (*p == '{');
+    if (field)
+    {
+      ++p;
+      if (*p == ':')
+        ++p;
+      else if (*p != '}')
+        return false;
+    }
+    
+    if ((*p != '\0') && (*p != '{') && (*p != '}') && is_align_(p[1]))
+    {
+      fill_ = *p++;
+      align_ = *p++;
+    }
+    else if (is_align_(*p))
+    {
+      align_ = *p++;
+    }
+    
+    if ((*p == '+') || (*p == '-') || (*p == ' '))
+      sign_ = *p++;
+    
+    if (*p == '#')
+    {
+      alternate_ = true;
+      ++p;
+    }
+    
+    if (*p == '0')
+    {
+      zero_pad_ = true;
+      ++p;
+    }
+    
+    if (is_digit_(*p) && !parse_number_(p, width_))
+      return false;
+    
+    if (*p == '.')
+    {
+      ++p;
+      if (!is_digit_(*p) || !parse_number_(p, precision_))
+        return false;
+    }
+    
+    if (*p == 'L')
+      ++p;
+    
+    switch (*p)
+    {
+    case 'd': case 'o': case 'x': case 'X':
+    case 'f': case 'F': case 'e': case 'E':
+    case 'g': case 'G': case 'a': case 'A':
+      type_ = *p++;
+      break;
+    default:
+      break;
+    }
+    
+    if (field && (*p++ != '}'))
+      return false;
+    
+    if (*p != '\0')
+      return false;
+    
+    // iostreams cannot centre, or write a space for the sign.
+    return (align_ != '^') && (sign_ != ' ');
+  }
+  
+  char               fill_;
+  char               align_;
+  char               sign_;
+  bool               alternate_;
+  bool               zero_pad_;
+  ::std::streamsize  width_;
+  ::std::streamsize  precision_;
+  char               type_;
+  bool               valid_;
+};
+
+namespace detail {
+
+// 
+// Gives a stream the formatting state described by a format spec, and
+// restores the stream's flags, precision and fill character when it is
+// destroyed (the width is reset to zero by the write, as usual).
+// 
+template <typename CharT, typename Traits>
+class format_spec_state
+{
+public:
+  format_spec_state(::std::basic_ostream<CharT, Traits>& s, format_spec const& spec) :
+    stream_(s),
+    flags_(s.flags()),
+    precision_(s.precision()),
+    fill_(s.fill())
+  {
+    s.flags(spec.flags(flags_));
+    s.width(spec.width());
+    
+    if (spec.precision() >= 0)
+      s.precision(spec.precision());
+    
+    if (spec.zero_pad() && (spec.align() == 0))
+      s.fill(s.widen('0'));
+    else
+      s.fill(s.widen(spec.fill()));
+  }
+  
+  format_spec_state(format_spec_state const&) = delete;
+  format_spec_state& operator=(format_spec_state const&) = delete;
+  
+  ~format_spec_state()
+  {
+    stream_.flags(flags_);
+    stream_.precision(precision_);
+    stream_.fill(fill_);
+  }
+  
+private:
+  ::std::basic_ostream<CharT, Traits>&  stream_;
+  ::std::ios_base::fmtflags const       flags_;
+  ::std::streamsize const               precision_;
+  CharT const                           fill_;
+};
+
+// Fails the stream, for writes with an invalid format spec.
+template <typename CharT, typename Traits>
+void fail_format_spec(::std::basic_ostream<CharT, Traits>& o)
+{
+  o.width(0);
+  
+  // This may throw, if o has exceptions enabled.
+  o.setstate(::std::ios_base::failbit);
+}
+
+} // namespace detail
+
+// Formatted immediate write_iterator_range().
+// 
+// These are exactly the same as the immediate versions of
+// write_iterator_range() (and write_iterator_range_n()) with a delimiter,
+// except that each element is formatted as described by spec, rather than
+// with the stream's formatting state - for example:
+// 
+//   write_iterator_range(out, prices.begin(), prices.end(), ", ", "{:>8.3f}");
+// 
+// The spec is parsed once per call (or once at compile time, if it is a
+// constexpr format_spec), and the stream is given the formatting state it
+// describes once, for the whole range, and then given its own flags,
+// precision and fill character back afterwards. So the elements are written
+// with no formatting state changes between them, and integers are written by
+// the batched write loop (see write_impl()) whenever the spec allows it.
+// 
+// If the spec is not valid, nothing is written and the stream's failbit is
+// set.
+// 
+// These are only available with a delimiter (a spec would otherwise be
+// ambiguous with a delimiter).
+// 
+BOOST_RANGEIO_MODULE_EXPORT template <typename InputIterator, typename Sentinel, typename Delimiter, typename CharT, typename Traits>
+write_iterator_range_result_t<InputIterator>
+write_iterator_range(::std::basic_ostream<CharT, Traits>& o, InputIterator i, Sentinel const e, Delimiter&& d, format_spec const& spec)
+{
+  write_iterator_range_result_t<InputIterator> w(i);
+  
+  if (spec.valid())
+  {
+    detail::format_spec_state<CharT, Traits> const state(o, spec);
+    detail::write_impl(o, w.next, e, d, w.count);
+  }
+  else
+  {
+    detail::fail_format_spec(o);
+  }
+  
+  return w;
+}
+
+BOOST_RANGEIO_MODULE_EXPORT template <typename InputIterator, typename Delimiter, typename CharT, typename Traits>
+write_iterator_range_result_t<InputIterator>
+write_iterator_range_n(::std::basic_ostream<CharT, Traits>& o, InputIterator i, ::std::size_t n, Delimiter&& d, format_spec const& spec)
+{
+  write_iterator_range_result_t<InputIterator> w(i);
+  
+  if (spec.valid())
+  {
+    detail::format_spec_state<CharT, Traits> const state(o, spec);
+    detail::write_n_impl(o, w.next, n, d, w.count);
+  }
+  else
+  {
+    detail::fail_format_spec(o);
+  }
+  
+  return w;
+}
+
+} // namespace rangeio
+} // namespace boost
+
+#endif  // BOOST_NO_CXX11_RVALUE_REFERENCES
+#endif  // include guard
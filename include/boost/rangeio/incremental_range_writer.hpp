@@ -0,0 +1,236 @@
+//
+// Copyright (c) Mark A. Gibbs, 2015.
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+// 
+
+// Defines basic_incremental_range_writer, which keeps the formatted output of
+// an append-only range, and only formats the elements appended since the
+// previous write.
+// 
+// Requires at least C++11.
+
+#ifndef BOOST_RANGEIO_Inc_incremental_range_writer_2015_01_01_
+#define BOOST_RANGEIO_Inc_incremental_range_writer_2015_01_01_
+
+#include <boost/config.hpp>
+
+#ifdef BOOST_NO_CXX11_RVALUE_REFERENCES
+#   error "C++98 is not supported"
+#else
+
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <ostream>
+#include <string>
+
+#include <boost/type_traits/integral_constant.hpp>
+#include <boost/type_traits/is_base_of.hpp>
+
+#include <boost/rangeio/detail/cached_output.hpp>
+#include <boost/rangeio/detail/module_export.hpp>
+#include <boost/rangeio/detail/write.hpp>
+
+namespace boost {
+namespace rangeio {
+
+namespace detail {
+
+// Advances i by n, unless e is reached first. Returns false if e was
+// reached first.
+template <typename ForwardIterator>
+bool advance_within(ForwardIterator& i, ForwardIterator const& e, ::std::size_t n, ::boost::true_type)
+{
+  if (::std::size_t(e - i) < n)
+    return false;
+  
+  i += n;
+  return true;
+}
+
+template <typename ForwardIterator>
+bool advance_within(ForwardIterator& i, ForwardIterator const& e, ::std::size_t n, ::boost::false_type)
+{
+  for (; n != 0; --n, ++i)
+  {
+    if (i == e)
+      return false;
+  }
+  
+  return true;
+}
+
+template <typename ForwardIterator>
+bool advance_within(ForwardIterator& i, ForwardIterator const& e, ::std::size_t n)
+{
+  typedef typename ::std::iterator_traits<ForwardIterator>::iterator_category category;
+  
+  return detail::advance_within(i, e, n,
+    typename ::boost::is_base_of< ::std::random_access_iterator_tag, category>::type());
+}
+
+} // namespace detail
+
+// Incremental range writer.
+// 
+// Writes an append-only range (such as an event log in a vector) exactly as
+// the immediate write_iterator_range() would, but keeps the formatted output
+// and the number of elements it holds. The next write formats only the
+// elements that have been appended since (with a delimiter between the old
+// output and the new, if needed), appends them to the kept output, then
+// writes all of it to the stream with a single sputn().
+// 
+// Each write is given the whole range, from its beginning - the writer keeps
+// an element count rather than an iterator, so it keeps working when the
+// container reallocates. If the range has become shorter than the number of
+// elements already formatted, it is formatted again from the beginning.
+// Elements already formatted are otherwise assumed not to change; call
+// reset() if they do.
+// 
+// As with basic_cached_range_writer, the range is also formatted again from
+// the beginning if the stream's formatting state (flags, precision, width,
+// fill character or locale) is not the same as the previous write's. The
+// delimiter must be the same for every write.
+// 
+// If formatting fails part way, the kept output is discarded, so the next
+// write starts again from the beginning.
+// 
+// An incremental writer is not thread-safe.
+// 
+BOOST_RANGEIO_MODULE_EXPORT template <typename CharT, typename Traits = ::std::char_traits<CharT>, typename Allocator = ::std::allocator<CharT>>
+class basic_incremental_range_writer
+{
+public:
+  typedef CharT                                               char_type;
+  typedef Traits                                              traits_type;
+  typedef Allocator                                           allocator_type;
+  typedef ::std::basic_ostream<CharT, Traits>                 ostream_type;
+  
+  typedef typename detail::cached_output<CharT, Traits, Allocator>::size_type
+                                                              size_type;
+  
+  basic_incremental_range_writer() :
+    basic_incremental_range_writer(Allocator())
+  {}
+  
+  explicit basic_incremental_range_writer(Allocator const& a) :
+    output_(a),
+    count_(0)
+  {}
+  
+  basic_incremental_range_writer(basic_incremental_range_writer const&) = delete;
+  basic_incremental_range_writer& operator=(basic_incremental_range_writer const&) = delete;
+  
+  // Writes the range [first, last), with delim between the elements.
+  template <typename ForwardIterator, typename Delimiter>
+  ostream_type& write(ostream_type& o, ForwardIterator first, ForwardIterator const last, Delimiter&& d)
+  {
+    if (bool(o))
+    {
+      bool const append = prepare_(o, first, last);
+      
+      if (!(first == last))
+      {
+        if (append)
+          write_delimiter_(d);
+        
+        detail::write_impl(output_.stream(), first, last, d, count_);
+      }
+      
+      store_(o);
+    }
+    
+    return output_.commit(o);
+  }
+  
+  // Writes the range [first, last), with no delimiter.
+  template <typename ForwardIterator>
+  ostream_type& write(ostream_type& o, ForwardIterator first, ForwardIterator const last)
+  {
+    if (bool(o))
+    {
+      prepare_(o, first, last);
+      
+      if (!(first == last))
+        detail::write_impl(output_.stream(), first, last, count_);
+      
+      store_(o);
+    }
+    
+    return output_.commit(o);
+  }
+  
+  // Discards the kept output (keeping the buffer's capacity), so that the
+  // next write formats the range from the beginning.
+  void reset()
+  {
+    output_.invalidate();
+    count_ = 0;
+  }
+  
+  // The number of elements, and characters, in the kept output.
+  ::std::size_t count() const { return count_; }
+  size_type size() const { return output_.size(); }
+  
+  allocator_type get_allocator() const { return output_.get_allocator(); }
+  
+private:
+  // Advances first past the elements already formatted, and returns true if
+  // there are any. Otherwise, discards the kept output to start again with
+  // o's formatting state.
+  template <typename ForwardIterator>
+  bool prepare_(ostream_type& o, ForwardIterator& first, ForwardIterator const& last)
+  {
+    if (output_.matches(o))
+    {
+      ForwardIterator i = first;
+      if (detail::advance_within(i, last, count_))
+      {
+        first = i;
+        output_.resume();
+        return (count_ != 0);
+      }
+    }
+    
+    output_.reset(o);
+    count_ = 0;
+    
+    return false;
+  }
+  
+  // Writes the delimiter between the kept output and the new elements, the
+  // same way write_impl() writes delimiters (with the width reset, then
+  // restored afterwards).
+  template <typename Delimiter>
+  void write_delimiter_(Delimiter& d)
+  {
+    ostream_type& stream = output_.stream();
+    
+    ::std::streamsize const width = stream.width();
+    
+    stream.width(0);
+    stream << d;
+    stream.width(width);
+  }
+  
+  void store_(ostream_type const& o)
+  {
+    output_.store(o);
+    if (!output_.valid())
+      count_ = 0;
+  }
+  
+  detail::cached_output<CharT, Traits, Allocator>   output_;
+  ::std::size_t                                     count_;
+};
+
+BOOST_RANGEIO_MODULE_EXPORT typedef basic_incremental_range_writer<char>     incremental_range_writer;
+BOOST_RANGEIO_MODULE_EXPORT typedef basic_incremental_range_writer<wchar_t>  wincremental_range_writer;
+
+} // namespace rangeio
+} // namespace boost
+
+#endif  // BOOST_NO_CXX11_RVALUE_REFERENCES
+#endif  // include guard
@@ -0,0 +1,58 @@
+//
+// Copyright (c) Mark A. Gibbs, 2015.
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+// 
+
+// Defines the prefer_inline_write customization point.
+// 
+// Normally, every distinct combination of iterator, sentinel, delimiter and
+// stream type gets its own fully inlined copy of the write loop. If
+// BOOST_RANGEIO_ERASED_WRITE is defined before any RangeIO header is
+// included, writes instead go through a single type-erased write loop per
+// stream type (see detail/erased_write.hpp), and only a handful of small
+// adapter functions are generated for each combination. That trades a few
+// indirect calls per element for much less code.
+// 
+// prefer_inline_write lets hot combinations opt back in to the inlined loop
+// in that mode. It has no effect when BOOST_RANGEIO_ERASED_WRITE is not
+// defined.
+// 
+// This file is written to be C++98-safe.
+
+#ifndef BOOST_RANGEIO_Inc_prefer_inline_write_2015_01_01_
+#define BOOST_RANGEIO_Inc_prefer_inline_write_2015_01_01_
+
+#include <boost/config.hpp>
+
+#include <boost/rangeio/detail/module_export.hpp>
+
+#include <boost/type_traits/integral_constant.hpp>
+
+namespace boost {
+namespace rangeio {
+
+// Traits class to select the inlined write loop for a range type when
+// BOOST_RANGEIO_ERASED_WRITE is defined.
+// 
+// Delimiter is void for writes without delimiters. Otherwise it is the
+// delimiter type as it is stored (or referenced) by the write, which may be
+// const-qualified.
+// 
+// The primary template derives from boost::false_type. To keep the inlined
+// loop for a range type, specialize this template (partially, if desired) to
+// derive from boost::true_type.
+// 
+// (Segmented ranges and null-terminated ranges always use the inlined loops,
+// because they have their own specialized write algorithms.)
+// 
+BOOST_RANGEIO_MODULE_EXPORT template <typename InputIterator, typename Sentinel, typename Delimiter = void>
+struct prefer_inline_write :
+  ::boost::false_type
+{};
+
+} // namespace rangeio
+} // namespace boost
+
+#endif  // include guard
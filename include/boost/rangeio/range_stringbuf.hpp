@@ -0,0 +1,348 @@
+//
+// Copyright (c) Mark A. Gibbs, 2015.
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+// 
+
+// Defines basic_range_stringbuf and basic_range_ostream, an output string
+// buffer (and stream) whose contents can be viewed without copying, and moved
+// out as a string.
+// 
+// Requires at least C++11.
+
+#ifndef BOOST_RANGEIO_Inc_range_stringbuf_2015_01_01_
+#define BOOST_RANGEIO_Inc_range_stringbuf_2015_01_01_
+
+#include <boost/config.hpp>
+
+#ifdef BOOST_NO_CXX11_RVALUE_REFERENCES
+#   error "C++98 is not supported"
+#else
+
+#include <climits>
+#include <cstddef>
+#include <ios>
+#include <memory>
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include <utility>
+
+#ifndef BOOST_NO_CXX17_HDR_STRING_VIEW
+#   include <string_view>
+#endif
+
+// If basic_string::resize_and_overwrite() is available, the buffer uses it
+// to extend the string over its capacity without writing anything.
+#if defined(__cpp_lib_string_resize_and_overwrite) && (__cpp_lib_string_resize_and_overwrite >= 202110L)
+#   define BOOST_RANGEIO_RANGE_STRINGBUF_UNINITIALIZED_GROWTH
+#endif
+
+#include <boost/rangeio/detail/module_export.hpp>
+#include <boost/rangeio/detail/pmr.hpp>
+
+namespace boost {
+namespace rangeio {
+
+// Output string buffer.
+// 
+// Like std::basic_stringbuf in output mode, except that:
+//   * the contents can be accessed directly (via data() and size(), or
+//     view() in C++17), without making a copy;
+//   * release() moves the contents out as a string, without making a copy
+//     (the buffer's storage *is* a string, so the result is simply moved);
+//   * the initial capacity can be given up front, so that writes of a known
+//     approximate size do not need to grow the buffer at all;
+//   * clear() keeps the capacity, so a reused buffer stops allocating once it
+//     has grown large enough;
+//   * it is output-only, and seeking is only supported to query the current
+//     position.
+// 
+// All memory is allocated with Allocator (through the string). In C++17,
+// there are aliases in the pmr namespace that use
+// std::pmr::polymorphic_allocator.
+// 
+// When the buffer grows, the new capacity is at least double the old, and
+// the contents are copied once. In C++23 (with resize_and_overwrite()), the
+// new space is not otherwise touched; before that, the string has to fill it
+// with null characters first, which costs about as much as the copy.
+// 
+BOOST_RANGEIO_MODULE_EXPORT template <typename CharT, typename Traits = ::std::char_traits<CharT>, typename Allocator = ::std::allocator<CharT>>
+class basic_range_stringbuf :
+  public ::std::basic_streambuf<CharT, Traits>
+{
+public:
+  typedef CharT                                             char_type;
+  typedef Traits                                            traits_type;
+  typedef Allocator                                         allocator_type;
+  typedef typename Traits::int_type                         int_type;
+  typedef typename Traits::pos_type                         pos_type;
+  typedef typename Traits::off_type                         off_type;
+  
+  typedef ::std::basic_string<CharT, Traits, Allocator>     string_type;
+  typedef typename string_type::size_type                   size_type;
+
+#ifndef BOOST_NO_CXX17_HDR_STRING_VIEW
+  typedef ::std::basic_string_view<CharT, Traits>           string_view_type;
+#endif
+
+  basic_range_stringbuf() :
+    buffer_(Allocator())
+  {
+    reset_(0);
+  }
+  
+  explicit basic_range_stringbuf(Allocator const& a) :
+    buffer_(a)
+  {
+    reset_(0);
+  }
+  
+  // Creates a buffer with room for at least capacity_hint characters.
+  explicit basic_range_stringbuf(size_type capacity_hint, Allocator const& a = Allocator()) :
+    buffer_(a)
+  {
+    buffer_.reserve(capacity_hint);
+    reset_(0);
+  }
+  
+  basic_range_stringbuf(basic_range_stringbuf const&) = delete;
+  basic_range_stringbuf& operator=(basic_range_stringbuf const&) = delete;
+  
+  allocator_type get_allocator() const { return buffer_.get_allocator(); }
+  
+  CharT const* data() const { return this->pbase(); }
+  
+  size_type size() const { return size_type(this->pptr() - this->pbase()); }
+  
+  size_type capacity() const { return buffer_.size(); }
+
+#ifndef BOOST_NO_CXX17_HDR_STRING_VIEW
+  // The contents, valid until the next write or call to any non-const
+  // member function.
+  string_view_type view() const { return string_view_type(data(), size()); }
+#endif
+
+  // Discards the contents, keeping the capacity.
+  void clear() { reset_(0); }
+  
+  // Makes room for at least n characters in total.
+  void reserve(size_type n)
+  {
+    if (n > capacity())
+      grow_(n);
+  }
+  
+  // Moves the contents out as a string, and leaves the buffer empty (with
+  // only the string's minimum capacity).
+  string_type release()
+  {
+    buffer_.resize(size());
+    
+    string_type s(::std::move(buffer_));
+    
+    buffer_ = string_type(s.get_allocator());
+    reset_(0);
+    
+    return s;
+  }
+  
+protected:
+  int_type overflow(int_type c)
+  {
+    if (Traits::eq_int_type(c, Traits::eof()))
+      return Traits::not_eof(c);
+    
+    grow_(size() + 1);
+    
+    *this->pptr() = Traits::to_char_type(c);
+    this->pbump(1);
+    
+    return c;
+  }
+  
+  ::std::streamsize xsputn(CharT const* s, ::std::streamsize n)
+  {
+    if (n <= 0)
+      return 0;
+    
+    size_type const count = size_type(n);
+    
+    if (count > size_type(this->epptr() - this->pptr()))
+      grow_(size() + count);
+    
+    Traits::copy(this->pptr(), s, count);
+    advance_(count);
+    
+    return n;
+  }
+  
+  // Only supports querying the current output position, so that the number
+  // of characters written can be measured.
+  pos_type seekoff(off_type off, ::std::ios_base::seekdir dir, ::std::ios_base::openmode which)
+  {
+    if ((off == 0) && (dir == ::std::ios_base::cur) && (which & ::std::ios_base::out))
+      return pos_type(off_type(size()));
+    
+    return pos_type(off_type(-1));
+  }
+  
+private:
+  void grow_(size_type min_capacity)
+  {
+    size_type const old_size = size();
+    
+    size_type new_capacity = 2 * capacity();
+    if (new_capacity < min_capacity)
+      new_capacity = min_capacity;
+    
+    // Shrinking the string to the used size first means that only the
+    // contents are copied into the new storage. Then use all of the capacity
+    // the string actually got.
+    buffer_.resize(old_size);
+    buffer_.reserve(new_capacity);
+    
+    reset_(old_size);
+  }
+  
+  // Makes the whole of the string's capacity the put area, with the first n
+  // characters already written.
+  void reset_(size_type n)
+  {
+#ifdef BOOST_RANGEIO_RANGE_STRINGBUF_UNINITIALIZED_GROWTH
+    // Only the characters before the put pointer are ever read, so the rest
+    // can be left as they are.
+    buffer_.resize_and_overwrite(buffer_.capacity(), keep_all_());
+#else
+    buffer_.resize(buffer_.capacity());
+#endif
+
+    CharT* const p = &buffer_[0];
+    this->setp(p, p + buffer_.size());
+    advance_(n);
+  }
+
+#ifdef BOOST_RANGEIO_RANGE_STRINGBUF_UNINITIALIZED_GROWTH
+  // resize_and_overwrite() operation that keeps every character.
+  struct keep_all_
+  {
+    size_type operator()(CharT*, size_type count) const { return count; }
+  };
+#endif
+
+  // pbump() takes an int, so advance in int-sized steps.
+  void advance_(size_type n)
+  {
+    while (n > size_type(INT_MAX))
+    {
+      this->pbump(INT_MAX);
+      n -= size_type(INT_MAX);
+    }
+    
+    this->pbump(int(n));
+  }
+  
+  string_type buffer_;
+};
+
+BOOST_RANGEIO_MODULE_EXPORT typedef basic_range_stringbuf<char>     range_stringbuf;
+BOOST_RANGEIO_MODULE_EXPORT typedef basic_range_stringbuf<wchar_t>  wrange_stringbuf;
+
+// Output stream that writes to a basic_range_stringbuf.
+// 
+// The stream owns the buffer, and forwards the buffer's interface.
+// 
+BOOST_RANGEIO_MODULE_EXPORT template <typename CharT, typename Traits = ::std::char_traits<CharT>, typename Allocator = ::std::allocator<CharT>>
+class basic_range_ostream :
+  public ::std::basic_ostream<CharT, Traits>
+{
+public:
+  typedef basic_range_stringbuf<CharT, Traits, Allocator>  buffer_type;
+  typedef typename buffer_type::allocator_type             allocator_type;
+  typedef typename buffer_type::string_type                string_type;
+  typedef typename buffer_type::size_type                  size_type;
+
+#ifndef BOOST_NO_CXX17_HDR_STRING_VIEW
+  typedef typename buffer_type::string_view_type           string_view_type;
+#endif
+
+  basic_range_ostream() :
+    ::std::basic_ostream<CharT, Traits>(nullptr)
+  {
+    ::std::basic_ios<CharT, Traits>::rdbuf(&buffer_);
+  }
+  
+  explicit basic_range_ostream(Allocator const& a) :
+    ::std::basic_ostream<CharT, Traits>(nullptr),
+    buffer_(a)
+  {
+    ::std::basic_ios<CharT, Traits>::rdbuf(&buffer_);
+  }
+  
+  explicit basic_range_ostream(size_type capacity_hint, Allocator const& a = Allocator()) :
+    ::std::basic_ostream<CharT, Traits>(nullptr),
+    buffer_(capacity_hint, a)
+  {
+    ::std::basic_ios<CharT, Traits>::rdbuf(&buffer_);
+  }
+  
+  basic_range_ostream(basic_range_ostream const&) = delete;
+  basic_range_ostream& operator=(basic_range_ostream const&) = delete;
+  
+  buffer_type* rdbuf() const { return const_cast<buffer_type*>(&buffer_); }
+  
+  allocator_type get_allocator() const { return buffer_.get_allocator(); }
+  
+  CharT const* data() const { return buffer_.data(); }
+  size_type size() const { return buffer_.size(); }
+  size_type capacity() const { return buffer_.capacity(); }
+
+#ifndef BOOST_NO_CXX17_HDR_STRING_VIEW
+  string_view_type view() const { return buffer_.view(); }
+#endif
+
+  void reserve(size_type n) { buffer_.reserve(n); }
+  
+  // Discards the buffer's contents (keeping the capacity), and clears the
+  // stream's error state.
+  void clear_contents()
+  {
+    buffer_.clear();
+    this->clear();
+  }
+  
+  string_type release() { return buffer_.release(); }
+  
+private:
+  buffer_type buffer_;
+};
+
+BOOST_RANGEIO_MODULE_EXPORT typedef basic_range_ostream<char>     range_ostream;
+BOOST_RANGEIO_MODULE_EXPORT typedef basic_range_ostream<wchar_t>  wrange_ostream;
+
+#ifdef BOOST_RANGEIO_HAS_PMR
+
+namespace pmr {
+
+BOOST_RANGEIO_MODULE_EXPORT template <typename CharT, typename Traits = ::std::char_traits<CharT>>
+using basic_range_stringbuf = ::boost::rangeio::basic_range_stringbuf<CharT, Traits, ::std::pmr::polymorphic_allocator<CharT>>;
+
+BOOST_RANGEIO_MODULE_EXPORT template <typename CharT, typename Traits = ::std::char_traits<CharT>>
+using basic_range_ostream = ::boost::rangeio::basic_range_ostream<CharT, Traits, ::std::pmr::polymorphic_allocator<CharT>>;
+
+BOOST_RANGEIO_MODULE_EXPORT typedef basic_range_stringbuf<char>     range_stringbuf;
+BOOST_RANGEIO_MODULE_EXPORT typedef basic_range_stringbuf<wchar_t>  wrange_stringbuf;
+
+BOOST_RANGEIO_MODULE_EXPORT typedef basic_range_ostream<char>     range_ostream;
+BOOST_RANGEIO_MODULE_EXPORT typedef basic_range_ostream<wchar_t>  wrange_ostream;
+
+} // namespace pmr
+
+#endif // BOOST_RANGEIO_HAS_PMR
+
+} // namespace rangeio
+} // namespace boost
+
+#endif  // BOOST_NO_CXX11_RVALUE_REFERENCES
+#endif  // include guard
@@ -0,0 +1,575 @@
+//
+// Copyright (c) Mark A. Gibbs, 2015.
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+// 
+
+// Defines ring_sink, an asynchronous sink that writes ranges as records to a
+// file descriptor.
+// 
+// Requires at least C++11, and a POSIX system.
+
+#ifndef BOOST_RANGEIO_Inc_ring_sink_2015_01_01_
+#define BOOST_RANGEIO_Inc_ring_sink_2015_01_01_
+
+#include <boost/config.hpp>
+
+#ifdef BOOST_NO_CXX11_RVALUE_REFERENCES
+#   error "C++98 is not supported"
+#else
+
+#if !defined(BOOST_HAS_UNISTD_H)
+#   error "ring_sink requires a POSIX system"
+#endif
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <ios>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <streambuf>
+#include <thread>
+
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <boost/rangeio/detail/module_export.hpp>
+#include <boost/rangeio/detail/mpsc_ring.hpp>
+#include <boost/rangeio/detail/write.hpp>
+
+namespace boost {
+namespace rangeio {
+
+// What a ring_sink does when a record is written while the ring is full.
+//   drop:  the record is discarded (and counted), and write() returns false
+//          immediately.
+//   block: write() waits until the consumer frees a slot.
+BOOST_RANGEIO_MODULE_EXPORT enum class ring_sink_full_policy
+{
+  drop,
+  block
+};
+
+// Configuration for a ring_sink.
+// 
+// Has three public data members:
+//   slot_count:   the number of slots in the ring (rounded up to a power of
+//                 two).
+//   slot_size:    the size of each slot in bytes, which is the maximum size
+//                 of a record (including its terminator).
+//   full_policy:  what to do when the ring is full.
+BOOST_RANGEIO_MODULE_EXPORT struct ring_sink_options
+{
+  ring_sink_options() :
+    slot_count(1024),
+    slot_size(512),
+    full_policy(ring_sink_full_policy::drop)
+  {}
+  
+  ::std::size_t          slot_count;
+  ::std::size_t          slot_size;
+  ring_sink_full_policy  full_policy;
+};
+
+// A snapshot of a ring_sink's counters.
+// 
+// Has six public data members:
+//   written:       the number of records written to the file descriptor.
+//   dropped:       the number of records dropped because the ring was full
+//                  (drop policy only).
+//   blocked:       the number of writes that had to wait for a free slot
+//                  (block policy only).
+//   truncated:     the number of records that did not fit in a slot, and were
+//                  truncated.
+//   write_errors:  the number of records lost because writing to the file
+//                  descriptor failed.
+//   abandoned:     the number of records abandoned because an element's
+//                  inserter threw an exception.
+BOOST_RANGEIO_MODULE_EXPORT struct ring_sink_counters
+{
+  ::std::uint64_t  written;
+  ::std::uint64_t  dropped;
+  ::std::uint64_t  blocked;
+  ::std::uint64_t  truncated;
+  ::std::uint64_t  write_errors;
+  ::std::uint64_t  abandoned;
+};
+
+namespace detail {
+
+// Stream buffer that writes into a ring slot, and fails when it is full.
+class ring_slot_streambuf :
+  public ::std::streambuf
+{
+public:
+  ring_slot_streambuf() :
+    overflowed_(false)
+  {}
+  
+  void reset(char* p, ::std::size_t n)
+  {
+    setp(p, p + n);
+    overflowed_ = false;
+  }
+  
+  ::std::size_t size() const { return ::std::size_t(pptr() - pbase()); }
+  
+  bool overflowed() const { return overflowed_; }
+  
+protected:
+  int_type overflow(int_type c)
+  {
+    if (!traits_type::eq_int_type(c, traits_type::eof()))
+      overflowed_ = true;
+    
+    return traits_type::eof();
+  }
+  
+  ::std::streamsize xsputn(char const* s, ::std::streamsize n)
+  {
+    ::std::streamsize const room = ::std::streamsize(epptr() - pptr());
+    
+    if (n > room)
+    {
+      overflowed_ = true;
+      n = room;
+    }
+    
+    traits_type::copy(pptr(), s, ::std::size_t(n));
+    pbump(int(n));
+    
+    return n;
+  }
+  
+private:
+  bool overflowed_;
+};
+
+// The stream used by a thread to format records into ring slots.
+// 
+// Each thread has one that is reused for every record. If an element's
+// inserter itself writes to a ring_sink (so the thread's formatter is already
+// in use), a temporary formatter is used instead.
+class ring_sink_formatter
+{
+public:
+  ring_sink_formatter() :
+    stream(&buffer),
+    busy(false)
+  {}
+  
+  ring_sink_formatter(ring_sink_formatter const&) = delete;
+  ring_sink_formatter& operator=(ring_sink_formatter const&) = delete;
+  
+  static ring_sink_formatter& this_thread()
+  {
+    static thread_local ring_sink_formatter formatter;
+    return formatter;
+  }
+  
+  // Prepares the stream to format into the n bytes at p, with the default
+  // formatting state.
+  ::std::ostream& prepare(char* p, ::std::size_t n)
+  {
+    buffer.reset(p, n);
+    
+    stream.clear();
+    stream.flags(::std::ios_base::skipws | ::std::ios_base::dec);
+    stream.precision(6);
+    stream.fill(' ');
+    stream.width(0);
+    
+    return stream;
+  }
+  
+  ring_slot_streambuf  buffer;
+  ::std::ostream       stream;
+  bool                 busy;
+};
+
+} // namespace detail
+
+// 
+// Asynchronous sink that writes ranges as records to a file descriptor.
+// 
+// Each call to write() formats a range - exactly as write_iterator_range()
+// would, with the default stream formatting state and the stream's default
+// locale - directly into a slot of a bounded lock-free ring, followed by a
+// newline. A single background thread takes the records from the ring in
+// order and writes them to the file descriptor, batching consecutive records
+// into a single writev() call.
+// 
+// Producers never take a lock or make a system call unless the consumer is
+// asleep (in which case it is woken with a condition variable), or the ring
+// is full and the policy is to block.
+// 
+// Records longer than a slot are truncated (and counted). If an element's
+// inserter throws an exception, the exception propagates out of write(), and
+// the record is abandoned (and counted): nothing is written for it, but its
+// slot is still handed to the consumer, so the records after it are not held
+// up. The sink does not own the file descriptor.
+// 
+// The destructor writes all records that have been published, then stops the
+// consumer thread. There must be no writes in progress when the sink is
+// destroyed.
+// 
+BOOST_RANGEIO_MODULE_EXPORT class ring_sink
+{
+public:
+  explicit ring_sink(int fd, ring_sink_options const& options = ring_sink_options()) :
+    fd_(fd),
+    full_policy_(options.full_policy),
+    ring_(options.slot_count, (options.slot_size < 2) ? 2 : options.slot_size),
+    stop_(false),
+    consumer_sleeping_(false),
+    written_(0),
+    dropped_(0),
+    blocked_(0),
+    truncated_(0),
+    write_errors_(0),
+    abandoned_(0)
+  {
+    consumer_ = ::std::thread([this] { consume_(); });
+  }
+  
+  ~ring_sink()
+  {
+    {
+      ::std::lock_guard< ::std::mutex> const lock(mutex_);
+      stop_.store(true, ::std::memory_order_release);
+    }
+    
+    wakeup_.notify_one();
+    consumer_.join();
+  }
+  
+  ring_sink(ring_sink const&) = delete;
+  ring_sink& operator=(ring_sink const&) = delete;
+  
+  // Writes a range as a record.
+  // 
+  // Returns true if the record was queued, or false if it was dropped because
+  // the ring was full.
+  // 
+  // There are two versions - one with a delimiter, and one without.
+  template <typename InputIterator, typename Sentinel, typename Delimiter>
+  bool write(InputIterator i, Sentinel const e, Delimiter&& d)
+  {
+    detail::mpsc_ring::slot s;
+    if (!claim_(s))
+      return false;
+    
+    claimed_slot claim(*this, s);
+    
+    formatting_scope scope;
+    ::std::ostream& out = scope.formatter().prepare(s.data, ring_.slot_size() - 1);
+    
+    ::std::size_t n = 0;
+    detail::write_impl(out, i, e, d, n);
+    
+    claim.publish(scope.formatter().buffer);
+    return true;
+  }
+  
+  template <typename InputIterator, typename Sentinel>
+  bool write(InputIterator i, Sentinel const e)
+  {
+    detail::mpsc_ring::slot s;
+    if (!claim_(s))
+      return false;
+    
+    claimed_slot claim(*this, s);
+    
+    formatting_scope scope;
+    ::std::ostream& out = scope.formatter().prepare(s.data, ring_.slot_size() - 1);
+    
+    ::std::size_t n = 0;
+    detail::write_impl(out, i, e, n);
+    
+    claim.publish(scope.formatter().buffer);
+    return true;
+  }
+  
+  // Waits until every record queued before the call has been written (or
+  // lost to a write error).
+  void flush()
+  {
+    ::std::size_t const target = ring_.enqueue_position();
+    
+    while (::std::ptrdiff_t(ring_.dequeue_position() - target) < 0)
+    {
+      if (consumer_sleeping_.load(::std::memory_order_relaxed))
+        wake_consumer_();
+      
+      ::std::this_thread::yield();
+    }
+  }
+  
+  ring_sink_counters counters() const
+  {
+    ring_sink_counters c;
+    
+    c.written = written_.load(::std::memory_order_relaxed);
+    c.dropped = dropped_.load(::std::memory_order_relaxed);
+    c.blocked = blocked_.load(::std::memory_order_relaxed);
+    c.truncated = truncated_.load(::std::memory_order_relaxed);
+    c.write_errors = write_errors_.load(::std::memory_order_relaxed);
+    c.abandoned = abandoned_.load(::std::memory_order_relaxed);
+    
+    return c;
+  }
+  
+private:
+  // Acquires a formatter for the duration of a write.
+  class formatting_scope
+  {
+  public:
+    formatting_scope() :
+      formatter_(&detail::ring_sink_formatter::this_thread())
+    {
+      if (formatter_->busy)
+      {
+        temporary_.reset(new detail::ring_sink_formatter());
+        formatter_ = temporary_.get();
+      }
+      
+      formatter_->busy = true;
+    }
+    
+    ~formatting_scope()
+    {
+      formatter_->busy = false;
+    }
+    
+    detail::ring_sink_formatter& formatter() { return *formatter_; }
+    
+  private:
+    detail::ring_sink_formatter*                    formatter_;
+    ::std::unique_ptr<detail::ring_sink_formatter>  temporary_;
+  };
+  
+  // Publishes a claimed slot when it is destroyed: with the formatted record,
+  // if publish() was called, or otherwise (if formatting the record threw an
+  // exception) as an abandoned record. Every claimed slot must be published,
+  // because the consumer (and flush()) wait for the slots in claim order.
+  class claimed_slot
+  {
+  public:
+    claimed_slot(ring_sink& sink, detail::mpsc_ring::slot const& s) :
+      sink_(sink),
+      slot_(s),
+      published_(false)
+    {}
+    
+    ~claimed_slot()
+    {
+      if (!published_)
+        sink_.abandon_(slot_);
+    }
+    
+    claimed_slot(claimed_slot const&) = delete;
+    claimed_slot& operator=(claimed_slot const&) = delete;
+    
+    void publish(detail::ring_slot_streambuf const& buffer)
+    {
+      sink_.publish_(slot_, buffer);
+      published_ = true;
+    }
+    
+  private:
+    ring_sink&                      sink_;
+    detail::mpsc_ring::slot const&  slot_;
+    bool                            published_;
+  };
+  
+  bool claim_(detail::mpsc_ring::slot& s)
+  {
+    if (ring_.try_claim(s))
+      return true;
+    
+    if (full_policy_ == ring_sink_full_policy::drop)
+    {
+      dropped_.fetch_add(1, ::std::memory_order_relaxed);
+      return false;
+    }
+    
+    blocked_.fetch_add(1, ::std::memory_order_relaxed);
+    
+    do
+    {
+      if (consumer_sleeping_.load(::std::memory_order_relaxed))
+        wake_consumer_();
+      
+      ::std::this_thread::yield();
+    } while (!ring_.try_claim(s));
+    
+    return true;
+  }
+  
+  void publish_(detail::mpsc_ring::slot const& s, detail::ring_slot_streambuf const& buffer)
+  {
+    ::std::size_t size = buffer.size();
+    
+    if (buffer.overflowed())
+      truncated_.fetch_add(1, ::std::memory_order_relaxed);
+    
+    s.data[size++] = '\n';
+    
+    publish_record_(s, size);
+  }
+  
+  // Publishes a claimed slot as an abandoned record, which is an empty one
+  // (the consumer skips them, so every real record is at least a newline).
+  void abandon_(detail::mpsc_ring::slot const& s)
+  {
+    abandoned_.fetch_add(1, ::std::memory_order_relaxed);
+    
+    publish_record_(s, 0);
+  }
+  
+  void publish_record_(detail::mpsc_ring::slot const& s, ::std::size_t size)
+  {
+    ring_.publish(s, size);
+    
+    // Pairs with the fence in consume_(): either the consumer sees the
+    // published slot, or this sees that the consumer is asleep (or both).
+    ::std::atomic_thread_fence(::std::memory_order_seq_cst);
+    
+    if (consumer_sleeping_.load(::std::memory_order_relaxed))
+      wake_consumer_();
+  }
+  
+  void wake_consumer_()
+  {
+    {
+      ::std::lock_guard< ::std::mutex> const lock(mutex_);
+    }
+    
+    wakeup_.notify_one();
+  }
+  
+  void consume_()
+  {
+    // Records are written in batches of up to max_batch.
+    static ::std::size_t const max_batch = 64;
+    
+    ::iovec iov[max_batch];
+    
+    for (;;)
+    {
+      ::std::size_t batch = 0;
+      ::std::size_t records = 0;
+      
+      detail::mpsc_ring::slot s;
+      while ((batch != max_batch) && ring_.peek(s, batch))
+      {
+        ++batch;
+        
+        // Skip abandoned records (see abandon_()).
+        if (s.size == 0)
+          continue;
+        
+        iov[records].iov_base = s.data;
+        iov[records].iov_len = s.size;
+        ++records;
+      }
+      
+      if (batch != 0)
+      {
+        if (write_all_(iov, records))
+          written_.fetch_add(records, ::std::memory_order_relaxed);
+        else
+          write_errors_.fetch_add(records, ::std::memory_order_relaxed);
+        
+        ring_.release(batch);
+        continue;
+      }
+      
+      if (stop_.load(::std::memory_order_acquire))
+      {
+        // Make sure nothing was published between the last check and the
+        // stop flag being seen.
+        if (!ring_.peek(s))
+          return;
+        
+        continue;
+      }
+      
+      // Nothing to do, so sleep until woken (with a timeout, as a safety
+      // net).
+      ::std::unique_lock< ::std::mutex> lock(mutex_);
+      
+      consumer_sleeping_.store(true, ::std::memory_order_relaxed);
+      ::std::atomic_thread_fence(::std::memory_order_seq_cst);
+      
+      if (!ring_.peek(s) && !stop_.load(::std::memory_order_acquire))
+        wakeup_.wait_for(lock, ::std::chrono::milliseconds(10));
+      
+      consumer_sleeping_.store(false, ::std::memory_order_relaxed);
+    }
+  }
+  
+  // Writes all of the buffers, handling partial writes and interruptions.
+  bool write_all_(::iovec* iov, ::std::size_t count)
+  {
+    while (count != 0)
+    {
+      ::ssize_t const n = ::writev(fd_, iov, int(count));
+      
+      if (n < 0)
+      {
+        if (errno == EINTR)
+          continue;
+        
+        return false;
+      }
+      
+      ::std::size_t remaining = ::std::size_t(n);
+      
+      while ((count != 0) && (remaining >= iov->iov_len))
+      {
+        remaining -= iov->iov_len;
+        ++iov;
+        --count;
+      }
+      
+      if (count != 0)
+      {
+        iov->iov_base = static_cast<char*>(iov->iov_base) + remaining;
+        iov->iov_len -= remaining;
+      }
+    }
+    
+    return true;
+  }
+  
+  int const                        fd_;
+  ring_sink_full_policy const      full_policy_;
+  
+  detail::mpsc_ring                ring_;
+  
+  ::std::thread                    consumer_;
+  ::std::mutex                     mutex_;
+  ::std::condition_variable        wakeup_;
+  ::std::atomic<bool>              stop_;
+  ::std::atomic<bool>              consumer_sleeping_;
+  
+  ::std::atomic< ::std::uint64_t>  written_;
+  ::std::atomic< ::std::uint64_t>  dropped_;
+  ::std::atomic< ::std::uint64_t>  blocked_;
+  ::std::atomic< ::std::uint64_t>  truncated_;
+  ::std::atomic< ::std::uint64_t>  write_errors_;
+  ::std::atomic< ::std::uint64_t>  abandoned_;
+};
+
+} // namespace rangeio
+} // namespace boost
+
+#endif  // BOOST_NO_CXX11_RVALUE_REFERENCES
+#endif  // include guard
@@ -0,0 +1,85 @@
+//
+// Copyright (c) Mark A. Gibbs, 2015.
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+// 
+
+// Defines the functions that control the per-thread scratch memory used by
+// the buffered write functions (such as write_iterator_range_atomic()).
+// 
+// Requires at least C++11.
+
+#ifndef BOOST_RANGEIO_Inc_scratch_memory_2015_01_01_
+#define BOOST_RANGEIO_Inc_scratch_memory_2015_01_01_
+
+#include <boost/config.hpp>
+
+#ifdef BOOST_NO_CXX11_RVALUE_REFERENCES
+#   error "C++98 is not supported"
+#else
+
+#include <cstddef>
+
+#include <boost/rangeio/detail/module_export.hpp>
+#include <boost/rangeio/detail/scratch_arena.hpp>
+
+namespace boost {
+namespace rangeio {
+
+// Scratch memory.
+// 
+// Write functions that must format a range before writing it (rather than
+// writing it directly to the stream) format it into scratch memory. Each
+// thread has its own scratch memory, which keeps its capacity between writes,
+// so after the first few writes on a thread, formatting never allocates.
+// 
+// The memory is held until the thread exits, or until it is released by one
+// of these functions:
+//   release_scratch_memory():      frees the calling thread's scratch memory
+//                                  (except any that is in use, if called
+//                                  while a write is in progress).
+//   release_idle_scratch_memory(): frees the scratch memory of every thread
+//                                  that has not done a buffered write since
+//                                  the previous call. Calling it periodically
+//                                  (say, once a minute) from a maintenance
+//                                  thread returns the memory of idle threads
+//                                  without affecting busy threads.
+// Both return the number of bytes freed.
+// 
+// In addition, when a write uses more scratch memory than the retain limit
+// (1 MiB by default), that memory is freed as soon as the write is done, so
+// that occasional huge writes do not pin their memory.
+// 
+BOOST_RANGEIO_MODULE_EXPORT inline ::std::size_t release_scratch_memory()
+{
+  return detail::scratch_arena::this_thread().release();
+}
+
+BOOST_RANGEIO_MODULE_EXPORT inline ::std::size_t release_idle_scratch_memory()
+{
+  return detail::scratch_arena::release_idle();
+}
+
+// The number of bytes of scratch memory held by the calling thread.
+BOOST_RANGEIO_MODULE_EXPORT inline ::std::size_t scratch_memory_size()
+{
+  return detail::scratch_arena::this_thread().capacity();
+}
+
+// The retain limit, in bytes (see above).
+BOOST_RANGEIO_MODULE_EXPORT inline ::std::size_t scratch_memory_retain_limit()
+{
+  return detail::scratch_retain_limit().load(::std::memory_order_relaxed);
+}
+
+BOOST_RANGEIO_MODULE_EXPORT inline void set_scratch_memory_retain_limit(::std::size_t n)
+{
+  detail::scratch_retain_limit().store(n, ::std::memory_order_relaxed);
+}
+
+} // namespace rangeio
+} // namespace boost
+
+#endif  // BOOST_NO_CXX11_RVALUE_REFERENCES
+#endif  // include guard
@@ -0,0 +1,97 @@
+//
+// Copyright (c) Mark A. Gibbs, 2015.
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+// 
+
+// Defines the segmented_iterator_traits customization point.
+// 
+// A segmented iterator is an iterator into a container that is not
+// contiguous as a whole, but is made up of a sequence of contiguous (or at
+// least simple) segments - std::deque, ropes, lists of blocks, and so on.
+// When a range is described by two segmented iterators of the same type, the
+// write functions write it segment by segment, using the (much cheaper) local
+// iterators within each segment.
+// 
+// (This follows the design described in Matthew Austern's "Segmented
+// Iterators and Hierarchical Algorithms".)
+// 
+// This file is written to be C++98-safe.
+
+#ifndef BOOST_RANGEIO_Inc_segmented_iterator_traits_2015_01_01_
+#define BOOST_RANGEIO_Inc_segmented_iterator_traits_2015_01_01_
+
+#include <boost/config.hpp>
+
+#include <boost/rangeio/detail/module_export.hpp>
+
+#include <boost/type_traits/integral_constant.hpp>
+
+#if defined(BOOST_LIBSTDCXX_VERSION)
+#   include <deque>
+#endif
+
+namespace boost {
+namespace rangeio {
+
+// Traits class for segmented iterators.
+// 
+// The primary template describes a non-segmented iterator. To mark an
+// iterator type as segmented, specialize this template with the following
+// members:
+//   is_segmented_iterator:
+//     Typedef for boost::true_type.
+//   segment_iterator:
+//     Type of an iterator over the segments. Must be EqualityComparable and
+//     incrementable.
+//   local_iterator:
+//     Type of an iterator over the elements within a segment (ideally a
+//     pointer).
+//   static segment_iterator segment(Iterator i):
+//     Returns the segment that i points into.
+//   static local_iterator local(Iterator i):
+//     Returns the position of i within its segment.
+//   static local_iterator begin(segment_iterator s):
+//     Returns the first position in segment s.
+//   static local_iterator end(segment_iterator s):
+//     Returns the one-past-the-end position in segment s.
+//   static Iterator compose(segment_iterator s, local_iterator l):
+//     Returns the iterator for position l within segment s.
+// 
+BOOST_RANGEIO_MODULE_EXPORT template <typename Iterator>
+struct segmented_iterator_traits
+{
+  typedef ::boost::false_type is_segmented_iterator;
+};
+
+#if defined(BOOST_LIBSTDCXX_VERSION)
+
+// Specialization for std::deque iterators in libstdc++.
+// 
+// Each segment is one of the deque's fixed-size element blocks.
+template <typename T, typename Reference, typename Pointer>
+struct segmented_iterator_traits< ::std::_Deque_iterator<T, Reference, Pointer> >
+{
+  typedef ::boost::true_type is_segmented_iterator;
+  
+  typedef ::std::_Deque_iterator<T, Reference, Pointer> iterator;
+  
+  typedef typename iterator::_Map_pointer  segment_iterator;
+  typedef typename iterator::_Elt_pointer  local_iterator;
+  
+  static segment_iterator segment(iterator const& i) { return i._M_node; }
+  static local_iterator local(iterator const& i) { return i._M_cur; }
+  
+  static local_iterator begin(segment_iterator s) { return *s; }
+  static local_iterator end(segment_iterator s) { return *s + iterator::_S_buffer_size(); }
+  
+  static iterator compose(segment_iterator s, local_iterator l) { return iterator(l, s); }
+};
+
+#endif // BOOST_LIBSTDCXX_VERSION
+
+} // namespace rangeio
+} // namespace boost
+
+#endif  // include guard
@@ -0,0 +1,89 @@
+//
+// Copyright (c) Mark A. Gibbs, 2015.
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+// 
+
+// Defines special sentinel types that can be used to mark the end of a range
+// in the write functions.
+// 
+// This file is written to be C++98-safe.
+
+#ifndef BOOST_RANGEIO_Inc_sentinels_2015_01_01_
+#define BOOST_RANGEIO_Inc_sentinels_2015_01_01_
+
+#include <boost/config.hpp>
+
+#include <boost/rangeio/detail/module_export.hpp>
+
+#include <iterator>
+
+namespace boost {
+namespace rangeio {
+
+// Sentinel that never compares equal to any iterator.
+// 
+// A range ending in unreachable_sentinel is written until the output stream
+// fails. To write a fixed number of elements from an iterator without an
+// end, use write_iterator_range_n() instead - that uses a plain counter to
+// find the end, rather than comparing iterators.
+// 
+BOOST_RANGEIO_MODULE_EXPORT struct unreachable_sentinel_t {};
+
+BOOST_RANGEIO_MODULE_EXPORT BOOST_INLINE_VARIABLE unreachable_sentinel_t const unreachable_sentinel = unreachable_sentinel_t();
+
+BOOST_RANGEIO_MODULE_EXPORT template <typename Iterator>
+bool operator==(Iterator const&, unreachable_sentinel_t) { return false; }
+
+BOOST_RANGEIO_MODULE_EXPORT template <typename Iterator>
+bool operator==(unreachable_sentinel_t, Iterator const&) { return false; }
+
+BOOST_RANGEIO_MODULE_EXPORT template <typename Iterator>
+bool operator!=(Iterator const&, unreachable_sentinel_t) { return true; }
+
+BOOST_RANGEIO_MODULE_EXPORT template <typename Iterator>
+bool operator!=(unreachable_sentinel_t, Iterator const&) { return true; }
+
+// Sentinel for null-terminated sequences (such as C strings).
+// 
+// Compares equal to an iterator when the element it refers to is equal to a
+// value-initialized element (for example, '\0' for a char).
+// 
+// When the iterator is a pointer, the write functions find the end of the
+// sequence up front - using std::char_traits<CharT>::length() (which is
+// usually a vectorized strlen()) for character types - and then write a
+// counted range, rather than testing each element as it is written.
+// 
+BOOST_RANGEIO_MODULE_EXPORT struct null_terminated_t {};
+
+BOOST_RANGEIO_MODULE_EXPORT BOOST_INLINE_VARIABLE null_terminated_t const null_terminated = null_terminated_t();
+
+BOOST_RANGEIO_MODULE_EXPORT template <typename Iterator>
+bool operator==(Iterator const& i, null_terminated_t)
+{
+  return *i == typename ::std::iterator_traits<Iterator>::value_type();
+}
+
+BOOST_RANGEIO_MODULE_EXPORT template <typename Iterator>
+bool operator==(null_terminated_t, Iterator const& i)
+{
+  return i == null_terminated_t();
+}
+
+BOOST_RANGEIO_MODULE_EXPORT template <typename Iterator>
+bool operator!=(Iterator const& i, null_terminated_t)
+{
+  return !(i == null_terminated_t());
+}
+
+BOOST_RANGEIO_MODULE_EXPORT template <typename Iterator>
+bool operator!=(null_terminated_t, Iterator const& i)
+{
+  return !(i == null_terminated_t());
+}
+
+} // namespace rangeio
+} // namespace boost
+
+#endif  // include guard
@@ -0,0 +1,293 @@
+//
+// Copyright (c) Mark A. Gibbs, 2015.
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+// 
+
+// Defines the write_hex() functions, which write contiguous ranges of bytes
+// or integers in hex (or binary), and hex_format, which describes the
+// layout.
+// 
+// Requires at least C++11.
+
+#ifndef BOOST_RANGEIO_Inc_write_hex_2015_01_01_
+#define BOOST_RANGEIO_Inc_write_hex_2015_01_01_
+
+#include <boost/config.hpp>
+
+#ifdef BOOST_NO_CXX11_RVALUE_REFERENCES
+#   error "C++98 is not supported"
+#else
+
+#include <cstddef>
+#include <cstring>
+#include <ios>
+#include <locale>
+#include <ostream>
+#include <type_traits>
+
+#include <boost/core/enable_if.hpp>
+
+#include <boost/rangeio/detail/batch_output.hpp>
+#include <boost/rangeio/detail/hex.hpp>
+#include <boost/rangeio/detail/module_export.hpp>
+#include <boost/rangeio/write_iterator_range.hpp>
+
+namespace boost {
+namespace rangeio {
+
+// Layout of the output of write_hex().
+// 
+// The default is the plain hex dump of a hash or a key: every element written
+// with all of its digits (two per byte), in lowercase, with nothing between
+// the elements.
+// 
+// Members:
+//   binary:          if true, elements are written in binary (base 2)
+//                    rather than hex, and all the other members apply to the
+//                    binary digits.
+//   width:           minimum number of digits per element. When zero_fill is
+//                    true, 0 means all the digits of the element type (so
+//                    every element is the same width).
+//   zero_fill:       if true, elements are padded to width with leading
+//                    zeros; otherwise, leading zeros are dropped and elements
+//                    are padded to width with leading spaces.
+//   uppercase:       if true, the digits A to F are written in uppercase.
+//   group:           number of elements per group, or 0 for no grouping.
+//   separator:       written between elements.
+//   group_separator: written between groups, instead of separator.
+// 
+// For example, a hex dump with a space between bytes, an extra space between
+// groups of 8, and 16 bytes per line, is written with:
+// 
+//   hex_format f;
+//   f.separator = " ";
+//   f.group = 8;
+//   f.group_separator = "  ";
+//   // ... then one write_hex() per line of 16 bytes.
+// 
+// The separators must outlive the write.
+// 
+BOOST_RANGEIO_MODULE_EXPORT struct hex_format
+{
+  hex_format() :
+    binary(false),
+    width(0),
+    zero_fill(true),
+    uppercase(false),
+    group(0),
+    separator(""),
+    group_separator("")
+  {}
+  
+  bool           binary;
+  ::std::size_t  width;
+  bool           zero_fill;
+  bool           uppercase;
+  ::std::size_t  group;
+  char const*    separator;
+  char const*    group_separator;
+};
+
+namespace detail {
+
+// Tests whether T can be written by write_hex(): all integer types except
+// bool.
+template <typename T>
+struct is_hex_element :
+  ::std::integral_constant<bool,
+    ::std::is_integral<T>::value &&
+    !::std::is_same<typename ::std::remove_cv<T>::type, bool>::value>
+{};
+
+// Appends the narrow string s, widened with ct, to out.
+template <typename CharT, typename Traits, ::std::size_t N>
+bool append_widened(batch_output<CharT, Traits, N>& out, ::std::ctype<CharT> const& ct, char const* s, ::std::size_t n)
+{
+  while (n != 0)
+  {
+    if ((out.space() == 0) && !out.flush())
+      return false;
+    
+    ::std::size_t const k = (n < out.space()) ? n : out.space();
+    ct.widen(s, s + k, out.position());
+    out.commit(k);
+    
+    s += k;
+    n -= k;
+  }
+  
+  return !out.failed();
+}
+
+// Underlying implementation function for write_hex().
+// 
+// Formats the elements [i, e) in hex or binary, according to f, into a batch_output
+// that writes to out's stream buffer. On return, n is the number of elements
+// completely handed to the stream buffer, and i refers to the first element
+// that was not. If the stream buffer fails, out's badbit is set. As with
+// write_impl(), the stream's width is reset to zero.
+// 
+// Bytes written with all their digits and no separators - the common case
+// of a hash or a key - are encoded in bulk with hex_encode_bytes(), which is
+// vectorized where possible (see detail/simd.hpp). Everything else is
+// encoded element by element.
+template <typename T, typename CharT, typename Traits>
+void hex_write_impl(
+  ::std::basic_ostream<CharT, Traits>& out,
+  T const*& i,
+  T const* const e,
+  ::std::size_t& n,
+  hex_format const& f)
+{
+  typedef typename ::std::make_unsigned<typename ::std::remove_cv<T>::type>::type unsigned_type;
+  
+  ::std::ios_base::iostate state = ::std::ios_base::goodbit;
+  
+  if ((i != e) && bool(out))
+  {
+    typename ::std::basic_ostream<CharT, Traits>::sentry const sentry(out);
+    
+    if (sentry)
+    {
+      ::std::ctype<CharT> const& ct = ::std::use_facet< ::std::ctype<CharT>>(out.getloc());
+      
+      CharT digits[16];
+      char const* const narrow_digits = detail::hex_digits(f.uppercase);
+      ct.widen(narrow_digits, narrow_digits + 16, digits);
+      
+      char const* const separator = f.separator ? f.separator : "";
+      char const* const group_separator = f.group_separator ? f.group_separator : "";
+      
+      ::std::size_t const separator_size = ::std::strlen(separator);
+      ::std::size_t const group_separator_size = ::std::strlen(group_separator);
+      
+      ::std::size_t const all_digits = (f.binary ? 8 : 2) * sizeof(T);
+      
+      detail::batch_output<CharT, Traits> batch(out);
+      
+      T const* p = i;
+      
+      if ((sizeof(T) == 1) && !f.binary && f.zero_fill && ((f.width == 0) || (f.width == 2)) &&
+        (separator_size == 0) && ((f.group == 0) || (group_separator_size == 0)))
+      {
+        while ((p != e) && batch.reserve(2))
+        {
+          ::std::size_t const available = batch.space() / 2;
+          ::std::size_t const k = (::std::size_t(e - p) < available) ? ::std::size_t(e - p) : available;
+          
+          detail::hex_encode_bytes(reinterpret_cast<unsigned char const*>(p), k, batch.position(), digits);
+          batch.commit(2 * k);
+          batch.end_groups(k, 2, 1);
+          
+          p += k;
+        }
+      }
+      else
+      {
+        CharT const space = ct.widen(' ');
+        
+        for (::std::size_t index = 0; p != e; ++p, ++index)
+        {
+          if (index != 0)
+          {
+            bool const group_start = (f.group != 0) && ((index % f.group) == 0);
+            
+            if (!(group_start ?
+                detail::append_widened(batch, ct, group_separator, group_separator_size) :
+                detail::append_widened(batch, ct, separator, separator_size)))
+              break;
+          }
+          
+          unsigned_type const v = unsigned_type(*p);
+          ::std::size_t const length = f.binary ? detail::binary_length(v) : detail::hex_length(v);
+          
+          if (f.zero_fill)
+          {
+            ::std::size_t const width = (f.width == 0) ? all_digits : f.width;
+            
+            if ((width > length) && !batch.append(width - length, digits[0]))
+              break;
+          }
+          else if ((f.width > length) && !batch.append(f.width - length, space))
+          {
+            break;
+          }
+          
+          if (!batch.reserve(length))
+            break;
+          
+          if (f.binary)
+            detail::binary_encode_integer(v, length, batch.position(), digits);
+          else
+            detail::hex_encode_integer(v, length, batch.position(), digits);
+          
+          batch.commit(length);
+          batch.end_element();
+        }
+      }
+      
+      if (!batch.flush())
+        state |= ::std::ios_base::badbit;
+      
+      n += batch.elements();
+      i += batch.elements();
+    }
+  }
+  
+  // Regardless of anything else, reset the stream's width to zero.
+  out.width(0);
+  
+  // This may throw, if out has exceptions enabled.
+  if (state != ::std::ios_base::goodbit)
+    out.setstate(state);
+}
+
+} // namespace detail
+
+// Hex write_hex().
+// 
+// These versions of write_hex take an ostream& as their first argument, and
+// a contiguous range of integers (such as bytes) - either as a pair of
+// pointers, or a pointer and a count - and write every element in hex (or in
+// binary, if f.binary is set), laid out as f describes, returning a struct with info about how it went.
+// 
+// Unlike "out << std::hex" and write_iterator_range(), this writes bytes
+// (including char) as numbers rather than characters, and ignores the
+// stream's formatting flags, fill character and locale (except for widening
+// the characters). Signed integers are written as their unsigned
+// representation (so -1 as a signed char is "ff").
+// 
+// The output is formatted in batches into a local buffer, which is handed to
+// the stream buffer with a single sputn() each time it fills. If the stream
+// buffer fails, the result's count is the number of elements whose output was
+// completely handed to it.
+// 
+BOOST_RANGEIO_MODULE_EXPORT template <typename T, typename CharT, typename Traits>
+typename ::boost::enable_if_c<
+  detail::is_hex_element<T>::value,
+  write_iterator_range_result_t<T const*>>::type
+write_hex(::std::basic_ostream<CharT, Traits>& o, T const* first, T const* last, hex_format const& f = hex_format())
+{
+  write_iterator_range_result_t<T const*> w(first);
+  detail::hex_write_impl(o, w.next, last, w.count, f);
+  return w;
+}
+
+BOOST_RANGEIO_MODULE_EXPORT template <typename T, typename CharT, typename Traits>
+typename ::boost::enable_if_c<
+  detail::is_hex_element<T>::value,
+  write_iterator_range_result_t<T const*>>::type
+write_hex(::std::basic_ostream<CharT, Traits>& o, T const* first, ::std::size_t n, hex_format const& f = hex_format())
+{
+  write_iterator_range_result_t<T const*> w(first);
+  detail::hex_write_impl(o, w.next, first + n, w.count, f);
+  return w;
+}
+
+} // namespace rangeio
+} // namespace boost
+
+#endif  // BOOST_NO_CXX11_RVALUE_REFERENCES
+#endif  // include guard
@@ -20,11 +20,17 @@
 
 #include <cstddef>
 #include <iosfwd>
+#include <memory>
+#include <type_traits>
 #include <utility>
 
 #include <boost/core/enable_if.hpp>
 
+#include <boost/rangeio/detail/module_export.hpp>
+#include <boost/rangeio/detail/projection.hpp>
+#include <boost/rangeio/detail/uses_allocator.hpp>
 #include <boost/rangeio/detail/write.hpp>
+#include <boost/rangeio/sentinels.hpp>
 
 #include <boost/type_traits/is_base_of.hpp>
 
@@ -38,7 +44,7 @@ namespace rangeio {
 //          or one-past-the-end if all were written.
 //   count: the number of elements written
 // 
-template <typename InputIterator>
+BOOST_RANGEIO_MODULE_EXPORT template <typename InputIterator>
 struct write_iterator_range_result_t
 {
   //BOOST_CONCEPT_ASSERT(( boost_concepts::InputIterator<InputIterator> ));
@@ -49,7 +55,7 @@ struct write_iterator_range_result_t
   
   iterator       next;
   ::std::size_t  count;
-  
+
 //protected:  
   explicit write_iterator_range_result_t(iterator p) :
     next(::std::move(p)),
@@ -81,7 +87,7 @@ struct write_iterator_range_result_t
 // Internally stores the range end marker - so it knows when to stop writing -
 // and the delimiter (if necessary, and if so by val or by ref depending).
 // 
-template <typename InputIterator, typename Sentinel, typename Delimiter = void>
+BOOST_RANGEIO_MODULE_EXPORT template <typename InputIterator, typename Sentinel, typename Delimiter = void>
 struct write_iterator_range_t :
   protected write_iterator_range_result_t<InputIterator>
 {
@@ -90,7 +96,7 @@ public:
   
   using write_iterator_range_result_t<InputIterator>::next;
   using write_iterator_range_result_t<InputIterator>::count;
-  
+
 //protected:
   explicit write_iterator_range_t(iterator p, Sentinel e, Delimiter d) :
     write_iterator_range_result_t<InputIterator>(::std::move(p)),
@@ -111,7 +117,7 @@ public:
   
   using write_iterator_range_result_t<InputIterator>::next;
   using write_iterator_range_result_t<InputIterator>::count;
-  
+
 //protected:
   explicit write_iterator_range_t(iterator p, Sentinel e, Delimiter& d) :
     write_iterator_range_result_t<InputIterator>(::std::move(p)),
@@ -132,7 +138,7 @@ public:
   
   using write_iterator_range_result_t<InputIterator>::next;
   using write_iterator_range_result_t<InputIterator>::count;
-  
+
 //protected:
   explicit write_iterator_range_t(iterator p, Sentinel e) :
     write_iterator_range_result_t<InputIterator>(::std::move(p)),
@@ -142,7 +148,7 @@ public:
   Sentinel  last_;
 };
 
-template <typename InputIterator, typename Sentinel, typename Delimiter, typename CharT, typename Traits>
+BOOST_RANGEIO_MODULE_EXPORT template <typename InputIterator, typename Sentinel, typename Delimiter, typename CharT, typename Traits>
 ::std::basic_ostream<CharT, Traits>&
 operator<<(::std::basic_ostream<CharT, Traits>& o, write_iterator_range_t<InputIterator, Sentinel, Delimiter>& w)
 {
@@ -150,14 +156,14 @@ operator<<(::std::basic_ostream<CharT, Traits>& o, write_iterator_range_t<InputI
   return o;
 }
 
-template <typename InputIterator, typename Sentinel, typename Delimiter, typename CharT, typename Traits>
+BOOST_RANGEIO_MODULE_EXPORT template <typename InputIterator, typename Sentinel, typename Delimiter, typename CharT, typename Traits>
 ::std::basic_ostream<CharT, Traits>&
 operator<<(::std::basic_ostream<CharT, Traits>& o, write_iterator_range_t<InputIterator, Sentinel, Delimiter>&& w)
 {
   return o << w;
 }
 
-template <typename InputIterator, typename Sentinel, typename CharT, typename Traits>
+BOOST_RANGEIO_MODULE_EXPORT template <typename InputIterator, typename Sentinel, typename CharT, typename Traits>
 ::std::basic_ostream<CharT, Traits>&
 operator<<(::std::basic_ostream<CharT, Traits>& o, write_iterator_range_t<InputIterator, Sentinel, void>& w)
 {
@@ -165,7 +171,7 @@ operator<<(::std::basic_ostream<CharT, Traits>& o, write_iterator_range_t<InputI
   return o;
 }
 
-template <typename InputIterator, typename Sentinel, typename CharT, typename Traits>
+BOOST_RANGEIO_MODULE_EXPORT template <typename InputIterator, typename Sentinel, typename CharT, typename Traits>
 ::std::basic_ostream<CharT, Traits>&
 operator<<(::std::basic_ostream<CharT, Traits>& o, write_iterator_range_t<InputIterator, Sentinel, void>&& w)
 {
@@ -180,7 +186,7 @@ operator<<(::std::basic_ostream<CharT, Traits>& o, write_iterator_range_t<InputI
 // 
 // There are two versions - one with a delimiter, and one without.
 // 
-template <typename InputIterator, typename Sentinel, typename Delimiter, typename CharT, typename Traits>
+BOOST_RANGEIO_MODULE_EXPORT template <typename InputIterator, typename Sentinel, typename Delimiter, typename CharT, typename Traits>
 write_iterator_range_result_t<InputIterator>
 write_iterator_range(::std::basic_ostream<CharT, Traits>& o, InputIterator i, Sentinel const e, Delimiter&& d)
 {
@@ -189,7 +195,7 @@ write_iterator_range(::std::basic_ostream<CharT, Traits>& o, InputIterator i, Se
   return w;
 }
 
-template <typename InputIterator, typename Sentinel, typename CharT, typename Traits>
+BOOST_RANGEIO_MODULE_EXPORT template <typename InputIterator, typename Sentinel, typename CharT, typename Traits>
 write_iterator_range_result_t<InputIterator>
 write_iterator_range(::std::basic_ostream<CharT, Traits>& o, InputIterator i, Sentinel const e)
 {
@@ -198,6 +204,88 @@ write_iterator_range(::std::basic_ostream<CharT, Traits>& o, InputIterator i, Se
   return w;
 }
 
+// Projected immediate write_iterator_range().
+// 
+// The same as the immediate version with a delimiter, except that each
+// element is projected with proj before it is written. proj can be a pointer
+// to a data member (to write that member of each element), a pointer to a
+// const member function taking no arguments (to write the result of calling
+// it), or any function object that can be called with an element - for
+// example:
+// 
+//   write_iterator_range(out, orders.begin(), orders.end(), ", ", &order::id);
+// 
+// The projection is applied to each element as it is written, so data
+// members are written in place (without being copied), and the range keeps
+// its own iterators - so segmented and null-terminated ranges are still
+// written with their specialized algorithms. Ranges whose projected values
+// are integers (for example, &order::id above) are written with the same
+// batched loop as ranges of integers, when it produces exactly the same
+// output. Projected writes never use the type-erased write loop.
+// 
+// This is only available with a delimiter (a projection would otherwise be
+// ambiguous with a delimiter).
+// 
+BOOST_RANGEIO_MODULE_EXPORT template <typename InputIterator, typename Sentinel, typename Delimiter, typename Projection, typename CharT, typename Traits>
+typename ::boost::enable_if_c<
+  detail::is_projection<Projection, InputIterator>::value,
+  write_iterator_range_result_t<InputIterator>>::type
+write_iterator_range(::std::basic_ostream<CharT, Traits>& o, InputIterator i, Sentinel const e, Delimiter&& d, Projection proj)
+{
+  write_iterator_range_result_t<InputIterator> w(i);
+  detail::write_impl(o, w.next, e, d, w.count, proj);
+  return w;
+}
+
+// Counted write_iterator_range_n().
+// 
+// These versions of write_iterator_range take an ostream& as their first
+// argument, an iterator to the first element, and the number of elements to
+// write (rather than a sentinel), and perform the write immediately, returning
+// a struct with info about how it went.
+// 
+// Because the end of the range is found by counting rather than by comparing
+// iterators, these are useful both for ranges that are naturally described
+// by a count, and for iterators that have no end at all (with an element
+// budget).
+// 
+// There are two versions - one with a delimiter, and one without.
+// 
+BOOST_RANGEIO_MODULE_EXPORT template <typename InputIterator, typename Delimiter, typename CharT, typename Traits>
+write_iterator_range_result_t<InputIterator>
+write_iterator_range_n(::std::basic_ostream<CharT, Traits>& o, InputIterator i, ::std::size_t n, Delimiter&& d)
+{
+  write_iterator_range_result_t<InputIterator> w(i);
+  detail::write_n_impl(o, w.next, n, d, w.count);
+  return w;
+}
+
+BOOST_RANGEIO_MODULE_EXPORT template <typename InputIterator, typename CharT, typename Traits>
+write_iterator_range_result_t<InputIterator>
+write_iterator_range_n(::std::basic_ostream<CharT, Traits>& o, InputIterator i, ::std::size_t n)
+{
+  write_iterator_range_result_t<InputIterator> w(i);
+  detail::write_n_impl(o, w.next, n, w.count);
+  return w;
+}
+
+// Projected counted write_iterator_range_n().
+// 
+// The same as the counted version with a delimiter, except that each element
+// is projected with proj before it is written (see the projected
+// write_iterator_range()).
+// 
+BOOST_RANGEIO_MODULE_EXPORT template <typename InputIterator, typename Delimiter, typename Projection, typename CharT, typename Traits>
+typename ::boost::enable_if_c<
+  detail::is_projection<Projection, InputIterator>::value,
+  write_iterator_range_result_t<InputIterator>>::type
+write_iterator_range_n(::std::basic_ostream<CharT, Traits>& o, InputIterator i, ::std::size_t n, Delimiter&& d, Projection proj)
+{
+  write_iterator_range_result_t<InputIterator> w(i);
+  detail::write_n_impl(o, w.next, n, d, w.count, proj);
+  return w;
+}
+
 // Deferred write_iterator_range().
 // 
 // These versions of write_iterator_range do not accept a stream as the first
@@ -212,7 +300,7 @@ write_iterator_range(::std::basic_ostream<CharT, Traits>& o, InputIterator i, Se
 // All three return a structure which can be used in an ostream insert
 // expression, and queried to see how the last write operation went.
 // 
-template <typename InputIterator, typename Sentinel, typename Delimiter>
+BOOST_RANGEIO_MODULE_EXPORT template <typename InputIterator, typename Sentinel, typename Delimiter>
 typename ::boost::disable_if_c<
   ::boost::is_base_of<std::ios_base, InputIterator>::value,
   write_iterator_range_t<InputIterator, Sentinel, Delimiter&>>::type
@@ -221,7 +309,7 @@ write_iterator_range(InputIterator i, Sentinel e, Delimiter& d)
   return write_iterator_range_t<InputIterator, Sentinel, Delimiter&>(::std::move(i), ::std::move(e), d);
 }
 
-template <typename InputIterator, typename Sentinel, typename Delimiter>
+BOOST_RANGEIO_MODULE_EXPORT template <typename InputIterator, typename Sentinel, typename Delimiter>
 typename ::boost::disable_if_c<
   ::boost::is_base_of<std::ios_base, InputIterator>::value,
   write_iterator_range_t<InputIterator, Sentinel, Delimiter>>::type
@@ -230,13 +318,36 @@ write_iterator_range(InputIterator i, Sentinel e, Delimiter&& d)
   return write_iterator_range_t<InputIterator, Sentinel, Delimiter>(::std::move(i), ::std::move(e), ::std::move(d));
 }
 
-template <typename InputIterator, typename Sentinel>
+BOOST_RANGEIO_MODULE_EXPORT template <typename InputIterator, typename Sentinel>
 write_iterator_range_t<InputIterator, Sentinel>
 write_iterator_range(InputIterator i, Sentinel e)
 {
   return write_iterator_range_t<InputIterator, Sentinel>(::std::move(i), ::std::move(e));
 }
 
+// Allocator-aware deferred write_iterator_range().
+// 
+// The same as the deferred version with a delimiter, except that the
+// delimiter is always owned by the returned structure (even if it is an
+// lvalue, in which case it is copied), and it is constructed with the
+// allocator a if it is allocator-aware (using uses-allocator construction,
+// as std::uses_allocator describes). Other delimiters (like characters or
+// string literals) are simply stored.
+// 
+// For example, with a std::pmr::polymorphic_allocator (or a
+// std::pmr::memory_resource*) for a monotonic buffer resource, a
+// std::pmr::string delimiter is copied into the resource's buffer.
+// 
+BOOST_RANGEIO_MODULE_EXPORT template <typename Allocator, typename InputIterator, typename Sentinel, typename Delimiter>
+write_iterator_range_t<InputIterator, Sentinel, typename ::std::decay<Delimiter>::type>
+write_iterator_range(::std::allocator_arg_t, Allocator const& a, InputIterator i, Sentinel e, Delimiter&& d)
+{
+  typedef typename ::std::decay<Delimiter>::type delimiter_type;
+  
+  return write_iterator_range_t<InputIterator, Sentinel, delimiter_type>(::std::move(i), ::std::move(e),
+    detail::make_using_allocator<delimiter_type>(a, ::std::forward<Delimiter>(d)));
+}
+
 } // namespace rangeio
 } // namespace boost
 
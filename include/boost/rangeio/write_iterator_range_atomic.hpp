@@ -0,0 +1,359 @@
+//
+// Copyright (c) Mark A. Gibbs, 2015.
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+// 
+
+// Defines the write_iterator_range_atomic() functions, which write a whole
+// range to a stream shared between threads without interleaving with other
+// atomic writes.
+// 
+// Requires at least C++11.
+
+#ifndef BOOST_RANGEIO_Inc_write_iterator_range_atomic_2015_01_01_
+#define BOOST_RANGEIO_Inc_write_iterator_range_atomic_2015_01_01_
+
+#include <boost/config.hpp>
+
+#ifdef BOOST_NO_CXX11_RVALUE_REFERENCES
+#   error "C++98 is not supported"
+#else
+
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <ios>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <type_traits>
+
+#include <boost/core/enable_if.hpp>
+
+#include <boost/rangeio/detail/growable_streambuf.hpp>
+#include <boost/rangeio/detail/module_export.hpp>
+#include <boost/rangeio/detail/pmr.hpp>
+#include <boost/rangeio/detail/scratch_arena.hpp>
+#include <boost/rangeio/detail/write.hpp>
+#include <boost/rangeio/range_stringbuf.hpp>
+#include <boost/rangeio/scratch_memory.hpp>
+#include <boost/rangeio/write_iterator_range.hpp>
+
+namespace boost {
+namespace rangeio {
+namespace detail {
+
+// A mutex on its own cache line, so that threads using different mutexes do
+// not contend through false sharing.
+struct alignas(64) atomic_write_mutex_slot
+{
+  ::std::mutex mutex;
+};
+
+// Gets the mutex that serializes atomic writes to a stream buffer.
+// 
+// Rather than one mutex per stream buffer, there is a fixed table of mutexes,
+// and each stream buffer is assigned one by its address. Writes to different
+// stream buffers may occasionally share a mutex, which is harmless.
+inline ::std::mutex& atomic_write_mutex(void const* key)
+{
+  static atomic_write_mutex_slot slots[64];
+  
+  // Stream buffers are larger than 64 bytes, so the low bits of the address
+  // carry no information.
+  ::std::uintptr_t const h = reinterpret_cast< ::std::uintptr_t>(key);
+  
+  return slots[((h >> 6) ^ (h >> 12)) % 64].mutex;
+}
+
+// The formatting stream used by an atomic write.
+// 
+// Each thread has one that is reused for every atomic write. Its buffer
+// borrows a block from the thread's scratch arena for each write, so it only
+// allocates until the block has grown large enough. If an element's inserter
+// itself does an atomic write (so the thread's formatter is already in use),
+// a temporary formatter is used instead (which still borrows its buffer's
+// storage from the arena).
+template <typename CharT, typename Traits>
+class atomic_write_formatter
+{
+public:
+  atomic_write_formatter() :
+    stream(&buffer),
+    busy(false)
+  {}
+  
+  atomic_write_formatter(atomic_write_formatter const&) = delete;
+  atomic_write_formatter& operator=(atomic_write_formatter const&) = delete;
+  
+  static atomic_write_formatter& this_thread()
+  {
+    static thread_local atomic_write_formatter formatter;
+    return formatter;
+  }
+  
+  detail::growable_streambuf<CharT, Traits>  buffer;
+  ::std::basic_ostream<CharT, Traits>        stream;
+  bool                                       busy;
+};
+
+// Gives stream the same formatting state as out (via copyfmt(), so that the
+// flags, fill, precision, width, locale and any iword()/pword() data all
+// match), ready to format an atomic write to out.
+// 
+// All access to out is done while holding its atomic write mutex, because out
+// is shared with other threads.
+template <typename CharT, typename Traits>
+void atomic_write_prepare(::std::basic_ostream<CharT, Traits>& out, ::std::basic_ostream<CharT, Traits>& stream)
+{
+  ::std::lock_guard< ::std::mutex> const lock(detail::atomic_write_mutex(out.rdbuf()));
+  
+  stream.copyfmt(out);
+  stream.tie(0);
+  
+  // Exceptions are raised on out (in atomic_write_commit()), not while
+  // formatting.
+  stream.exceptions(::std::ios_base::goodbit);
+  
+  // If out is not good, nothing will be written - set the formatting stream's
+  // state to match, so that the write functions don't bother formatting
+  // anything.
+  if (!out)
+    stream.setstate(::std::ios_base::failbit);
+}
+
+// Appends the n formatted characters at p to out's stream buffer in one
+// call, and copies the formatting stream's error state and width back to out.
+template <typename CharT, typename Traits>
+void atomic_write_commit(::std::basic_ostream<CharT, Traits>& out, CharT const* p, ::std::size_t n, ::std::ios_base::iostate formatting_state)
+{
+  ::std::ios_base::iostate state = ::std::ios_base::goodbit;
+  ::std::exception_ptr error;
+  
+  {
+    ::std::lock_guard< ::std::mutex> const lock(detail::atomic_write_mutex(out.rdbuf()));
+    
+    if (n != 0)
+    {
+      typename ::std::basic_ostream<CharT, Traits>::sentry const sentry(out);
+      
+      if (!sentry || (out.rdbuf()->sputn(p, ::std::streamsize(n)) != ::std::streamsize(n)))
+        state |= ::std::ios_base::badbit;
+    }
+    
+    // If the formatting failed part way, out must fail in the same way.
+    if (bool(out))
+      state |= formatting_state;
+    
+    out.width(0);
+    
+    // The state must be updated while holding the lock, because other
+    // writes test it in atomic_write_prepare(). If out has exceptions
+    // enabled, clear() sets the state and then throws - the exception is
+    // held and rethrown once the lock is released.
+    if (state != ::std::ios_base::goodbit)
+    {
+      try
+      {
+        out.clear(out.rdstate() | state);
+      }
+      catch (::std::ios_base::failure const&)
+      {
+        error = ::std::current_exception();
+      }
+    }
+  }
+  
+  if (error)
+    ::std::rethrow_exception(error);
+}
+
+// Manages the formatting stream for a single atomic write.
+// 
+// On construction, acquires a formatter, attaches its buffer to a block of
+// the thread's scratch arena, and prepares its stream (see
+// atomic_write_prepare()). commit() then appends everything that was
+// formatted to out (see atomic_write_commit()).
+template <typename CharT, typename Traits>
+class atomic_write_scope
+{
+public:
+  explicit atomic_write_scope(::std::basic_ostream<CharT, Traits>& out) :
+    out_(out),
+    formatter_(&atomic_write_formatter<CharT, Traits>::this_thread())
+  {
+    if (formatter_->busy)
+    {
+      temporary_.reset(new atomic_write_formatter<CharT, Traits>());
+      formatter_ = temporary_.get();
+    }
+    
+    formatter_->busy = true;
+    
+    formatter_->buffer.attach(lease_.block());
+    formatter_->stream.clear();
+    
+    detail::atomic_write_prepare(out_, formatter_->stream);
+  }
+  
+  ~atomic_write_scope()
+  {
+    formatter_->buffer.detach();
+    formatter_->busy = false;
+  }
+  
+  atomic_write_scope(atomic_write_scope const&) = delete;
+  atomic_write_scope& operator=(atomic_write_scope const&) = delete;
+  
+  ::std::basic_ostream<CharT, Traits>& stream() { return formatter_->stream; }
+  
+  void commit()
+  {
+    detail::atomic_write_commit(out_, formatter_->buffer.data(), formatter_->buffer.size(), formatter_->stream.rdstate());
+  }
+  
+private:
+  ::std::basic_ostream<CharT, Traits>&                      out_;
+  atomic_write_formatter<CharT, Traits>*                    formatter_;
+  ::std::unique_ptr<atomic_write_formatter<CharT, Traits>>  temporary_;
+  detail::scratch_lease                                     lease_;
+};
+
+// The allocator for an atomic write's formatting buffer: Allocator rebound to
+// the character type, or a std::pmr::polymorphic_allocator if Allocator is a
+// pointer to a std::pmr::memory_resource.
+template <typename CharT, typename Allocator, typename Enable = void>
+struct atomic_write_buffer_allocator
+{
+  typedef typename ::std::allocator_traits<Allocator>::template rebind_alloc<CharT> type;
+};
+
+#ifdef BOOST_RANGEIO_HAS_PMR
+
+template <typename CharT, typename Resource>
+struct atomic_write_buffer_allocator<CharT, Resource*,
+  typename ::boost::enable_if_c< ::std::is_convertible<Resource*, ::std::pmr::memory_resource*>::value>::type>
+{
+  typedef ::std::pmr::polymorphic_allocator<CharT> type;
+};
+
+#endif // BOOST_RANGEIO_HAS_PMR
+
+// The same as atomic_write_scope, except that the formatting buffer is
+// allocated with an allocator, rather than taken from the thread's scratch
+// arena.
+template <typename CharT, typename Traits, typename Allocator>
+class atomic_write_allocator_scope
+{
+public:
+  atomic_write_allocator_scope(::std::basic_ostream<CharT, Traits>& out, Allocator const& a) :
+    out_(out),
+    buffer_(char_allocator(a)),
+    stream_(&buffer_)
+  {
+    detail::atomic_write_prepare(out_, stream_);
+  }
+  
+  atomic_write_allocator_scope(atomic_write_allocator_scope const&) = delete;
+  atomic_write_allocator_scope& operator=(atomic_write_allocator_scope const&) = delete;
+  
+  ::std::basic_ostream<CharT, Traits>& stream() { return stream_; }
+  
+  void commit()
+  {
+    detail::atomic_write_commit(out_, buffer_.data(), buffer_.size(), stream_.rdstate());
+  }
+  
+private:
+  typedef typename atomic_write_buffer_allocator<CharT, Allocator>::type char_allocator;
+  
+  ::std::basic_ostream<CharT, Traits>&                             out_;
+  basic_range_stringbuf<CharT, Traits, char_allocator>             buffer_;
+  ::std::basic_ostream<CharT, Traits>                              stream_;
+};
+
+} // namespace detail
+
+// Atomic write_iterator_range().
+// 
+// These are the same as the immediate versions of write_iterator_range(),
+// except that when several threads write to the same stream at once, the
+// output of each atomic write is never interleaved with the output of any
+// other atomic write.
+// 
+// Each write formats the whole range into the thread's scratch memory (with
+// the same formatting state as the stream - see scratch_memory.hpp for how
+// that memory is managed), without holding any lock.
+// Then the buffer is appended to the stream's buffer with a single sputn()
+// call, while holding a mutex for the stream buffer. So formatting can run in
+// parallel, and only the final copy is serialized.
+// 
+// Note that:
+//   * Only atomic writes are serialized. Other output to the same stream may
+//     still interleave.
+//   * If an element's inserter throws, nothing is written to the stream.
+//   * If the stream buffer fails during the final copy, the stream's badbit
+//     is set, but next and count in the result still report what was
+//     formatted.
+// 
+// There are two versions - one with a delimiter, and one without.
+// 
+BOOST_RANGEIO_MODULE_EXPORT template <typename InputIterator, typename Sentinel, typename Delimiter, typename CharT, typename Traits>
+write_iterator_range_result_t<InputIterator>
+write_iterator_range_atomic(::std::basic_ostream<CharT, Traits>& o, InputIterator i, Sentinel const e, Delimiter&& d)
+{
+  write_iterator_range_result_t<InputIterator> w(i);
+  detail::atomic_write_scope<CharT, Traits> scope(o);
+  detail::write_impl(scope.stream(), w.next, e, d, w.count);
+  scope.commit();
+  return w;
+}
+
+BOOST_RANGEIO_MODULE_EXPORT template <typename InputIterator, typename Sentinel, typename CharT, typename Traits>
+write_iterator_range_result_t<InputIterator>
+write_iterator_range_atomic(::std::basic_ostream<CharT, Traits>& o, InputIterator i, Sentinel const e)
+{
+  write_iterator_range_result_t<InputIterator> w(i);
+  detail::atomic_write_scope<CharT, Traits> scope(o);
+  detail::write_impl(scope.stream(), w.next, e, w.count);
+  scope.commit();
+  return w;
+}
+
+// Allocator-aware atomic write_iterator_range().
+// 
+// The same as the other versions of write_iterator_range_atomic(), except
+// that the formatting buffer is allocated with the allocator a (rebound to
+// the character type) instead of using the thread's scratch memory. For
+// example, with a std::pmr::polymorphic_allocator (or a
+// std::pmr::memory_resource*) for a request's monotonic buffer resource, all
+// of the formatting memory comes from the resource.
+// 
+BOOST_RANGEIO_MODULE_EXPORT template <typename Allocator, typename InputIterator, typename Sentinel, typename Delimiter, typename CharT, typename Traits>
+write_iterator_range_result_t<InputIterator>
+write_iterator_range_atomic(::std::allocator_arg_t, Allocator const& a, ::std::basic_ostream<CharT, Traits>& o, InputIterator i, Sentinel const e, Delimiter&& d)
+{
+  write_iterator_range_result_t<InputIterator> w(i);
+  detail::atomic_write_allocator_scope<CharT, Traits, Allocator> scope(o, a);
+  detail::write_impl(scope.stream(), w.next, e, d, w.count);
+  scope.commit();
+  return w;
+}
+
+BOOST_RANGEIO_MODULE_EXPORT template <typename Allocator, typename InputIterator, typename Sentinel, typename CharT, typename Traits>
+write_iterator_range_result_t<InputIterator>
+write_iterator_range_atomic(::std::allocator_arg_t, Allocator const& a, ::std::basic_ostream<CharT, Traits>& o, InputIterator i, Sentinel const e)
+{
+  write_iterator_range_result_t<InputIterator> w(i);
+  detail::atomic_write_allocator_scope<CharT, Traits, Allocator> scope(o, a);
+  detail::write_impl(scope.stream(), w.next, e, w.count);
+  scope.commit();
+  return w;
+}
+
+} // namespace rangeio
+} // namespace boost
+
+#endif  // BOOST_NO_CXX11_RVALUE_REFERENCES
+#endif  // include guard
@@ -0,0 +1,96 @@
+//
+// Copyright (c) Mark A. Gibbs, 2015.
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+// 
+
+// Defines the write_iterator_range_if() functions, which write only the
+// elements of a range that satisfy a predicate.
+// 
+// Requires at least C++11.
+
+#ifndef BOOST_RANGEIO_Inc_write_iterator_range_if_2015_01_01_
+#define BOOST_RANGEIO_Inc_write_iterator_range_if_2015_01_01_
+
+#include <boost/config.hpp>
+
+#ifdef BOOST_NO_CXX11_RVALUE_REFERENCES
+#   error "C++98 is not supported"
+#else
+
+#include <cstddef>
+#include <iosfwd>
+#include <utility>
+
+#include <boost/rangeio/detail/module_export.hpp>
+#include <boost/rangeio/detail/projection.hpp>
+#include <boost/rangeio/detail/write.hpp>
+#include <boost/rangeio/write_iterator_range.hpp>
+
+namespace boost {
+namespace rangeio {
+
+// Result type from write_iterator_range_if().
+// 
+// Has three public data members:
+//   next:    an iterator to the next element in the range that would be
+//            visited, or one-past-the-end if all were visited.
+//   count:   the number of elements written
+//   visited: the number of elements visited (written or skipped)
+// 
+BOOST_RANGEIO_MODULE_EXPORT template <typename InputIterator>
+struct write_iterator_range_if_result_t :
+  write_iterator_range_result_t<InputIterator>
+{
+  using typename write_iterator_range_result_t<InputIterator>::iterator;
+  
+  ::std::size_t  visited;
+
+//protected:
+  explicit write_iterator_range_if_result_t(iterator p) :
+    write_iterator_range_result_t<InputIterator>(::std::move(p)),
+    visited(0)
+  {}
+};
+
+// Filtered write_iterator_range_if().
+// 
+// These versions of write_iterator_range take an ostream& as their first
+// argument, and write only the elements for which pred is true - for
+// example, to write only the non-zero counters in a range:
+// 
+//   write_iterator_range_if(out, counters.begin(), counters.end(), ", ",
+//     [](int n) { return n != 0; });
+// 
+// The elements are filtered inside the write loop, so no filtered copy of
+// the range is made. Delimiters are only written between elements that are
+// actually written. pred can be anything that can be used as a projection
+// with the projected write_iterator_range() - including a pointer to a bool
+// data member or const member function.
+// 
+// There are two versions - one with a delimiter, and one without.
+// 
+BOOST_RANGEIO_MODULE_EXPORT template <typename InputIterator, typename Sentinel, typename Delimiter, typename Predicate, typename CharT, typename Traits>
+write_iterator_range_if_result_t<InputIterator>
+write_iterator_range_if(::std::basic_ostream<CharT, Traits>& o, InputIterator i, Sentinel const e, Delimiter&& d, Predicate pred)
+{
+  write_iterator_range_if_result_t<InputIterator> w(i);
+  detail::filtered_write_impl(o, w.next, e, d, w.count, w.visited, pred);
+  return w;
+}
+
+BOOST_RANGEIO_MODULE_EXPORT template <typename InputIterator, typename Sentinel, typename Predicate, typename CharT, typename Traits>
+write_iterator_range_if_result_t<InputIterator>
+write_iterator_range_if(::std::basic_ostream<CharT, Traits>& o, InputIterator i, Sentinel const e, Predicate pred)
+{
+  write_iterator_range_if_result_t<InputIterator> w(i);
+  detail::filtered_write_impl(o, w.next, e, w.count, w.visited, pred);
+  return w;
+}
+
+} // namespace rangeio
+} // namespace boost
+
+#endif  // BOOST_NO_CXX11_RVALUE_REFERENCES
+#endif  // include guard
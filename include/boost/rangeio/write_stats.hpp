@@ -0,0 +1,145 @@
+//
+// Copyright (c) Mark A. Gibbs, 2015.
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+// 
+
+// Defines write_stats, and the instrumented versions of the immediate
+// write_iterator_range() functions that fill it.
+// 
+// Requires at least C++11.
+
+#ifndef BOOST_RANGEIO_Inc_write_stats_2015_01_01_
+#define BOOST_RANGEIO_Inc_write_stats_2015_01_01_
+
+#include <boost/config.hpp>
+
+#ifdef BOOST_NO_CXX11_RVALUE_REFERENCES
+#   error "C++98 is not supported"
+#else
+
+#include <chrono>
+#include <cstddef>
+#include <ios>
+#include <iosfwd>
+
+#include <boost/rangeio/detail/module_export.hpp>
+#include <boost/rangeio/detail/counting_streambuf.hpp>
+#include <boost/rangeio/detail/write.hpp>
+#include <boost/rangeio/write_iterator_range.hpp>
+
+namespace boost {
+namespace rangeio {
+
+// Statistics about a single write operation.
+// 
+// Has five public data members:
+//   elements:   the number of elements written.
+//   delimiters: the number of delimiters written.
+//   bytes:      the number of characters written to the stream's buffer.
+//   elapsed:    the time taken by the write.
+//   failed:     true if the write stopped before the end of the range was
+//               reached (because the stream failed).
+// 
+// The number of characters written is counted by temporarily wrapping the
+// stream's buffer in a pass-through buffer for the duration of the write, so
+// it works for every kind of stream buffer (including ones attached to pipes
+// or sockets), at the cost of an extra virtual call per character or block
+// of characters. Characters the stream buffer refused are not counted.
+// 
+// Each instrumented write overwrites all of the members.
+// 
+BOOST_RANGEIO_MODULE_EXPORT struct write_stats
+{
+  typedef ::std::chrono::steady_clock clock;
+  
+  write_stats() :
+    elements(0),
+    delimiters(0),
+    bytes(0),
+    elapsed(clock::duration::zero()),
+    failed(false)
+  {}
+  
+  ::std::size_t     elements;
+  ::std::size_t     delimiters;
+  ::std::streamoff  bytes;
+  clock::duration   elapsed;
+  bool              failed;
+};
+
+namespace detail {
+
+// Instrumentation policy that fills a write_stats structure (see
+// null_write_instrument for the interface), taking the number of characters
+// written from an output_counter that spans the write.
+template <typename CharT, typename Traits>
+class write_stats_instrument
+{
+public:
+  write_stats_instrument(write_stats& stats, output_counter<CharT, Traits> const& counter) :
+    stats_(stats),
+    counter_(counter)
+  {}
+  
+  void start(::std::basic_ostream<CharT, Traits>&)
+  {
+    stats_ = write_stats();
+    
+    start_time_ = write_stats::clock::now();
+  }
+  
+  void element() { ++stats_.elements; }
+  void delimiter() { ++stats_.delimiters; }
+  
+  void finish(::std::basic_ostream<CharT, Traits>&, bool stopped)
+  {
+    stats_.elapsed = write_stats::clock::now() - start_time_;
+    stats_.bytes = counter_.count();
+    stats_.failed = stopped;
+  }
+  
+private:
+  write_stats&                          stats_;
+  output_counter<CharT, Traits> const&  counter_;
+  write_stats::clock::time_point        start_time_;
+};
+
+} // namespace detail
+
+// Instrumented immediate write_iterator_range().
+// 
+// These are exactly the same as the immediate versions of
+// write_iterator_range(), except that the statistics of the write are stored
+// in stats.
+// 
+// There are two versions - one with a delimiter, and one without.
+// 
+BOOST_RANGEIO_MODULE_EXPORT template <typename InputIterator, typename Sentinel, typename Delimiter, typename CharT, typename Traits>
+write_iterator_range_result_t<InputIterator>
+write_iterator_range(::std::basic_ostream<CharT, Traits>& o, InputIterator i, Sentinel const e, Delimiter&& d, write_stats& stats)
+{
+  write_iterator_range_result_t<InputIterator> w(i);
+  detail::output_counter<CharT, Traits> const counter(o);
+  detail::write_stats_instrument<CharT, Traits> instrument(stats, counter);
+  detail::instrumented_write_impl(o, w.next, e, d, w.count, instrument);
+  return w;
+}
+
+BOOST_RANGEIO_MODULE_EXPORT template <typename InputIterator, typename Sentinel, typename CharT, typename Traits>
+write_iterator_range_result_t<InputIterator>
+write_iterator_range(::std::basic_ostream<CharT, Traits>& o, InputIterator i, Sentinel const e, write_stats& stats)
+{
+  write_iterator_range_result_t<InputIterator> w(i);
+  detail::output_counter<CharT, Traits> const counter(o);
+  detail::write_stats_instrument<CharT, Traits> instrument(stats, counter);
+  detail::instrumented_write_impl(o, w.next, e, w.count, instrument);
+  return w;
+}
+
+} // namespace rangeio
+} // namespace boost
+
+#endif  // BOOST_NO_CXX11_RVALUE_REFERENCES
+#endif  // include guard
@@ -0,0 +1,222 @@
+//
+// Copyright (c) Mark A. Gibbs, 2015.
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+// 
+
+// Defines the write_zipped() function, which writes several parallel ranges
+// (such as the columns of struct-of-arrays data) as rows.
+// 
+// Requires at least C++11.
+
+#ifndef BOOST_RANGEIO_Inc_write_zipped_2015_01_01_
+#define BOOST_RANGEIO_Inc_write_zipped_2015_01_01_
+
+#include <boost/config.hpp>
+
+#ifdef BOOST_NO_CXX11_RVALUE_REFERENCES
+#   error "C++98 is not supported"
+#else
+
+#include <cstddef>
+#include <iosfwd>
+#include <iterator>
+#include <tuple>
+#include <utility>
+
+#include <boost/rangeio/detail/formatting_saver.hpp>
+#include <boost/rangeio/detail/module_export.hpp>
+#include <boost/rangeio/detail/write_probe.hpp>
+
+namespace boost {
+namespace rangeio {
+
+namespace detail {
+
+// Operations on the I-th and following columns of a zipped row, where
+// Iterators is a tuple of N iterators (one for each column).
+template <::std::size_t I, ::std::size_t N>
+struct zipped_columns
+{
+  // True if none of the iterators has reached its end.
+  template <typename Iterators, typename Sentinels>
+  static bool valid(Iterators const& i, Sentinels const& e)
+  {
+    return !(::std::get<I>(i) == ::std::get<I>(e)) &&
+      zipped_columns<I + 1, N>::valid(i, e);
+  }
+  
+  // Writes the fields of the current row (restoring the formatting state
+  // before each), with delim between them. Returns false if any write fails.
+  template <typename CharT, typename Traits, typename Delimiter, typename Iterators>
+  static bool write(
+    ::std::basic_ostream<CharT, Traits>& out,
+    Delimiter& delim,
+    Iterators& i,
+    detail::formatting_saver<CharT, Traits> const& formatting)
+  {
+    if ((I != 0) && !(out << delim))
+      return false;
+    
+    formatting.restore();
+    
+    if (!(out << *::std::get<I>(i)))
+      return false;
+    
+    return zipped_columns<I + 1, N>::write(out, delim, i, formatting);
+  }
+  
+  // Moves all of the iterators to the next row.
+  template <typename Iterators>
+  static void advance(Iterators& i)
+  {
+    ++::std::get<I>(i);
+    zipped_columns<I + 1, N>::advance(i);
+  }
+};
+
+template <::std::size_t N>
+struct zipped_columns<N, N>
+{
+  template <typename Iterators, typename Sentinels>
+  static bool valid(Iterators const&, Sentinels const&) { return true; }
+  
+  template <typename CharT, typename Traits, typename Delimiter, typename Iterators>
+  static bool write(
+    ::std::basic_ostream<CharT, Traits>&,
+    Delimiter&,
+    Iterators&,
+    detail::formatting_saver<CharT, Traits> const&)
+  {
+    return true;
+  }
+  
+  template <typename Iterators>
+  static void advance(Iterators&) {}
+};
+
+// Underlying implementation function for write_zipped().
+// 
+// While none of the iterators in i has reached its end in e and bool(out) is
+// true, writes a row: performs "out << row_delim" (if this is not the first
+// row), then writes the element each iterator refers to, restoring the
+// formatting state before each and performing "out << field_delim" between
+// them. If bool(out) is still true, advances all the iterators and performs
+// "++n".
+// 
+// So on return, n is the number of complete rows written, and i refers to the
+// first row not completely written. As with write_impl(), the stream's width
+// is reset to zero.
+template <
+  typename Iterators,
+  typename Sentinels,
+  typename RowDelimiter,
+  typename FieldDelimiter,
+  typename CharT,
+  typename Traits>
+void
+zipped_write_impl(
+  ::std::basic_ostream<CharT, Traits>& out,
+  Iterators& i,
+  Sentinels const& e,
+  RowDelimiter& row_delim,
+  FieldDelimiter& field_delim,
+  ::std::size_t& n)
+{
+  typedef zipped_columns<0, ::std::tuple_size<Iterators>::value> columns;
+  
+  detail::write_probe<CharT, Traits> const probe(out, n);
+  
+  bool valid = columns::valid(i, e);
+  
+  if (valid && bool(out))
+  {
+    // Save the formatting state prior to writing the first row.
+    detail::formatting_saver<CharT, Traits> formatting(out);
+    
+    bool first = true;
+    
+    do
+    {
+      if (!first && !(out << row_delim))
+        break;
+      
+      if (!columns::write(out, field_delim, i, formatting))
+        break;
+      
+      ++n;
+      columns::advance(i);
+      
+      first = false;
+      valid = columns::valid(i, e);
+    } while (valid && bool(out));
+  }
+  
+  // Regardless of anything else, reset the stream's width to zero.
+  out.width(0);
+  
+  probe.finish(out, n, valid);
+}
+
+} // namespace detail
+
+// Result type from write_zipped().
+// 
+// Has two public data members:
+//   next:  a tuple of iterators (one into each range) to the next row that
+//          would be written, or to the end of the shortest range if all were
+//          written.
+//   count: the number of rows written
+// 
+BOOST_RANGEIO_MODULE_EXPORT template <typename... Iterators>
+struct write_zipped_result_t
+{
+  typedef ::std::tuple<Iterators...> iterators;
+  
+  iterators      next;
+  ::std::size_t  count;
+
+//protected:
+  explicit write_zipped_result_t(iterators p) :
+    next(::std::move(p)),
+    count(0)
+  {}
+};
+
+// Zipped write.
+// 
+// Walks the ranges in lockstep, and writes each row of elements - the first
+// element of each range, then the second of each, and so on - with
+// field_delim between the elements in a row, and row_delim between the rows.
+// For example, with struct-of-arrays data:
+// 
+//   write_zipped(out, '\n', ',', ids, names, values);
+// 
+// writes "id,name,value" lines, without building a range of tuples. Each
+// field is written with its own type's operator<<, and the formatting state
+// is restored before each field, so (for example) the width applies to every
+// field.
+// 
+// Writing stops at the end of the shortest range. The ranges can be anything
+// that std::begin() and std::end() accept, including arrays.
+// 
+BOOST_RANGEIO_MODULE_EXPORT template <typename RowDelimiter, typename FieldDelimiter, typename... Ranges, typename CharT, typename Traits>
+write_zipped_result_t<decltype(::std::begin(::std::declval<Ranges const&>()))...>
+write_zipped(::std::basic_ostream<CharT, Traits>& o, RowDelimiter&& row_delim, FieldDelimiter&& field_delim, Ranges const&... ranges)
+{
+  static_assert(sizeof...(Ranges) != 0, "write_zipped() requires at least one range");
+  
+  write_zipped_result_t<decltype(::std::begin(::std::declval<Ranges const&>()))...> w(::std::make_tuple(::std::begin(ranges)...));
+  
+  auto const e = ::std::make_tuple(::std::end(ranges)...);
+  detail::zipped_write_impl(o, w.next, e, row_delim, field_delim, w.count);
+  
+  return w;
+}
+
+} // namespace rangeio
+} // namespace boost
+
+#endif  // BOOST_NO_CXX11_RVALUE_REFERENCES
+#endif  // include guard
@@ -0,0 +1,138 @@
+//
+// Copyright (c) Mark A. Gibbs, 2015.
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+// 
+
+// Primary module interface unit for the boost.rangeio module.
+// 
+// Exports the public interface of the library, from the headers included at
+// the end of this file:
+//   base64.hpp:
+//     write_base64(), read_base64(), base64_format and read_base64_result_t.
+//   cached_range_writer.hpp, incremental_range_writer.hpp:
+//     the cached and incremental range writers.
+//   flush_batching.hpp:
+//     flush_batching, and the write_iterator_range() overloads that take it.
+//   format_spec.hpp:
+//     format_spec, and the write_iterator_range() overloads that take it.
+//   prefer_inline_write.hpp, segmented_iterator_traits.hpp:
+//     the customization points.
+//   range_stringbuf.hpp:
+//     the range string buffers and streams (and their pmr aliases).
+//   scratch_memory.hpp:
+//     the scratch memory functions.
+//   sentinels.hpp:
+//     the sentinels.
+//   write_hex.hpp:
+//     write_hex() and hex_format.
+//   write_iterator_range.hpp:
+//     write_iterator_range() and write_iterator_range_n() (including the
+//     projected overloads), write_iterator_range_t and
+//     write_iterator_range_result_t.
+//   write_iterator_range_atomic.hpp:
+//     write_iterator_range_atomic().
+//   write_iterator_range_if.hpp:
+//     the filtered writes, write_iterator_range_if().
+//   write_stats.hpp:
+//     write_stats, and the instrumented write_iterator_range() overloads.
+//   write_zipped.hpp:
+//     write_zipped() - except with GCC 12 and earlier (see below).
+// 
+// ring_sink.hpp is deliberately left out: it only compiles on POSIX systems,
+// and it would pull <thread>, <condition_variable> and the POSIX headers into
+// every importer. Include it directly instead.
+// 
+// All of the standard library and Boost headers the library depends on are
+// included in the global module fragment, so they are not attached to the
+// module. The RangeIO headers are then included in the module purview, with
+// BOOST_RANGEIO_MODULE_EXPORT defined as "export" (see
+// detail/module_export.hpp).
+// 
+// When adding a new public header, include it at the end of this file (and
+// add it to the list above), add any new standard library or Boost
+// dependencies to the global module fragment, and mark its public
+// declarations with BOOST_RANGEIO_MODULE_EXPORT.
+// 
+// GCC 12 writes an unreadable module if non-template code in the purview
+// instantiates a standard library class template with one of the library's
+// own types (for example, a non-template class with a
+// std::vector<detail::foo> member), so such code must avoid standard
+// containers of library types.
+// 
+// GCC 12 and earlier crash when code that imports the module instantiates
+// write_zipped() (inside <tuple>), so write_zipped.hpp is left out of the
+// module for those compilers; include the header directly instead.
+// 
+// Requires C++20 modules support (see module/Makefile).
+
+module;
+
+#include <boost/config.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <ios>
+#include <iosfwd>
+#include <istream>
+#include <iterator>
+#include <locale>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <new>
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <boost/core/enable_if.hpp>
+#include <boost/static_assert.hpp>
+
+#include <boost/type_traits/integral_constant.hpp>
+#include <boost/type_traits/is_base_of.hpp>
+#include <boost/type_traits/is_convertible.hpp>
+#include <boost/type_traits/is_same.hpp>
+#include <boost/type_traits/is_signed.hpp>
+#include <boost/type_traits/make_unsigned.hpp>
+#include <boost/type_traits/remove_const.hpp>
+#include <boost/type_traits/remove_cv.hpp>
+#include <boost/type_traits/remove_reference.hpp>
+
+// The SIMD intrinsics headers, if any instruction sets are enabled
+#include <boost/rangeio/detail/simd.hpp>
+
+export module boost.rangeio;
+
+#define BOOST_RANGEIO_MODULE_EXPORT export
+
+#include <boost/rangeio/base64.hpp>
+#include <boost/rangeio/cached_range_writer.hpp>
+#include <boost/rangeio/flush_batching.hpp>
+#include <boost/rangeio/format_spec.hpp>
+#include <boost/rangeio/incremental_range_writer.hpp>
+#include <boost/rangeio/prefer_inline_write.hpp>
+#include <boost/rangeio/range_stringbuf.hpp>
+#include <boost/rangeio/scratch_memory.hpp>
+#include <boost/rangeio/segmented_iterator_traits.hpp>
+#include <boost/rangeio/sentinels.hpp>
+#include <boost/rangeio/write_hex.hpp>
+#include <boost/rangeio/write_iterator_range.hpp>
+#include <boost/rangeio/write_iterator_range_atomic.hpp>
+#include <boost/rangeio/write_iterator_range_if.hpp>
+#include <boost/rangeio/write_stats.hpp>
+
+#if !defined(BOOST_GCC_VERSION) || (BOOST_GCC_VERSION >= 130000)
+#   include <boost/rangeio/write_zipped.hpp>
+#endif
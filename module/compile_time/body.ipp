@@ -0,0 +1,45 @@
+//
+// Copyright (c) Mark A. Gibbs, 2015.
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+// 
+
+// Common body of the compile-time benchmark translation units.
+// 
+// Included after RangeIO has been made available (either by including the
+// headers or by importing the module), and after <sstream>, <string> and
+// <vector>.
+
+namespace compile_time_benchmark {
+
+template <typename T>
+void write_all(::std::ostream& out, ::std::vector<T> const& v)
+{
+  ::boost::rangeio::write_iterator_range(out, v.begin(), v.end());
+  ::boost::rangeio::write_iterator_range(out, v.begin(), v.end(), ", ");
+  ::boost::rangeio::write_iterator_range_n(out, v.begin(), v.size(), ' ');
+  
+  out << ::boost::rangeio::write_iterator_range(v.begin(), v.end(), '\n');
+  
+  ::boost::rangeio::write_stats stats;
+  ::boost::rangeio::write_iterator_range(out, v.begin(), v.end(), ';', stats);
+}
+
+} // namespace compile_time_benchmark
+
+int main()
+{
+  using namespace compile_time_benchmark;
+  
+  ::std::ostringstream out;
+  
+  write_all(out, ::std::vector<int>(3, 1));
+  write_all(out, ::std::vector<double>(3, 1.0));
+  write_all(out, ::std::vector< ::std::string>(3, "x"));
+  
+  char const* s = "abc";
+  ::boost::rangeio::write_iterator_range(out, s, ::boost::rangeio::null_terminated);
+  
+  return out.str().empty() ? 1 : 0;
+}
@@ -0,0 +1,17 @@
+//
+// Copyright (c) Mark A. Gibbs, 2015.
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+// 
+
+// Compile-time benchmark translation unit that imports the boost.rangeio
+// module.
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+import boost.rangeio;
+
+#include "body.ipp"
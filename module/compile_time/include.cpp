@@ -0,0 +1,17 @@
+//
+// Copyright (c) Mark A. Gibbs, 2015.
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+// 
+
+// Compile-time benchmark translation unit that includes the RangeIO headers.
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <boost/rangeio/write_iterator_range.hpp>
+#include <boost/rangeio/write_stats.hpp>
+
+#include "body.ipp"
@@ -0,0 +1,15 @@
+//
+// Copyright (c) Mark A. Gibbs, 2015.
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+// 
+
+// Defines the explicit instantiations of the write implementation functions
+// declared extern when BOOST_RANGEIO_SEPARATE_COMPILATION is defined.
+// 
+// Requires at least C++11.
+
+#define BOOST_RANGEIO_SOURCE
+
+#include <boost/rangeio/detail/extern_templates.hpp>
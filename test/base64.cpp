@@ -0,0 +1,340 @@
+//
+// Copyright (c) Mark A. Gibbs, 2015.
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+// 
+
+// This test covers write_base64() and read_base64().
+// 
+// The tests must confirm that the output matches the RFC 4648 test vectors
+// and a simple reference encoder for every input length (so every path
+// through the block encoder is covered), for both alphabets, with and without
+// padding; that everything written can be read back; and that the stream
+// state is handled properly by both.
+// 
+// The block encoding is vectorized when AVX2 is enabled, so this test should
+// also be run built with (for example) -mavx2; detail_simd.cpp compares it
+// with the scalar encoding directly.
+// 
+// This test requires C++11.
+
+#include <boost/config.hpp>
+
+#ifdef BOOST_NO_CXX11_RVALUE_REFERENCES
+#   include <iostream>
+int main() { ::std::cout << "Not supported in C++98.\n"; }
+#else
+
+#include <cstddef>
+#include <ios>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <boost/core/lightweight_test.hpp>
+
+#include <boost/rangeio/base64.hpp>
+
+#include "extras/array_streambuf.hpp"
+#include "extras/more_tests.hpp"
+#include "extras/throwing_streambuf.hpp"
+
+namespace base64_tests {
+
+// Encodes r bit by bit.
+::std::string reference(::std::vector<unsigned char> const& r, bool url, bool padding)
+{
+  char const* const alphabet = url ?
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_" :
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+  
+  ::std::string s;
+  
+  ::std::size_t const bits = r.size() * 8;
+  for (::std::size_t b = 0; b < bits; b += 6)
+  {
+    int v = 0;
+    for (::std::size_t k = b; k < b + 6; ++k)
+      v = (v << 1) | ((k < bits) ? ((r[k / 8] >> (7 - (k % 8))) & 1) : 0);
+    
+    s += alphabet[v];
+  }
+  
+  while (padding && ((s.size() % 4) != 0))
+    s += '=';
+  
+  return s;
+}
+
+::std::vector<unsigned char> make_data(::std::size_t n)
+{
+  ::std::vector<unsigned char> r;
+  for (::std::size_t k = 0; k < n; ++k)
+    r.push_back((unsigned char)((k * 151) ^ (k >> 2) ^ 0x5A));
+  
+  return r;
+}
+
+// Confirm that the output is correct.
+namespace encode {
+
+void test()
+{
+  // RFC 4648 test vectors
+  {
+    char const* const vectors[][2] = {
+      { "f", "Zg==" },
+      { "fo", "Zm8=" },
+      { "foo", "Zm9v" },
+      { "foob", "Zm9vYg==" },
+      { "fooba", "Zm9vYmE=" },
+      { "foobar", "Zm9vYmFy" } };
+    
+    for (auto const& v : vectors)
+    {
+      ::std::string const in = v[0];
+      
+      ::std::ostringstream out;
+      
+      auto const res = ::boost::rangeio::write_base64(out, in.data(), in.size());
+      
+      BOOST_TEST(bool(out));
+      BOOST_TEST(in.data() + in.size() == res.next);
+      BOOST_TEST_EQ(in.size(), res.count);
+      BOOST_RANGEIO_TEST_STR_EQ(out.str(), v[1]);
+    }
+  }
+  
+  // Both alphabets
+  {
+    unsigned char const in[] = { 0xFB, 0xFF };
+    
+    ::std::ostringstream out;
+    ::boost::rangeio::write_base64(out, in, in + 2);
+    out << ' ';
+    ::boost::rangeio::write_base64(out, in, in + 2, ::boost::rangeio::base64_format::base64url());
+    
+    BOOST_RANGEIO_TEST_STR_EQ(out.str(), "+/8= -_8");
+  }
+  
+  // Every length, up to several blocks and batches
+  for (::std::size_t n = 0; n < 1000; n += ((n < 200) ? 1 : 37))
+  {
+    ::std::vector<unsigned char> const data = make_data(n);
+    
+    for (int variant = 0; variant < 4; ++variant)
+    {
+      ::boost::rangeio::base64_format f;
+      f.url = ((variant & 1) != 0);
+      f.padding = ((variant & 2) != 0);
+      
+      ::std::ostringstream out;
+      
+      auto const res = ::boost::rangeio::write_base64(out, data.data(), data.size(), f);
+      
+      BOOST_TEST_EQ(n, res.count);
+      BOOST_TEST(out.str() == reference(data, f.url, f.padding));
+    }
+  }
+  
+  // Wide streams
+  {
+    ::std::string const in = "fooba";
+    
+    ::std::wostringstream out;
+    ::boost::rangeio::write_base64(out, in.data(), in.size());
+    BOOST_TEST(out.str() == L"Zm9vYmE=");
+  }
+}
+
+} // namespace encode
+
+// Confirm that the output can be read back, and that the input is handled
+// properly.
+namespace decode {
+
+::std::string decoded(::std::string const& in, ::std::ios_base::iostate expected_state,
+  ::boost::rangeio::base64_format const& f = ::boost::rangeio::base64_format())
+{
+  ::std::istringstream stream(in);
+  ::std::string s;
+  
+  auto const res = ::boost::rangeio::read_base64(stream, ::std::back_inserter(s), f);
+  
+  BOOST_TEST_EQ(s.size(), res.count);
+  BOOST_TEST_EQ(int(expected_state), int(stream.rdstate()));
+  
+  return s;
+}
+
+void test()
+{
+  // Round trips
+  for (::std::size_t n = 1; n < 300; n += 7)
+  {
+    ::std::vector<unsigned char> const data = make_data(n);
+    
+    for (int variant = 0; variant < 4; ++variant)
+    {
+      ::boost::rangeio::base64_format f;
+      f.url = ((variant & 1) != 0);
+      f.padding = ((variant & 2) != 0);
+      
+      ::std::stringstream stream;
+      ::boost::rangeio::write_base64(stream, data.data(), data.size(), f);
+      
+      ::std::vector<unsigned char> back;
+      auto const res = ::boost::rangeio::read_base64(stream, ::std::back_inserter(back), f);
+      
+      BOOST_TEST_EQ(n, res.count);
+      BOOST_TEST(data == back);
+      BOOST_TEST(stream.eof());
+      BOOST_TEST(!stream.fail());
+    }
+  }
+  
+  auto const eof = ::std::ios_base::eofbit;
+  auto const fail = ::std::ios_base::failbit;
+  auto const good = ::std::ios_base::goodbit;
+  
+  BOOST_RANGEIO_TEST_STR_EQ(decoded("  Zm9vYmFy", eof), "foobar");
+  BOOST_RANGEIO_TEST_STR_EQ(decoded("Zm9vYg==", eof), "foob");
+  BOOST_RANGEIO_TEST_STR_EQ(decoded("Zm9vYg", eof), "foob");
+  BOOST_RANGEIO_TEST_STR_EQ(decoded("-_8", eof, ::boost::rangeio::base64_format::base64url()), "\xFB\xFF");
+  
+  // Reading stops at the first character that is not in the alphabet, or
+  // after the padding
+  {
+    ::std::istringstream stream("Zm9v!Zg==Zg==");
+    ::std::string s;
+    
+    ::boost::rangeio::read_base64(stream, ::std::back_inserter(s));
+    BOOST_RANGEIO_TEST_STR_EQ(s, "foo");
+    BOOST_TEST_EQ('!', char(stream.get()));
+    
+    ::boost::rangeio::read_base64(stream, ::std::back_inserter(s));
+    BOOST_RANGEIO_TEST_STR_EQ(s, "foof");
+    BOOST_TEST(stream.good());
+    
+    ::boost::rangeio::read_base64(stream, ::std::back_inserter(s));
+    BOOST_RANGEIO_TEST_STR_EQ(s, "fooff");
+  }
+  
+  BOOST_RANGEIO_TEST_STR_EQ(decoded("Zm9v-", good), "foo");
+  
+  // Bad input
+  BOOST_RANGEIO_TEST_STR_EQ(decoded("", fail | eof), "");
+  BOOST_RANGEIO_TEST_STR_EQ(decoded("!", fail), "");
+  BOOST_RANGEIO_TEST_STR_EQ(decoded("Zm9vY", fail | eof), "foo");
+  BOOST_RANGEIO_TEST_STR_EQ(decoded("Zg=", fail | eof), "f");
+  BOOST_RANGEIO_TEST_STR_EQ(decoded("Zm9vY=", fail), "foo");
+  
+  // Wide streams
+  {
+    ::std::wistringstream stream(L"Zm9vYmE=");
+    ::std::string s;
+    
+    ::boost::rangeio::read_base64(stream, ::std::back_inserter(s));
+    BOOST_RANGEIO_TEST_STR_EQ(s, "fooba");
+  }
+}
+
+} // namespace decode
+
+// Confirm that the stream state is handled properly by write_base64().
+namespace state {
+
+void test()
+{
+  ::std::vector<unsigned char> const data = make_data(3000);
+  
+  // The stream's formatting is ignored, and the width is reset
+  {
+    ::std::ostringstream out;
+    out.width(10);
+    out.fill('*');
+    
+    ::boost::rangeio::write_base64(out, data.data(), 3);
+    
+    BOOST_TEST_EQ(::std::size_t(4), out.str().size());
+    BOOST_TEST_EQ(0, out.width());
+  }
+  
+  // Stream buffer that fails part way through the first batch; the bytes
+  // of each group whose characters were all accepted are counted
+  {
+    ::boost::rangeio::test_extras::array_streambuf<char, 5> buf;
+    ::std::ostream out(&buf);
+    
+    auto const res = ::boost::rangeio::write_base64(out, data.data(), 30);
+    
+    BOOST_TEST(!out);
+    BOOST_TEST_EQ(::std::size_t(3), res.count);
+    BOOST_TEST(data.data() + 3 == res.next);
+  }
+  
+  // ... and part way through a group in a later batch
+  {
+    ::boost::rangeio::test_extras::array_streambuf<char, 1002> buf;
+    ::std::ostream out(&buf);
+    
+    auto const res = ::boost::rangeio::write_base64(out, data.data(), data.size());
+    
+    BOOST_TEST(!out);
+    BOOST_TEST_EQ(::std::size_t(750), res.count);
+    BOOST_TEST(data.data() + 750 == res.next);
+  }
+  
+  // Stream that has already failed
+  {
+    ::std::ostringstream out;
+    out.setstate(::std::ios_base::failbit);
+    
+    auto const res = ::boost::rangeio::write_base64(out, data.data(), data.size());
+    
+    BOOST_TEST_EQ(::std::size_t(0), res.count);
+    BOOST_TEST(out.str().empty());
+  }
+  
+  // Stream buffer that throws; badbit is set, and the exception is rethrown
+  // only if the stream's exceptions include badbit
+  {
+    ::boost::rangeio::test_extras::throwing_streambuf<char, 5> buf;
+    ::std::ostream out(&buf);
+    
+    auto const res = ::boost::rangeio::write_base64(out, data.data(), 30);
+    
+    BOOST_TEST(out.bad());
+    BOOST_TEST_EQ(::std::size_t(0), res.count);
+    BOOST_TEST(data.data() == res.next);
+  }
+  {
+    ::boost::rangeio::test_extras::throwing_streambuf<char, 5> buf;
+    ::std::ostream out(&buf);
+    out.exceptions(::std::ios_base::badbit);
+    
+    BOOST_TEST_THROWS(::boost::rangeio::write_base64(out, data.data(), 30),
+      ::boost::rangeio::test_extras::streambuf_error);
+    BOOST_TEST(out.bad());
+  }
+}
+
+} // namespace state
+
+} // namespace base64_tests
+
+int main()
+{
+  using namespace base64_tests;
+  
+  encode::test();
+  decode::test();
+  
+  state::test();
+  
+  return boost::report_errors();
+}
+
+#endif  // BOOST_NO_CXX11_RVALUE_REFERENCES
@@ -0,0 +1,322 @@
+//
+// Copyright (c) Mark A. Gibbs, 2015.
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+// 
+
+// This test covers basic_cached_range_writer.
+// 
+// The tests must confirm that the output is exactly the same as the
+// immediate write_iterator_range(), that repeated writes with the same
+// version and formatting state reuse the cached output (with a single sputn()
+// and no allocations), and that changing the version or the formatting state
+// causes the range to be formatted again.
+// 
+// This test requires C++11.
+
+#include <boost/config.hpp>
+
+#ifdef BOOST_NO_CXX11_RVALUE_REFERENCES
+#   include <iostream>
+int main() { ::std::cout << "Not supported in C++98.\n"; }
+#else
+
+#include <cstddef>
+#include <ios>
+#include <locale>
+#include <sstream>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+#include <boost/core/lightweight_test.hpp>
+
+#include <boost/rangeio/cached_range_writer.hpp>
+#include <boost/rangeio/write_iterator_range.hpp>
+
+#include "extras/allocation_counter.hpp"
+#include "extras/array_streambuf.hpp"
+#include "extras/more_tests.hpp"
+
+namespace cached_range_writer_tests {
+
+// String buffer that counts the calls to xsputn().
+class counting_stringbuf :
+  public ::std::stringbuf
+{
+public:
+  counting_stringbuf() : puts(0) {}
+  
+  ::std::size_t puts;
+  
+protected:
+  ::std::streamsize xsputn(char const* s, ::std::streamsize n)
+  {
+    ++puts;
+    return ::std::stringbuf::xsputn(s, n);
+  }
+};
+
+// Element whose inserter fails if its value is negative.
+struct failing_element
+{
+  int value;
+};
+
+::std::ostream& operator<<(::std::ostream& o, failing_element const& e)
+{
+  if (e.value < 0)
+    o.setstate(::std::ios_base::failbit);
+  else
+    o << e.value;
+  
+  return o;
+}
+
+// Confirm that the output is the same as the immediate write.
+namespace normal_range {
+
+template <typename CharT>
+void do_test()
+{
+  ::std::vector<double> const r = { 1.5, 2.25, 3.125, -4.0 };
+  
+  ::std::basic_ostringstream<CharT> expected;
+  expected.precision(3);
+  expected.width(6);
+  ::boost::rangeio::write_iterator_range(expected, r.begin(), r.end(), CharT(';'));
+  
+  ::boost::rangeio::basic_cached_range_writer<CharT> writer;
+  
+  for (int n = 0; n < 3; ++n)
+  {
+    ::std::basic_ostringstream<CharT> out;
+    out.precision(3);
+    out.width(6);
+    
+    writer.write(out, 1, r.begin(), r.end(), CharT(';'));
+    
+    BOOST_TEST(bool(out));
+    BOOST_TEST_EQ(0, out.width());
+    BOOST_RANGEIO_TEST_STR_EQ(out.str(), expected.str());
+    BOOST_TEST(writer.cached());
+    BOOST_TEST_EQ(r.size(), writer.count());
+  }
+  
+  // Without a delimiter
+  {
+    ::boost::rangeio::basic_cached_range_writer<CharT> writer;
+    
+    for (int n = 0; n < 2; ++n)
+    {
+      ::std::basic_ostringstream<CharT> out;
+      writer.write(out, 1, r.begin(), r.end());
+      
+      BOOST_TEST(bool(out));
+      BOOST_RANGEIO_TEST_STR_EQ(out.str(), "1.52.253.125-4");
+    }
+  }
+}
+
+void test()
+{
+  do_test<char>();
+  do_test<wchar_t>();
+}
+
+} // namespace normal_range
+
+// Confirm that the cached output is reused while the version is unchanged,
+// and that changing the version causes the range to be formatted again.
+namespace version {
+
+void test()
+{
+  ::std::vector<int> r = { 1, 2, 3 };
+  
+  ::boost::rangeio::cached_range_writer writer;
+  
+  {
+    ::std::ostringstream out;
+    writer.write(out, 1, r.begin(), r.end(), ", ");
+    BOOST_RANGEIO_TEST_STR_EQ(out.str(), "1, 2, 3");
+  }
+  
+  // Same version, so the (unannounced) change is not seen
+  r[1] = 42;
+  {
+    ::std::ostringstream out;
+    writer.write(out, 1, r.begin(), r.end(), ", ");
+    BOOST_RANGEIO_TEST_STR_EQ(out.str(), "1, 2, 3");
+  }
+  
+  // New version
+  {
+    ::std::ostringstream out;
+    writer.write(out, 2, r.begin(), r.end(), ", ");
+    BOOST_RANGEIO_TEST_STR_EQ(out.str(), "1, 42, 3");
+    BOOST_TEST_EQ(2u, writer.version());
+  }
+  
+  // Explicit invalidation
+  r[2] = 7;
+  writer.invalidate();
+  BOOST_TEST(!writer.cached());
+  {
+    ::std::ostringstream out;
+    writer.write(out, 2, r.begin(), r.end(), ", ");
+    BOOST_RANGEIO_TEST_STR_EQ(out.str(), "1, 42, 7");
+  }
+}
+
+} // namespace version
+
+// Confirm that changing the formatting state causes the range to be
+// formatted again.
+namespace formatting {
+
+void test()
+{
+  ::std::vector<int> const r = { 10, 11, 12 };
+  
+  ::boost::rangeio::cached_range_writer writer;
+  
+  ::std::ostringstream out;
+  
+  writer.write(out, 1, r.begin(), r.end(), ' ');
+  out << '|';
+  out << ::std::hex;
+  writer.write(out, 1, r.begin(), r.end(), ' ');
+  out << '|';
+  out.width(3);
+  out.fill('0');
+  writer.write(out, 1, r.begin(), r.end(), ' ');
+  out << '|';
+  out.width(3);
+  writer.write(out, 1, r.begin(), r.end(), ' ');
+  out << '|';
+  out.imbue(::std::locale(::std::locale::classic(), new ::std::numpunct<char>()));
+  writer.write(out, 1, r.begin(), r.end(), ' ');
+  
+  BOOST_RANGEIO_TEST_STR_EQ(out.str(), "10 11 12|a b c|00a 00b 00c|00a 00b 00c|a b c");
+}
+
+} // namespace formatting
+
+// Confirm that a cached write is a single sputn(), with no allocations.
+namespace single_put {
+
+void test()
+{
+  ::std::vector<int> r;
+  for (int i = 0; i < 1000; ++i)
+    r.push_back(i);
+  
+  ::boost::rangeio::cached_range_writer writer;
+  
+  // Prime the cache
+  {
+    ::std::ostringstream out;
+    writer.write(out, 1, r.begin(), r.end(), ',');
+  }
+  
+  {
+    counting_stringbuf buf;
+    ::std::ostream out(&buf);
+    
+    writer.write(out, 1, r.begin(), r.end(), ',');
+    
+    BOOST_TEST_EQ(::std::size_t(1), buf.puts);
+    BOOST_TEST_EQ(writer.size(), buf.str().size());
+  }
+  
+  {
+    static ::boost::rangeio::test_extras::array_streambuf<char, 8192> buf;
+    ::std::ostream out(&buf);
+    
+    ::boost::rangeio::test_extras::allocation_counter counter;
+    
+    for (int n = 0; n < 2; ++n)
+      writer.write(out, 1, r.begin(), r.end(), ',');
+    
+    BOOST_TEST_EQ(::std::size_t(0), counter.allocations());
+    BOOST_TEST(bool(out));
+    BOOST_TEST_EQ(2 * writer.size(), buf.size());
+  }
+}
+
+} // namespace single_put
+
+// Confirm that failed streams are handled the same way as by the immediate
+// write, and that failed writes are not cached.
+namespace failure {
+
+void test()
+{
+  ::std::vector<int> const r = { 1, 2, 3, 4, 5, 6 };
+  
+  ::boost::rangeio::cached_range_writer writer;
+  
+  // Already failed stream
+  {
+    ::std::ostringstream out;
+    out.setstate(::std::ios_base::failbit);
+    out.width(4);
+    
+    writer.write(out, 1, r.begin(), r.end(), ',');
+    
+    BOOST_TEST(!out);
+    BOOST_TEST_EQ(0, out.width());
+    BOOST_TEST(out.str().empty());
+    BOOST_TEST(!writer.cached());
+  }
+  
+  // Stream that fails part way
+  {
+    ::boost::rangeio::test_extras::array_streambuf<char, 4> buf;
+    ::std::ostream out(&buf);
+    
+    writer.write(out, 1, r.begin(), r.end(), ',');
+    
+    BOOST_TEST(!out);
+    BOOST_TEST(writer.cached());
+  }
+  
+  // Element inserter that fails part way
+  {
+    failing_element const f[] = { { 1 }, { 2 }, { -1 }, { 4 } };
+    
+    ::std::ostringstream out;
+    
+    ::boost::rangeio::cached_range_writer w;
+    w.write(out, 1, f, f + 4, ',');
+    
+    BOOST_TEST(!out);
+    BOOST_TEST(!w.cached());
+    BOOST_TEST_EQ(::std::size_t(2), w.count());
+    BOOST_RANGEIO_TEST_STR_EQ(out.str(), "1,2,");
+  }
+}
+
+} // namespace failure
+
+} // namespace cached_range_writer_tests
+
+int main()
+{
+  using namespace cached_range_writer_tests;
+  
+  normal_range::test();
+  
+  version::test();
+  formatting::test();
+  
+  single_put::test();
+  
+  failure::test();
+  
+  return boost::report_errors();
+}
+
+#endif  // BOOST_NO_CXX11_RVALUE_REFERENCES
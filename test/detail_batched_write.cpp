@@ -0,0 +1,502 @@
+//
+// Copyright (c) Mark A. Gibbs, 2015.
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+// 
+
+// This test covers the batched write loop that write_impl() uses for ranges
+// of integers.
+// 
+// The tests must confirm that the output is always exactly the same as
+// writing each element with "out << *i" (with the width restored for each
+// element), for every integer type, adjustment, base and fill, with each
+// kind of delimiter; that the loop is not used when it would produce
+// different output (showbase, unitbuf, a locale with digit grouping); and
+// that failures and the stream's width are handled the same way.
+// 
+// This test requires C++11.
+
+#include <boost/config.hpp>
+
+#ifdef BOOST_NO_CXX11_RVALUE_REFERENCES
+#   include <iostream>
+int main() { ::std::cout << "Not supported in C++98.\n"; }
+#else
+
+#include <cstddef>
+#include <ios>
+#include <iterator>
+#include <limits>
+#include <locale>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <boost/core/lightweight_test.hpp>
+
+#include <boost/rangeio/write_iterator_range.hpp>
+
+#include "extras/array_streambuf.hpp"
+#include "extras/more_tests.hpp"
+#include "extras/throwing_streambuf.hpp"
+
+namespace detail_batched_write_tests {
+
+// Sets up a stream's formatting state.
+struct format
+{
+  ::std::ios_base::fmtflags  flags;
+  ::std::streamsize          width;
+  char                       fill;
+  
+  template <typename CharT, typename Traits>
+  void apply(::std::basic_ostream<CharT, Traits>& out) const
+  {
+    out.flags(flags);
+    out.width(width);
+    out.fill(out.widen(fill));
+  }
+};
+
+::std::vector<format> formats()
+{
+  using ::std::ios_base;
+  
+  return {
+    { ios_base::dec, 0, ' ' },
+    { ios_base::dec, 12, ' ' },
+    { ios_base::dec | ios_base::left, 12, '.' },
+    { ios_base::dec | ios_base::internal | ios_base::showpos, 12, '*' },
+    { ios_base::dec | ios_base::right | ios_base::showpos, 3, '#' },
+    { ios_base::hex, 0, ' ' },
+    { ios_base::hex | ios_base::uppercase | ios_base::internal, 20, '0' },
+    { ios_base::oct | ios_base::left | ios_base::showpos, 25, '_' }
+  };
+}
+
+// Some values of type T, including the extremes.
+template <typename T>
+::std::vector<T> values()
+{
+  ::std::vector<T> v;
+  
+  v.push_back(T(0));
+  v.push_back(T(1));
+  v.push_back(T(-1));
+  v.push_back(T(42));
+  v.push_back(T(-42));
+  v.push_back(::std::numeric_limits<T>::min());
+  v.push_back(::std::numeric_limits<T>::max());
+  v.push_back(T(::std::numeric_limits<T>::max() / 3));
+  
+  return v;
+}
+
+// The expected output: each element written with "out << *i", with the
+// width restored for each one.
+template <typename CharT, typename T, typename Delimiter>
+::std::basic_string<CharT> expected(::std::vector<T> const& v, format const& f, Delimiter const& d)
+{
+  ::std::basic_ostringstream<CharT> out;
+  f.apply(out);
+  
+  for (::std::size_t k = 0; k < v.size(); ++k)
+  {
+    if (k != 0)
+      out << d;
+    
+    out.width(f.width);
+    out << v[k];
+  }
+  
+  return out.str();
+}
+
+template <typename CharT, typename T>
+::std::basic_string<CharT> expected(::std::vector<T> const& v, format const& f)
+{
+  ::std::basic_ostringstream<CharT> out;
+  f.apply(out);
+  
+  for (auto const& x : v)
+  {
+    out.width(f.width);
+    out << x;
+  }
+  
+  return out.str();
+}
+
+// Confirm that the output is the same as "out << *i" for each integer type
+// and format.
+namespace types {
+
+template <typename CharT, typename T>
+void do_test()
+{
+  auto const v = values<T>();
+  
+  for (auto const& f : formats())
+  {
+    // No delimiter
+    {
+      ::std::basic_ostringstream<CharT> out;
+      f.apply(out);
+      
+      auto const res = ::boost::rangeio::write_iterator_range(out, v.begin(), v.end());
+      
+      BOOST_TEST(v.end() == res.next);
+      BOOST_TEST_EQ(v.size(), res.count);
+      BOOST_TEST(bool(out));
+      BOOST_TEST_EQ(0, out.width());
+      BOOST_TEST(out.str() == (expected<CharT>(v, f)));
+    }
+    
+    // Delimiter
+    {
+      ::std::basic_ostringstream<CharT> out;
+      f.apply(out);
+      
+      auto const res = ::boost::rangeio::write_iterator_range(out, v.begin(), v.end(), CharT(','));
+      
+      BOOST_TEST(v.end() == res.next);
+      BOOST_TEST_EQ(v.size(), res.count);
+      BOOST_TEST_EQ(0, out.width());
+      BOOST_TEST(out.str() == (expected<CharT>(v, f, CharT(','))));
+    }
+    
+    // Counted
+    {
+      ::std::basic_ostringstream<CharT> out;
+      f.apply(out);
+      
+      auto const res = ::boost::rangeio::write_iterator_range_n(out, v.begin(), 3, CharT(','));
+      
+      BOOST_TEST(v.begin() + 3 == res.next);
+      BOOST_TEST_EQ(::std::size_t(3), res.count);
+      BOOST_TEST(out.str() == (expected<CharT>(::std::vector<T>(v.begin(), v.begin() + 3), f, CharT(','))));
+    }
+  }
+}
+
+template <typename CharT>
+void do_test()
+{
+  do_test<CharT, short>();
+  do_test<CharT, unsigned short>();
+  do_test<CharT, int>();
+  do_test<CharT, unsigned int>();
+  do_test<CharT, long>();
+  do_test<CharT, unsigned long>();
+  do_test<CharT, long long>();
+  do_test<CharT, unsigned long long>();
+}
+
+void test()
+{
+  do_test<char>();
+  do_test<wchar_t>();
+}
+
+} // namespace types
+
+// Confirm that each kind of delimiter is written properly, including ones
+// the batched loop does not support.
+namespace delimiters {
+
+struct custom_delimiter {};
+
+::std::ostream& operator<<(::std::ostream& o, custom_delimiter)
+{
+  return o << "<>";
+}
+
+void test()
+{
+  ::std::vector<int> const v = { 1, -2, 3 };
+  format const f = { ::std::ios_base::dec | ::std::ios_base::left, 4, '.' };
+  
+  {
+    ::std::ostringstream out;
+    f.apply(out);
+    ::boost::rangeio::write_iterator_range(out, v.begin(), v.end(), ", ");
+    BOOST_RANGEIO_TEST_STR_EQ(out.str(), "1..., -2.., 3...");
+  }
+  
+  {
+    char d[] = "|";
+    ::std::ostringstream out;
+    f.apply(out);
+    ::boost::rangeio::write_iterator_range(out, v.begin(), v.end(), static_cast<char*>(d));
+    BOOST_RANGEIO_TEST_STR_EQ(out.str(), "1...|-2..|3...");
+  }
+  
+  {
+    ::std::ostringstream out;
+    f.apply(out);
+    ::boost::rangeio::write_iterator_range(out, v.begin(), v.end(), ::std::string(" - "));
+    BOOST_RANGEIO_TEST_STR_EQ(out.str(), "1... - -2.. - 3...");
+  }
+  
+  {
+    ::std::ostringstream out;
+    f.apply(out);
+    ::boost::rangeio::write_iterator_range(out, v.begin(), v.end(), custom_delimiter());
+    BOOST_RANGEIO_TEST_STR_EQ(out.str(), "1...<>-2..<>3...");
+  }
+  
+  // A null pointer delimiter fails the stream, as "out << d" would
+  {
+    ::std::ostringstream out;
+    
+    auto const res = ::boost::rangeio::write_iterator_range(out, v.begin(), v.end(), static_cast<char const*>(0));
+    
+    BOOST_TEST(!out);
+    BOOST_TEST(v.begin() + 1 == res.next);
+    BOOST_TEST_EQ(::std::size_t(1), res.count);
+  }
+}
+
+} // namespace delimiters
+
+// Confirm that ranges larger than the batch are written properly.
+namespace large {
+
+void test()
+{
+  ::std::vector<long> v;
+  for (long k = -5000; k < 5000; k += 3)
+    v.push_back(k * 1234567L);
+  
+  for (auto const& f : formats())
+  {
+    ::std::ostringstream out;
+    f.apply(out);
+    
+    auto const res = ::boost::rangeio::write_iterator_range(out, v.begin(), v.end(), ", ");
+    
+    BOOST_TEST(v.end() == res.next);
+    BOOST_TEST_EQ(v.size(), res.count);
+    BOOST_RANGEIO_TEST_STR_EQ(out.str(), (expected<char>(v, f, ", ")));
+  }
+}
+
+} // namespace large
+
+// Confirm that the output is still correct when the batched loop cannot be
+// used.
+namespace fallback {
+
+// Groups digits in threes, with ' as the separator.
+struct grouping_numpunct :
+  ::std::numpunct<char>
+{
+protected:
+  char do_thousands_sep() const { return '\''; }
+  ::std::string do_grouping() const { return "\3"; }
+};
+
+void test()
+{
+  ::std::vector<int> const v = { 10, 1234567, -255 };
+  
+  // showbase
+  {
+    ::std::ostringstream out;
+    out << ::std::hex << ::std::showbase;
+    ::boost::rangeio::write_iterator_range(out, v.begin(), v.end(), ' ');
+    BOOST_RANGEIO_TEST_STR_EQ(out.str(), "0xa 0x12d687 0xffffff01");
+  }
+  
+  // unitbuf
+  {
+    ::std::ostringstream out;
+    out << ::std::unitbuf;
+    ::boost::rangeio::write_iterator_range(out, v.begin(), v.end(), ' ');
+    BOOST_RANGEIO_TEST_STR_EQ(out.str(), "10 1234567 -255");
+  }
+  
+  // Digit grouping
+  {
+    ::std::ostringstream out;
+    out.imbue(::std::locale(out.getloc(), new grouping_numpunct));
+    ::boost::rangeio::write_iterator_range(out, v.begin(), v.end(), ' ');
+    BOOST_RANGEIO_TEST_STR_EQ(out.str(), "10 1'234'567 -255");
+  }
+  
+  // Not random access
+  {
+    ::std::istringstream in("1 2 3");
+    ::std::ostringstream out;
+    out.width(2);
+    ::boost::rangeio::write_iterator_range(out, ::std::istream_iterator<int>(in), ::std::istream_iterator<int>(), ',');
+    BOOST_RANGEIO_TEST_STR_EQ(out.str(), " 1, 2, 3");
+  }
+  
+  // Not integers
+  {
+    ::std::vector<char> const c = { 'a', 'b' };
+    ::std::ostringstream out;
+    out.width(2);
+    ::boost::rangeio::write_iterator_range(out, c.begin(), c.end(), ',');
+    BOOST_RANGEIO_TEST_STR_EQ(out.str(), " a, b");
+  }
+}
+
+} // namespace fallback
+
+// Confirm that the loop is used when the range's iterator and end are
+// different, but convertible, types.
+namespace mixed_iterators {
+
+// Unbuffered stream buffer that counts the calls made to write to it.
+class counting_streambuf :
+  public ::std::streambuf
+{
+public:
+  counting_streambuf() :
+    writes(0)
+  {}
+  
+  ::std::string str;
+  int writes;
+  
+protected:
+  int_type overflow(int_type c)
+  {
+    if (!traits_type::eq_int_type(c, traits_type::eof()))
+    {
+      ++writes;
+      str += traits_type::to_char_type(c);
+    }
+    
+    return traits_type::not_eof(c);
+  }
+  
+  ::std::streamsize xsputn(char const* p, ::std::streamsize n)
+  {
+    ++writes;
+    str.append(p, ::std::size_t(n));
+    return n;
+  }
+};
+
+template <typename InputIterator, typename Sentinel>
+void do_test(InputIterator i, Sentinel e, ::std::size_t size)
+{
+  counting_streambuf buf;
+  ::std::ostream out(&buf);
+  
+  auto const res = ::boost::rangeio::write_iterator_range(out, i, e, ", ");
+  
+  BOOST_TEST(bool(out));
+  BOOST_TEST(e == res.next);
+  BOOST_TEST_EQ(size, res.count);
+  BOOST_RANGEIO_TEST_STR_EQ("17, -42, 99, 0", buf.str);
+  
+  // The batched loop hands everything on in one write (the element-wise loop
+  // makes at least one for each element and delimiter).
+  BOOST_TEST_EQ(1, buf.writes);
+}
+
+void test()
+{
+  ::std::vector<int> v = { 17, -42, 99, 0 };
+  
+  do_test(v.cbegin(), v.end(), v.size());
+  do_test(v.begin(), v.cend(), v.size());
+  
+  int const* const p = v.data();
+  do_test(v.data(), p + v.size(), v.size());
+}
+
+} // namespace mixed_iterators
+
+// Confirm that failures are handled the same way as by the element-wise
+// loop.
+namespace failure {
+
+void test()
+{
+  ::std::vector<int> const v = { 17, 42, 99 };
+  
+  // Stream that fails part way
+  {
+    ::boost::rangeio::test_extras::array_streambuf<char, 5> buf;
+    ::std::ostream out(&buf);
+    out.width(3);
+    
+    auto const res = ::boost::rangeio::write_iterator_range(out, v.begin(), v.end(), ", ");
+    
+    BOOST_TEST(!out);
+    BOOST_TEST(out.bad());
+    BOOST_TEST_EQ(0, out.width());
+    BOOST_TEST(v.begin() + 1 == res.next);
+    BOOST_TEST_EQ(::std::size_t(1), res.count);
+  }
+  
+  // Stream that has already failed
+  {
+    ::std::ostringstream out;
+    out.setstate(::std::ios_base::failbit);
+    out.width(3);
+    
+    auto const res = ::boost::rangeio::write_iterator_range(out, v.begin(), v.end(), ", ");
+    
+    BOOST_TEST(v.begin() == res.next);
+    BOOST_TEST_EQ(::std::size_t(0), res.count);
+    BOOST_TEST_EQ(0, out.width());
+    BOOST_TEST(out.str().empty());
+  }
+  
+  // Stream buffer that throws; badbit is set, and the exception is not
+  // rethrown...
+  {
+    ::boost::rangeio::test_extras::throwing_streambuf<char, 5> buf;
+    ::std::ostream out(&buf);
+    out.width(3);
+    
+    auto const res = ::boost::rangeio::write_iterator_range(out, v.begin(), v.end(), ", ");
+    
+    BOOST_TEST(out.bad());
+    BOOST_TEST_EQ(0, out.width());
+    BOOST_TEST(v.begin() == res.next);
+    BOOST_TEST_EQ(::std::size_t(0), res.count);
+  }
+  
+  // ... unless the stream's exceptions include badbit
+  {
+    ::boost::rangeio::test_extras::throwing_streambuf<char, 5> buf;
+    ::std::ostream out(&buf);
+    out.exceptions(::std::ios_base::badbit);
+    
+    BOOST_TEST_THROWS(::boost::rangeio::write_iterator_range(out, v.begin(), v.end()),
+      ::boost::rangeio::test_extras::streambuf_error);
+    BOOST_TEST(out.bad());
+  }
+}
+
+} // namespace failure
+
+} // namespace detail_batched_write_tests
+
+int main()
+{
+  using namespace detail_batched_write_tests;
+  
+  types::test();
+  delimiters::test();
+  
+  large::test();
+  
+  fallback::test();
+  
+  mixed_iterators::test();
+  
+  failure::test();
+  
+  return boost::report_errors();
+}
+
+#endif  // BOOST_NO_CXX11_RVALUE_REFERENCES
@@ -9,8 +9,14 @@
 // state of an istream or ostream at the beginning of a read/write operation,
 // and restores it before each element after the first.
 // 
+// The tests must confirm that the whole formatting state (flags, precision,
+// width and fill character) is restored, and that the stream is never imbued
+// (the locale is deliberately not saved - see formatting_saver).
+// 
 // This test must work even in C++98 mode.
 
+#include <ios>
+#include <locale>
 #include <sstream>
 
 #include <boost/core/lightweight_test.hpp>
@@ -26,13 +32,59 @@ namespace formatting_saver_tests {
 template <typename CharT>
 struct stream_state
 {
-  ::std::streamsize  width;
+  ::std::ios_base::fmtflags  flags;
+  ::std::streamsize          precision;
+  ::std::streamsize          width;
+  CharT                      fill;
   
-  stream_state(::std::streamsize w) :
-    width(w)
+  stream_state(::std::ios_base::fmtflags f, ::std::streamsize p, ::std::streamsize w, CharT c) :
+    flags(f),
+    precision(p),
+    width(w),
+    fill(c)
   {}
+  
+  template <typename IOStream>
+  void apply(IOStream& s) const
+  {
+    s.flags(flags);
+    s.precision(precision);
+    s.width(width);
+    s.fill(fill);
+  }
+  
+  template <typename IOStream>
+  bool matches(IOStream const& s) const
+  {
+    return (s.flags() == flags) &&
+      (s.precision() == precision) &&
+      (s.width() == width) &&
+      (s.fill() == fill);
+  }
+};
+
+// 
+// Numpunct facet that is distinguishable from the classic one.
+// 
+template <typename CharT>
+struct test_numpunct :
+  ::std::numpunct<CharT>
+{
+protected:
+  CharT do_decimal_point() const { return CharT(','); }
 };
 
+// 
+// Stream callback that counts the times a stream is imbued.
+// 
+int imbue_count = 0;
+
+void count_imbues(::std::ios_base::event ev, ::std::ios_base&, int)
+{
+  if (ev == ::std::ios_base::imbue_event)
+    ++imbue_count;
+}
+
 // 
 // Templated test function, so that the different stream types can all be tested
 // with a single function.
@@ -43,43 +95,73 @@ void test_formatting_saver(IOStream& s)
   typedef typename IOStream::char_type   char_type;
   typedef typename IOStream::traits_type traits_type;
   
-  stream_state<char_type> const a(10);
-  stream_state<char_type> const b(2);
+  stream_state<char_type> const a(::std::ios_base::hex | ::std::ios_base::left, 3, 10, char_type('*'));
+  stream_state<char_type> const b(::std::ios_base::oct | ::std::ios_base::showpos, 9, 2, char_type('_'));
+  
+  a.apply(s);
   
-  s.width(a.width);
+  ::std::locale const original = s.getloc();
+  ::std::locale const other(original, new test_numpunct<char_type>);
+  
+  s.register_callback(&count_imbues, 0);
   
   {
     // Make sure we're starting out sane.
-    BOOST_TEST_EQ(a.width, s.width());
+    BOOST_TEST(a.matches(s));
     
     ::boost::rangeio::detail::formatting_saver<char_type, traits_type> const fs(s);
     
     // Confirm that no state is changed by the constructor.
-    BOOST_TEST_EQ(a.width, s.width());
+    BOOST_TEST(a.matches(s));
     
+    imbue_count = 0;
     fs.restore();
     
-    // Check that the original state has been restored.
-    BOOST_TEST_EQ(a.width, s.width());
+    // Check that the original state has been restored, without imbuing the
+    // stream.
+    BOOST_TEST(a.matches(s));
+    BOOST_TEST_EQ(0, imbue_count);
     
+    // Change only the width.
     s.width(b.width);
+    BOOST_TEST_EQ(b.width, s.width());
+    
+    fs.restore();
+    
+    BOOST_TEST(a.matches(s));
+    BOOST_TEST_EQ(0, imbue_count);
+    
+    // Change everything.
+    b.apply(s);
+    s.imbue(other);
     
     // Confirm that we've changed the state.
-    BOOST_TEST_EQ(b.width, s.width());
+    BOOST_TEST(b.matches(s));
+    BOOST_TEST(s.getloc() == other);
+    BOOST_TEST_EQ(1, imbue_count);
     
     fs.restore();
     
-    // Check that the original state has been restored.
-    BOOST_TEST_EQ(a.width, s.width());
+    // Check that the original state has been restored, and the locale has
+    // been left alone.
+    BOOST_TEST(a.matches(s));
+    BOOST_TEST(s.getloc() == other);
+    BOOST_TEST_EQ(1, imbue_count);
     
-    s.width(b.width);
+    // Check that it isn't restored again, once it has been restored.
+    fs.restore();
+    
+    BOOST_TEST(a.matches(s));
+    BOOST_TEST_EQ(1, imbue_count);
+    
+    b.apply(s);
     
     // Confirm that we've changed the state.
-    BOOST_TEST_EQ(b.width, s.width());
+    BOOST_TEST(b.matches(s));
   }
   
   // Check that the destructor did not change the state.
-  BOOST_TEST_EQ(b.width, s.width());
+  BOOST_TEST(b.matches(s));
 }
 
 namespace istream_formatting_saver {
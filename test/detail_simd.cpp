@@ -0,0 +1,160 @@
+//
+// Copyright (c) Mark A. Gibbs, 2015.
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+// 
+
+// This test covers the vectorized encoding functions (see detail/simd.hpp).
+// 
+// The tests must confirm that each vectorized function produces exactly the
+// same output as its scalar version, for every length (including the lengths
+// around the vector block sizes), at every alignment, and that it writes
+// nothing past the end of its output. Each input is copied to storage of
+// exactly its size, so that reads past its end are caught by the address
+// sanitizer (when it is used).
+// 
+// The vectorized functions are only compiled when their instruction sets are
+// enabled, so the makefile also builds this test with -mssse3
+// (detail_simd_ssse3) and -mavx2 (detail_simd_avx2). Built without them, it
+// only compares the scalar functions with themselves.
+// 
+// This test requires C++11.
+
+#include <boost/config.hpp>
+
+#ifdef BOOST_NO_CXX11_RVALUE_REFERENCES
+#   include <iostream>
+int main() { ::std::cout << "Not supported in C++98.\n"; }
+#else
+
+#include <cstddef>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include <boost/core/lightweight_test.hpp>
+
+#include <boost/rangeio/detail/base64.hpp>
+#include <boost/rangeio/detail/hex.hpp>
+#include <boost/rangeio/detail/simd.hpp>
+
+namespace detail_simd_tests {
+
+// The longest input tried, in elements (bytes or groups).
+::std::size_t const max_length = 300;
+
+// The most the input is offset from an aligned address.
+::std::size_t const max_offset = 31;
+
+// Written after the expected end of the output, to catch overruns.
+char const guard = '#';
+
+// n random bytes.
+::std::vector<unsigned char> random_bytes(::std::mt19937& engine, ::std::size_t n)
+{
+  ::std::uniform_int_distribution<int> byte(0, 255);
+  
+  ::std::vector<unsigned char> r(n);
+  for (auto& b : r)
+    b = static_cast<unsigned char>(byte(engine));
+  
+  return r;
+}
+
+// Confirm that hex_encode_bytes() matches hex_encode_bytes_scalar().
+namespace hex {
+
+void test()
+{
+  ::std::mt19937 engine(12345);
+  
+  char const* const digits = ::boost::rangeio::detail::hex_digits(false);
+  
+  for (int round = 0; round != 20; ++round)
+  {
+    ::std::vector<unsigned char> const r = random_bytes(engine, max_offset + max_length);
+    
+    for (::std::size_t offset = 0; offset <= max_offset; offset += (round % 4) + 1)
+    {
+      for (::std::size_t n = 0; n <= max_length; ++n)
+      {
+        ::std::vector<unsigned char> const in(r.begin(), r.begin() + (offset + n));
+        
+        ::std::vector<char> expected(2 * n + 64, guard);
+        ::std::vector<char> actual(2 * n + 64, guard);
+        
+        ::boost::rangeio::detail::hex_encode_bytes_scalar(in.data() + offset, n, expected.data(), digits);
+        ::boost::rangeio::detail::hex_encode_bytes(in.data() + offset, n, actual.data(), digits);
+        
+        if (!BOOST_TEST(actual == expected))
+        {
+          ::std::cerr << "  (hex, length " << n << ", offset " << offset << ")\n";
+          return;
+        }
+      }
+    }
+  }
+}
+
+} // namespace hex
+
+// Confirm that base64_encode_groups() matches base64_encode_groups_scalar(),
+// for both alphabets.
+namespace base64 {
+
+void test()
+{
+  ::std::mt19937 engine(54321);
+  
+  for (int round = 0; round != 20; ++round)
+  {
+    ::std::vector<unsigned char> const r = random_bytes(engine, max_offset + 3 * max_length);
+    
+    char const* const alphabet = ::boost::rangeio::detail::base64_alphabet((round % 2) != 0);
+    
+    for (::std::size_t offset = 0; offset <= max_offset; offset += (round % 4) + 1)
+    {
+      for (::std::size_t n = 0; n <= max_length; ++n)
+      {
+        ::std::vector<unsigned char> const in(r.begin(), r.begin() + (offset + 3 * n));
+        
+        ::std::vector<char> expected(4 * n + 64, guard);
+        ::std::vector<char> actual(4 * n + 64, guard);
+        
+        ::boost::rangeio::detail::base64_encode_groups_scalar(in.data() + offset, n, expected.data(), alphabet);
+        ::boost::rangeio::detail::base64_encode_groups(in.data() + offset, n, actual.data(), alphabet);
+        
+        if (!BOOST_TEST(actual == expected))
+        {
+          ::std::cerr << "  (base64, groups " << n << ", offset " << offset << ")\n";
+          return;
+        }
+      }
+    }
+  }
+}
+
+} // namespace base64
+
+} // namespace detail_simd_tests
+
+int main()
+{
+  using namespace detail_simd_tests;
+
+#if defined(BOOST_RANGEIO_HAS_AVX2) && defined(__GNUC__)
+  if (!__builtin_cpu_supports("avx2"))
+  {
+    ::std::cout << "Not supported by this processor (no AVX2).\n";
+    return 0;
+  }
+#endif
+
+  hex::test();
+  base64::test();
+  
+  return boost::report_errors();
+}
+
+#endif  // BOOST_NO_CXX11_RVALUE_REFERENCES
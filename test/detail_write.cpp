@@ -10,7 +10,7 @@
 // delimiters.
 // 
 // The tests must confirm that writes are done correctly and that formatting is
-// preserved between elements.
+// preserved between elements, even when an element changes it.
 // 
 // This test must work even in C++98 mode.
 
@@ -274,6 +274,59 @@ void test()
 
 } // namespace formatting
 
+// Confirm that the formatting is restored for each element, even when the
+// previous element changed it.
+namespace changed_formatting {
+
+// Element that changes the stream's formatting state after writing itself.
+struct meddling_element
+{
+  double value;
+};
+
+::std::ostream& operator<<(::std::ostream& out, meddling_element const& e)
+{
+  out << e.value;
+  
+  out.precision(1);
+  out.fill('#');
+  out.setf(::std::ios_base::fixed, ::std::ios_base::floatfield);
+  out.imbue(::std::locale(::std::locale::classic(), new ::std::numpunct<char>));
+  
+  return out;
+}
+
+void test()
+{
+  // Prepare the range to be written
+  meddling_element const r[] = { { 1.23456 }, { 2.5 }, { 3.0 } };
+  ::std::size_t const r_size = sizeof(r) / sizeof(r[0]);
+  
+  // Prepare the output stream
+  ::std::ostringstream out;
+  ::std::locale const loc = out.getloc();
+  
+  out.width(6);
+  out.fill('.');
+  out.precision(3);
+  
+  // Do the write
+  meddling_element const* i = r;
+  ::std::size_t n = 0;
+  ::boost::rangeio::detail::write_impl(out, i, i + r_size, n);
+  
+  // Make sure the write happened as it should have
+  BOOST_TEST_EQ(r_size, n);
+  BOOST_TEST(bool(out));
+  BOOST_TEST_EQ("..1.23" "...2.5" ".....3", out.str());
+  
+  // The last element's changes are not undone
+  BOOST_TEST_EQ(::std::streamsize(1), out.precision());
+  BOOST_TEST(out.getloc() != loc);
+}
+
+} // namespace changed_formatting
+
 } // namespace write_impl_tests
 
 int main()
@@ -289,6 +342,7 @@ int main()
   input_iterator_range::test();
   
   formatting::test();
+  changed_formatting::test();
   
   return boost::report_errors();
 }
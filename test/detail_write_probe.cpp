@@ -0,0 +1,168 @@
+//
+// Copyright (c) Mark A. Gibbs, 2015.
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+// 
+
+// This test covers the internal write implementation with the USDT probes
+// compiled in (if <sys/sdt.h> is available - otherwise, it is the same as
+// running the tests with the probes disabled).
+// 
+// The tests must confirm that the probes do not change the results of a
+// write in any way - including when the stream fails, and when the characters
+// written are being counted - and that they do not change how the user's own
+// probes are compiled.
+// 
+// This test must work even in C++98 mode.
+
+#if defined(__has_include)
+#   if __has_include(<sys/sdt.h>)
+#       define BOOST_RANGEIO_ENABLE_USDT
+#   endif
+#endif
+
+// Whether this test (as the user) asked for semaphores.
+#if !defined(_SDT_HAS_SEMAPHORES)
+#   define WRITE_PROBE_TESTS_NO_SEMAPHORES
+#endif
+
+#include <locale>
+#include <sstream>
+#include <vector>
+
+#include <boost/core/lightweight_test.hpp>
+
+#include <boost/rangeio/detail/write.hpp>
+
+#include "extras/array_streambuf.hpp"
+#include "extras/more_tests.hpp"
+
+namespace write_probe_tests {
+
+// Confirm that ranges are written properly, with and without delimiters.
+namespace normal_range {
+
+template <typename CharT>
+void do_test()
+{
+  int r[] = { 1, 1, 2, 3, 5, 8 };
+  ::std::size_t const r_size = sizeof(r) / sizeof(r[0]);
+  
+  // Without delimiter
+  {
+    ::std::basic_ostringstream<CharT> out;
+    out.imbue(::std::locale::classic());
+    
+    int* i = r;
+    ::std::size_t n = 42;
+    ::boost::rangeio::detail::write_impl(out, i, r + r_size, n);
+    
+    BOOST_TEST_EQ(r_size + 42, n);
+    BOOST_TEST(r + r_size == i);
+    
+    BOOST_TEST(bool(out));
+    BOOST_RANGEIO_TEST_STR_EQ("112358", out.str());
+  }
+  
+  // With delimiter
+  {
+    ::std::basic_ostringstream<CharT> out;
+    out.imbue(::std::locale::classic());
+    
+    int* i = r;
+    ::std::size_t n = 0;
+    char const delim = '-';
+    ::boost::rangeio::detail::write_impl(out, i, r + r_size, delim, n);
+    
+    BOOST_TEST_EQ(r_size, n);
+    BOOST_TEST(r + r_size == i);
+    
+    BOOST_TEST(bool(out));
+    BOOST_RANGEIO_TEST_STR_EQ("1-1-2-3-5-8", out.str());
+  }
+}
+
+void test()
+{
+  do_test<char>();
+  do_test<wchar_t>();
+}
+
+} // namespace normal_range
+
+// Confirm that failed writes stop in the right place, and leave the stream's
+// buffer and state as they would be without the probes.
+namespace failed_write {
+
+void test()
+{
+  ::std::vector<int> r(10, 1234);
+  
+  ::boost::rangeio::test_extras::array_streambuf<char, 12> buf;
+  ::std::ostream out(&buf);
+  out.imbue(::std::locale::classic());
+  
+  ::std::vector<int>::iterator i = r.begin();
+  ::std::size_t n = 0;
+  char const delim = ' ';
+  ::boost::rangeio::detail::write_impl(out, i, r.end(), delim, n);
+  
+  BOOST_TEST(!out);
+  BOOST_TEST(out.rdbuf() == &buf);
+  BOOST_TEST_EQ(::std::size_t(2), n);
+  BOOST_TEST(r.begin() + 2 == i);
+  BOOST_TEST_EQ("1234 1234 12", buf.str());
+}
+
+} // namespace failed_write
+
+// Confirm that nothing changes while a tracer is attached (which is simulated
+// by setting a probe semaphore, if the probes have them), when the characters
+// written are counted.
+namespace attached {
+
+void test()
+{
+#if defined(BOOST_RANGEIO_ENABLE_USDT) && defined(_SDT_HAS_SEMAPHORES)
+  ++boost_rangeio_write__end_semaphore;
+  
+  normal_range::do_test<char>();
+  failed_write::test();
+  
+  --boost_rangeio_write__end_semaphore;
+#endif
+}
+
+} // namespace attached
+
+// Confirm that the user's own probes still compile and link without
+// semaphores of their own (which they would need if including the probes
+// turned semaphores on for the whole translation unit).
+namespace user_probe {
+
+void test()
+{
+#if defined(BOOST_RANGEIO_ENABLE_USDT) && defined(WRITE_PROBE_TESTS_NO_SEMAPHORES)
+  DTRACE_PROBE(write_probe_tests, user);
+#endif
+}
+
+} // namespace user_probe
+
+} // namespace write_probe_tests
+
+int main()
+{
+  using namespace write_probe_tests;
+  
+  normal_range::test();
+  
+  failed_write::test();
+  
+  attached::test();
+  
+  user_probe::test();
+  
+  return boost::report_errors();
+}
@@ -0,0 +1,244 @@
+//
+// Copyright (c) Mark A. Gibbs, 2015.
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+// 
+
+// This test covers the type-erased write loop, used when
+// BOOST_RANGEIO_ERASED_WRITE is defined.
+// 
+// The tests must confirm that the type-erased loop is selected only when it
+// should be, and that writes using it behave exactly the same as writes using
+// the inlined loops.
+// 
+// This test requires C++11.
+
+#define BOOST_RANGEIO_ERASED_WRITE
+
+#include <boost/config.hpp>
+
+#ifdef BOOST_NO_CXX11_RVALUE_REFERENCES
+#   include <iostream>
+int main() { ::std::cout << "Not supported in C++98.\n"; }
+#else
+
+#include <deque>
+#include <ios>
+#include <list>
+#include <locale>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <boost/core/lightweight_test.hpp>
+
+#include <boost/rangeio/prefer_inline_write.hpp>
+#include <boost/rangeio/sentinels.hpp>
+#include <boost/rangeio/write_iterator_range.hpp>
+
+#include "extras/array_streambuf.hpp"
+#include "extras/more_tests.hpp"
+
+// Opt list<long> back in to the inlined loop.
+namespace boost {
+namespace rangeio {
+
+template <typename Delimiter>
+struct prefer_inline_write<
+  ::std::list<long>::const_iterator,
+  ::std::list<long>::const_iterator,
+  Delimiter> :
+  ::boost::true_type
+{};
+
+} // namespace rangeio
+} // namespace boost
+
+namespace erased_write_tests {
+
+// Confirm that the type-erased loop is selected when it should be.
+namespace selection {
+
+void test()
+{
+  using ::boost::rangeio::detail::use_erased_write;
+  
+  typedef ::std::vector<int>::const_iterator vector_iterator;
+  typedef ::std::list<long>::const_iterator list_iterator;
+  typedef ::std::deque<int>::const_iterator deque_iterator;
+  
+  BOOST_TEST((use_erased_write<vector_iterator, vector_iterator, void>::value));
+  BOOST_TEST((use_erased_write<vector_iterator, vector_iterator, char const>::value));
+  BOOST_TEST((use_erased_write<int*, int*, char const[3]>::value));
+  
+  BOOST_TEST((!use_erased_write<list_iterator, list_iterator, void>::value));
+  BOOST_TEST((!use_erased_write<list_iterator, list_iterator, char>::value));
+  
+  BOOST_TEST((!use_erased_write<char const*, ::boost::rangeio::null_terminated_t, void>::value));
+
+#if defined(BOOST_LIBSTDCXX_VERSION)
+  BOOST_TEST((!use_erased_write<deque_iterator, deque_iterator, void>::value));
+#endif
+}
+
+} // namespace selection
+
+// Confirm that ranges are written properly.
+namespace normal_range {
+
+template <typename CharT>
+void do_test()
+{
+  ::std::vector<int> const r = { 1, 1, 2, 3, 5, 8, 13 };
+  
+  // Empty range
+  {
+    ::std::vector<int> const empty;
+    
+    ::std::basic_ostringstream<CharT> out;
+    
+    auto res = ::boost::rangeio::write_iterator_range(out, empty.begin(), empty.end(), ", ");
+    
+    BOOST_TEST(empty.end() == res.next);
+    BOOST_TEST_EQ(::std::size_t(0), res.count);
+    BOOST_TEST(bool(out));
+    BOOST_TEST(out.str().empty());
+  }
+  
+  // Without delimiter
+  {
+    ::std::basic_ostringstream<CharT> out;
+    out.imbue(::std::locale::classic());
+    
+    auto res = ::boost::rangeio::write_iterator_range(out, r.begin(), r.end());
+    
+    BOOST_TEST(r.end() == res.next);
+    BOOST_TEST_EQ(r.size(), res.count);
+    BOOST_TEST(bool(out));
+    BOOST_RANGEIO_TEST_STR_EQ("11235813", out.str());
+  }
+  
+  // With delimiter
+  {
+    ::std::basic_ostringstream<CharT> out;
+    out.imbue(::std::locale::classic());
+    
+    auto res = ::boost::rangeio::write_iterator_range(out, r.begin(), r.end(), ", ");
+    
+    BOOST_TEST(r.end() == res.next);
+    BOOST_TEST_EQ(r.size(), res.count);
+    BOOST_TEST(bool(out));
+    BOOST_RANGEIO_TEST_STR_EQ("1, 1, 2, 3, 5, 8, 13", out.str());
+  }
+  
+  // Deferred, with an owned delimiter
+  {
+    ::std::basic_ostringstream<CharT> out;
+    out.imbue(::std::locale::classic());
+    
+    auto w = ::boost::rangeio::write_iterator_range(r.begin(), r.end(), ::std::basic_string<CharT>(2, CharT('-')));
+    out << w;
+    
+    BOOST_TEST(r.end() == w.next);
+    BOOST_TEST_EQ(r.size(), w.count);
+    BOOST_RANGEIO_TEST_STR_EQ("1--1--2--3--5--8--13", out.str());
+  }
+}
+
+void test()
+{
+  do_test<char>();
+  do_test<wchar_t>();
+}
+
+} // namespace normal_range
+
+// Confirm that ranges that use the inlined loops are still written properly.
+namespace inline_range {
+
+void test()
+{
+  ::std::list<long> const r = { 3, 1, 4 };
+  char const s[] = "abc";
+  
+  ::std::ostringstream out;
+  out.imbue(::std::locale::classic());
+  
+  auto res = ::boost::rangeio::write_iterator_range(out, r.begin(), r.end(), '.');
+  
+  char const* p = s;
+  ::boost::rangeio::write_iterator_range(out, p, ::boost::rangeio::null_terminated, '/');
+  
+  BOOST_TEST(r.end() == res.next);
+  BOOST_TEST_EQ(r.size(), res.count);
+  BOOST_TEST_EQ("3.1.4a/b/c", out.str());
+}
+
+} // namespace inline_range
+
+// Confirm that a write stopped by a stream failure leaves the result in the
+// last good state.
+namespace failed_write {
+
+void test()
+{
+  ::std::vector<int> r(10, 12345);
+  
+  ::boost::rangeio::test_extras::array_streambuf<char, 16> buf;
+  ::std::ostream out(&buf);
+  out.imbue(::std::locale::classic());
+  
+  auto res = ::boost::rangeio::write_iterator_range(out, r.begin(), r.end(), ' ');
+  
+  BOOST_TEST(!out);
+  
+  BOOST_TEST_EQ(::std::size_t(2), res.count);
+  BOOST_TEST(r.begin() + 2 == res.next);
+  BOOST_TEST_EQ("12345 12345 1234", buf.str());
+}
+
+} // namespace failed_write
+
+// Confirm that the stream formatting is treated exactly as it is by the
+// inlined loops.
+namespace formatting {
+
+void test()
+{
+  ::std::vector<int> const r = { 0x0287, 0x071A, 0x00E6 };
+  
+  ::std::ostringstream out;
+  out.imbue(::std::locale::classic());
+  
+  out.width(6);
+  out.fill('.');
+  out.setf(::std::ios_base::hex, ::std::ios_base::basefield);
+  
+  ::boost::rangeio::write_iterator_range(out, r.begin(), r.end(), '|');
+  
+  BOOST_TEST_EQ(::std::streamsize(0), out.width());
+  BOOST_TEST_EQ("...287|...71a|....e6", out.str());
+}
+
+} // namespace formatting
+
+} // namespace erased_write_tests
+
+int main()
+{
+  using namespace erased_write_tests;
+  
+  selection::test();
+  
+  normal_range::test();
+  inline_range::test();
+  
+  failed_write::test();
+  
+  formatting::test();
+  
+  return boost::report_errors();
+}
+
+#endif  // BOOST_NO_CXX11_RVALUE_REFERENCES
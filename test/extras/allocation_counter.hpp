@@ -0,0 +1,286 @@
+//
+// Copyright (c) Mark A. Gibbs, 2015.
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+// 
+
+// Replaces the global allocation and deallocation functions with versions
+// that count how many allocations are made (and how many bytes are
+// requested), so that tests and benchmarks can check how often a piece of
+// code hits the heap. Over-aligned allocations (C++17) are counted too.
+// 
+// Because this header *defines* the replacement operator new and operator
+// delete functions, it must be included in exactly one translation unit per
+// program. (That is not a problem for the tests, which are all single
+// translation unit programs.)
+// 
+// The counters are global atomics (updated with relaxed operations), so other
+// threads may allocate safely, but their allocations are counted by every
+// counter - so counting is only meaningful when a single thread is
+// allocating.
+// 
+// Requires at least C++11.
+
+#ifndef BOOST_RANGEIO_TestInc_extras_X_allocation_counter_2015_01_01_
+#define BOOST_RANGEIO_TestInc_extras_X_allocation_counter_2015_01_01_
+
+#include <boost/config.hpp>
+
+#ifdef BOOST_NO_CXX11_NOEXCEPT
+#   error "C++98 is not supported"
+#endif
+
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+namespace boost {
+namespace rangeio {
+namespace test_extras {
+
+// 
+// Raw running totals of all allocations and deallocations made since the
+// program started.
+// 
+struct allocation_totals
+{
+  std::atomic<std::size_t> allocations;
+  std::atomic<std::size_t> deallocations;
+  std::atomic<std::size_t> bytes;
+};
+
+inline allocation_totals& global_allocation_totals()
+{
+  // Constant-initialized, so it is usable by allocations made during static
+  // initialization.
+  static allocation_totals totals = { { 0 }, { 0 }, { 0 } };
+  return totals;
+}
+
+// A snapshot of the global totals.
+struct allocation_snapshot
+{
+  allocation_snapshot() :
+    allocations(global_allocation_totals().allocations.load(std::memory_order_relaxed)),
+    deallocations(global_allocation_totals().deallocations.load(std::memory_order_relaxed)),
+    bytes(global_allocation_totals().bytes.load(std::memory_order_relaxed))
+  {}
+  
+  std::size_t allocations;
+  std::size_t deallocations;
+  std::size_t bytes;
+};
+
+// 
+// Counts the allocations made between its construction and the time any of
+// its observers are called.
+// 
+// Counters may be nested freely - each one simply takes a snapshot of the
+// global totals when it is constructed (or reset).
+// 
+class allocation_counter
+{
+public:
+  void reset() { start_ = allocation_snapshot(); }
+  
+  std::size_t allocations() const
+  {
+    return allocation_snapshot().allocations - start_.allocations;
+  }
+  
+  std::size_t deallocations() const
+  {
+    return allocation_snapshot().deallocations - start_.deallocations;
+  }
+  
+  std::size_t bytes() const
+  {
+    return allocation_snapshot().bytes - start_.bytes;
+  }
+  
+private:
+  allocation_snapshot start_;
+};
+
+// The allocation and deallocation helpers are never inlined: if they were,
+// GCC would see std::free() called directly on pointers that came from
+// operator new (in every function that deletes something), and warn about it
+// (-Wmismatched-new-delete).
+BOOST_NOINLINE inline void* counted_allocate(std::size_t n)
+{
+  allocation_totals& totals = global_allocation_totals();
+  totals.allocations.fetch_add(1, std::memory_order_relaxed);
+  totals.bytes.fetch_add(n, std::memory_order_relaxed);
+  
+  return std::malloc(n == 0 ? 1 : n);
+}
+
+BOOST_NOINLINE inline void counted_deallocate(void* p) noexcept
+{
+  if (p)
+  {
+    global_allocation_totals().deallocations.fetch_add(1, std::memory_order_relaxed);
+    std::free(p);
+  }
+}
+
+#ifdef __cpp_aligned_new
+
+// Over-aligned allocations are made by over-allocating with std::malloc(),
+// and storing the pointer std::malloc() returned just before the aligned
+// block (std::aligned_alloc() is not available everywhere).
+BOOST_NOINLINE inline void* counted_allocate_aligned(std::size_t n, std::size_t align)
+{
+  allocation_totals& totals = global_allocation_totals();
+  totals.allocations.fetch_add(1, std::memory_order_relaxed);
+  totals.bytes.fetch_add(n, std::memory_order_relaxed);
+  
+  if (align < sizeof(void*))
+    align = sizeof(void*);
+  
+  void* const raw = std::malloc(n + align + sizeof(void*));
+  if (!raw)
+    return nullptr;
+  
+  std::size_t const start = reinterpret_cast<std::size_t>(raw) + sizeof(void*);
+  void* const p = reinterpret_cast<void*>((start + (align - 1)) & ~(align - 1));
+  
+  static_cast<void**>(p)[-1] = raw;
+  
+  return p;
+}
+
+BOOST_NOINLINE inline void counted_deallocate_aligned(void* p) noexcept
+{
+  if (p)
+  {
+    global_allocation_totals().deallocations.fetch_add(1, std::memory_order_relaxed);
+    std::free(static_cast<void**>(p)[-1]);
+  }
+}
+
+#endif // __cpp_aligned_new
+
+} // namespace test_extras
+} // namespace rangeio
+} // namespace boost
+
+void* operator new(std::size_t n)
+{
+  if (void* p = ::boost::rangeio::test_extras::counted_allocate(n))
+    return p;
+  throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t n)
+{
+  if (void* p = ::boost::rangeio::test_extras::counted_allocate(n))
+    return p;
+  throw std::bad_alloc();
+}
+
+void* operator new(std::size_t n, std::nothrow_t const&) noexcept
+{
+  return ::boost::rangeio::test_extras::counted_allocate(n);
+}
+
+void* operator new[](std::size_t n, std::nothrow_t const&) noexcept
+{
+  return ::boost::rangeio::test_extras::counted_allocate(n);
+}
+
+void operator delete(void* p) noexcept
+{
+  ::boost::rangeio::test_extras::counted_deallocate(p);
+}
+
+void operator delete[](void* p) noexcept
+{
+  ::boost::rangeio::test_extras::counted_deallocate(p);
+}
+
+void operator delete(void* p, std::nothrow_t const&) noexcept
+{
+  ::boost::rangeio::test_extras::counted_deallocate(p);
+}
+
+void operator delete[](void* p, std::nothrow_t const&) noexcept
+{
+  ::boost::rangeio::test_extras::counted_deallocate(p);
+}
+
+#ifdef __cpp_sized_deallocation
+
+void operator delete(void* p, std::size_t) noexcept
+{
+  ::boost::rangeio::test_extras::counted_deallocate(p);
+}
+
+void operator delete[](void* p, std::size_t) noexcept
+{
+  ::boost::rangeio::test_extras::counted_deallocate(p);
+}
+
+#endif // __cpp_sized_deallocation
+
+#ifdef __cpp_aligned_new
+
+void* operator new(std::size_t n, std::align_val_t a)
+{
+  if (void* p = ::boost::rangeio::test_extras::counted_allocate_aligned(n, std::size_t(a)))
+    return p;
+  throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t n, std::align_val_t a)
+{
+  if (void* p = ::boost::rangeio::test_extras::counted_allocate_aligned(n, std::size_t(a)))
+    return p;
+  throw std::bad_alloc();
+}
+
+void* operator new(std::size_t n, std::align_val_t a, std::nothrow_t const&) noexcept
+{
+  return ::boost::rangeio::test_extras::counted_allocate_aligned(n, std::size_t(a));
+}
+
+void* operator new[](std::size_t n, std::align_val_t a, std::nothrow_t const&) noexcept
+{
+  return ::boost::rangeio::test_extras::counted_allocate_aligned(n, std::size_t(a));
+}
+
+void operator delete(void* p, std::align_val_t) noexcept
+{
+  ::boost::rangeio::test_extras::counted_deallocate_aligned(p);
+}
+
+void operator delete[](void* p, std::align_val_t) noexcept
+{
+  ::boost::rangeio::test_extras::counted_deallocate_aligned(p);
+}
+
+void operator delete(void* p, std::align_val_t, std::nothrow_t const&) noexcept
+{
+  ::boost::rangeio::test_extras::counted_deallocate_aligned(p);
+}
+
+void operator delete[](void* p, std::align_val_t, std::nothrow_t const&) noexcept
+{
+  ::boost::rangeio::test_extras::counted_deallocate_aligned(p);
+}
+
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept
+{
+  ::boost::rangeio::test_extras::counted_deallocate_aligned(p);
+}
+
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept
+{
+  ::boost::rangeio::test_extras::counted_deallocate_aligned(p);
+}
+
+#endif // __cpp_aligned_new
+
+#endif  // include guard
@@ -0,0 +1,55 @@
+//
+// Copyright (c) Mark A. Gibbs, 2015.
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+// 
+
+#ifndef BOOST_RANGEIO_TestInc_extras_X_array_streambuf_2015_01_01_
+#define BOOST_RANGEIO_TestInc_extras_X_array_streambuf_2015_01_01_
+
+#include <boost/config.hpp>
+
+#include <cstddef>
+#include <streambuf>
+#include <string>
+
+namespace boost {
+namespace rangeio {
+namespace test_extras {
+
+// 
+// A pre-sized output stream buffer that writes into a fixed array, and never
+// allocates.
+// 
+// When the array is full, further writes fail (overflow() returns eof), which
+// makes this useful both as an allocation-free sink, and as a way to make a
+// stream fail after a known number of characters.
+// 
+template <typename CharT, std::size_t N, typename Traits = std::char_traits<CharT> >
+class array_streambuf :
+  public std::basic_streambuf<CharT, Traits>
+{
+public:
+  array_streambuf() { this->setp(buffer_, buffer_ + N); }
+  
+  std::size_t size() const { return std::size_t(this->pptr() - this->pbase()); }
+  
+  CharT const* data() const { return buffer_; }
+  
+  std::basic_string<CharT, Traits> str() const
+  {
+    return std::basic_string<CharT, Traits>(this->pbase(), this->pptr());
+  }
+  
+  void clear() { this->setp(buffer_, buffer_ + N); }
+  
+private:
+  CharT buffer_[N];
+};
+
+} // namespace test_extras
+} // namespace rangeio
+} // namespace boost
+
+#endif  // include guard
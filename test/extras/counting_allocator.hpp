@@ -0,0 +1,55 @@
+//
+// Copyright (c) Mark A. Gibbs, 2015.
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+// 
+
+#ifndef BOOST_RANGEIO_TestInc_extras_X_counting_allocator_2015_01_01_
+#define BOOST_RANGEIO_TestInc_extras_X_counting_allocator_2015_01_01_
+
+#include <boost/config.hpp>
+
+#include <cstddef>
+#include <memory>
+
+namespace boost {
+namespace rangeio {
+namespace test_extras {
+
+// 
+// An allocator that counts the allocations made through it (and all of its
+// rebound copies) in an external counter.
+// 
+template <typename T>
+struct counting_allocator
+{
+  typedef T value_type;
+  
+  explicit counting_allocator(std::size_t* c) : count(c) {}
+  
+  template <typename U>
+  counting_allocator(counting_allocator<U> const& a) : count(a.count) {}
+  
+  T* allocate(std::size_t n)
+  {
+    ++*count;
+    return std::allocator<T>().allocate(n);
+  }
+  
+  void deallocate(T* p, std::size_t n) { std::allocator<T>().deallocate(p, n); }
+  
+  std::size_t* count;
+};
+
+template <typename T, typename U>
+bool operator==(counting_allocator<T> const& a, counting_allocator<U> const& b) { return a.count == b.count; }
+
+template <typename T, typename U>
+bool operator!=(counting_allocator<T> const& a, counting_allocator<U> const& b) { return a.count != b.count; }
+
+} // namespace test_extras
+} // namespace rangeio
+} // namespace boost
+
+#endif  // include guard
@@ -0,0 +1,46 @@
+//
+// Copyright (c) Mark A. Gibbs, 2015.
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+// 
+
+#ifndef BOOST_RANGEIO_TestInc_extras_X_throwing_streambuf_2015_01_01_
+#define BOOST_RANGEIO_TestInc_extras_X_throwing_streambuf_2015_01_01_
+
+#include <boost/config.hpp>
+
+#include <cstddef>
+#include <string>
+
+#include "array_streambuf.hpp"
+
+namespace boost {
+namespace rangeio {
+namespace test_extras {
+
+// The exception thrown by throwing_streambuf.
+struct streambuf_error {};
+
+// 
+// An array_streambuf that throws streambuf_error, rather than failing, when
+// its array is full.
+// 
+// This is useful to check that an exception thrown by the stream buffer is
+// handled the way the formatted output functions handle it: by setting the
+// stream's badbit, and rethrowing the exception only if the stream's
+// exceptions include badbit.
+// 
+template <typename CharT, std::size_t N, typename Traits = std::char_traits<CharT> >
+class throwing_streambuf :
+  public array_streambuf<CharT, N, Traits>
+{
+protected:
+  typename Traits::int_type overflow(typename Traits::int_type) { throw streambuf_error(); }
+};
+
+} // namespace test_extras
+} // namespace rangeio
+} // namespace boost
+
+#endif  // include guard
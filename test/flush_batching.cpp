@@ -0,0 +1,366 @@
+//
+// Copyright (c) Mark A. Gibbs, 2015.
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+// 
+
+// This test covers the flush_batching versions of write_iterator_range.
+// 
+// The tests must confirm that the output is exactly the same as the plain
+// immediate write's, that a unitbuf stream is flushed once at the end rather
+// than once per element, that the stream is flushed every flush_batching
+// bytes when that is requested, that the tied stream is flushed once, that
+// the stream's flags are left alone, and that failures are reported.
+// 
+// This test requires C++11.
+
+#include <boost/config.hpp>
+
+#ifdef BOOST_NO_CXX11_RVALUE_REFERENCES
+#   include <iostream>
+int main() { ::std::cout << "Not supported in C++98.\n"; }
+#else
+
+#include <cstddef>
+#include <ios>
+#include <iterator>
+#include <list>
+#include <ostream>
+#include <sstream>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+#include <boost/core/lightweight_test.hpp>
+
+#include <boost/rangeio/flush_batching.hpp>
+
+#include "extras/array_streambuf.hpp"
+#include "extras/more_tests.hpp"
+
+namespace flush_batching_tests {
+
+// Unbuffered stream buffer that counts the calls that would be system calls
+// (writes and flushes) for a real unbuffered stream buffer.
+class counting_streambuf :
+  public ::std::streambuf
+{
+public:
+  counting_streambuf() :
+    writes(0),
+    syncs(0)
+  {}
+  
+  ::std::string str;
+  int writes;
+  int syncs;
+  
+protected:
+  int_type overflow(int_type c)
+  {
+    if (!traits_type::eq_int_type(c, traits_type::eof()))
+    {
+      ++writes;
+      str += traits_type::to_char_type(c);
+    }
+    
+    return traits_type::not_eof(c);
+  }
+  
+  ::std::streamsize xsputn(char const* p, ::std::streamsize n)
+  {
+    ++writes;
+    str.append(p, ::std::size_t(n));
+    return n;
+  }
+  
+  int sync()
+  {
+    ++syncs;
+    return 0;
+  }
+};
+
+::std::vector<int> make_range(int n)
+{
+  ::std::vector<int> r;
+  for (int k = 0; k < n; ++k)
+    r.push_back(k * 7);
+  
+  return r;
+}
+
+// Confirm that the output is the same as the plain immediate write's.
+namespace output {
+
+void test()
+{
+  auto const r = make_range(1000);
+  ::std::vector<double> const d = { 1.5, -0.25, 3.0 };
+  
+  {
+    ::std::ostringstream expected;
+    expected.width(5);
+    ::boost::rangeio::write_iterator_range(expected, r.begin(), r.end(), ", ");
+    
+    ::std::ostringstream out;
+    out.width(5);
+    
+    auto const res = ::boost::rangeio::write_iterator_range(out, r.begin(), r.end(), ", ",
+      ::boost::rangeio::flush_batching());
+    
+    BOOST_TEST(r.end() == res.next);
+    BOOST_TEST_EQ(r.size(), res.count);
+    BOOST_TEST(bool(out));
+    BOOST_TEST_EQ(0, out.width());
+    BOOST_RANGEIO_TEST_STR_EQ(out.str(), expected.str());
+  }
+  
+  // Without a delimiter
+  {
+    ::std::ostringstream out;
+    out.precision(2);
+    out.setf(::std::ios_base::fixed, ::std::ios_base::floatfield);
+    
+    ::boost::rangeio::write_iterator_range(out, d.begin(), d.end(), ::boost::rangeio::flush_batching());
+    
+    BOOST_RANGEIO_TEST_STR_EQ(out.str(), "1.50-0.253.00");
+  }
+  
+  // Wide streams
+  {
+    ::std::wostringstream out;
+    ::boost::rangeio::write_iterator_range(out, d.begin(), d.end(), L' ', ::boost::rangeio::flush_batching());
+    BOOST_TEST(out.str() == L"1.5 -0.25 3");
+  }
+}
+
+} // namespace output
+
+// Confirm that unitbuf streams are flushed once, and written in large
+// blocks.
+namespace unitbuf {
+
+void test()
+{
+  auto const r = make_range(1000);
+  
+  // The plain write: at least one write and one flush per element
+  {
+    counting_streambuf buf;
+    ::std::ostream out(&buf);
+    out << ::std::unitbuf;
+    
+    ::boost::rangeio::write_iterator_range(out, r.begin(), r.end(), ' ');
+    
+    BOOST_TEST(buf.writes >= int(r.size()));
+    BOOST_TEST(buf.syncs >= int(r.size()));
+  }
+  
+  {
+    counting_streambuf buf;
+    ::std::ostream out(&buf);
+    out << ::std::unitbuf;
+    
+    ::std::ostringstream expected;
+    ::boost::rangeio::write_iterator_range(expected, r.begin(), r.end(), ' ');
+    
+    auto const res = ::boost::rangeio::write_iterator_range(out, r.begin(), r.end(), ' ',
+      ::boost::rangeio::flush_batching());
+    
+    BOOST_TEST_EQ(r.size(), res.count);
+    BOOST_RANGEIO_TEST_STR_EQ(buf.str, expected.str());
+    
+    BOOST_TEST(buf.writes <= int(expected.str().size() / 1024) + 1);
+    BOOST_TEST_EQ(1, buf.syncs);
+    
+    // The flags are left alone
+    BOOST_TEST((out.flags() & ::std::ios_base::unitbuf) != 0);
+  }
+  
+  // Flushes requested by the elements are deferred
+  {
+    ::std::vector<::std::string> const lines = { "a", "b", "c" };
+    
+    counting_streambuf buf;
+    ::std::ostream out(&buf);
+    
+    ::boost::rangeio::write_iterator_range(out, lines.begin(), lines.end(), ::std::endl<char, ::std::char_traits<char>>,
+      ::boost::rangeio::flush_batching());
+    
+    BOOST_RANGEIO_TEST_STR_EQ(buf.str, "a\nb\nc");
+    BOOST_TEST_EQ(1, buf.writes);
+    BOOST_TEST_EQ(0, buf.syncs);
+  }
+}
+
+} // namespace unitbuf
+
+// Confirm that the stream is flushed every flush_batching bytes.
+namespace periodic {
+
+void test()
+{
+  ::std::vector<::std::string> const r(1000, "0123456789");
+  
+  {
+    counting_streambuf buf;
+    ::std::ostream out(&buf);
+    
+    ::boost::rangeio::write_iterator_range(out, r.begin(), r.end(), ::boost::rangeio::flush_batching(100));
+    
+    BOOST_TEST_EQ(10000u, buf.str.size());
+    BOOST_TEST_EQ(100, buf.writes);
+    BOOST_TEST_EQ(100, buf.syncs);
+  }
+  
+  {
+    counting_streambuf buf;
+    ::std::ostream out(&buf);
+    
+    ::boost::rangeio::write_iterator_range(out, r.begin(), r.end(), ::boost::rangeio::flush_batching(5000));
+    
+    // Handed on in blocks of 2048 characters, so flushed after 6144
+    BOOST_TEST_EQ(10000u, buf.str.size());
+    BOOST_TEST_EQ(5, buf.writes);
+    BOOST_TEST_EQ(1, buf.syncs);
+  }
+}
+
+} // namespace periodic
+
+// Confirm that the tied stream is flushed once.
+namespace tied {
+
+void test()
+{
+  auto const r = make_range(100);
+  
+  counting_streambuf tied_buf;
+  ::std::ostream tied_stream(&tied_buf);
+  
+  ::std::ostringstream out;
+  out.tie(&tied_stream);
+  
+  ::boost::rangeio::write_iterator_range(out, r.begin(), r.end(), ',', ::boost::rangeio::flush_batching());
+  
+  BOOST_TEST_EQ(1, tied_buf.syncs);
+  BOOST_TEST(out.tie() == &tied_stream);
+}
+
+} // namespace tied
+
+// Confirm that failures are reported.
+namespace failure {
+
+void test()
+{
+  auto const r = make_range(100);
+  
+  // Stream that fills up; the count and next are the same as the plain
+  // immediate write's
+  {
+    ::boost::rangeio::test_extras::array_streambuf<char, 64> plain_buf;
+    ::std::ostream plain_out(&plain_buf);
+    
+    auto const expected = ::boost::rangeio::write_iterator_range(plain_out, r.begin(), r.end(), ',');
+    
+    ::boost::rangeio::test_extras::array_streambuf<char, 64> buf;
+    ::std::ostream out(&buf);
+    
+    auto const res = ::boost::rangeio::write_iterator_range(out, r.begin(), r.end(), ',', ::boost::rangeio::flush_batching());
+    
+    BOOST_TEST(out.bad());
+    BOOST_TEST_EQ(0, out.width());
+    BOOST_TEST_EQ(expected.count, res.count);
+    BOOST_TEST(expected.next == res.next);
+    BOOST_TEST(res.count < r.size());
+  }
+  
+  // ... after some of the output has already been handed on, with a range
+  // that is not random access
+  {
+    ::std::list<int> const l(r.begin(), r.end());
+    
+    ::boost::rangeio::test_extras::array_streambuf<char, 150> plain_buf;
+    ::std::ostream plain_out(&plain_buf);
+    
+    auto const expected = ::boost::rangeio::write_iterator_range(plain_out, l.begin(), l.end());
+    
+    ::boost::rangeio::test_extras::array_streambuf<char, 150> buf;
+    ::std::ostream out(&buf);
+    
+    auto const res = ::boost::rangeio::write_iterator_range(out, l.begin(), l.end(), ::boost::rangeio::flush_batching(40));
+    
+    BOOST_TEST(out.bad());
+    BOOST_TEST_EQ(expected.count, res.count);
+    BOOST_TEST(expected.next == res.next);
+  }
+  
+  // ... with a single-pass range, which cannot be moved back; next and the
+  // count still agree (every element before next is counted)
+  {
+    ::std::ostringstream in_text;
+    for (auto const v : r)
+      in_text << v << ' ';
+    
+    ::std::istringstream in(in_text.str());
+    
+    ::boost::rangeio::test_extras::array_streambuf<char, 150> buf;
+    ::std::ostream out(&buf);
+    
+    auto const res = ::boost::rangeio::write_iterator_range(out,
+      ::std::istream_iterator<int>(in), ::std::istream_iterator<int>(), ',',
+      ::boost::rangeio::flush_batching(40));
+    
+    BOOST_TEST(out.bad());
+    BOOST_TEST(res.count < r.size());
+    
+    // The elements from next on are the ones not counted.
+    ::std::size_t rest = 0;
+    for (auto i = res.next; i != ::std::istream_iterator<int>(); ++i)
+    {
+      BOOST_TEST_EQ(r[res.count + rest], *i);
+      ++rest;
+    }
+    
+    BOOST_TEST_EQ(r.size(), res.count + rest);
+  }
+  
+  // Stream that has already failed
+  {
+    ::std::ostringstream out;
+    out.setstate(::std::ios_base::failbit);
+    out.width(4);
+    
+    auto const res = ::boost::rangeio::write_iterator_range(out, r.begin(), r.end(), ',',
+      ::boost::rangeio::flush_batching());
+    
+    BOOST_TEST(r.begin() == res.next);
+    BOOST_TEST_EQ(::std::size_t(0), res.count);
+    BOOST_TEST_EQ(0, out.width());
+    BOOST_TEST(out.str().empty());
+  }
+}
+
+} // namespace failure
+
+} // namespace flush_batching_tests
+
+int main()
+{
+  using namespace flush_batching_tests;
+  
+  output::test();
+  
+  unitbuf::test();
+  periodic::test();
+  tied::test();
+  
+  failure::test();
+  
+  return boost::report_errors();
+}
+
+#endif  // BOOST_NO_CXX11_RVALUE_REFERENCES
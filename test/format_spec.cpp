@@ -0,0 +1,264 @@
+//
+// Copyright (c) Mark A. Gibbs, 2015.
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+// 
+
+// This test covers format_spec, and the versions of write_iterator_range and
+// write_iterator_range_n that format each element with it.
+// 
+// The tests must confirm that specs are parsed properly (and at compile time,
+// in C++14), that unsupported specs are rejected, that each element is
+// written exactly as it would be with the equivalent iostream formatting
+// state, that the stream's formatting state is given back afterwards, and
+// that writes with invalid specs fail the stream.
+// 
+// This test requires C++11.
+
+#include <boost/config.hpp>
+
+#ifdef BOOST_NO_CXX11_RVALUE_REFERENCES
+#   include <iostream>
+int main() { ::std::cout << "Not supported in C++98.\n"; }
+#else
+
+#include <cstddef>
+#include <ios>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <boost/core/lightweight_test.hpp>
+
+#include <boost/rangeio/format_spec.hpp>
+
+#include "extras/more_tests.hpp"
+
+namespace format_spec_tests {
+
+// Confirm that specs are parsed properly.
+namespace parse {
+
+void test()
+{
+  using ::boost::rangeio::format_spec;
+  
+  // Empty specs
+  BOOST_TEST(format_spec("").valid());
+  BOOST_TEST(format_spec("{}").valid());
+  BOOST_TEST(format_spec("{:}").valid());
+  
+  // Everything
+  {
+    format_spec const spec("{:*<+#012.4LX}");
+    
+    BOOST_TEST(spec.valid());
+    BOOST_TEST_EQ('*', spec.fill());
+    BOOST_TEST_EQ('<', spec.align());
+    BOOST_TEST_EQ('+', spec.sign());
+    BOOST_TEST(spec.alternate());
+    BOOST_TEST(spec.zero_pad());
+    BOOST_TEST_EQ(::std::streamsize(12), spec.width());
+    BOOST_TEST_EQ(::std::streamsize(4), spec.precision());
+    BOOST_TEST_EQ('X', spec.type());
+  }
+  
+  // Just the spec, without the braces
+  {
+    format_spec const spec(">8.3f");
+    
+    BOOST_TEST(spec.valid());
+    BOOST_TEST_EQ(' ', spec.fill());
+    BOOST_TEST_EQ('>', spec.align());
+    BOOST_TEST_EQ('-', spec.sign());
+    BOOST_TEST(!spec.alternate());
+    BOOST_TEST(!spec.zero_pad());
+    BOOST_TEST_EQ(::std::streamsize(8), spec.width());
+    BOOST_TEST_EQ(::std::streamsize(3), spec.precision());
+    BOOST_TEST_EQ('f', spec.type());
+  }
+  
+  // Defaults
+  {
+    format_spec const spec("{:x}");
+    
+    BOOST_TEST(spec.valid());
+    BOOST_TEST_EQ(0, spec.align());
+    BOOST_TEST_EQ(::std::streamsize(0), spec.width());
+    BOOST_TEST_EQ(::std::streamsize(-1), spec.precision());
+  }
+  
+  // Fill characters that look like other parts of the spec
+  BOOST_TEST_EQ('0', format_spec("{:0>5}").fill());
+  BOOST_TEST_EQ('<', format_spec("{:<<5}").fill());
+  
+  // Malformed and unsupported specs
+  BOOST_TEST(!format_spec(static_cast<char const*>(0)).valid());
+  BOOST_TEST(!format_spec("{").valid());
+  BOOST_TEST(!format_spec("{:5").valid());
+  BOOST_TEST(!format_spec("{0:5}").valid());
+  BOOST_TEST(!format_spec("{:5}x").valid());
+  BOOST_TEST(!format_spec("{:.f}").valid());
+  BOOST_TEST(!format_spec("{:5q}").valid());
+  BOOST_TEST(!format_spec("{:b}").valid());
+  BOOST_TEST(!format_spec("{:^5}").valid());
+  BOOST_TEST(!format_spec("{: d}").valid());
+  BOOST_TEST(!format_spec("{:99999999999}").valid());
+}
+
+#ifndef BOOST_NO_CXX14_CONSTEXPR
+constexpr ::boost::rangeio::format_spec compiled_spec("{:>8.3f}");
+
+static_assert(compiled_spec.valid(), "compile time parse failed");
+static_assert(compiled_spec.width() == 8, "compile time parse failed");
+static_assert(compiled_spec.precision() == 3, "compile time parse failed");
+static_assert(!::boost::rangeio::format_spec("{:^8}").valid(), "compile time parse failed");
+#endif // BOOST_NO_CXX14_CONSTEXPR
+
+} // namespace parse
+
+// Confirm that the elements are written exactly as they would be with the
+// equivalent iostream formatting state.
+namespace output {
+
+template <typename T>
+::std::string write(::std::vector<T> const& v, ::boost::rangeio::format_spec const& spec)
+{
+  ::std::ostringstream out;
+  
+  auto const res = ::boost::rangeio::write_iterator_range(out, v.begin(), v.end(), ",", spec);
+  
+  BOOST_TEST(v.end() == res.next);
+  BOOST_TEST_EQ(v.size(), res.count);
+  BOOST_TEST(bool(out));
+  
+  return out.str();
+}
+
+void test()
+{
+  ::std::vector<double> const d = { 3.14159, -2.5, 100.0 };
+  ::std::vector<int> const i = { 26, -7, 0 };
+  
+  BOOST_RANGEIO_TEST_STR_EQ(write(d, "{:>8.3f}"), "   3.142,  -2.500, 100.000");
+  BOOST_RANGEIO_TEST_STR_EQ(write(d, "{:*<9.2e}"), "3.14e+00*,-2.50e+00,1.00e+02*");
+  BOOST_RANGEIO_TEST_STR_EQ(write(d, "{:.2E}"), "3.14E+00,-2.50E+00,1.00E+02");
+  BOOST_RANGEIO_TEST_STR_EQ(write(d, "{:+08.1f}"), "+00003.1,-00002.5,+00100.0");
+  BOOST_RANGEIO_TEST_STR_EQ(write(d, "{:#.3g}"), "3.14,-2.50,100.");
+  BOOST_RANGEIO_TEST_STR_EQ(write(d, "{}"), "3.14159,-2.5,100");
+  
+  BOOST_RANGEIO_TEST_STR_EQ(write(i, "{:5d}"), "   26,   -7,    0");
+  BOOST_RANGEIO_TEST_STR_EQ(write(i, "{:_<4}"), "26__,-7__,0___");
+  BOOST_RANGEIO_TEST_STR_EQ(write(i, "{:+05}"), "+0026,-0007,+0000");
+  BOOST_RANGEIO_TEST_STR_EQ(write(i, "{:x}"), "1a,fffffff9,0");
+  BOOST_RANGEIO_TEST_STR_EQ(write(i, "{:#06X}"), "0X001A,0XFFFFFFF9,000000");
+  BOOST_RANGEIO_TEST_STR_EQ(write(i, "{:o}"), "32,37777777771,0");
+  
+  // Counted
+  {
+    ::std::ostringstream out;
+    
+    auto const res = ::boost::rangeio::write_iterator_range_n(out, d.begin(), 2, "; ", "{:.1f}");
+    
+    BOOST_TEST(d.begin() + 2 == res.next);
+    BOOST_TEST_EQ(::std::size_t(2), res.count);
+    BOOST_RANGEIO_TEST_STR_EQ(out.str(), "3.1; -2.5");
+  }
+  
+  // Wide streams
+  {
+    ::std::wostringstream out;
+    ::boost::rangeio::write_iterator_range(out, i.begin(), i.end(), L'|', "{:*>4}");
+    BOOST_TEST(out.str() == L"**26|**-7|***0");
+  }
+}
+
+} // namespace output
+
+// Confirm that the stream's formatting state is given back afterwards, and
+// that the spec replaces it for the write.
+namespace state {
+
+void test()
+{
+  ::std::vector<double> const d = { 1.5, 2.25 };
+  
+  ::std::ostringstream out;
+  out.setf(::std::ios_base::scientific, ::std::ios_base::floatfield);
+  out.setf(::std::ios_base::left, ::std::ios_base::adjustfield);
+  out.setf(::std::ios_base::showpos | ::std::ios_base::boolalpha);
+  out.precision(9);
+  out.fill('#');
+  out.width(20);
+  
+  ::std::ios_base::fmtflags const flags = out.flags();
+  
+  ::boost::rangeio::write_iterator_range(out, d.begin(), d.end(), ' ', "{:6.2f}");
+  
+  BOOST_RANGEIO_TEST_STR_EQ(out.str(), "  1.50   2.25");
+  
+  BOOST_TEST(flags == out.flags());
+  BOOST_TEST_EQ(::std::streamsize(9), out.precision());
+  BOOST_TEST_EQ('#', out.fill());
+  BOOST_TEST_EQ(::std::streamsize(0), out.width());
+  
+  // The stream's precision is kept if the spec has none, as are the flags
+  // the spec does not describe
+  out.str("");
+  ::std::vector<bool> const b = { true, false };
+  ::boost::rangeio::write_iterator_range(out, d.begin(), d.end(), ' ', "{:f}");
+  ::boost::rangeio::write_iterator_range(out, b.begin(), b.end(), ' ', "{}");
+  BOOST_RANGEIO_TEST_STR_EQ(out.str(), "1.500000000 2.250000000true false");
+}
+
+} // namespace state
+
+// Confirm that writes with invalid specs fail the stream, without writing
+// anything.
+namespace invalid {
+
+void test()
+{
+  ::std::vector<int> const v = { 1, 2, 3 };
+  
+  ::std::ostringstream out;
+  out.width(5);
+  
+  auto const res = ::boost::rangeio::write_iterator_range(out, v.begin(), v.end(), ',', "{:^5}");
+  
+  BOOST_TEST(!out);
+  BOOST_TEST(v.begin() == res.next);
+  BOOST_TEST_EQ(::std::size_t(0), res.count);
+  BOOST_TEST_EQ(::std::streamsize(0), out.width());
+  BOOST_TEST(out.str().empty());
+  
+  out.clear();
+  
+  auto const res_n = ::boost::rangeio::write_iterator_range_n(out, v.begin(), 2, ',', "{:5");
+  
+  BOOST_TEST(!out);
+  BOOST_TEST(v.begin() == res_n.next);
+  BOOST_TEST_EQ(::std::size_t(0), res_n.count);
+}
+
+} // namespace invalid
+
+} // namespace format_spec_tests
+
+int main()
+{
+  using namespace format_spec_tests;
+  
+  parse::test();
+  
+  output::test();
+  
+  state::test();
+  
+  invalid::test();
+  
+  return boost::report_errors();
+}
+
+#endif  // BOOST_NO_CXX11_RVALUE_REFERENCES
@@ -0,0 +1,293 @@
+//
+// Copyright (c) Mark A. Gibbs, 2015.
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+// 
+
+// This test covers basic_incremental_range_writer.
+// 
+// The tests must confirm that the output is always exactly the same as the
+// immediate write_iterator_range() of the whole range, that only the newly
+// appended elements are formatted, and that the range is formatted again from
+// the beginning when it shrinks, when the formatting state changes, or when
+// the writer is reset.
+// 
+// This test requires C++11.
+
+#include <boost/config.hpp>
+
+#ifdef BOOST_NO_CXX11_RVALUE_REFERENCES
+#   include <iostream>
+int main() { ::std::cout << "Not supported in C++98.\n"; }
+#else
+
+#include <cstddef>
+#include <ios>
+#include <list>
+#include <locale>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <boost/core/lightweight_test.hpp>
+
+#include <boost/rangeio/incremental_range_writer.hpp>
+#include <boost/rangeio/write_iterator_range.hpp>
+
+#include "extras/more_tests.hpp"
+
+namespace incremental_range_writer_tests {
+
+// Element that counts how many times it has been written.
+struct counted_element
+{
+  explicit counted_element(int v) : value(v), writes(0) {}
+  
+  int value;
+  mutable int writes;
+};
+
+template <typename CharT, typename Traits>
+::std::basic_ostream<CharT, Traits>& operator<<(::std::basic_ostream<CharT, Traits>& o, counted_element const& e)
+{
+  ++e.writes;
+  return o << e.value;
+}
+
+template <typename CharT, typename Container, typename Delimiter>
+::std::basic_string<CharT> immediate(Container const& c, Delimiter d, ::std::streamsize width = 0)
+{
+  ::std::basic_ostringstream<CharT> out;
+  out.width(width);
+  ::boost::rangeio::write_iterator_range(out, c.begin(), c.end(), d);
+  return out.str();
+}
+
+// Confirm that appended elements are written properly, and that each element
+// is only formatted once.
+namespace append {
+
+template <typename CharT>
+void do_test()
+{
+  ::std::vector<counted_element> r;
+  ::std::vector<int> values; // The same values, for the expected output
+  
+  ::boost::rangeio::basic_incremental_range_writer<CharT> writer;
+  
+  for (int n = 0; n < 100; ++n)
+  {
+    // Append 0, 1 or 2 elements each time, so that empty appends are covered
+    for (int k = 0; k < (n % 3); ++k)
+    {
+      r.push_back(counted_element(int(r.size())));
+      values.push_back(r.back().value);
+    }
+    
+    ::std::basic_ostringstream<CharT> out;
+    out.width(3);
+    
+    writer.write(out, r.begin(), r.end(), CharT(','));
+    
+    BOOST_TEST(bool(out));
+    BOOST_TEST_EQ(0, out.width());
+    BOOST_TEST_EQ(r.size(), writer.count());
+    BOOST_TEST(out.str() == immediate<CharT>(values, CharT(','), 3));
+  }
+  
+  for (auto const& e : r)
+    BOOST_TEST_EQ(1, e.writes);
+}
+
+void test()
+{
+  do_test<char>();
+  do_test<wchar_t>();
+}
+
+} // namespace append
+
+// Confirm that ranges without delimiters, and ranges that are not random
+// access, work properly.
+namespace no_delimiter {
+
+void test()
+{
+  ::std::list<int> r;
+  
+  ::boost::rangeio::incremental_range_writer writer;
+  
+  for (int n = 0; n < 5; ++n)
+  {
+    r.push_back(n);
+    
+    ::std::ostringstream out;
+    writer.write(out, r.begin(), r.end());
+    
+    BOOST_TEST(bool(out));
+    BOOST_TEST_EQ(r.size(), writer.count());
+  }
+  
+  ::std::ostringstream out;
+  writer.write(out, r.begin(), r.end());
+  BOOST_RANGEIO_TEST_STR_EQ(out.str(), "01234");
+  
+  // Shrinking a list
+  r.pop_back();
+  r.pop_back();
+  r.push_front(9);
+  
+  out.str("");
+  writer.write(out, r.begin(), r.end());
+  BOOST_RANGEIO_TEST_STR_EQ(out.str(), "9012");
+}
+
+} // namespace no_delimiter
+
+// Confirm that the range is formatted again when it shrinks, when the
+// formatting state changes, and when the writer is reset.
+namespace restart {
+
+void test()
+{
+  ::std::vector<int> r = { 10, 11, 12 };
+  
+  ::boost::rangeio::incremental_range_writer writer;
+  
+  {
+    ::std::ostringstream out;
+    writer.write(out, r.begin(), r.end(), ", ");
+    BOOST_RANGEIO_TEST_STR_EQ(out.str(), "10, 11, 12");
+  }
+  
+  // Shrink
+  r.resize(2);
+  {
+    ::std::ostringstream out;
+    writer.write(out, r.begin(), r.end(), ", ");
+    BOOST_RANGEIO_TEST_STR_EQ(out.str(), "10, 11");
+  }
+  
+  // Formatting change
+  r.push_back(13);
+  {
+    ::std::ostringstream out;
+    out << ::std::hex;
+    writer.write(out, r.begin(), r.end(), ", ");
+    BOOST_RANGEIO_TEST_STR_EQ(out.str(), "a, b, d");
+  }
+  
+  // Change of already-written elements needs a reset
+  r[0] = 1;
+  {
+    ::std::ostringstream out;
+    out << ::std::hex;
+    writer.write(out, r.begin(), r.end(), ", ");
+    BOOST_RANGEIO_TEST_STR_EQ(out.str(), "a, b, d");
+  }
+  
+  writer.reset();
+  BOOST_TEST_EQ(::std::size_t(0), writer.count());
+  {
+    ::std::ostringstream out;
+    out << ::std::hex;
+    writer.write(out, r.begin(), r.end(), ", ");
+    BOOST_RANGEIO_TEST_STR_EQ(out.str(), "1, b, d");
+  }
+}
+
+} // namespace restart
+
+// Confirm that an element that changes the formatting state does not affect
+// the elements appended after it.
+namespace changed_formatting {
+
+struct meddling_element
+{
+  double value;
+};
+
+::std::ostream& operator<<(::std::ostream& out, meddling_element const& e)
+{
+  out << e.value;
+  
+  out.precision(1);
+  out.fill('#');
+  out.setf(::std::ios_base::fixed, ::std::ios_base::floatfield);
+  out.imbue(::std::locale(::std::locale::classic(), new ::std::numpunct<char>));
+  
+  return out;
+}
+
+void test()
+{
+  ::std::vector<meddling_element> r;
+  
+  ::boost::rangeio::incremental_range_writer writer;
+  
+  for (double const v : { 1.23456, 2.5, 3.0 })
+  {
+    r.push_back(meddling_element{ v });
+    
+    ::std::ostringstream out;
+    out.width(6);
+    out.fill('.');
+    out.precision(3);
+    
+    ::std::locale const loc = out.getloc();
+    
+    writer.write(out, r.begin(), r.end());
+    
+    BOOST_TEST(bool(out));
+    BOOST_TEST_EQ(r.size(), writer.count());
+    BOOST_TEST(out.getloc() == loc);
+    
+    if (r.size() == 3)
+      BOOST_RANGEIO_TEST_STR_EQ(out.str(), "..1.23" "...2.5" ".....3");
+  }
+}
+
+} // namespace changed_formatting
+
+// Confirm that failures are handled the same way as by the immediate write.
+namespace failure {
+
+void test()
+{
+  ::std::vector<int> const r = { 1, 2, 3 };
+  
+  ::boost::rangeio::incremental_range_writer writer;
+  
+  ::std::ostringstream out;
+  out.setstate(::std::ios_base::failbit);
+  out.width(5);
+  
+  writer.write(out, r.begin(), r.end(), ',');
+  
+  BOOST_TEST(!out);
+  BOOST_TEST_EQ(0, out.width());
+  BOOST_TEST(out.str().empty());
+  BOOST_TEST_EQ(::std::size_t(0), writer.count());
+}
+
+} // namespace failure
+
+} // namespace incremental_range_writer_tests
+
+int main()
+{
+  using namespace incremental_range_writer_tests;
+  
+  append::test();
+  no_delimiter::test();
+  
+  restart::test();
+  changed_formatting::test();
+  
+  failure::test();
+  
+  return boost::report_errors();
+}
+
+#endif  // BOOST_NO_CXX11_RVALUE_REFERENCES
@@ -0,0 +1,266 @@
+//
+// Copyright (c) Mark A. Gibbs, 2015.
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+// 
+
+// This test covers basic_range_stringbuf and basic_range_ostream.
+// 
+// The tests must confirm that ranges are written into the buffer properly,
+// that the contents can be viewed and released without copying, that the
+// capacity hint is respected, and that all memory comes from the allocator.
+// 
+// This test requires C++11. The string_view and std::pmr parts require
+// C++17.
+
+#include <boost/config.hpp>
+
+#ifdef BOOST_NO_CXX11_RVALUE_REFERENCES
+#   include <iostream>
+int main() { ::std::cout << "Not supported in C++98.\n"; }
+#else
+
+#include <cstddef>
+#include <ios>
+#include <locale>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <boost/core/lightweight_test.hpp>
+
+#include <boost/rangeio/range_stringbuf.hpp>
+#include <boost/rangeio/write_iterator_range.hpp>
+#include <boost/rangeio/write_stats.hpp>
+
+#include "extras/counting_allocator.hpp"
+#include "extras/more_tests.hpp"
+
+namespace range_stringbuf_tests {
+
+using ::boost::rangeio::test_extras::counting_allocator;
+
+// Confirm that ranges are written properly.
+namespace normal_range {
+
+template <typename CharT>
+void do_test()
+{
+  int const r[] = { 1, 1, 2, 3, 5, 8, 13 };
+  ::std::size_t const r_size = sizeof(r) / sizeof(r[0]);
+  
+  ::boost::rangeio::basic_range_ostream<CharT> out;
+  out.imbue(::std::locale::classic());
+  
+  BOOST_TEST_EQ(::std::size_t(0), out.size());
+  
+  ::boost::rangeio::write_iterator_range(out, r, r + r_size, ", ");
+  
+  BOOST_TEST(bool(out));
+  BOOST_RANGEIO_TEST_STR_EQ("1, 1, 2, 3, 5, 8, 13", out.release());
+  
+  BOOST_TEST_EQ(::std::size_t(0), out.size());
+  
+  // The stream is still usable after release.
+  out << r[6];
+  BOOST_RANGEIO_TEST_STR_EQ("13", out.release());
+}
+
+void test()
+{
+  do_test<char>();
+  do_test<wchar_t>();
+}
+
+} // namespace normal_range
+
+// Confirm that large contents are written properly (through many growths),
+// and released without copying.
+namespace large_range {
+
+void test()
+{
+  ::std::vector<int> r;
+  for (int i = 0; i < 10000; ++i)
+    r.push_back(i);
+  
+  ::std::ostringstream expected;
+  for (int i = 0; i < 10000; ++i)
+    expected << (i ? "," : "") << i;
+  
+  ::boost::rangeio::range_ostream out;
+  ::boost::rangeio::write_iterator_range(out, r.begin(), r.end(), ',');
+  
+  BOOST_TEST_EQ(expected.str().size(), out.size());
+  BOOST_TEST(out.capacity() >= out.size());
+  
+  char const* const p = out.data();
+  
+  ::std::string const s = out.release();
+  
+  BOOST_TEST_EQ(expected.str(), s);
+  BOOST_TEST(p == s.data());
+}
+
+} // namespace large_range
+
+// Confirm that the capacity hint prevents growth.
+namespace capacity_hint {
+
+void test()
+{
+  ::std::vector<int> const r(100, 12345);
+  
+  ::boost::rangeio::range_ostream out(600);
+  BOOST_TEST(out.capacity() >= 600);
+  
+  char const* const p = out.data();
+  
+  ::boost::rangeio::write_iterator_range(out, r.begin(), r.end(), ' ');
+  
+  BOOST_TEST_EQ(::std::size_t(599), out.size());
+  BOOST_TEST(p == out.data());
+  
+  // reserve() keeps the contents.
+  out.reserve(10000);
+  BOOST_TEST(out.capacity() >= 10000);
+  BOOST_TEST_EQ(::std::size_t(599), out.size());
+  BOOST_TEST_EQ(::std::string(599, ' ').size(), out.release().size());
+}
+
+} // namespace capacity_hint
+
+// Confirm that clearing the contents keeps the capacity, so reuse does not
+// allocate.
+namespace reuse {
+
+void test()
+{
+  ::std::vector<int> const r(100, 12345);
+  
+  ::std::size_t allocations = 0;
+  counting_allocator<char> a(&allocations);
+  
+  ::boost::rangeio::basic_range_ostream<char, ::std::char_traits<char>, counting_allocator<char>> out(a);
+  
+  ::boost::rangeio::write_iterator_range(out, r.begin(), r.end(), ' ');
+  BOOST_TEST(allocations != 0);
+  
+  ::std::size_t const warm = allocations;
+  
+  for (int i = 0; i < 10; ++i)
+  {
+    out.clear_contents();
+    ::boost::rangeio::write_iterator_range(out, r.begin(), r.end(), ' ');
+    BOOST_TEST_EQ(::std::size_t(599), out.size());
+  }
+  
+  BOOST_TEST_EQ(warm, allocations);
+  
+  // The released string uses the same allocator.
+  auto const s = out.release();
+  BOOST_TEST(s.get_allocator() == a);
+  BOOST_TEST_EQ(warm, allocations);
+}
+
+} // namespace reuse
+
+// Confirm that the buffer can report its position, so write statistics work.
+namespace stats {
+
+void test()
+{
+  int const r[] = { 1, 2, 3 };
+  
+  ::boost::rangeio::range_ostream out;
+  out << "ab";
+  
+  ::boost::rangeio::write_stats stats;
+  ::boost::rangeio::write_iterator_range(out, r, r + 3, ", ", stats);
+  
+  BOOST_TEST_EQ(::std::streamoff(7), stats.bytes);
+  BOOST_TEST_EQ("ab1, 2, 3", out.release());
+}
+
+} // namespace stats
+
+#ifndef BOOST_NO_CXX17_HDR_STRING_VIEW
+
+// Confirm that the contents can be viewed without copying.
+namespace view {
+
+void test()
+{
+  int const r[] = { 1, 2, 3 };
+  
+  ::boost::rangeio::range_ostream out;
+  ::boost::rangeio::write_iterator_range(out, r, r + 3, '-');
+  
+  ::std::string_view const v = out.view();
+  BOOST_TEST(v == "1-2-3");
+  BOOST_TEST(v.data() == out.data());
+}
+
+} // namespace view
+
+#endif // BOOST_NO_CXX17_HDR_STRING_VIEW
+
+#ifdef BOOST_RANGEIO_HAS_PMR
+
+// Confirm that all memory comes from the memory resource.
+namespace pmr {
+
+void test()
+{
+  ::std::vector<int> r;
+  for (int i = 0; i < 1000; ++i)
+    r.push_back(i);
+  
+  // With no upstream, the monotonic resource fails when its initial buffer
+  // is exhausted - so give it one that is big enough.
+  static char storage[65536];
+  ::std::pmr::monotonic_buffer_resource resource(storage, sizeof(storage), ::std::pmr::null_memory_resource());
+  
+  ::boost::rangeio::pmr::range_ostream out(&resource);
+  ::boost::rangeio::write_iterator_range(out, r.begin(), r.end(), ',');
+  
+  ::std::pmr::string const s = out.release();
+  
+  BOOST_TEST(s.get_allocator().resource() == &resource);
+  BOOST_TEST(s.data() >= storage);
+  BOOST_TEST(s.data() < (storage + sizeof(storage)));
+  BOOST_TEST_EQ(::std::size_t(3889), s.size());
+}
+
+} // namespace pmr
+
+#endif // BOOST_RANGEIO_HAS_PMR
+
+} // namespace range_stringbuf_tests
+
+int main()
+{
+  using namespace range_stringbuf_tests;
+  
+  normal_range::test();
+  large_range::test();
+  
+  capacity_hint::test();
+  reuse::test();
+  
+  stats::test();
+
+#ifndef BOOST_NO_CXX17_HDR_STRING_VIEW
+  view::test();
+#endif
+
+#ifdef BOOST_RANGEIO_HAS_PMR
+  pmr::test();
+#endif
+
+  return boost::report_errors();
+}
+
+#endif  // BOOST_NO_CXX11_RVALUE_REFERENCES
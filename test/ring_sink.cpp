@@ -0,0 +1,463 @@
+//
+// Copyright (c) Mark A. Gibbs, 2015.
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+// 
+
+// This test covers ring_sink.
+// 
+// The tests must confirm that records are written exactly as
+// write_iterator_range() would write them (one per line), that records that
+// do not fit in a slot are truncated, that the full policies work, that the
+// counters are correct, that a record whose element throws is abandoned
+// without holding up the records after it, and that concurrent writers never
+// corrupt each other's records.
+// 
+// This test requires C++11, and a POSIX system.
+
+#include <boost/config.hpp>
+
+#if defined(BOOST_NO_CXX11_RVALUE_REFERENCES) || !defined(BOOST_HAS_UNISTD_H)
+#   include <iostream>
+int main() { ::std::cout << "Not supported on this platform.\n"; }
+#else
+
+#include <cstddef>
+#include <cstdio>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <boost/core/lightweight_test.hpp>
+
+#include <boost/rangeio/ring_sink.hpp>
+
+namespace ring_sink_tests {
+
+// Reads everything written to a temporary file.
+::std::string read_all(::std::FILE* f)
+{
+  ::std::string s;
+  
+  ::std::rewind(f);
+  
+  char buffer[4096];
+  while (::std::size_t const n = ::std::fread(buffer, 1, sizeof(buffer), f))
+    s.append(buffer, n);
+  
+  return s;
+}
+
+// Reads everything from a pipe until it is closed.
+::std::string drain(int fd)
+{
+  ::std::string s;
+  
+  char buffer[4096];
+  for (;;)
+  {
+    ::ssize_t const n = ::read(fd, buffer, sizeof(buffer));
+    if (n <= 0)
+      break;
+    
+    s.append(buffer, ::std::size_t(n));
+  }
+  
+  return s;
+}
+
+// Fills a pipe, so that the next write to it blocks. Returns the number of
+// bytes written.
+::std::size_t fill_pipe(int fd)
+{
+  int const flags = ::fcntl(fd, F_GETFL);
+  ::fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+  
+  ::std::size_t total = 0;
+  
+  char const buffer[4096] = {};
+  for (;;)
+  {
+    ::ssize_t const n = ::write(fd, buffer, sizeof(buffer));
+    if (n <= 0)
+      break;
+    
+    total += ::std::size_t(n);
+  }
+  
+  ::fcntl(fd, F_SETFL, flags);
+  
+  return total;
+}
+
+// Confirm that records are written properly.
+namespace normal_records {
+
+void test()
+{
+  ::std::FILE* const f = ::std::tmpfile();
+  
+  ::std::vector<int> const r = { 1, 1, 2, 3, 5, 8, 13 };
+  ::std::vector<int> const empty;
+  
+  {
+    ::boost::rangeio::ring_sink sink(::fileno(f));
+    
+    BOOST_TEST(sink.write(r.begin(), r.end(), ", "));
+    BOOST_TEST(sink.write(r.begin(), r.end()));
+    BOOST_TEST(sink.write(empty.begin(), empty.end(), ','));
+    BOOST_TEST(sink.write(r.begin(), r.begin() + 2, ::std::string(" and ")));
+    
+    sink.flush();
+    
+    auto const c = sink.counters();
+    BOOST_TEST_EQ(4u, c.written);
+    BOOST_TEST_EQ(0u, c.dropped);
+    BOOST_TEST_EQ(0u, c.blocked);
+    BOOST_TEST_EQ(0u, c.truncated);
+    BOOST_TEST_EQ(0u, c.write_errors);
+  }
+  
+  BOOST_TEST_EQ("1, 1, 2, 3, 5, 8, 13\n11235813\n\n1 and 1\n", read_all(f));
+  
+  ::std::fclose(f);
+}
+
+} // namespace normal_records
+
+// Confirm that each record starts with the default formatting state, even if
+// an element's inserter changed it.
+namespace formatting {
+
+struct hex_element
+{
+  int value;
+};
+
+::std::ostream& operator<<(::std::ostream& out, hex_element const& e)
+{
+  return out << ::std::hex << e.value;
+}
+
+void test()
+{
+  ::std::FILE* const f = ::std::tmpfile();
+  
+  hex_element const h[] = { { 255 } };
+  int const r[] = { 255 };
+  
+  {
+    ::boost::rangeio::ring_sink sink(::fileno(f));
+    
+    sink.write(h, h + 1);
+    sink.write(r, r + 1);
+  }
+  
+  BOOST_TEST_EQ("ff\n255\n", read_all(f));
+  
+  ::std::fclose(f);
+}
+
+} // namespace formatting
+
+// Confirm that records longer than a slot are truncated.
+namespace truncated_records {
+
+void test()
+{
+  ::std::FILE* const f = ::std::tmpfile();
+  
+  ::std::vector<int> const r(10, 12345);
+  
+  {
+    ::boost::rangeio::ring_sink_options options;
+    options.slot_size = 16;
+    
+    ::boost::rangeio::ring_sink sink(::fileno(f), options);
+    
+    sink.write(r.begin(), r.end(), ' ');
+    sink.write(r.begin(), r.begin() + 1);
+    
+    sink.flush();
+    
+    BOOST_TEST_EQ(2u, sink.counters().written);
+    BOOST_TEST_EQ(1u, sink.counters().truncated);
+  }
+  
+  BOOST_TEST_EQ("12345 12345 123\n12345\n", read_all(f));
+  
+  ::std::fclose(f);
+}
+
+} // namespace truncated_records
+
+// Confirm that a record whose element's inserter throws is abandoned, and
+// does not hold up the records after it (or flush()).
+namespace throwing_element {
+
+struct element
+{
+  bool fail;
+};
+
+::std::ostream& operator<<(::std::ostream& out, element const& e)
+{
+  if (e.fail)
+    throw ::std::runtime_error("element failed");
+  
+  return out << 'x';
+}
+
+void test()
+{
+  ::std::FILE* const f = ::std::tmpfile();
+  
+  element const r[] = { { false }, { true }, { false } };
+  
+  {
+    ::boost::rangeio::ring_sink_options options;
+    options.slot_count = 4;
+    options.full_policy = ::boost::rangeio::ring_sink_full_policy::block;
+    
+    ::boost::rangeio::ring_sink sink(::fileno(f), options);
+    
+    BOOST_TEST(sink.write(r, r + 1, ','));
+    
+    bool thrown = false;
+    try
+    {
+      sink.write(r, r + 3, ',');
+    }
+    catch (::std::runtime_error const&)
+    {
+      thrown = true;
+    }
+    BOOST_TEST(thrown);
+    
+    // Enough records to wrap around the ring, past the abandoned slot
+    for (int i = 0; i != 10; ++i)
+      BOOST_TEST(sink.write(r + 2, r + 3));
+    
+    sink.flush();
+    
+    auto const c = sink.counters();
+    BOOST_TEST_EQ(11u, c.written);
+    BOOST_TEST_EQ(1u, c.abandoned);
+    BOOST_TEST_EQ(0u, c.write_errors);
+  }
+  
+  ::std::string expected = "x\n";
+  for (int i = 0; i != 10; ++i)
+    expected += "x\n";
+  
+  BOOST_TEST_EQ(expected, read_all(f));
+  
+  ::std::fclose(f);
+}
+
+} // namespace throwing_element
+
+// Confirm that the drop policy drops records when the ring is full.
+namespace drop_policy {
+
+void test()
+{
+  int fds[2];
+  BOOST_TEST_EQ(0, ::pipe(fds));
+  
+  ::std::size_t const filled = fill_pipe(fds[1]);
+  
+  ::std::vector<int> const r = { 1, 2, 3 };
+  
+  ::std::size_t queued = 0;
+  ::std::size_t dropped = 0;
+  
+  ::std::string output;
+  
+  {
+    ::boost::rangeio::ring_sink_options options;
+    options.slot_count = 8;
+    options.full_policy = ::boost::rangeio::ring_sink_full_policy::drop;
+    
+    ::boost::rangeio::ring_sink sink(fds[1], options);
+    
+    // The consumer is blocked writing to the full pipe, so at most 8 slots
+    // can be in use at once.
+    for (int i = 0; i != 100; ++i)
+    {
+      if (sink.write(r.begin(), r.end(), ','))
+        ++queued;
+      else
+        ++dropped;
+    }
+    
+    BOOST_TEST(dropped != 0);
+    BOOST_TEST(queued <= 8);
+    BOOST_TEST_EQ(dropped, sink.counters().dropped);
+    BOOST_TEST_EQ(0u, sink.counters().blocked);
+    
+    ::std::thread reader([&] { output = drain(fds[0]); });
+    
+    sink.flush();
+    BOOST_TEST_EQ(queued, sink.counters().written);
+    
+    ::close(fds[1]);
+    reader.join();
+  }
+  
+  ::close(fds[0]);
+  
+  BOOST_TEST_EQ(filled + (queued * 6), output.size());
+}
+
+} // namespace drop_policy
+
+// Confirm that the block policy waits for a free slot when the ring is full.
+namespace block_policy {
+
+void test()
+{
+  int fds[2];
+  BOOST_TEST_EQ(0, ::pipe(fds));
+  
+  ::std::size_t const filled = fill_pipe(fds[1]);
+  
+  ::std::vector<int> const r = { 1, 2, 3 };
+  
+  ::std::string output;
+  
+  {
+    ::boost::rangeio::ring_sink_options options;
+    options.slot_count = 8;
+    options.full_policy = ::boost::rangeio::ring_sink_full_policy::block;
+    
+    ::boost::rangeio::ring_sink sink(fds[1], options);
+    
+    // The reader starts draining the pipe after a delay, so the writes must
+    // fill the ring and block.
+    ::std::thread reader([&]
+    {
+      ::std::this_thread::sleep_for(::std::chrono::milliseconds(50));
+      output = drain(fds[0]);
+    });
+    
+    for (int i = 0; i != 100; ++i)
+      BOOST_TEST(sink.write(r.begin(), r.end(), ','));
+    
+    sink.flush();
+    
+    BOOST_TEST_EQ(100u, sink.counters().written);
+    BOOST_TEST_EQ(0u, sink.counters().dropped);
+    BOOST_TEST(sink.counters().blocked != 0);
+    
+    ::close(fds[1]);
+    reader.join();
+  }
+  
+  ::close(fds[0]);
+  
+  BOOST_TEST_EQ(filled + (100 * 6), output.size());
+}
+
+} // namespace block_policy
+
+// Confirm that concurrent writers never corrupt each other's records.
+namespace concurrent_writers {
+
+void test()
+{
+  ::std::FILE* const f = ::std::tmpfile();
+  
+  ::std::size_t const thread_count = 4;
+  ::std::size_t const writes_per_thread = 2000;
+  ::std::size_t const range_size = 10;
+  
+  {
+    ::boost::rangeio::ring_sink_options options;
+    options.slot_count = 64;
+    options.full_policy = ::boost::rangeio::ring_sink_full_policy::block;
+    
+    ::boost::rangeio::ring_sink sink(::fileno(f), options);
+    
+    ::std::vector< ::std::thread> threads;
+    for (::std::size_t t = 0; t != thread_count; ++t)
+    {
+      threads.emplace_back([&sink, t, writes_per_thread, range_size]
+      {
+        ::std::vector<int> const r(range_size, int(t));
+        
+        for (::std::size_t i = 0; i != writes_per_thread; ++i)
+          sink.write(r.begin(), r.end(), ',');
+      });
+    }
+    
+    for (auto& thread : threads)
+      thread.join();
+    
+    sink.flush();
+    
+    BOOST_TEST_EQ(thread_count * writes_per_thread, sink.counters().written);
+  }
+  
+  ::std::string const s = read_all(f);
+  ::std::size_t const record_size = 2 * range_size;
+  
+  BOOST_TEST_EQ(thread_count * writes_per_thread * record_size, s.size());
+  
+  ::std::size_t counts[thread_count] = {};
+  
+  for (::std::size_t i = 0; (i + record_size) <= s.size(); i += record_size)
+  {
+    char const c = s[i];
+    
+    for (::std::size_t j = 0; j != record_size; ++j)
+    {
+      if (j == (record_size - 1))
+        BOOST_TEST_EQ('\n', s[i + j]);
+      else if ((j % 2) == 0)
+        BOOST_TEST_EQ(c, s[i + j]);
+      else
+        BOOST_TEST_EQ(',', s[i + j]);
+    }
+    
+    if ((c >= '0') && (c < char('0' + thread_count)))
+      ++counts[c - '0'];
+  }
+  
+  for (::std::size_t t = 0; t != thread_count; ++t)
+    BOOST_TEST_EQ(writes_per_thread, counts[t]);
+  
+  ::std::fclose(f);
+}
+
+} // namespace concurrent_writers
+
+} // namespace ring_sink_tests
+
+int main()
+{
+  using namespace ring_sink_tests;
+  
+  normal_records::test();
+  
+  formatting::test();
+  
+  truncated_records::test();
+  
+  throwing_element::test();
+  
+  drop_policy::test();
+  block_policy::test();
+  
+  concurrent_writers::test();
+  
+  return boost::report_errors();
+}
+
+#endif  // BOOST_NO_CXX11_RVALUE_REFERENCES || !BOOST_HAS_UNISTD_H
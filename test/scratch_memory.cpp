@@ -0,0 +1,407 @@
+//
+// Copyright (c) Mark A. Gibbs, 2015.
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+// 
+
+// This test covers the per-thread scratch memory used by the buffered write
+// functions, and the functions that release it.
+// 
+// The tests must confirm that buffered writes do not allocate once the
+// thread's scratch memory has warmed up, and that the memory is released
+// when it should be (and only then).
+// 
+// This test requires C++11.
+
+#include <boost/config.hpp>
+
+#ifdef BOOST_NO_CXX11_RVALUE_REFERENCES
+#   include <iostream>
+int main() { ::std::cout << "Not supported in C++98.\n"; }
+#else
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <locale>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/core/lightweight_test.hpp>
+
+#include <boost/rangeio/scratch_memory.hpp>
+#include <boost/rangeio/write_iterator_range_atomic.hpp>
+
+#include "extras/allocation_counter.hpp"
+#include "extras/array_streambuf.hpp"
+
+namespace scratch_memory_tests {
+
+// Confirm that atomic writes do not allocate after the first write.
+namespace no_allocations {
+
+template <typename CharT>
+void do_test()
+{
+  ::std::vector<int> r;
+  for (int i = 0; i < 100; ++i)
+    r.push_back(i * 7919);
+  
+  static ::boost::rangeio::test_extras::array_streambuf<CharT, 65536> buf;
+  ::std::basic_ostream<CharT> out(&buf);
+  out.imbue(::std::locale::classic());
+  
+  // Warm up.
+  ::boost::rangeio::write_iterator_range_atomic(out, r.begin(), r.end(), CharT(','));
+  
+  ::boost::rangeio::test_extras::allocation_counter counter;
+  
+  for (int i = 0; i < 50; ++i)
+  {
+    ::boost::rangeio::write_iterator_range_atomic(out, r.begin(), r.end(), CharT(','));
+    ::boost::rangeio::write_iterator_range_atomic(out, r.begin(), r.begin() + 10);
+  }
+  
+  BOOST_TEST_EQ(::std::size_t(0), counter.allocations());
+  BOOST_TEST_EQ(::std::size_t(0), counter.deallocations());
+  
+  BOOST_TEST(bool(out));
+  
+  ::boost::rangeio::release_scratch_memory();
+}
+
+void test()
+{
+  do_test<char>();
+  do_test<wchar_t>();
+}
+
+} // namespace no_allocations
+
+// Confirm that the calling thread's scratch memory can be released.
+namespace release_thread {
+
+void test()
+{
+  ::boost::rangeio::release_scratch_memory();
+  BOOST_TEST_EQ(::std::size_t(0), ::boost::rangeio::scratch_memory_size());
+  
+  ::std::vector<int> const r(100, 12345);
+  
+  static ::boost::rangeio::test_extras::array_streambuf<char, 4096> buf;
+  ::std::ostream out(&buf);
+  
+  ::boost::rangeio::write_iterator_range_atomic(out, r.begin(), r.end(), ' ');
+  
+  ::std::size_t const size = ::boost::rangeio::scratch_memory_size();
+  BOOST_TEST(size >= 600);
+  
+  BOOST_TEST_EQ(size, ::boost::rangeio::release_scratch_memory());
+  BOOST_TEST_EQ(::std::size_t(0), ::boost::rangeio::scratch_memory_size());
+  BOOST_TEST_EQ(::std::size_t(0), ::boost::rangeio::release_scratch_memory());
+  
+  // The memory is still usable after being released.
+  buf.clear();
+  ::boost::rangeio::write_iterator_range_atomic(out, r.begin(), r.begin() + 3, ' ');
+  BOOST_TEST_EQ("12345 12345 12345", buf.str());
+  
+  ::boost::rangeio::release_scratch_memory();
+}
+
+} // namespace release_thread
+
+// Confirm that nested writes each get their own block, that releasing memory
+// during a write only releases the blocks not in use, and that very deeply
+// nested writes work.
+namespace nested_writes {
+
+struct nested
+{
+  ::std::vector<int> values;
+};
+
+::std::ostream& operator<<(::std::ostream& out, nested const& n)
+{
+  out << '[';
+  ::boost::rangeio::write_iterator_range_atomic(out, n.values.begin(), n.values.end(), ',');
+  return out << ']';
+}
+
+struct releaser
+{
+  ::std::size_t* released;
+};
+
+::std::ostream& operator<<(::std::ostream& out, releaser const& r)
+{
+  *r.released = ::boost::rangeio::release_scratch_memory();
+  return out << 'r';
+}
+
+struct deep
+{
+  int levels;
+};
+
+::std::ostream& operator<<(::std::ostream& out, deep const& d)
+{
+  if (d.levels == 0)
+    return out << '*';
+  
+  deep const inner[] = { { d.levels - 1 } };
+  
+  out << '(';
+  ::boost::rangeio::write_iterator_range_atomic(out, inner, inner + 1);
+  return out << ')';
+}
+
+void test()
+{
+  ::std::vector<nested> const r = { { { 1, 2 } }, { { 3 } } };
+  
+  static ::boost::rangeio::test_extras::array_streambuf<char, 4096> buf;
+  ::std::ostream out(&buf);
+  
+  ::boost::rangeio::write_iterator_range_atomic(out, r.begin(), r.end(), ' ');
+  BOOST_TEST_EQ("[1,2] [3]", buf.str());
+  
+  // Two blocks - one for each level of nesting.
+  ::std::size_t const size = ::boost::rangeio::scratch_memory_size();
+  BOOST_TEST(size != 0);
+  
+  // Releasing from inside a write keeps the outer block (in use), but frees
+  // the inner block.
+  ::std::size_t released = 0;
+  releaser const rr[] = { { &released } };
+  
+  buf.clear();
+  ::boost::rangeio::write_iterator_range_atomic(out, rr, rr + 1);
+  BOOST_TEST_EQ("r", buf.str());
+  BOOST_TEST(released != 0);
+  BOOST_TEST(released < size);
+  BOOST_TEST_EQ(size - released, ::boost::rangeio::scratch_memory_size());
+  
+  ::boost::rangeio::release_scratch_memory();
+  
+  // Writes nested more deeply than the arena's block stack still work.
+  deep const d[] = { { 20 } };
+  
+  buf.clear();
+  ::boost::rangeio::write_iterator_range_atomic(out, d, d + 1);
+  BOOST_TEST_EQ("((((((((((((((((((((*))))))))))))))))))))", buf.str());
+  
+  ::boost::rangeio::release_scratch_memory();
+}
+
+} // namespace nested_writes
+
+// Confirm that writes larger than the retain limit free their memory.
+namespace retain_limit {
+
+void test()
+{
+  ::std::size_t const old_limit = ::boost::rangeio::scratch_memory_retain_limit();
+  
+  ::boost::rangeio::set_scratch_memory_retain_limit(1024);
+  BOOST_TEST_EQ(::std::size_t(1024), ::boost::rangeio::scratch_memory_retain_limit());
+  
+  static ::boost::rangeio::test_extras::array_streambuf<char, 8192> buf;
+  ::std::ostream out(&buf);
+  
+  // Small writes keep their memory.
+  ::std::vector<int> const small(10, 12345);
+  ::boost::rangeio::write_iterator_range_atomic(out, small.begin(), small.end(), ' ');
+  BOOST_TEST(::boost::rangeio::scratch_memory_size() != 0);
+  BOOST_TEST(::boost::rangeio::scratch_memory_size() <= 1024);
+  
+  // Large writes do not.
+  ::std::vector<int> const large(1000, 12345);
+  ::boost::rangeio::write_iterator_range_atomic(out, large.begin(), large.end(), ' ');
+  BOOST_TEST_EQ(::std::size_t(0), ::boost::rangeio::scratch_memory_size());
+  
+  BOOST_TEST(bool(out));
+  BOOST_TEST_EQ((10 * 6) - 1 + (1000 * 6) - 1, buf.size());
+  
+  ::boost::rangeio::set_scratch_memory_retain_limit(old_limit);
+}
+
+} // namespace retain_limit
+
+// Confirm that the memory of idle threads can be released from another
+// thread, and that the memory of busy threads is not.
+namespace idle_threads {
+
+// A thread that does an atomic write each time it is told to, and reports
+// its scratch memory size.
+class worker
+{
+public:
+  worker() :
+    step_(0),
+    done_step_(0),
+    size_(0),
+    thread_([this] { run_(); })
+  {}
+  
+  ~worker()
+  {
+    command_(-1);
+    thread_.join();
+  }
+  
+  void write() { command_(1); }
+  
+  ::std::size_t size()
+  {
+    command_(0);
+    return size_;
+  }
+  
+private:
+  void command_(int c)
+  {
+    ::std::unique_lock< ::std::mutex> lock(mutex_);
+    command_value_ = c;
+    ++step_;
+    cv_.notify_all();
+    cv_.wait(lock, [this] { return done_step_ == step_; });
+  }
+  
+  void run_()
+  {
+    ::std::vector<int> const r(100, 12345);
+    ::std::ostream out(&buf_);
+    
+    ::std::unique_lock< ::std::mutex> lock(mutex_);
+    for (;;)
+    {
+      cv_.wait(lock, [this] { return done_step_ != step_; });
+      
+      if (command_value_ == 1)
+      {
+        buf_.clear();
+        ::boost::rangeio::write_iterator_range_atomic(out, r.begin(), r.end(), ' ');
+      }
+      
+      size_ = ::boost::rangeio::scratch_memory_size();
+      
+      done_step_ = step_;
+      cv_.notify_all();
+      
+      if (command_value_ == -1)
+        break;
+    }
+  }
+  
+  ::std::mutex                                                 mutex_;
+  ::std::condition_variable                                    cv_;
+  int                                                          command_value_;
+  int                                                          step_;
+  int                                                          done_step_;
+  ::std::size_t                                                size_;
+  ::boost::rangeio::test_extras::array_streambuf<char, 4096>  buf_;
+  ::std::thread                                                thread_;
+};
+
+void test()
+{
+  ::boost::rangeio::release_scratch_memory();
+  
+  worker idle;
+  worker busy;
+  
+  idle.write();
+  busy.write();
+  
+  ::std::size_t const idle_size = idle.size();
+  ::std::size_t const busy_size = busy.size();
+  BOOST_TEST(idle_size != 0);
+  BOOST_TEST(busy_size != 0);
+  
+  // Both threads have written since the last sweep, so nothing is freed.
+  ::boost::rangeio::release_idle_scratch_memory();
+  BOOST_TEST_EQ(idle_size, idle.size());
+  BOOST_TEST_EQ(busy_size, busy.size());
+  
+  busy.write();
+  
+  // Now only the idle thread is freed.
+  BOOST_TEST_EQ(idle_size, ::boost::rangeio::release_idle_scratch_memory());
+  BOOST_TEST_EQ(::std::size_t(0), idle.size());
+  BOOST_TEST_EQ(busy_size, busy.size());
+  
+  // A thread whose memory was freed can still write.
+  idle.write();
+  BOOST_TEST_EQ(idle_size, idle.size());
+}
+
+} // namespace idle_threads
+
+namespace concurrent_release {
+
+// A thread releasing its own scratch memory while another thread sweeps
+// idle memory must never have the same blocks freed twice.
+void test()
+{
+  ::std::vector<int> const r(100, 12345);
+  
+  ::boost::rangeio::test_extras::array_streambuf<char, 4096> buf;
+  ::std::ostream out(&buf);
+  
+  ::boost::rangeio::release_scratch_memory();
+  ::boost::rangeio::write_iterator_range_atomic(out, r.begin(), r.end(), ' ');
+  ::std::string const expected = buf.str();
+  ::std::size_t const full_size = ::boost::rangeio::scratch_memory_size();
+  BOOST_TEST(full_size != 0);
+  
+  ::std::atomic<bool> done(false);
+  ::std::thread sweeper([&done]
+  {
+    while (!done.load())
+      ::boost::rangeio::release_idle_scratch_memory();
+  });
+  
+  for (int i = 0; i != 5000; ++i)
+  {
+    buf.clear();
+    ::boost::rangeio::write_iterator_range_atomic(out, r.begin(), r.end(), ' ');
+    BOOST_TEST(buf.str() == expected);
+    
+    // The sweep may or may not have got there first, but the memory is
+    // only ever freed once.
+    ::std::size_t const released = ::boost::rangeio::release_scratch_memory();
+    BOOST_TEST(released == 0 || released == full_size);
+  }
+  
+  done = true;
+  sweeper.join();
+  
+  BOOST_TEST_EQ(::std::size_t(0), ::boost::rangeio::release_scratch_memory());
+  BOOST_TEST_EQ(::std::size_t(0), ::boost::rangeio::scratch_memory_size());
+}
+
+} // namespace concurrent_release
+
+} // namespace scratch_memory_tests
+
+int main()
+{
+  using namespace scratch_memory_tests;
+  
+  no_allocations::test();
+  
+  release_thread::test();
+  nested_writes::test();
+  retain_limit::test();
+  
+  idle_threads::test();
+  concurrent_release::test();
+  
+  return boost::report_errors();
+}
+
+#endif  // BOOST_NO_CXX11_RVALUE_REFERENCES
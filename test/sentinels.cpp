@@ -0,0 +1,160 @@
+//
+// Copyright (c) Mark A. Gibbs, 2015.
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+// 
+
+// This test covers the special sentinels (null_terminated and
+// unreachable_sentinel) used with write_iterator_range.
+// 
+// The tests must confirm that the ranges end where they should, both for
+// pointers (which have a special fast path for null-terminated ranges) and for
+// other iterators.
+// 
+// This test requires C++11.
+
+#include <boost/config.hpp>
+
+#ifdef BOOST_NO_CXX11_RVALUE_REFERENCES
+#   include <iostream>
+int main() { ::std::cout << "Not supported in C++98.\n"; }
+#else
+
+#include <locale>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <boost/core/lightweight_test.hpp>
+
+#include <boost/rangeio/write_iterator_range.hpp>
+
+#include "extras/array_streambuf.hpp"
+#include "extras/more_tests.hpp"
+
+namespace sentinels_tests {
+
+// Confirm that null-terminated character strings are written up to (but not
+// including) the terminator.
+namespace null_terminated_string {
+
+void test()
+{
+  // Narrow string, immediate
+  {
+    char const* const s = "hello";
+    
+    ::std::ostringstream out;
+    auto res = ::boost::rangeio::write_iterator_range(out, s, ::boost::rangeio::null_terminated);
+    
+    BOOST_TEST_EQ(::std::size_t(5), res.count);
+    BOOST_TEST(s + 5 == res.next);
+    BOOST_TEST_EQ("hello", out.str());
+  }
+  
+  // Wide string, immediate with delimiter
+  {
+    wchar_t const* const s = L"abc";
+    
+    ::std::wostringstream out;
+    auto res = ::boost::rangeio::write_iterator_range(out, s, ::boost::rangeio::null_terminated, L'.');
+    
+    BOOST_TEST_EQ(::std::size_t(3), res.count);
+    BOOST_TEST(s + 3 == res.next);
+    BOOST_TEST(L"a.b.c" == out.str());
+  }
+  
+  // Mutable array, deferred
+  {
+    char s[] = "xyz";
+    
+    ::std::ostringstream out;
+    out << ::boost::rangeio::write_iterator_range(&s[0], ::boost::rangeio::null_terminated, ", ");
+    
+    BOOST_TEST_EQ("x, y, z", out.str());
+  }
+  
+  // Empty string
+  {
+    ::std::ostringstream out;
+    auto res = ::boost::rangeio::write_iterator_range(out, "", ::boost::rangeio::null_terminated, ',');
+    
+    BOOST_TEST_EQ(::std::size_t(0), res.count);
+    BOOST_TEST(out.str().empty());
+  }
+}
+
+} // namespace null_terminated_string
+
+// Confirm that null-terminated ranges of non-character types, and with
+// non-pointer iterators, are written up to the terminator.
+namespace null_terminated_other {
+
+void test()
+{
+  // Zero-terminated array of ints
+  {
+    int const r[] = { 3, 1, 4, 1, 5, 0, 9, 2 };
+    
+    ::std::ostringstream out;
+    out.imbue(::std::locale::classic());
+    
+    auto res = ::boost::rangeio::write_iterator_range(out, r, ::boost::rangeio::null_terminated, ' ');
+    
+    BOOST_TEST_EQ(::std::size_t(5), res.count);
+    BOOST_TEST(r + 5 == res.next);
+    BOOST_TEST_EQ("3 1 4 1 5", out.str());
+  }
+  
+  // Non-pointer iterator
+  {
+    ::std::string const s("ab\0cd", 5);
+    
+    ::std::ostringstream out;
+    auto res = ::boost::rangeio::write_iterator_range(out, s.begin(), ::boost::rangeio::null_terminated);
+    
+    BOOST_TEST_EQ(::std::size_t(2), res.count);
+    BOOST_TEST(s.begin() + 2 == res.next);
+    BOOST_TEST_EQ("ab", out.str());
+  }
+}
+
+} // namespace null_terminated_other
+
+// Confirm that a range ending in unreachable_sentinel is written until the
+// stream fails.
+namespace unreachable {
+
+void test()
+{
+  ::std::vector<char> r(100, 'z');
+  
+  ::boost::rangeio::test_extras::array_streambuf<char, 10> buf;
+  ::std::ostream out(&buf);
+  
+  auto res = ::boost::rangeio::write_iterator_range(out, r.begin(), ::boost::rangeio::unreachable_sentinel);
+  
+  BOOST_TEST(!out);
+  BOOST_TEST_EQ(::std::size_t(10), res.count);
+  BOOST_TEST(r.begin() + 10 == res.next);
+  BOOST_TEST_EQ("zzzzzzzzzz", buf.str());
+}
+
+} // namespace unreachable
+
+} // namespace sentinels_tests
+
+int main()
+{
+  using namespace sentinels_tests;
+  
+  null_terminated_string::test();
+  null_terminated_other::test();
+  
+  unreachable::test();
+  
+  return boost::report_errors();
+}
+
+#endif  // BOOST_NO_CXX11_RVALUE_REFERENCES
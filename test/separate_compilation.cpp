@@ -0,0 +1,105 @@
+//
+// Copyright (c) Mark A. Gibbs, 2015.
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+// 
+
+// This test covers using the compiled RangeIO library (with
+// BOOST_RANGEIO_SEPARATE_COMPILATION defined).
+// 
+// The tests must confirm that writes using the extern instantiations (which
+// are linked from the library) and writes using other instantiations (which
+// are instantiated implicitly) both work correctly.
+// 
+// This test requires C++11.
+
+#define BOOST_RANGEIO_SEPARATE_COMPILATION
+
+#include <boost/config.hpp>
+
+#ifdef BOOST_NO_CXX11_RVALUE_REFERENCES
+#   include <iostream>
+int main() { ::std::cout << "Not supported in C++98.\n"; }
+#else
+
+#include <list>
+#include <locale>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <boost/core/lightweight_test.hpp>
+
+#include <boost/rangeio/write_iterator_range.hpp>
+
+#include "extras/more_tests.hpp"
+
+namespace separate_compilation_tests {
+
+// Confirm that instantiations from the library work.
+namespace extern_instantiations {
+
+template <typename CharT>
+void do_test()
+{
+  ::std::vector<int> const r = { 1, 2, 3 };
+  ::std::vector<double> d = { 0.5, 1.5 };
+  CharT const delim = CharT(',');
+  
+  ::std::basic_ostringstream<CharT> out;
+  out.imbue(::std::locale::classic());
+  
+  ::boost::rangeio::write_iterator_range(out, r.begin(), r.end());
+  out << ::boost::rangeio::write_iterator_range(d.begin(), d.end(), delim);
+  
+  BOOST_TEST(bool(out));
+  BOOST_RANGEIO_TEST_STR_EQ("1230.5,1.5", out.str());
+}
+
+void test()
+{
+  do_test<char>();
+  do_test<wchar_t>();
+  
+  ::std::vector< ::std::string> const s = { "a", "b" };
+  ::std::string const delim = "--";
+  
+  ::std::ostringstream out;
+  ::boost::rangeio::write_iterator_range(out, s.begin(), s.end(), delim);
+  
+  BOOST_TEST_EQ("a--b", out.str());
+}
+
+} // namespace extern_instantiations
+
+// Confirm that other instantiations still work.
+namespace implicit_instantiations {
+
+void test()
+{
+  ::std::list<int> const r = { 4, 5, 6 };
+  
+  ::std::ostringstream out;
+  out.imbue(::std::locale::classic());
+  
+  ::boost::rangeio::write_iterator_range(out, r.begin(), r.end(), ", ");
+  
+  BOOST_TEST_EQ("4, 5, 6", out.str());
+}
+
+} // namespace implicit_instantiations
+
+} // namespace separate_compilation_tests
+
+int main()
+{
+  using namespace separate_compilation_tests;
+  
+  extern_instantiations::test();
+  implicit_instantiations::test();
+  
+  return boost::report_errors();
+}
+
+#endif  // BOOST_NO_CXX11_RVALUE_REFERENCES
@@ -0,0 +1,387 @@
+//
+// Copyright (c) Mark A. Gibbs, 2015.
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+// 
+
+// This test covers write_hex().
+// 
+// The tests must confirm that bytes and wider integers are written in hex
+// exactly as the format describes (widths, zero fill, case, separators and
+// grouping), that long ranges are written properly across batches, and that
+// failures are reported with the number of elements actually written.
+// 
+// The bulk byte encoding is vectorized when SSSE3 is enabled, so this test
+// should also be run built with (for example) -mssse3; detail_simd.cpp
+// compares it with the scalar encoding directly.
+// 
+// This test requires C++11.
+
+#include <boost/config.hpp>
+
+#ifdef BOOST_NO_CXX11_RVALUE_REFERENCES
+#   include <iostream>
+int main() { ::std::cout << "Not supported in C++98.\n"; }
+#else
+
+#include <cstddef>
+#include <cstdint>
+#include <iomanip>
+#include <ios>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <boost/core/lightweight_test.hpp>
+
+#include <boost/rangeio/write_hex.hpp>
+
+#include "extras/array_streambuf.hpp"
+#include "extras/more_tests.hpp"
+#include "extras/throwing_streambuf.hpp"
+
+namespace write_hex_tests {
+
+// The hex dump of r, written the slow way.
+template <typename T>
+::std::string reference(::std::vector<T> const& r)
+{
+  ::std::ostringstream out;
+  out << ::std::hex << ::std::setfill('0');
+  
+  for (auto const v : r)
+    out << ::std::setw(2 * sizeof(T)) << (unsigned long long)(typename ::std::make_unsigned<T>::type(v));
+  
+  return out.str();
+}
+
+// Confirm that bytes are written properly.
+namespace bytes {
+
+void test()
+{
+  ::std::vector<unsigned char> const r = { 0x00, 0x0F, 0xAB, 0xFF, 0x10 };
+  
+  {
+    ::std::ostringstream out;
+    
+    auto const res = ::boost::rangeio::write_hex(out, r.data(), r.data() + r.size());
+    
+    BOOST_TEST(bool(out));
+    BOOST_TEST(r.data() + r.size() == res.next);
+    BOOST_TEST_EQ(r.size(), res.count);
+    BOOST_RANGEIO_TEST_STR_EQ(out.str(), "000fabff10");
+  }
+  
+  // Uppercase, and a count rather than an end pointer
+  {
+    ::boost::rangeio::hex_format f;
+    f.uppercase = true;
+    
+    ::std::ostringstream out;
+    
+    auto const res = ::boost::rangeio::write_hex(out, r.data(), 3, f);
+    
+    BOOST_TEST_EQ(::std::size_t(3), res.count);
+    BOOST_RANGEIO_TEST_STR_EQ(out.str(), "000FAB");
+  }
+  
+  // Chars are written as numbers, and signed values as their unsigned
+  // representation
+  {
+    ::std::string const s = "A\xFF";
+    
+    ::std::ostringstream out;
+    ::boost::rangeio::write_hex(out, s.data(), s.size());
+    BOOST_RANGEIO_TEST_STR_EQ(out.str(), "41ff");
+  }
+  
+  // Wide streams
+  {
+    ::std::wostringstream out;
+    ::boost::rangeio::write_hex(out, r.data(), r.size());
+    BOOST_TEST(out.str() == L"000fabff10");
+  }
+  
+  // Long ranges, across many batches, in both the bulk and element-by-element
+  // encodings
+  {
+    ::std::vector<unsigned char> data;
+    for (int n = 0; n < 5000; ++n)
+      data.push_back((unsigned char)((n * 37) ^ (n >> 3)));
+    
+    ::std::ostringstream out;
+    
+    auto const res = ::boost::rangeio::write_hex(out, data.data(), data.size());
+    
+    BOOST_TEST_EQ(data.size(), res.count);
+    BOOST_TEST(out.str() == reference(data));
+    
+    ::boost::rangeio::hex_format f;
+    f.width = 3;
+    
+    ::std::ostringstream padded;
+    ::boost::rangeio::write_hex(padded, data.data(), data.size(), f);
+    
+    BOOST_TEST_EQ(data.size() * 3, padded.str().size());
+    BOOST_TEST(padded.str().substr(0, 9) == ("0" + reference(data).substr(0, 2) + "0" + reference(data).substr(2, 2) + "0" + reference(data).substr(4, 2)));
+  }
+}
+
+} // namespace bytes
+
+// Confirm that wider integers are written properly.
+namespace integers {
+
+void test()
+{
+  {
+    ::std::vector< ::std::uint16_t> const r = { 0x1, 0xABCD, 0x20 };
+    
+    ::boost::rangeio::hex_format f;
+    f.separator = " ";
+    
+    {
+      ::std::ostringstream out;
+      ::boost::rangeio::write_hex(out, r.data(), r.size(), f);
+      BOOST_RANGEIO_TEST_STR_EQ(out.str(), "0001 abcd 0020");
+    }
+    
+    // Minimum width
+    f.width = 3;
+    {
+      ::std::ostringstream out;
+      ::boost::rangeio::write_hex(out, r.data(), r.size(), f);
+      BOOST_RANGEIO_TEST_STR_EQ(out.str(), "001 abcd 020");
+    }
+    
+    // No zero fill
+    f.zero_fill = false;
+    {
+      ::std::ostringstream out;
+      ::boost::rangeio::write_hex(out, r.data(), r.size(), f);
+      BOOST_RANGEIO_TEST_STR_EQ(out.str(), "  1 abcd  20");
+    }
+    
+    f.width = 0;
+    {
+      ::std::ostringstream out;
+      ::boost::rangeio::write_hex(out, r.data(), r.size(), f);
+      BOOST_RANGEIO_TEST_STR_EQ(out.str(), "1 abcd 20");
+    }
+  }
+  
+  {
+    ::std::vector< ::std::int32_t> const r = { -1, 0, 0x12345678 };
+    
+    ::std::ostringstream out;
+    ::boost::rangeio::write_hex(out, r.data(), r.size());
+    BOOST_RANGEIO_TEST_STR_EQ(out.str(), "ffffffff0000000012345678");
+  }
+  
+  {
+    ::std::vector< ::std::uint64_t> const r = { 0x0123456789ABCDEFull, 1 };
+    
+    ::std::ostringstream out;
+    ::boost::rangeio::write_hex(out, r.data(), r.size());
+    BOOST_TEST(out.str() == reference(r));
+  }
+}
+
+} // namespace integers
+
+// Confirm that grouping works.
+namespace grouping {
+
+void test()
+{
+  ::std::vector<unsigned char> r;
+  for (int n = 0; n < 10; ++n)
+    r.push_back((unsigned char)(n));
+  
+  ::boost::rangeio::hex_format f;
+  f.separator = " ";
+  f.group = 4;
+  f.group_separator = " | ";
+  
+  {
+    ::std::ostringstream out;
+    ::boost::rangeio::write_hex(out, r.data(), r.size(), f);
+    BOOST_RANGEIO_TEST_STR_EQ(out.str(), "00 01 02 03 | 04 05 06 07 | 08 09");
+  }
+  
+  // Groups with no separator within them
+  f.separator = "";
+  f.group_separator = "-";
+  {
+    ::std::wostringstream out;
+    ::boost::rangeio::write_hex(out, r.data(), r.size(), f);
+    BOOST_TEST(out.str() == L"00010203-04050607-0809");
+  }
+  
+  // Separators longer than a batch
+  f.group = 0;
+  f.separator = "";
+  ::std::string const long_separator(1000, '.');
+  f.separator = long_separator.c_str();
+  {
+    ::std::ostringstream out;
+    
+    auto const res = ::boost::rangeio::write_hex(out, r.data(), 2, f);
+    
+    BOOST_TEST_EQ(::std::size_t(2), res.count);
+    BOOST_TEST(out.str() == ("00" + long_separator + "01"));
+  }
+}
+
+} // namespace grouping
+
+// Confirm that binary output works.
+namespace binary {
+
+void test()
+{
+  ::boost::rangeio::hex_format f;
+  f.binary = true;
+  
+  {
+    ::std::vector<unsigned char> const r = { 0x00, 0xA5, 0xFF };
+    
+    ::std::ostringstream out;
+    auto const res = ::boost::rangeio::write_hex(out, r.data(), r.size(), f);
+    
+    BOOST_TEST_EQ(r.size(), res.count);
+    BOOST_RANGEIO_TEST_STR_EQ(out.str(), "000000001010010111111111");
+  }
+  
+  {
+    ::std::vector< ::std::uint16_t> const r = { 0x5, 0x100 };
+    
+    f.separator = " ";
+    f.zero_fill = false;
+    f.width = 4;
+    
+    ::std::wostringstream out;
+    ::boost::rangeio::write_hex(out, r.data(), r.size(), f);
+    BOOST_TEST(out.str() == L" 101 100000000");
+  }
+}
+
+} // namespace binary
+
+// Confirm that the stream state is handled properly.
+namespace state {
+
+void test()
+{
+  ::std::vector<unsigned char> r(1000, 0xAA);
+  
+  // The stream's formatting is ignored, and the width is reset
+  {
+    ::std::ostringstream out;
+    out << ::std::uppercase << ::std::showbase << ::std::setw(10) << ::std::setfill('*');
+    
+    ::boost::rangeio::write_hex(out, r.data(), 2);
+    
+    BOOST_RANGEIO_TEST_STR_EQ(out.str(), "aaaa");
+    BOOST_TEST_EQ(0, out.width());
+  }
+  
+  // Stream buffer that fails part way through the first batch; the bytes
+  // whose digits were both accepted are counted
+  {
+    ::boost::rangeio::test_extras::array_streambuf<char, 5> buf;
+    ::std::ostream out(&buf);
+    
+    auto const res = ::boost::rangeio::write_hex(out, r.data(), 10);
+    
+    BOOST_TEST(!out);
+    BOOST_TEST(r.data() + 2 == res.next);
+    BOOST_TEST_EQ(::std::size_t(2), res.count);
+  }
+  
+  // ... and part way through a later batch
+  {
+    ::boost::rangeio::test_extras::array_streambuf<char, 1101> buf;
+    ::std::ostream out(&buf);
+    
+    auto const res = ::boost::rangeio::write_hex(out, r.data(), r.size());
+    
+    BOOST_TEST(!out);
+    BOOST_TEST(r.data() + 550 == res.next);
+    BOOST_TEST_EQ(::std::size_t(550), res.count);
+  }
+  
+  // Stream buffer that fails on a later batch
+  {
+    ::boost::rangeio::hex_format f;
+    f.separator = " ";
+    
+    ::boost::rangeio::test_extras::array_streambuf<char, 600> buf;
+    ::std::ostream out(&buf);
+    
+    auto const res = ::boost::rangeio::write_hex(out, r.data(), r.size(), f);
+    
+    BOOST_TEST(!out);
+    BOOST_TEST(res.count != 0);
+    BOOST_TEST(res.count < r.size());
+    BOOST_TEST(((res.count * 3) - 1) <= 600);
+    BOOST_TEST(r.data() + res.count == res.next);
+  }
+  
+  // Stream that has already failed
+  {
+    ::std::ostringstream out;
+    out.setstate(::std::ios_base::failbit);
+    out.width(5);
+    
+    auto const res = ::boost::rangeio::write_hex(out, r.data(), r.size());
+    
+    BOOST_TEST_EQ(::std::size_t(0), res.count);
+    BOOST_TEST(out.str().empty());
+    BOOST_TEST_EQ(0, out.width());
+  }
+  
+  // Stream buffer that throws; badbit is set, and the exception is rethrown
+  // only if the stream's exceptions include badbit
+  {
+    ::boost::rangeio::test_extras::throwing_streambuf<char, 5> buf;
+    ::std::ostream out(&buf);
+    
+    auto const res = ::boost::rangeio::write_hex(out, r.data(), 10);
+    
+    BOOST_TEST(out.bad());
+    BOOST_TEST_EQ(::std::size_t(0), res.count);
+    BOOST_TEST(r.data() == res.next);
+  }
+  {
+    ::boost::rangeio::test_extras::throwing_streambuf<char, 5> buf;
+    ::std::ostream out(&buf);
+    out.exceptions(::std::ios_base::badbit);
+    
+    BOOST_TEST_THROWS(::boost::rangeio::write_hex(out, r.data(), 10),
+      ::boost::rangeio::test_extras::streambuf_error);
+    BOOST_TEST(out.bad());
+  }
+}
+
+} // namespace state
+
+} // namespace write_hex_tests
+
+int main()
+{
+  using namespace write_hex_tests;
+  
+  bytes::test();
+  integers::test();
+  grouping::test();
+  binary::test();
+  
+  state::test();
+  
+  return boost::report_errors();
+}
+
+#endif  // BOOST_NO_CXX11_RVALUE_REFERENCES
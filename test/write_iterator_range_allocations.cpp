@@ -0,0 +1,176 @@
+//
+// Copyright (c) Mark A. Gibbs, 2015.
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+// 
+
+// This test covers the heap usage of write_iterator_range.
+// 
+// The tests must confirm that writing a range to a pre-sized sink does not
+// allocate, no matter how many elements are written.
+// 
+// This test requires C++11.
+
+#include <boost/config.hpp>
+
+#ifdef BOOST_NO_CXX11_RVALUE_REFERENCES
+#   include <iostream>
+int main() { ::std::cout << "Not supported in C++98.\n"; }
+#else
+
+#include <locale>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include <boost/core/lightweight_test.hpp>
+
+#include <boost/rangeio/write_iterator_range.hpp>
+
+#include "extras/allocation_counter.hpp"
+#include "extras/array_streambuf.hpp"
+#include "extras/more_tests.hpp"
+
+namespace write_iterator_range_allocations_tests {
+
+// Confirm that the allocation counter actually sees allocations, otherwise
+// the other tests prove nothing.
+namespace counter_sanity {
+
+void test()
+{
+  ::boost::rangeio::test_extras::allocation_counter counter;
+  
+  {
+    ::std::vector<int> v(100);
+    BOOST_TEST_EQ(::std::size_t(1), counter.allocations());
+    BOOST_TEST(counter.bytes() >= (100 * sizeof(int)));
+  }
+  
+  BOOST_TEST_EQ(::std::size_t(1), counter.deallocations());
+  
+  counter.reset();
+  BOOST_TEST_EQ(::std::size_t(0), counter.allocations());
+  BOOST_TEST_EQ(::std::size_t(0), counter.deallocations());
+  BOOST_TEST_EQ(::std::size_t(0), counter.bytes());
+
+#ifdef __cpp_aligned_new
+  // Over-aligned allocations
+  {
+    struct alignas(64) aligned_block { char c[64]; };
+    
+    auto const p = new aligned_block;
+    BOOST_TEST_EQ(::std::size_t(1), counter.allocations());
+    BOOST_TEST_EQ(::std::size_t(0), reinterpret_cast<::std::size_t>(p) % 64);
+    
+    delete p;
+    BOOST_TEST_EQ(::std::size_t(1), counter.deallocations());
+  }
+#endif // __cpp_aligned_new
+}
+
+} // namespace counter_sanity
+
+// Confirm that the immediate forms do not allocate, with and without
+// delimiters.
+namespace immediate {
+
+template <typename CharT>
+void do_test()
+{
+  ::std::vector<int> r;
+  for (int i = 0; i < 1000; ++i)
+    r.push_back(i * 7919);
+  
+  ::boost::rangeio::test_extras::array_streambuf<CharT, 32768> buf;
+  ::std::basic_ostream<CharT> out(&buf);
+  out.imbue(::std::locale::classic());
+  
+  ::boost::rangeio::test_extras::allocation_counter counter;
+  
+  auto res1 = ::boost::rangeio::write_iterator_range(out, r.begin(), r.end());
+  auto res2 = ::boost::rangeio::write_iterator_range(out, r.begin(), r.end(), CharT(','));
+  
+  BOOST_TEST_EQ(::std::size_t(0), counter.allocations());
+  BOOST_TEST_EQ(::std::size_t(0), counter.deallocations());
+  
+  BOOST_TEST(bool(out));
+  BOOST_TEST_EQ(r.size(), res1.count);
+  BOOST_TEST_EQ(r.size(), res2.count);
+}
+
+void test()
+{
+  do_test<char>();
+  do_test<wchar_t>();
+}
+
+} // namespace immediate
+
+// Confirm that the deferred forms do not allocate, including when the range
+// holds floating point values and the delimiter is a string literal.
+namespace deferred {
+
+void test()
+{
+  ::std::vector<double> r(500, 3.25);
+  
+  ::boost::rangeio::test_extras::array_streambuf<char, 32768> buf;
+  ::std::ostream out(&buf);
+  out.imbue(::std::locale::classic());
+  
+  ::boost::rangeio::test_extras::allocation_counter counter;
+  
+  out << ::boost::rangeio::write_iterator_range(r.cbegin(), r.cend(), ", ");
+  
+  BOOST_TEST_EQ(::std::size_t(0), counter.allocations());
+  
+  BOOST_TEST(bool(out));
+  BOOST_RANGEIO_TEST_STR_EQ("3.25, 3.25", buf.str().substr(0, 10));
+}
+
+} // namespace deferred
+
+// Confirm that no allocations are made even when the sink fills up and the
+// write fails part way through.
+namespace failed_write {
+
+void test()
+{
+  ::std::vector<int> r(100, 12345);
+  ::std::string const delim = " ";
+  
+  ::boost::rangeio::test_extras::array_streambuf<char, 64> buf;
+  ::std::ostream out(&buf);
+  out.imbue(::std::locale::classic());
+  
+  ::boost::rangeio::test_extras::allocation_counter counter;
+  
+  auto res = ::boost::rangeio::write_iterator_range(out, r.begin(), r.end(), delim);
+  
+  BOOST_TEST_EQ(::std::size_t(0), counter.allocations());
+  
+  BOOST_TEST(!out);
+  BOOST_TEST(res.count < r.size());
+}
+
+} // namespace failed_write
+
+} // namespace write_iterator_range_allocations_tests
+
+int main()
+{
+  using namespace write_iterator_range_allocations_tests;
+  
+  counter_sanity::test();
+  
+  immediate::test();
+  deferred::test();
+  
+  failed_write::test();
+  
+  return boost::report_errors();
+}
+
+#endif  // BOOST_NO_CXX11_RVALUE_REFERENCES
@@ -0,0 +1,315 @@
+//
+// Copyright (c) Mark A. Gibbs, 2015.
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+// 
+
+// This test covers the allocator-aware versions of write_iterator_range (the
+// deferred version, and the atomic versions).
+// 
+// The tests must confirm that the output is exactly the same as the normal
+// versions, that allocator-aware delimiters are constructed with the
+// allocator (both leading and trailing allocator conventions), that other
+// delimiters are simply stored, and that the atomic versions get all of their
+// formatting memory from the allocator.
+// 
+// This test requires C++11. The std::pmr parts require C++17.
+
+#include <boost/config.hpp>
+
+#ifdef BOOST_NO_CXX11_RVALUE_REFERENCES
+#   include <iostream>
+int main() { ::std::cout << "Not supported in C++98.\n"; }
+#else
+
+#include <cstddef>
+#include <memory>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <boost/core/lightweight_test.hpp>
+
+#include <boost/rangeio/write_iterator_range.hpp>
+#include <boost/rangeio/write_iterator_range_atomic.hpp>
+
+#include "extras/counting_allocator.hpp"
+#include "extras/more_tests.hpp"
+
+namespace write_iterator_range_allocator_tests {
+
+typedef ::boost::rangeio::test_extras::counting_allocator<char> allocator;
+
+typedef ::std::basic_string<char, ::std::char_traits<char>, allocator> string;
+
+// A delimiter that uses the leading allocator convention, and records
+// whether it was given an allocator.
+struct leading_delimiter
+{
+  typedef allocator allocator_type;
+  
+  leading_delimiter() : count(nullptr) {}
+  leading_delimiter(::std::allocator_arg_t, allocator_type const& a, leading_delimiter const&) : count(a.count) {}
+  
+  ::std::size_t* count;
+};
+
+::std::ostream& operator<<(::std::ostream& o, leading_delimiter const& d)
+{
+  return o << (d.count ? '+' : '-');
+}
+
+// A delimiter too long to fit in a string's small string buffer, so that
+// copying it into a string must allocate.
+char const long_delimiter[] = " <-- this delimiter is too long for the small string buffer --> ";
+
+// Confirm that an allocator-aware delimiter is copied using the allocator.
+namespace owned_delimiter {
+
+void test()
+{
+  ::std::vector<int> const r = { 1, 2, 3 };
+  
+  ::std::size_t original_count = 0;
+  ::std::size_t count = 0;
+  
+  // Lvalue delimiter (trailing allocator convention)
+  {
+    string const d(long_delimiter, allocator(&original_count));
+    
+    auto w = ::boost::rangeio::write_iterator_range(::std::allocator_arg, allocator(&count), r.begin(), r.end(), d);
+    
+    BOOST_TEST(w.delim_.get_allocator().count == &count);
+    BOOST_TEST_EQ(::std::size_t(1), count);
+    
+    ::std::ostringstream out;
+    out << w;
+    
+    BOOST_RANGEIO_TEST_STR_EQ(out.str(),
+      "1" + ::std::string(long_delimiter) + "2" + ::std::string(long_delimiter) + "3");
+  }
+  
+  // Rvalue delimiter - because the allocators differ, it is copied
+  {
+    count = 0;
+    
+    auto w = ::boost::rangeio::write_iterator_range(::std::allocator_arg, allocator(&count), r.begin(), r.end(),
+      string(long_delimiter, allocator(&original_count)));
+    
+    BOOST_TEST(w.delim_.get_allocator().count == &count);
+    BOOST_TEST_EQ(::std::size_t(1), count);
+  }
+  
+  // Leading allocator convention
+  {
+    leading_delimiter const d;
+    
+    auto w = ::boost::rangeio::write_iterator_range(::std::allocator_arg, allocator(&count), r.begin(), r.end(), d);
+    
+    BOOST_TEST(w.delim_.count == &count);
+    
+    ::std::ostringstream out;
+    out << w;
+    
+    BOOST_RANGEIO_TEST_STR_EQ(out.str(), "1+2+3");
+  }
+}
+
+} // namespace owned_delimiter
+
+// Confirm that delimiters that are not allocator-aware are simply stored.
+namespace plain_delimiter {
+
+void test()
+{
+  ::std::vector<int> const r = { 1, 2, 3 };
+  
+  ::std::size_t count = 0;
+  
+  {
+    auto w = ::boost::rangeio::write_iterator_range(::std::allocator_arg, allocator(&count), r.begin(), r.end(), ',');
+    
+    ::std::ostringstream out;
+    out << w;
+    
+    BOOST_RANGEIO_TEST_STR_EQ(out.str(), "1,2,3");
+  }
+  
+  {
+    auto w = ::boost::rangeio::write_iterator_range(::std::allocator_arg, allocator(&count), r.begin(), r.end(), ", ");
+    
+    ::std::ostringstream out;
+    out << w;
+    
+    BOOST_RANGEIO_TEST_STR_EQ(out.str(), "1, 2, 3");
+  }
+  
+  BOOST_TEST_EQ(::std::size_t(0), count);
+}
+
+} // namespace plain_delimiter
+
+// Confirm that the atomic versions write properly, and allocate their
+// formatting memory with the allocator.
+namespace atomic {
+
+void test()
+{
+  ::std::vector<int> r;
+  for (int i = 0; i < 1000; ++i)
+    r.push_back(i);
+  
+  ::std::ostringstream expected;
+  ::boost::rangeio::write_iterator_range(expected, r.begin(), r.end(), ", ");
+  
+  // With a delimiter
+  {
+    ::std::size_t count = 0;
+    
+    ::std::ostringstream out;
+    auto const res = ::boost::rangeio::write_iterator_range_atomic(::std::allocator_arg, allocator(&count), out, r.begin(), r.end(), ", ");
+    
+    BOOST_TEST(r.end() == res.next);
+    BOOST_TEST_EQ(r.size(), res.count);
+    BOOST_TEST(bool(out));
+    BOOST_RANGEIO_TEST_STR_EQ(out.str(), expected.str());
+    BOOST_TEST(count != 0);
+  }
+  
+  // Without a delimiter
+  {
+    ::std::size_t count = 0;
+    
+    ::std::ostringstream out;
+    out.width(3);
+    out.fill('*');
+    
+    auto const res = ::boost::rangeio::write_iterator_range_atomic(::std::allocator_arg, allocator(&count), out, r.begin(), r.begin() + 3);
+    
+    BOOST_TEST(r.begin() + 3 == res.next);
+    BOOST_TEST_EQ(::std::size_t(3), res.count);
+    BOOST_TEST(bool(out));
+    BOOST_RANGEIO_TEST_STR_EQ(out.str(), "**0**1**2");
+    BOOST_TEST_EQ(0, out.width());
+  }
+  
+  // Failed stream
+  {
+    ::std::size_t count = 0;
+    
+    ::std::ostringstream out;
+    out.setstate(::std::ios_base::failbit);
+    
+    auto const res = ::boost::rangeio::write_iterator_range_atomic(::std::allocator_arg, allocator(&count), out, r.begin(), r.end(), ", ");
+    
+    BOOST_TEST(r.begin() == res.next);
+    BOOST_TEST_EQ(::std::size_t(0), res.count);
+    BOOST_TEST(!out);
+    BOOST_TEST(out.str().empty());
+  }
+}
+
+} // namespace atomic
+
+#ifdef BOOST_RANGEIO_HAS_PMR
+
+// Confirm that std::pmr delimiters and buffers come from the memory resource.
+namespace pmr {
+
+// Memory resource that counts its allocations.
+class counting_resource :
+  public ::std::pmr::memory_resource
+{
+public:
+  counting_resource() : count(0) {}
+  
+  int count;
+  
+private:
+  void* do_allocate(::std::size_t n, ::std::size_t align)
+  {
+    ++count;
+    return ::std::pmr::new_delete_resource()->allocate(n, align);
+  }
+  
+  void do_deallocate(void* p, ::std::size_t n, ::std::size_t align)
+  {
+    ::std::pmr::new_delete_resource()->deallocate(p, n, align);
+  }
+  
+  bool do_is_equal(::std::pmr::memory_resource const& other) const noexcept
+  {
+    return this == &other;
+  }
+};
+
+void test()
+{
+  ::std::vector<int> r;
+  for (int i = 0; i < 100; ++i)
+    r.push_back(i);
+  
+  // With no upstream, the monotonic resource fails when its initial buffer
+  // is exhausted - so give it one that is big enough.
+  static char storage[65536];
+  ::std::pmr::monotonic_buffer_resource resource(storage, sizeof(storage), ::std::pmr::null_memory_resource());
+  
+  ::std::pmr::polymorphic_allocator<char> const a(&resource);
+  
+  ::std::pmr::string const d(long_delimiter);
+  
+  auto w = ::boost::rangeio::write_iterator_range(::std::allocator_arg, a, r.begin(), r.end(), d);
+  
+  BOOST_TEST(w.delim_.get_allocator().resource() == &resource);
+  BOOST_TEST(w.delim_.data() >= storage);
+  BOOST_TEST(w.delim_.data() < (storage + sizeof(storage)));
+  
+  ::std::ostringstream expected;
+  ::boost::rangeio::write_iterator_range(expected, r.begin(), r.end(), d);
+  
+  ::std::ostringstream out;
+  ::boost::rangeio::write_iterator_range_atomic(::std::allocator_arg, a, out, r.begin(), r.end(), w.delim_);
+  
+  BOOST_RANGEIO_TEST_STR_EQ(out.str(), expected.str());
+  
+  // A memory resource pointer can be used in place of an allocator.
+  counting_resource counted;
+  
+  ::std::ostringstream resource_out;
+  ::boost::rangeio::write_iterator_range_atomic(::std::allocator_arg, &counted, resource_out, r.begin(), r.end(), d);
+  
+  BOOST_RANGEIO_TEST_STR_EQ(resource_out.str(), expected.str());
+  BOOST_TEST(counted.count != 0);
+  
+  counted.count = 0;
+  auto const w2 = ::boost::rangeio::write_iterator_range(::std::allocator_arg, &counted, r.begin(), r.end(), d);
+  
+  BOOST_TEST(w2.delim_.get_allocator().resource() == &counted);
+  BOOST_TEST(counted.count != 0);
+}
+
+} // namespace pmr
+
+#endif // BOOST_RANGEIO_HAS_PMR
+
+} // namespace write_iterator_range_allocator_tests
+
+int main()
+{
+  using namespace write_iterator_range_allocator_tests;
+  
+  owned_delimiter::test();
+  plain_delimiter::test();
+  
+  atomic::test();
+
+#ifdef BOOST_RANGEIO_HAS_PMR
+  pmr::test();
+#endif
+
+  return boost::report_errors();
+}
+
+#endif  // BOOST_NO_CXX11_RVALUE_REFERENCES
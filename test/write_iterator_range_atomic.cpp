@@ -0,0 +1,381 @@
+//
+// Copyright (c) Mark A. Gibbs, 2015.
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+// 
+
+// This test covers the atomic versions of write_iterator_range.
+// 
+// The tests must confirm that the writes produce exactly the same output as
+// the immediate versions, that the stream state is handled the same way, and
+// that concurrent atomic writes to the same stream do not interleave.
+// 
+// This test requires C++11.
+
+#include <boost/config.hpp>
+
+#ifdef BOOST_NO_CXX11_RVALUE_REFERENCES
+#   include <iostream>
+int main() { ::std::cout << "Not supported in C++98.\n"; }
+#else
+
+#include <cstddef>
+#include <ios>
+#include <locale>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/core/lightweight_test.hpp>
+
+#include <boost/rangeio/write_iterator_range_atomic.hpp>
+
+#include "extras/array_streambuf.hpp"
+#include "extras/more_tests.hpp"
+
+namespace write_iterator_range_atomic_tests {
+
+// Confirm that ranges are written properly.
+namespace normal_range {
+
+template <typename CharT>
+void do_test()
+{
+  ::std::vector<int> const r = { 1, 1, 2, 3, 5, 8, 13 };
+  
+  // Empty range
+  {
+    ::std::vector<int> const empty;
+    
+    ::std::basic_ostringstream<CharT> out;
+    
+    auto res = ::boost::rangeio::write_iterator_range_atomic(out, empty.begin(), empty.end(), ", ");
+    
+    BOOST_TEST(empty.end() == res.next);
+    BOOST_TEST_EQ(::std::size_t(0), res.count);
+    BOOST_TEST(bool(out));
+    BOOST_TEST(out.str().empty());
+  }
+  
+  // Without delimiter
+  {
+    ::std::basic_ostringstream<CharT> out;
+    out.imbue(::std::locale::classic());
+    out << 'a';
+    
+    auto res = ::boost::rangeio::write_iterator_range_atomic(out, r.begin(), r.end());
+    
+    BOOST_TEST(r.end() == res.next);
+    BOOST_TEST_EQ(r.size(), res.count);
+    BOOST_TEST(bool(out));
+    BOOST_RANGEIO_TEST_STR_EQ("a11235813", out.str());
+  }
+  
+  // With delimiter
+  {
+    ::std::basic_ostringstream<CharT> out;
+    out.imbue(::std::locale::classic());
+    out << 'a';
+    
+    auto res = ::boost::rangeio::write_iterator_range_atomic(out, r.begin(), r.end(), ::std::basic_string<CharT>(2, CharT('-')));
+    
+    BOOST_TEST(r.end() == res.next);
+    BOOST_TEST_EQ(r.size(), res.count);
+    BOOST_TEST(bool(out));
+    BOOST_RANGEIO_TEST_STR_EQ("a1--1--2--3--5--8--13", out.str());
+  }
+}
+
+void test()
+{
+  do_test<char>();
+  do_test<wchar_t>();
+}
+
+} // namespace normal_range
+
+// Confirm that the stream's formatting state (including the locale) is used
+// exactly as it is by the immediate versions.
+namespace formatting {
+
+struct comma_numpunct :
+  ::std::numpunct<char>
+{
+protected:
+  char do_thousands_sep() const { return ','; }
+  ::std::string do_grouping() const { return "\3"; }
+};
+
+void test()
+{
+  // Width, fill and flags
+  {
+    int const r[] = { 0x0287, 0x071A, 0x00E6 };
+    
+    ::std::ostringstream out;
+    out.imbue(::std::locale::classic());
+    
+    out.width(6);
+    out.fill('.');
+    out.setf(::std::ios_base::hex, ::std::ios_base::basefield);
+    
+    ::boost::rangeio::write_iterator_range_atomic(out, r, r + 3, '|');
+    
+    BOOST_TEST_EQ(::std::streamsize(0), out.width());
+    BOOST_TEST_EQ('.', out.fill());
+    BOOST_TEST_EQ("...287|...71a|....e6", out.str());
+  }
+  
+  // Locale
+  {
+    int const r[] = { 1234567, 89 };
+    
+    ::std::ostringstream out;
+    out.imbue(::std::locale(::std::locale::classic(), new comma_numpunct));
+    
+    ::boost::rangeio::write_iterator_range_atomic(out, r, r + 2, ' ');
+    
+    BOOST_TEST_EQ("1,234,567 89", out.str());
+  }
+}
+
+} // namespace formatting
+
+// Confirm that stream failures are handled the same way as by the immediate
+// versions.
+namespace failed_write {
+
+struct failing_element
+{
+  bool fail;
+};
+
+::std::ostream& operator<<(::std::ostream& out, failing_element const& e)
+{
+  if (e.fail)
+    out.setstate(::std::ios_base::failbit);
+  else
+    out << 'x';
+  
+  return out;
+}
+
+void test()
+{
+  // Stream already failed
+  {
+    int const r[] = { 1, 2, 3 };
+    
+    ::std::ostringstream out;
+    out.width(4);
+    out.setstate(::std::ios_base::failbit);
+    
+    auto res = ::boost::rangeio::write_iterator_range_atomic(out, r, r + 3, ',');
+    
+    BOOST_TEST(r == res.next);
+    BOOST_TEST_EQ(::std::size_t(0), res.count);
+    BOOST_TEST_EQ(::std::streamsize(0), out.width());
+    BOOST_TEST(out.str().empty());
+  }
+  
+  // Element fails part way
+  {
+    failing_element const r[] = { { false }, { false }, { true }, { false } };
+    
+    ::std::ostringstream out;
+    
+    auto res = ::boost::rangeio::write_iterator_range_atomic(out, r, r + 4, ',');
+    
+    BOOST_TEST(out.fail());
+    BOOST_TEST(r + 2 == res.next);
+    BOOST_TEST_EQ(::std::size_t(2), res.count);
+    BOOST_TEST_EQ("x,x,", out.str());
+  }
+  
+  // Stream buffer fails on commit
+  {
+    ::std::vector<int> r(10, 12345);
+    
+    ::boost::rangeio::test_extras::array_streambuf<char, 16> buf;
+    ::std::ostream out(&buf);
+    out.imbue(::std::locale::classic());
+    
+    auto res = ::boost::rangeio::write_iterator_range_atomic(out, r.begin(), r.end(), ' ');
+    
+    BOOST_TEST(out.bad());
+    BOOST_TEST(r.end() == res.next);
+    BOOST_TEST_EQ(r.size(), res.count);
+  }
+  
+  // Stream buffer fails on commit, with exceptions enabled
+  {
+    ::std::vector<int> r(10, 12345);
+    
+    ::boost::rangeio::test_extras::array_streambuf<char, 16> buf;
+    ::std::ostream out(&buf);
+    out.imbue(::std::locale::classic());
+    out.exceptions(::std::ios_base::badbit);
+    
+    bool caught = false;
+    try
+    {
+      ::boost::rangeio::write_iterator_range_atomic(out, r.begin(), r.end(), ' ');
+    }
+    catch (::std::ios_base::failure const&)
+    {
+      caught = true;
+    }
+    
+    BOOST_TEST(caught);
+    BOOST_TEST(out.bad());
+  }
+}
+
+} // namespace failed_write
+
+// Confirm that an element whose inserter does an atomic write to the same
+// stream works (the formatter is in use at that point).
+namespace nested_write {
+
+struct nested
+{
+  ::std::vector<int> values;
+};
+
+::std::ostream& operator<<(::std::ostream& out, nested const& n)
+{
+  out << '[';
+  ::boost::rangeio::write_iterator_range_atomic(out, n.values.begin(), n.values.end(), ',');
+  return out << ']';
+}
+
+void test()
+{
+  ::std::vector<nested> const r = { { { 1, 2 } }, { { 3 } }, { {} } };
+  
+  ::std::ostringstream out;
+  out.imbue(::std::locale::classic());
+  
+  auto res = ::boost::rangeio::write_iterator_range_atomic(out, r.begin(), r.end(), ' ');
+  
+  BOOST_TEST_EQ(r.size(), res.count);
+  BOOST_TEST_EQ("[1,2] [3] []", out.str());
+}
+
+} // namespace nested_write
+
+// Confirm that concurrent atomic writes to the same stream do not
+// interleave.
+namespace concurrent_writes {
+
+void test()
+{
+  ::std::size_t const thread_count = 8;
+  ::std::size_t const writes_per_thread = 200;
+  ::std::size_t const range_size = 20;
+  
+  ::std::ostringstream out;
+  out.imbue(::std::locale::classic());
+  
+  ::std::vector< ::std::thread> threads;
+  for (::std::size_t t = 0; t != thread_count; ++t)
+  {
+    threads.emplace_back([&out, t, writes_per_thread, range_size]
+    {
+      ::std::vector<int> const r(range_size, int(t));
+      
+      for (::std::size_t i = 0; i != writes_per_thread; ++i)
+        ::boost::rangeio::write_iterator_range_atomic(out, r.begin(), r.end(), ',');
+    });
+  }
+  
+  for (auto& thread : threads)
+    thread.join();
+  
+  // Each write is range_size digits separated by commas.
+  ::std::string const s = out.str();
+  ::std::size_t const write_size = (2 * range_size) - 1;
+  
+  BOOST_TEST_EQ(thread_count * writes_per_thread * write_size, s.size());
+  
+  for (::std::size_t i = 0; (i + write_size) <= s.size(); i += write_size)
+  {
+    for (::std::size_t j = 0; j != write_size; ++j)
+    {
+      char const c = s[i + j];
+      
+      if ((j % 2) == 0)
+        BOOST_TEST_EQ(s[i], c);
+      else
+        BOOST_TEST_EQ(',', c);
+    }
+  }
+}
+
+} // namespace concurrent_writes
+
+// Confirm that concurrent atomic writes to a stream that fails stop writing
+// once it fails. (The state is updated under the lock, so a thread sanitizer
+// should not report a race here.)
+namespace concurrent_failures {
+
+void test()
+{
+  ::std::size_t const rounds = 50;
+  ::std::size_t const thread_count = 4;
+  ::std::size_t const writes_per_thread = 20;
+  
+  for (::std::size_t round = 0; round != rounds; ++round)
+  {
+    ::boost::rangeio::test_extras::array_streambuf<char, 64> buf;
+    ::std::ostream out(&buf);
+    out.imbue(::std::locale::classic());
+    
+    ::std::vector< ::std::thread> threads;
+    for (::std::size_t t = 0; t != thread_count; ++t)
+    {
+      threads.emplace_back([&out, writes_per_thread]
+      {
+        ::std::vector<int> const r(5, 12345);
+        
+        for (::std::size_t i = 0; i != writes_per_thread; ++i)
+          ::boost::rangeio::write_iterator_range_atomic(out, r.begin(), r.end(), ',');
+      });
+    }
+    
+    for (auto& thread : threads)
+      thread.join();
+    
+    // Each write is 29 characters, so the third one fills the buffer and
+    // fails, and nothing is written after that.
+    BOOST_TEST(out.bad());
+    BOOST_TEST_EQ(::std::size_t(64), buf.str().size());
+  }
+}
+
+} // namespace concurrent_failures
+
+} // namespace write_iterator_range_atomic_tests
+
+int main()
+{
+  using namespace write_iterator_range_atomic_tests;
+  
+  normal_range::test();
+  
+  formatting::test();
+  
+  failed_write::test();
+  
+  nested_write::test();
+  
+  concurrent_writes::test();
+  concurrent_failures::test();
+  
+  return boost::report_errors();
+}
+
+#endif  // BOOST_NO_CXX11_RVALUE_REFERENCES
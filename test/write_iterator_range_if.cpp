@@ -0,0 +1,281 @@
+//
+// Copyright (c) Mark A. Gibbs, 2015.
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+// 
+
+// This test covers write_iterator_range_if().
+// 
+// The tests must confirm that only the elements satisfying the predicate are
+// written, that delimiters only go between written elements (including when
+// the first or last elements are skipped), that both the elements visited
+// and the elements written are reported, and that failures stop the write at
+// the element that could not be written, and that each element is only
+// dereferenced once.
+// 
+// This test requires C++11.
+
+#include <boost/config.hpp>
+
+#ifdef BOOST_NO_CXX11_RVALUE_REFERENCES
+#   include <iostream>
+int main() { ::std::cout << "Not supported in C++98.\n"; }
+#else
+
+#include <cstddef>
+#include <ios>
+#include <iterator>
+#include <list>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <boost/core/lightweight_test.hpp>
+
+#include <boost/rangeio/write_iterator_range_if.hpp>
+
+#include "extras/array_streambuf.hpp"
+#include "extras/more_tests.hpp"
+
+namespace write_iterator_range_if_tests {
+
+bool non_zero(int n) { return n != 0; }
+
+struct counter
+{
+  bool active() const { return value != 0; }
+  
+  int   value;
+  bool  enabled;
+};
+
+::std::ostream& operator<<(::std::ostream& o, counter const& c)
+{
+  return o << c.value;
+}
+
+// Confirm that only the elements satisfying the predicate are written, with
+// delimiters only between them.
+namespace filter {
+
+template <typename CharT>
+void do_test()
+{
+  ::std::vector<int> const r = { 0, 1, 0, 0, 2, 3, 0 };
+  
+  {
+    ::std::basic_ostringstream<CharT> out;
+    
+    auto const res = ::boost::rangeio::write_iterator_range_if(out, r.begin(), r.end(), CharT(','), non_zero);
+    
+    BOOST_TEST(bool(out));
+    BOOST_TEST(r.end() == res.next);
+    BOOST_TEST_EQ(::std::size_t(3), res.count);
+    BOOST_TEST_EQ(r.size(), res.visited);
+    BOOST_TEST(out.str() == ::std::basic_string<CharT>({ CharT('1'), CharT(','), CharT('2'), CharT(','), CharT('3') }));
+  }
+  
+  // No delimiter
+  {
+    ::std::basic_ostringstream<CharT> out;
+    
+    auto const res = ::boost::rangeio::write_iterator_range_if(out, r.begin(), r.end(), non_zero);
+    
+    BOOST_TEST(r.end() == res.next);
+    BOOST_TEST_EQ(::std::size_t(3), res.count);
+    BOOST_TEST_EQ(r.size(), res.visited);
+    BOOST_TEST(out.str() == ::std::basic_string<CharT>({ CharT('1'), CharT('2'), CharT('3') }));
+  }
+}
+
+void test()
+{
+  do_test<char>();
+  do_test<wchar_t>();
+  
+  // Nothing satisfies the predicate
+  {
+    ::std::vector<int> const r = { 0, 0, 0 };
+    
+    ::std::ostringstream out;
+    
+    auto const res = ::boost::rangeio::write_iterator_range_if(out, r.begin(), r.end(), ", ", non_zero);
+    
+    BOOST_TEST(bool(out));
+    BOOST_TEST_EQ(::std::size_t(0), res.count);
+    BOOST_TEST_EQ(::std::size_t(3), res.visited);
+    BOOST_TEST(out.str().empty());
+  }
+  
+  // Empty range
+  {
+    ::std::list<int> const r;
+    
+    ::std::ostringstream out;
+    
+    auto const res = ::boost::rangeio::write_iterator_range_if(out, r.begin(), r.end(), ", ", non_zero);
+    
+    BOOST_TEST(r.end() == res.next);
+    BOOST_TEST_EQ(::std::size_t(0), res.count);
+    BOOST_TEST_EQ(::std::size_t(0), res.visited);
+  }
+}
+
+} // namespace filter
+
+// Confirm that the different kinds of predicates work.
+namespace predicates {
+
+void test()
+{
+  ::std::list<counter> const r = { { 0, true }, { 5, false }, { 7, true } };
+  
+  {
+    ::std::ostringstream out;
+    ::boost::rangeio::write_iterator_range_if(out, r.begin(), r.end(), ", ", &counter::enabled);
+    BOOST_RANGEIO_TEST_STR_EQ(out.str(), "0, 7");
+  }
+  
+  {
+    ::std::ostringstream out;
+    ::boost::rangeio::write_iterator_range_if(out, r.begin(), r.end(), ", ", &counter::active);
+    BOOST_RANGEIO_TEST_STR_EQ(out.str(), "5, 7");
+  }
+  
+  {
+    int calls = 0;
+    
+    ::std::ostringstream out;
+    ::boost::rangeio::write_iterator_range_if(out, r.begin(), r.end(), ", ",
+      [&calls](counter const& c) { ++calls; return c.value > 6; });
+    BOOST_RANGEIO_TEST_STR_EQ(out.str(), "7");
+    BOOST_TEST_EQ(3, calls);
+  }
+}
+
+} // namespace predicates
+
+// Confirm that the formatting and stream state are handled properly.
+namespace state {
+
+void test()
+{
+  ::std::vector<int> const r = { 1, 0, 22, 0, 333 };
+  
+  // Width applies to each written element, but not to the delimiters
+  {
+    ::std::ostringstream out;
+    out.width(3);
+    out.fill('*');
+    
+    ::boost::rangeio::write_iterator_range_if(out, r.begin(), r.end(), '|', non_zero);
+    
+    BOOST_RANGEIO_TEST_STR_EQ(out.str(), "**1|*22|333");
+    BOOST_TEST_EQ(0, out.width());
+  }
+  
+  // Stream that fails part way
+  {
+    ::boost::rangeio::test_extras::array_streambuf<char, 5> buf;
+    ::std::ostream out(&buf);
+    
+    auto const res = ::boost::rangeio::write_iterator_range_if(out, r.begin(), r.end(), ", ", non_zero);
+    
+    BOOST_TEST(!out);
+    BOOST_TEST(r.begin() + 4 == res.next);
+    BOOST_TEST_EQ(::std::size_t(2), res.count);
+    BOOST_TEST_EQ(::std::size_t(4), res.visited);
+  }
+  
+  // Stream that has already failed
+  {
+    ::std::ostringstream out;
+    out.setstate(::std::ios_base::failbit);
+    out.width(5);
+    
+    auto const res = ::boost::rangeio::write_iterator_range_if(out, r.begin(), r.end(), ", ", non_zero);
+    
+    BOOST_TEST(r.begin() == res.next);
+    BOOST_TEST_EQ(::std::size_t(0), res.count);
+    BOOST_TEST_EQ(::std::size_t(0), res.visited);
+    BOOST_TEST_EQ(0, out.width());
+  }
+}
+
+} // namespace state
+
+// Confirm that each element is dereferenced only once, for both the test and
+// the write.
+namespace dereferences {
+
+// Input iterator over an array of ints that counts how often it is
+// dereferenced.
+class counting_iterator
+{
+public:
+  typedef ::std::input_iterator_tag iterator_category;
+  typedef int                       value_type;
+  typedef ::std::ptrdiff_t          difference_type;
+  typedef int const*                pointer;
+  typedef int                       reference;
+  
+  counting_iterator(int const* p, int& count) : p_(p), count_(&count) {}
+  
+  int operator*() const { ++*count_; return *p_; }
+  counting_iterator& operator++() { ++p_; return *this; }
+  
+  friend bool operator==(counting_iterator const& a, counting_iterator const& b) { return a.p_ == b.p_; }
+  friend bool operator!=(counting_iterator const& a, counting_iterator const& b) { return a.p_ != b.p_; }
+  
+private:
+  int const*  p_;
+  int*        count_;
+};
+
+void test()
+{
+  int const r[] = { 1, 0, 22, 0, 333 };
+  
+  // Without delimiter
+  {
+    int count = 0;
+    
+    ::std::ostringstream out;
+    ::boost::rangeio::write_iterator_range_if(out, counting_iterator(r, count), counting_iterator(r + 5, count), non_zero);
+    
+    BOOST_RANGEIO_TEST_STR_EQ(out.str(), "122333");
+    BOOST_TEST_EQ(5, count);
+  }
+  
+  // With delimiter
+  {
+    int count = 0;
+    
+    ::std::ostringstream out;
+    ::boost::rangeio::write_iterator_range_if(out, counting_iterator(r, count), counting_iterator(r + 5, count), ", ", non_zero);
+    
+    BOOST_RANGEIO_TEST_STR_EQ(out.str(), "1, 22, 333");
+    BOOST_TEST_EQ(5, count);
+  }
+}
+
+} // namespace dereferences
+
+} // namespace write_iterator_range_if_tests
+
+int main()
+{
+  using namespace write_iterator_range_if_tests;
+  
+  filter::test();
+  predicates::test();
+  
+  state::test();
+  
+  dereferences::test();
+  
+  return boost::report_errors();
+}
+
+#endif  // BOOST_NO_CXX11_RVALUE_REFERENCES
@@ -0,0 +1,218 @@
+//
+// Copyright (c) Mark A. Gibbs, 2015.
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+// 
+
+// This test covers the counted version of write_iterator_range
+// (write_iterator_range_n), with and without delimiters.
+// 
+// The tests must confirm that exactly the requested number of elements are
+// written, that writes are done correctly and that formatting is preserved
+// between elements.
+// 
+// This test requires C++11.
+
+#include <boost/config.hpp>
+
+#ifdef BOOST_NO_CXX11_RVALUE_REFERENCES
+#   include <iostream>
+int main() { ::std::cout << "Not supported in C++98.\n"; }
+#else
+
+#include <locale>
+#include <iterator>
+#include <sstream>
+#include <vector>
+
+#include <boost/core/lightweight_test.hpp>
+
+#include <boost/rangeio/write_iterator_range.hpp>
+
+#include "extras/array_streambuf.hpp"
+#include "extras/more_tests.hpp"
+#include "extras/smart_delimiters.hpp"
+
+namespace write_iterator_range_n_tests {
+
+// Confirm that writing zero elements produces no output, and does not
+// dereference the iterator.
+namespace empty_range {
+
+template <typename CharT>
+void do_test()
+{
+  ::std::vector<int> r;
+  
+  ::std::basic_ostringstream<CharT> out;
+  out.width(7);
+  
+  auto res1 = ::boost::rangeio::write_iterator_range_n(out, r.begin(), 0);
+  auto res2 = ::boost::rangeio::write_iterator_range_n(out, r.begin(), 0, ", ");
+  
+  BOOST_TEST(r.begin() == res1.next);
+  BOOST_TEST_EQ(::std::size_t(0), res1.count);
+  BOOST_TEST(r.begin() == res2.next);
+  BOOST_TEST_EQ(::std::size_t(0), res2.count);
+  
+  BOOST_TEST(bool(out));
+  BOOST_TEST(out.str().empty());
+  BOOST_TEST_EQ(::std::streamsize(0), out.width());
+}
+
+void test()
+{
+  do_test<char>();
+  do_test<wchar_t>();
+}
+
+} // namespace empty_range
+
+// Confirm that only the requested number of elements are written, with and
+// without delimiters.
+namespace normal_range {
+
+template <typename CharT>
+void do_test()
+{
+  int const r[] = { 1, 1, 2, 3, 5, 8, 13, 21 };
+  
+  // Without delimiter
+  {
+    ::std::basic_ostringstream<CharT> out;
+    out.imbue(::std::locale::classic());
+    
+    auto res = ::boost::rangeio::write_iterator_range_n(out, r, 6);
+    
+    BOOST_TEST(r + 6 == res.next);
+    BOOST_TEST_EQ(::std::size_t(6), res.count);
+    
+    BOOST_TEST(bool(out));
+    BOOST_RANGEIO_TEST_STR_EQ("112358", out.str());
+  }
+  
+  // With delimiter
+  {
+    ::std::basic_ostringstream<CharT> out;
+    out.imbue(::std::locale::classic());
+    
+    auto res = ::boost::rangeio::write_iterator_range_n(out, r, 6, ", ");
+    
+    BOOST_TEST(r + 6 == res.next);
+    BOOST_TEST_EQ(::std::size_t(6), res.count);
+    
+    BOOST_TEST(bool(out));
+    BOOST_RANGEIO_TEST_STR_EQ("1, 1, 2, 3, 5, 8", out.str());
+  }
+  
+  // With smart delimiter
+  {
+    ::std::basic_ostringstream<CharT> out;
+    out.imbue(::std::locale::classic());
+    
+    ::boost::rangeio::test_extras::incrementing_integer_delimiter delim;
+    auto res = ::boost::rangeio::write_iterator_range_n(out, r, 4, delim);
+    
+    BOOST_TEST_EQ(::std::size_t(4), res.count);
+    BOOST_TEST_EQ(::std::size_t(3), delim.i);
+    BOOST_RANGEIO_TEST_STR_EQ("1011223", out.str());
+  }
+}
+
+void test()
+{
+  do_test<char>();
+  do_test<wchar_t>();
+}
+
+} // namespace normal_range
+
+// Confirm that a count can be used as an element budget for an iterator with
+// no end.
+namespace input_iterator_range {
+
+void test()
+{
+  ::std::istringstream in("2 4 6 8 10 12");
+  in.imbue(::std::locale::classic());
+  
+  ::std::ostringstream out;
+  out.imbue(::std::locale::classic());
+  
+  auto res = ::boost::rangeio::write_iterator_range_n(out, ::std::istream_iterator<int>(in), 3, ' ');
+  
+  BOOST_TEST_EQ(::std::size_t(3), res.count);
+  BOOST_TEST_EQ(8, *res.next);
+  
+  BOOST_TEST(bool(out));
+  BOOST_TEST_EQ("2 4 6", out.str());
+}
+
+} // namespace input_iterator_range
+
+// Confirm that writing stops when the stream fails.
+namespace failed_write {
+
+void test()
+{
+  ::std::vector<int> r(10, 1234);
+  
+  ::boost::rangeio::test_extras::array_streambuf<char, 12> buf;
+  ::std::ostream out(&buf);
+  out.imbue(::std::locale::classic());
+  
+  auto res = ::boost::rangeio::write_iterator_range_n(out, r.begin(), r.size(), ' ');
+  
+  BOOST_TEST(!out);
+  BOOST_TEST_EQ(::std::size_t(2), res.count);
+  BOOST_TEST(r.begin() + 2 == res.next);
+}
+
+} // namespace failed_write
+
+// Confirm that formatting is preserved across elements.
+namespace formatting {
+
+void test()
+{
+  int const r[] = { 0x0287, 0x071A, 0x00E6, 0x001A, 0x029E };
+  
+  ::std::ostringstream out;
+  out.imbue(::std::locale::classic());
+  
+  out.width(7);
+  out.fill('.');
+  out.setf(::std::ios_base::hex, ::std::ios_base::basefield);
+  out.setf(::std::ios_base::left, ::std::ios_base::adjustfield);
+  out.setf(::std::ios_base::uppercase);
+  out.setf(::std::ios_base::showbase);
+  
+  ::boost::rangeio::write_iterator_range_n(out, r, 3, ' ');
+  
+  BOOST_TEST_EQ(::std::streamsize(0), out.width());
+  BOOST_TEST_EQ("0X287.. 0X71A.. 0XE6...", out.str());
+}
+
+} // namespace formatting
+
+} // namespace write_iterator_range_n_tests
+
+int main()
+{
+  using namespace write_iterator_range_n_tests;
+  
+  empty_range::test();
+  
+  normal_range::test();
+  
+  input_iterator_range::test();
+  
+  failed_write::test();
+  
+  formatting::test();
+  
+  return boost::report_errors();
+}
+
+#endif  // BOOST_NO_CXX11_RVALUE_REFERENCES
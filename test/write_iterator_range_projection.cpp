@@ -0,0 +1,382 @@
+//
+// Copyright (c) Mark A. Gibbs, 2015.
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+// 
+
+// This test covers the projected versions of write_iterator_range and
+// write_iterator_range_n.
+// 
+// The tests must confirm that each kind of projection (data member, member
+// function, function object) is applied to each element, that data members
+// are written without being copied, that ranges of pointers work, that
+// segmented ranges are written properly, that the formatting and stream
+// state are handled the same way as by the unprojected versions, and that
+// ranges projected to integers are written with the batched write loop.
+// 
+// This test requires C++11.
+
+#include <boost/config.hpp>
+
+#ifdef BOOST_NO_CXX11_RVALUE_REFERENCES
+#   include <iostream>
+int main() { ::std::cout << "Not supported in C++98.\n"; }
+#else
+
+#include <cstddef>
+#include <deque>
+#include <ios>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <boost/core/lightweight_test.hpp>
+
+#include <boost/rangeio/write_iterator_range.hpp>
+#include <boost/rangeio/write_stats.hpp>
+
+#include "extras/array_streambuf.hpp"
+#include "extras/more_tests.hpp"
+
+namespace write_iterator_range_projection_tests {
+
+// Counts the copies made of it.
+struct copy_counter
+{
+  copy_counter() {}
+  copy_counter(copy_counter const&) { ++copies; }
+  copy_counter& operator=(copy_counter const&) { ++copies; return *this; }
+  
+  static int copies;
+};
+
+int copy_counter::copies = 0;
+
+::std::ostream& operator<<(::std::ostream& o, copy_counter const&)
+{
+  return o << 'c';
+}
+
+struct order
+{
+  order(int i, double p, int q) : id(i), price(p), quantity(q) {}
+  
+  double total() const { return price * quantity; }
+  
+  int           id;
+  double        price;
+  int           quantity;
+  copy_counter  tag;
+};
+
+::std::vector<order> make_orders()
+{
+  ::std::vector<order> orders;
+  orders.push_back(order(17, 1.5, 2));
+  orders.push_back(order(42, 0.25, 4));
+  orders.push_back(order(99, 3.0, 3));
+  
+  return orders;
+}
+
+// Confirm that each kind of projection works.
+namespace kinds {
+
+void test()
+{
+  ::std::vector<order> const orders = make_orders();
+  
+  // Data member
+  {
+    ::std::ostringstream out;
+    
+    auto const res = ::boost::rangeio::write_iterator_range(out, orders.begin(), orders.end(), ", ", &order::id);
+    
+    BOOST_TEST(orders.end() == res.next);
+    BOOST_TEST_EQ(orders.size(), res.count);
+    BOOST_TEST(bool(out));
+    BOOST_RANGEIO_TEST_STR_EQ(out.str(), "17, 42, 99");
+  }
+  
+  // Member function
+  {
+    ::std::ostringstream out;
+    ::boost::rangeio::write_iterator_range(out, orders.begin(), orders.end(), ' ', &order::total);
+    BOOST_RANGEIO_TEST_STR_EQ(out.str(), "3 1 9");
+  }
+  
+  // Function object
+  {
+    ::std::ostringstream out;
+    ::boost::rangeio::write_iterator_range(out, orders.begin(), orders.end(), ' ',
+      [](order const& o) { return o.id * 2; });
+    BOOST_RANGEIO_TEST_STR_EQ(out.str(), "34 84 198");
+  }
+  
+  // Range of pointers
+  {
+    ::std::vector<order const*> pointers;
+    for (auto const& o : orders)
+      pointers.push_back(&o);
+    
+    ::std::ostringstream out;
+    ::boost::rangeio::write_iterator_range(out, pointers.begin(), pointers.end(), '/', &order::quantity);
+    ::boost::rangeio::write_iterator_range(out, pointers.begin(), pointers.end(), '/', &order::total);
+    BOOST_RANGEIO_TEST_STR_EQ(out.str(), "2/4/33/1/9");
+  }
+  
+  // Counted
+  {
+    ::std::ostringstream out;
+    
+    auto const res = ::boost::rangeio::write_iterator_range_n(out, orders.begin(), 2, ", ", &order::id);
+    
+    BOOST_TEST(orders.begin() + 2 == res.next);
+    BOOST_TEST_EQ(::std::size_t(2), res.count);
+    BOOST_RANGEIO_TEST_STR_EQ(out.str(), "17, 42");
+  }
+  
+  // The instrumented version is still chosen for write_stats
+  {
+    ::std::ostringstream out;
+    ::boost::rangeio::write_stats stats;
+    
+    ::std::vector<int> const r = { 1, 2, 3 };
+    ::boost::rangeio::write_iterator_range(out, r.begin(), r.end(), ',', stats);
+    
+    BOOST_TEST_EQ(::std::size_t(3), stats.elements);
+    BOOST_RANGEIO_TEST_STR_EQ(out.str(), "1,2,3");
+  }
+}
+
+} // namespace kinds
+
+// Confirm that data members are written in place.
+namespace no_copies {
+
+void test()
+{
+  ::std::vector<order> const orders = make_orders();
+  
+  copy_counter::copies = 0;
+  
+  ::std::ostringstream out;
+  ::boost::rangeio::write_iterator_range(out, orders.begin(), orders.end(), ',', &order::tag);
+  
+  BOOST_RANGEIO_TEST_STR_EQ(out.str(), "c,c,c");
+  BOOST_TEST_EQ(0, copy_counter::copies);
+}
+
+} // namespace no_copies
+
+// Confirm that segmented ranges are written properly.
+namespace segmented {
+
+void test()
+{
+  ::std::deque<order> orders;
+  ::std::ostringstream expected;
+  
+  for (int i = 0; i < 1000; ++i)
+  {
+    orders.push_back(order(i, 0.0, 0));
+    
+    if (i != 0)
+      expected << ',';
+    expected << i;
+  }
+  
+  ::std::ostringstream out;
+  
+  auto const res = ::boost::rangeio::write_iterator_range(out, orders.begin(), orders.end(), ',', &order::id);
+  
+  BOOST_TEST(orders.end() == res.next);
+  BOOST_TEST_EQ(orders.size(), res.count);
+  BOOST_RANGEIO_TEST_STR_EQ(out.str(), expected.str());
+}
+
+} // namespace segmented
+
+// Confirm that the formatting and stream state are handled properly.
+namespace state {
+
+void test()
+{
+  ::std::vector<order> const orders = make_orders();
+  
+  // Width applies to each projected element
+  {
+    ::std::ostringstream out;
+    out.width(4);
+    out.fill('.');
+    
+    ::boost::rangeio::write_iterator_range(out, orders.begin(), orders.end(), '|', &order::id);
+    
+    BOOST_RANGEIO_TEST_STR_EQ(out.str(), "..17|..42|..99");
+    BOOST_TEST_EQ(0, out.width());
+  }
+  
+  // Stream that fails part way
+  {
+    ::boost::rangeio::test_extras::array_streambuf<char, 5> buf;
+    ::std::ostream out(&buf);
+    
+    auto const res = ::boost::rangeio::write_iterator_range(out, orders.begin(), orders.end(), ", ", &order::id);
+    
+    BOOST_TEST(!out);
+    BOOST_TEST(orders.begin() + 1 == res.next);
+    BOOST_TEST_EQ(::std::size_t(1), res.count);
+  }
+}
+
+} // namespace state
+
+// Confirm that ranges whose projected values are integers are written with
+// the batched write loop (with one sputn() or so per batch, rather than at
+// least one call per element), and produce exactly the same output as an
+// element-by-element write - including for segmented ranges, and for
+// counted writes.
+namespace batched {
+
+// Unbuffered stream buffer that counts the calls made to write to it.
+class counting_streambuf :
+  public ::std::streambuf
+{
+public:
+  counting_streambuf() :
+    writes(0)
+  {}
+  
+  ::std::string str;
+  int writes;
+  
+protected:
+  int_type overflow(int_type c)
+  {
+    if (!traits_type::eq_int_type(c, traits_type::eof()))
+    {
+      ++writes;
+      str += traits_type::to_char_type(c);
+    }
+    
+    return traits_type::not_eof(c);
+  }
+  
+  ::std::streamsize xsputn(char const* p, ::std::streamsize n)
+  {
+    ++writes;
+    str.append(p, ::std::size_t(n));
+    return n;
+  }
+};
+
+template <typename Range, typename Projection>
+void do_test(Range const& r, Projection proj, ::std::string const& expected, int max_writes)
+{
+  // Whole range
+  {
+    counting_streambuf buf;
+    ::std::ostream out(&buf);
+    out.width(5);
+    out.fill('_');
+    
+    auto const res = ::boost::rangeio::write_iterator_range(out, r.begin(), r.end(), ", ", proj);
+    
+    BOOST_TEST(bool(out));
+    BOOST_TEST(r.end() == res.next);
+    BOOST_TEST_EQ(r.size(), res.count);
+    BOOST_TEST_EQ(::std::streamsize(0), out.width());
+    BOOST_RANGEIO_TEST_STR_EQ(expected, buf.str);
+    BOOST_TEST(buf.writes <= max_writes);
+  }
+  
+  // Counted
+  {
+    counting_streambuf buf;
+    ::std::ostream out(&buf);
+    out.width(5);
+    out.fill('_');
+    
+    auto const res = ::boost::rangeio::write_iterator_range_n(out, r.begin(), r.size(), ", ", proj);
+    
+    BOOST_TEST(r.end() == res.next);
+    BOOST_TEST_EQ(r.size(), res.count);
+    BOOST_RANGEIO_TEST_STR_EQ(expected, buf.str);
+    BOOST_TEST(buf.writes <= max_writes);
+  }
+}
+
+struct doubled_id
+{
+  long operator()(order const& o) const { return 2L * o.id; }
+};
+
+void test()
+{
+  ::std::vector<order> orders;
+  ::std::ostringstream expected_id;
+  ::std::ostringstream expected_doubled;
+  
+  for (int i = 0; i != 500; ++i)
+  {
+    orders.push_back(order(i * 37 - 5000, 0.0, 0));
+    
+    if (i != 0)
+    {
+      expected_id << ", ";
+      expected_doubled << ", ";
+    }
+    
+    expected_id.width(5);
+    expected_id.fill('_');
+    expected_id << orders.back().id;
+    
+    expected_doubled.width(5);
+    expected_doubled.fill('_');
+    expected_doubled << (2L * orders.back().id);
+  }
+  
+  // Data member
+  do_test(orders, &order::id, expected_id.str(), 50);
+  
+  // Function object returning an integer
+  do_test(orders, doubled_id(), expected_doubled.str(), 50);
+  
+  // Segmented range
+  {
+    ::std::deque<order> const d(orders.begin(), orders.end());
+    
+    counting_streambuf buf;
+    ::std::ostream out(&buf);
+    out.width(5);
+    out.fill('_');
+    
+    ::boost::rangeio::write_iterator_range(out, d.begin(), d.end(), ", ", &order::id);
+    
+    BOOST_RANGEIO_TEST_STR_EQ(expected_id.str(), buf.str);
+    BOOST_TEST(buf.writes <= 100);
+  }
+}
+
+} // namespace batched
+
+} // namespace write_iterator_range_projection_tests
+
+int main()
+{
+  using namespace write_iterator_range_projection_tests;
+  
+  kinds::test();
+  no_copies::test();
+  
+  segmented::test();
+  
+  state::test();
+  
+  batched::test();
+  
+  return boost::report_errors();
+}
+
+#endif  // BOOST_NO_CXX11_RVALUE_REFERENCES
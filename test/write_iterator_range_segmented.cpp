@@ -0,0 +1,455 @@
+//
+// Copyright (c) Mark A. Gibbs, 2015.
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+// 
+
+// This test covers writing ranges of segmented iterators (std::deque, and a
+// custom chunked container) with write_iterator_range.
+// 
+// The tests must confirm that segmented ranges are written exactly as they
+// would be element by element - including delimiters and formatting across
+// segment boundaries, and stopping in the right place when the stream fails
+// - and that ranges of integers are written segment by segment with the
+// batched write loop.
+// 
+// This test requires C++11.
+
+#include <boost/config.hpp>
+
+#ifdef BOOST_NO_CXX11_RVALUE_REFERENCES
+#   include <iostream>
+int main() { ::std::cout << "Not supported in C++98.\n"; }
+#else
+
+#include <cstddef>
+#include <deque>
+#include <iterator>
+#include <list>
+#include <locale>
+#include <sstream>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+#include <boost/core/lightweight_test.hpp>
+
+#include <boost/rangeio/write_iterator_range.hpp>
+
+#include "extras/array_streambuf.hpp"
+#include "extras/more_tests.hpp"
+
+namespace write_iterator_range_segmented_tests {
+
+// A minimal chunked container: a list of fixed-size blocks, only the last of
+// which may be partially filled.
+class block_list
+{
+public:
+  static ::std::size_t const block_size = 3;
+  
+  typedef ::std::vector< ::std::vector<int> > blocks_type;
+  
+  class iterator
+  {
+  public:
+    typedef ::std::forward_iterator_tag iterator_category;
+    typedef int value_type;
+    typedef ::std::ptrdiff_t difference_type;
+    typedef int* pointer;
+    typedef int& reference;
+    
+    iterator() : block_(), pos_() {}
+    iterator(blocks_type::iterator b, int* p) : block_(b), pos_(p) {}
+    
+    int& operator*() const { return *pos_; }
+    
+    iterator& operator++()
+    {
+      if (++pos_ == (block_->data() + block_->size()))
+      {
+        ++block_;
+        pos_ = block_->data();
+      }
+      
+      return *this;
+    }
+    
+    friend bool operator==(iterator const& a, iterator const& b) { return a.pos_ == b.pos_; }
+    friend bool operator!=(iterator const& a, iterator const& b) { return a.pos_ != b.pos_; }
+    
+    blocks_type::iterator block_;
+    int* pos_;
+  };
+  
+  explicit block_list(::std::size_t n)
+  {
+    for (::std::size_t i = 0; i != n; ++i)
+    {
+      if (blocks_.empty() || (blocks_.back().size() == block_size))
+      {
+        blocks_.push_back(::std::vector<int>());
+        blocks_.back().reserve(block_size);
+      }
+      
+      blocks_.back().push_back(int(i));
+    }
+    
+    // Sentinel block, so that end() has somewhere to point.
+    blocks_.push_back(::std::vector<int>(1));
+    blocks_.back().clear();
+  }
+  
+  iterator begin() { return iterator(blocks_.begin(), blocks_.front().data()); }
+  iterator end() { return iterator(blocks_.end() - 1, blocks_.back().data()); }
+  
+  static ::std::size_t composes;
+  
+private:
+  blocks_type blocks_;
+};
+
+::std::size_t block_list::composes = 0;
+
+} // namespace write_iterator_range_segmented_tests
+
+namespace boost {
+namespace rangeio {
+
+template <>
+struct segmented_iterator_traits< ::write_iterator_range_segmented_tests::block_list::iterator>
+{
+  typedef ::boost::true_type is_segmented_iterator;
+  
+  typedef ::write_iterator_range_segmented_tests::block_list::iterator iterator;
+  typedef ::write_iterator_range_segmented_tests::block_list::blocks_type::iterator segment_iterator;
+  typedef int* local_iterator;
+  
+  static segment_iterator segment(iterator const& i) { return i.block_; }
+  static local_iterator local(iterator const& i) { return i.pos_; }
+  
+  static local_iterator begin(segment_iterator s) { return s->data(); }
+  static local_iterator end(segment_iterator s) { return s->data() + s->size(); }
+  
+  static iterator compose(segment_iterator s, local_iterator l)
+  {
+    ++::write_iterator_range_segmented_tests::block_list::composes;
+    return iterator(s, l);
+  }
+};
+
+} // namespace rangeio
+} // namespace boost
+
+namespace write_iterator_range_segmented_tests {
+
+// Writes a range element-by-element (via a std::list), for comparison.
+template <typename Iterator>
+::std::string expected_output(Iterator first, Iterator last, ::std::string const& delim)
+{
+  ::std::list<int> const l(first, last);
+  
+  ::std::ostringstream out;
+  out.imbue(::std::locale::classic());
+  out << ::boost::rangeio::write_iterator_range(l.begin(), l.end(), delim);
+  
+  return out.str();
+}
+
+// Confirm that deques of various sizes (spanning many blocks) are written
+// properly, including subranges that start and end part way through blocks.
+namespace deque_range {
+
+void test()
+{
+  ::std::size_t const sizes[] = { 0, 1, 2, 127, 128, 129, 256, 1000 };
+  
+  for (::std::size_t const size : sizes)
+  {
+    ::std::deque<int> d;
+    for (::std::size_t i = 0; i != size; ++i)
+      d.push_back(int(i));
+    
+    // Whole range
+    {
+      ::std::ostringstream out;
+      out.imbue(::std::locale::classic());
+      
+      auto res = ::boost::rangeio::write_iterator_range(out, d.begin(), d.end(), ",");
+      
+      BOOST_TEST(bool(out));
+      BOOST_TEST(d.end() == res.next);
+      BOOST_TEST_EQ(size, res.count);
+      BOOST_TEST_EQ(expected_output(d.begin(), d.end(), ","), out.str());
+    }
+    
+    // Subrange
+    if (size > 4)
+    {
+      ::std::deque<int>::const_iterator const first = d.cbegin() + 1;
+      ::std::deque<int>::const_iterator const last = d.cend() - 2;
+      
+      ::std::ostringstream out;
+      out.imbue(::std::locale::classic());
+      out << ::boost::rangeio::write_iterator_range(first, last);
+      
+      BOOST_TEST(bool(out));
+      BOOST_TEST_EQ(expected_output(first, last, ""), out.str());
+    }
+  }
+  
+  // Deque that has had elements popped from the front (so the first block is
+  // only partially used)
+  {
+    ::std::deque<int> d;
+    for (int i = 0; i != 300; ++i)
+      d.push_back(i);
+    for (int i = 0; i != 50; ++i)
+      d.pop_front();
+    
+    ::std::ostringstream out;
+    out.imbue(::std::locale::classic());
+    
+    auto res = ::boost::rangeio::write_iterator_range(out, d.begin(), d.end(), ' ');
+    
+    BOOST_TEST(d.end() == res.next);
+    BOOST_TEST_EQ(::std::size_t(250), res.count);
+    BOOST_TEST_EQ(expected_output(d.begin(), d.end(), " "), out.str());
+  }
+}
+
+} // namespace deque_range
+
+// Confirm that formatting is preserved across segment boundaries.
+namespace deque_formatting {
+
+void test()
+{
+  ::std::deque<int> d;
+  for (int i = 0; i != 200; ++i)
+    d.push_back(i);
+  
+  ::std::ostringstream out;
+  out.imbue(::std::locale::classic());
+  out.width(4);
+  out.fill('*');
+  
+  ::boost::rangeio::write_iterator_range(out, d.begin(), d.end(), '|');
+  
+  ::std::ostringstream expected;
+  expected.imbue(::std::locale::classic());
+  for (int i = 0; i != 200; ++i)
+  {
+    if (i != 0)
+      expected << '|';
+    expected.width(4);
+    expected.fill('*');
+    expected << i;
+  }
+  
+  BOOST_TEST_EQ(::std::streamsize(0), out.width());
+  BOOST_TEST_EQ(expected.str(), out.str());
+}
+
+} // namespace deque_formatting
+
+// Confirm that a failed write of a deque stops in the right place, even when
+// that is in a later block.
+namespace deque_failed_write {
+
+void test()
+{
+  ::std::deque<char> d(2000, 'x');
+  
+  ::boost::rangeio::test_extras::array_streambuf<char, 1500> buf;
+  ::std::ostream out(&buf);
+  
+  auto res = ::boost::rangeio::write_iterator_range(out, d.begin(), d.end(), '-');
+  
+  BOOST_TEST(!out);
+  BOOST_TEST_EQ(::std::size_t(750), res.count);
+  BOOST_TEST(d.begin() + 750 == res.next);
+}
+
+} // namespace deque_failed_write
+
+// Confirm that a custom segmented container is written through its
+// segmented_iterator_traits specialization.
+namespace custom_segmented {
+
+void test()
+{
+  for (::std::size_t size = 0; size != 10; ++size)
+  {
+    block_list b(size);
+    
+    ::std::ostringstream out;
+    out.imbue(::std::locale::classic());
+    
+    block_list::composes = 0;
+    auto res = ::boost::rangeio::write_iterator_range(out, b.begin(), b.end(), ", ");
+    
+    BOOST_TEST(b.end() == res.next);
+    BOOST_TEST_EQ(size, res.count);
+    BOOST_TEST_EQ(expected_output(b.begin(), b.end(), ", "), out.str());
+    
+    // Empty ranges are never written, so never need to be recomposed.
+    BOOST_TEST_EQ(::std::size_t(size == 0 ? 0 : 1), block_list::composes);
+  }
+}
+
+} // namespace custom_segmented
+
+// Confirm that the segments of ranges of integers are written with the
+// batched write loop (with one sputn() per segment or so, rather than at
+// least one call per element), and produce exactly the same output as an
+// element-by-element write, with width and fill, with and without
+// delimiters.
+namespace batched_segments {
+
+// Unbuffered stream buffer that counts the calls made to write to it.
+class counting_streambuf :
+  public ::std::streambuf
+{
+public:
+  counting_streambuf() :
+    writes(0)
+  {}
+  
+  ::std::string str;
+  int writes;
+  
+protected:
+  int_type overflow(int_type c)
+  {
+    if (!traits_type::eq_int_type(c, traits_type::eof()))
+    {
+      ++writes;
+      str += traits_type::to_char_type(c);
+    }
+    
+    return traits_type::not_eof(c);
+  }
+  
+  ::std::streamsize xsputn(char const* p, ::std::streamsize n)
+  {
+    ++writes;
+    str.append(p, ::std::size_t(n));
+    return n;
+  }
+};
+
+template <typename Iterator>
+::std::string expected_padded_output(Iterator first, Iterator last, char const* delim)
+{
+  ::std::ostringstream out;
+  out.imbue(::std::locale::classic());
+  
+  for (Iterator i = first; i != last; ++i)
+  {
+    if ((i != first) && delim)
+      out << delim;
+    out.width(6);
+    out.fill('_');
+    out.setf(::std::ios_base::left, ::std::ios_base::adjustfield);
+    out << *i;
+  }
+  
+  return out.str();
+}
+
+template <typename Range>
+void do_test(Range& r, ::std::size_t size, int max_writes)
+{
+  // With delimiter
+  {
+    counting_streambuf buf;
+    ::std::ostream out(&buf);
+    out.width(6);
+    out.fill('_');
+    out.setf(::std::ios_base::left, ::std::ios_base::adjustfield);
+    
+    auto res = ::boost::rangeio::write_iterator_range(out, r.begin(), r.end(), ", ");
+    
+    BOOST_TEST(bool(out));
+    BOOST_TEST(r.end() == res.next);
+    BOOST_TEST_EQ(size, res.count);
+    BOOST_TEST_EQ(::std::streamsize(0), out.width());
+    BOOST_RANGEIO_TEST_STR_EQ(expected_padded_output(r.begin(), r.end(), ", "), buf.str);
+    BOOST_TEST(buf.writes <= max_writes);
+  }
+  
+  // Without delimiter
+  {
+    counting_streambuf buf;
+    ::std::ostream out(&buf);
+    out.width(6);
+    out.fill('_');
+    out.setf(::std::ios_base::left, ::std::ios_base::adjustfield);
+    
+    auto res = ::boost::rangeio::write_iterator_range(out, r.begin(), r.end());
+    
+    BOOST_TEST(r.end() == res.next);
+    BOOST_TEST_EQ(size, res.count);
+    BOOST_RANGEIO_TEST_STR_EQ(expected_padded_output(r.begin(), r.end(), 0), buf.str);
+    BOOST_TEST(buf.writes <= max_writes);
+  }
+}
+
+void test()
+{
+  // std::deque
+  {
+    ::std::deque<int> d;
+    for (int i = 0; i != 1000; ++i)
+      d.push_back(i * 37 - 5000);
+    for (int i = 0; i != 10; ++i)
+      d.pop_front();
+    
+    do_test(d, d.size(), 100);
+  }
+  
+  // A custom segmented container, whose iterators are only forward
+  // iterators, but whose local iterators are pointers
+  {
+    block_list b(20);
+    do_test(b, 20, 30);
+  }
+  
+  // A failed write stops at the last element that was completely written,
+  // even when that is in a later segment.
+  {
+    ::std::deque<int> d(1000, 12345);
+    
+    ::boost::rangeio::test_extras::array_streambuf<char, 3001> buf;
+    ::std::ostream out(&buf);
+    
+    auto res = ::boost::rangeio::write_iterator_range(out, d.begin(), d.end(), ' ');
+    
+    BOOST_TEST(!out);
+    BOOST_TEST_EQ(::std::size_t(500), res.count);
+    BOOST_TEST(d.begin() + 500 == res.next);
+  }
+}
+
+} // namespace batched_segments
+
+} // namespace write_iterator_range_segmented_tests
+
+int main()
+{
+  using namespace write_iterator_range_segmented_tests;
+  
+  deque_range::test();
+  deque_formatting::test();
+  deque_failed_write::test();
+  
+  custom_segmented::test();
+  
+  batched_segments::test();
+  
+  return boost::report_errors();
+}
+
+#endif  // BOOST_NO_CXX11_RVALUE_REFERENCES
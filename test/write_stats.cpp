@@ -0,0 +1,249 @@
+//
+// Copyright (c) Mark A. Gibbs, 2015.
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+// 
+
+// This test covers the instrumented versions of write_iterator_range, that
+// fill a write_stats structure.
+// 
+// The tests must confirm that the writes are done exactly as they would be
+// without instrumentation, and that the statistics are correct.
+// 
+// This test requires C++11.
+
+#include <boost/config.hpp>
+
+#ifdef BOOST_NO_CXX11_RVALUE_REFERENCES
+#   include <iostream>
+int main() { ::std::cout << "Not supported in C++98.\n"; }
+#else
+
+#include <ios>
+#include <locale>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <boost/core/lightweight_test.hpp>
+
+#include <boost/rangeio/write_stats.hpp>
+
+#include "extras/array_streambuf.hpp"
+#include "extras/more_tests.hpp"
+
+namespace write_stats_tests {
+
+// Confirm that empty ranges produce zeroed statistics.
+namespace empty_range {
+
+template <typename CharT>
+void do_test()
+{
+  ::std::vector<int> r;
+  ::std::basic_ostringstream<CharT> out;
+  
+  ::boost::rangeio::write_stats stats;
+  stats.elements = 99;
+  stats.failed = true;
+  
+  auto res = ::boost::rangeio::write_iterator_range(out, r.begin(), r.end(), ", ", stats);
+  
+  BOOST_TEST(r.end() == res.next);
+  BOOST_TEST_EQ(::std::size_t(0), res.count);
+  
+  BOOST_TEST_EQ(::std::size_t(0), stats.elements);
+  BOOST_TEST_EQ(::std::size_t(0), stats.delimiters);
+  BOOST_TEST_EQ(::std::streamoff(0), stats.bytes);
+  BOOST_TEST(!stats.failed);
+  
+  BOOST_TEST(out.str().empty());
+}
+
+void test()
+{
+  do_test<char>();
+  do_test<wchar_t>();
+}
+
+} // namespace empty_range
+
+// Confirm that ranges are written properly, and that the statistics match
+// what was written.
+namespace normal_range {
+
+template <typename CharT>
+void do_test()
+{
+  int const r[] = { 1, 1, 2, 3, 5, 8, 13 };
+  ::std::size_t const r_size = sizeof(r) / sizeof(r[0]);
+  
+  // Without delimiter
+  {
+    ::std::basic_ostringstream<CharT> out;
+    out.imbue(::std::locale::classic());
+    out << 'a';
+    
+    ::boost::rangeio::write_stats stats;
+    auto res = ::boost::rangeio::write_iterator_range(out, r, r + r_size, stats);
+    
+    BOOST_TEST(r + r_size == res.next);
+    BOOST_TEST_EQ(r_size, res.count);
+    
+    BOOST_TEST_EQ(r_size, stats.elements);
+    BOOST_TEST_EQ(::std::size_t(0), stats.delimiters);
+    BOOST_TEST_EQ(::std::streamoff(8), stats.bytes);
+    BOOST_TEST(!stats.failed);
+    BOOST_TEST(stats.elapsed >= ::boost::rangeio::write_stats::clock::duration::zero());
+    
+    BOOST_TEST(bool(out));
+    BOOST_RANGEIO_TEST_STR_EQ("a11235813", out.str());
+  }
+  
+  // With delimiter
+  {
+    ::std::basic_ostringstream<CharT> out;
+    out.imbue(::std::locale::classic());
+    out << 'a';
+    
+    ::boost::rangeio::write_stats stats;
+    auto res = ::boost::rangeio::write_iterator_range(out, r, r + r_size, ", ", stats);
+    
+    BOOST_TEST(r + r_size == res.next);
+    BOOST_TEST_EQ(r_size, res.count);
+    
+    BOOST_TEST_EQ(r_size, stats.elements);
+    BOOST_TEST_EQ(r_size - 1, stats.delimiters);
+    BOOST_TEST_EQ(::std::streamoff(20), stats.bytes);
+    BOOST_TEST(!stats.failed);
+    
+    BOOST_TEST(bool(out));
+    BOOST_RANGEIO_TEST_STR_EQ("a1, 1, 2, 3, 5, 8, 13", out.str());
+  }
+}
+
+void test()
+{
+  do_test<char>();
+  do_test<wchar_t>();
+}
+
+} // namespace normal_range
+
+// Confirm that a write stopped by a stream failure is reported as failed, and
+// that the characters are counted even though the stream buffer cannot report
+// its position (only those it accepted are counted).
+namespace failed_write {
+
+void test()
+{
+  ::std::vector<int> r(10, 12345);
+  
+  ::boost::rangeio::test_extras::array_streambuf<char, 16> buf;
+  ::std::ostream out(&buf);
+  out.imbue(::std::locale::classic());
+  
+  ::boost::rangeio::write_stats stats;
+  auto res = ::boost::rangeio::write_iterator_range(out, r.begin(), r.end(), ' ', stats);
+  
+  BOOST_TEST(!out);
+  BOOST_TEST(out.rdbuf() == &buf);
+  
+  BOOST_TEST_EQ(::std::size_t(2), res.count);
+  BOOST_TEST(r.begin() + 2 == res.next);
+  
+  BOOST_TEST_EQ(::std::size_t(2), stats.elements);
+  BOOST_TEST_EQ(::std::size_t(2), stats.delimiters);
+  BOOST_TEST_EQ(::std::streamoff(16), stats.bytes);
+  BOOST_TEST(stats.failed);
+  
+  BOOST_TEST_EQ("12345 12345 1234", buf.str());
+}
+
+} // namespace failed_write
+
+// Confirm that the stream's buffer is put back (and the stream's state kept)
+// when the write is stopped by the stream's exceptions.
+namespace exception_thrown {
+
+struct thrower {};
+
+::std::ostream& operator<<(::std::ostream& out, thrower)
+{
+  out << 'x';
+  out.setstate(::std::ios_base::badbit);
+  return out;
+}
+
+void test()
+{
+  thrower const r[] = { thrower() };
+  
+  ::std::ostringstream out;
+  out.exceptions(::std::ios_base::badbit);
+  
+  ::boost::rangeio::write_stats stats;
+  
+  bool caught = false;
+  try
+  {
+    ::boost::rangeio::write_iterator_range(out, r, r + 1, stats);
+  }
+  catch (::std::ios_base::failure const&)
+  {
+    caught = true;
+  }
+  
+  BOOST_TEST(caught);
+  BOOST_TEST(out.bad());
+  BOOST_TEST(out.std::ios::rdbuf() == out.rdbuf());
+  BOOST_TEST_EQ("x", out.str());
+}
+
+} // namespace exception_thrown
+
+// Confirm that the stream formatting is treated exactly as it is without
+// instrumentation.
+namespace formatting {
+
+void test()
+{
+  int const r[] = { 0x0287, 0x071A, 0x00E6 };
+  ::std::size_t const r_size = sizeof(r) / sizeof(r[0]);
+  
+  ::std::ostringstream out;
+  out.imbue(::std::locale::classic());
+  
+  out.width(6);
+  out.fill('.');
+  out.setf(::std::ios_base::hex, ::std::ios_base::basefield);
+  
+  ::boost::rangeio::write_stats stats;
+  ::boost::rangeio::write_iterator_range(out, r, r + r_size, '|', stats);
+  
+  BOOST_TEST_EQ(::std::streamsize(0), out.width());
+  BOOST_TEST_EQ("...287|...71a|....e6", out.str());
+  BOOST_TEST_EQ(::std::streamoff(20), stats.bytes);
+}
+
+} // namespace formatting
+
+} // namespace write_stats_tests
+
+int main()
+{
+  using namespace write_stats_tests;
+  
+  empty_range::test();
+  normal_range::test();
+  
+  failed_write::test();
+  exception_thrown::test();
+  
+  formatting::test();
+  
+  return boost::report_errors();
+}
+
+#endif  // BOOST_NO_CXX11_RVALUE_REFERENCES
@@ -0,0 +1,179 @@
+//
+// Copyright (c) Mark A. Gibbs, 2015.
+//
+// Distributed under the Boost Software License, Version 1.0.
+// (See accompanying file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+// 
+
+// This test covers write_zipped().
+// 
+// The tests must confirm that the ranges are written as rows, with the
+// delimiters in the right places, that writing stops at the end of the
+// shortest range, and that the formatting and stream state are handled the
+// same way as by write_iterator_range().
+// 
+// This test requires C++11.
+
+#include <boost/config.hpp>
+
+#ifdef BOOST_NO_CXX11_RVALUE_REFERENCES
+#   include <iostream>
+int main() { ::std::cout << "Not supported in C++98.\n"; }
+#else
+
+#include <cstddef>
+#include <cstdint>
+#include <ios>
+#include <list>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include <boost/core/lightweight_test.hpp>
+
+#include <boost/rangeio/write_zipped.hpp>
+
+#include "extras/array_streambuf.hpp"
+#include "extras/more_tests.hpp"
+
+namespace write_zipped_tests {
+
+// Confirm that the ranges are written as rows.
+namespace rows {
+
+void test()
+{
+  ::std::vector< ::std::int64_t> const ids = { 1, 2, 3 };
+  ::std::list< ::std::string> const names = { "one", "two", "three" };
+  double const values[] = { 0.5, 1.25, 2.0 };
+  
+  {
+    ::std::ostringstream out;
+    
+    auto const res = ::boost::rangeio::write_zipped(out, '\n', ", ", ids, names, values);
+    
+    BOOST_TEST(bool(out));
+    BOOST_TEST_EQ(::std::size_t(3), res.count);
+    BOOST_TEST(ids.end() == ::std::get<0>(res.next));
+    BOOST_TEST(names.end() == ::std::get<1>(res.next));
+    BOOST_TEST(values + 3 == ::std::get<2>(res.next));
+    BOOST_RANGEIO_TEST_STR_EQ(out.str(), "1, one, 0.5\n2, two, 1.25\n3, three, 2");
+  }
+  
+  // A single range
+  {
+    ::std::ostringstream out;
+    ::boost::rangeio::write_zipped(out, ';', ',', ids);
+    BOOST_RANGEIO_TEST_STR_EQ(out.str(), "1;2;3");
+  }
+  
+  // Wide streams
+  {
+    ::std::vector<wchar_t> const letters = { L'a', L'b', L'c' };
+    
+    ::std::wostringstream out;
+    ::boost::rangeio::write_zipped(out, L"; ", L'=', letters, ids);
+    BOOST_TEST(out.str() == L"a=1; b=2; c=3");
+  }
+}
+
+} // namespace rows
+
+// Confirm that writing stops at the end of the shortest range.
+namespace lengths {
+
+void test()
+{
+  ::std::vector<int> const a = { 1, 2, 3, 4 };
+  ::std::vector<int> const b = { 5, 6 };
+  ::std::vector<int> const c;
+  
+  {
+    ::std::ostringstream out;
+    
+    auto const res = ::boost::rangeio::write_zipped(out, '|', ',', a, b);
+    
+    BOOST_TEST_EQ(::std::size_t(2), res.count);
+    BOOST_TEST(a.begin() + 2 == ::std::get<0>(res.next));
+    BOOST_TEST(b.end() == ::std::get<1>(res.next));
+    BOOST_RANGEIO_TEST_STR_EQ(out.str(), "1,5|2,6");
+  }
+  
+  {
+    ::std::ostringstream out;
+    
+    auto const res = ::boost::rangeio::write_zipped(out, '|', ',', a, c);
+    
+    BOOST_TEST(bool(out));
+    BOOST_TEST_EQ(::std::size_t(0), res.count);
+    BOOST_TEST(out.str().empty());
+  }
+}
+
+} // namespace lengths
+
+// Confirm that the formatting and stream state are handled properly.
+namespace state {
+
+void test()
+{
+  ::std::vector<int> const a = { 1, 22 };
+  ::std::vector<int> const b = { 333, 4 };
+  
+  // Width applies to each field, but not to the delimiters
+  {
+    ::std::ostringstream out;
+    out.width(3);
+    out.fill('*');
+    
+    ::boost::rangeio::write_zipped(out, '|', ',', a, b);
+    
+    BOOST_RANGEIO_TEST_STR_EQ(out.str(), "**1,333|*22,**4");
+    BOOST_TEST_EQ(0, out.width());
+  }
+  
+  // Stream that fails part way through the second row
+  {
+    ::boost::rangeio::test_extras::array_streambuf<char, 8> buf;
+    ::std::ostream out(&buf);
+    
+    auto const res = ::boost::rangeio::write_zipped(out, '|', ',', a, b);
+    
+    BOOST_TEST(!out);
+    BOOST_TEST_EQ(::std::size_t(1), res.count);
+    BOOST_TEST(a.begin() + 1 == ::std::get<0>(res.next));
+    BOOST_TEST(b.begin() + 1 == ::std::get<1>(res.next));
+  }
+  
+  // Stream that has already failed
+  {
+    ::std::ostringstream out;
+    out.setstate(::std::ios_base::failbit);
+    out.width(5);
+    
+    auto const res = ::boost::rangeio::write_zipped(out, '|', ',', a, b);
+    
+    BOOST_TEST_EQ(::std::size_t(0), res.count);
+    BOOST_TEST(a.begin() == ::std::get<0>(res.next));
+    BOOST_TEST_EQ(0, out.width());
+  }
+}
+
+} // namespace state
+
+} // namespace write_zipped_tests
+
+int main()
+{
+  using namespace write_zipped_tests;
+  
+  rows::test();
+  lengths::test();
+  
+  state::test();
+  
+  return boost::report_errors();
+}
+
+#endif  // BOOST_NO_CXX11_RVALUE_REFERENCES